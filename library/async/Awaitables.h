@@ -0,0 +1,259 @@
+/**
+ * @file Awaitables.h
+ * @brief Provide the events a @ref hal::async::Task "Task" can co_await
+ *
+ * - @ref hal::async::yield() "yield()" lets the other tasks run.
+ * - @ref hal::async::delay() "delay()" resumes the task after a number of milliseconds.
+ * - @ref hal::async::read() "read()" and @ref hal::async::write() "write()" run an asynchronous UART transfer, see
+ *   @ref hal::interfaces::InterfaceUART::readAsync() "readAsync()".
+ * - @ref hal::async::waitIRQ() "waitIRQ()" resumes the task on a GPIO interrupt, see
+ *   @ref hal::interfaces::InterfaceDigitalGPIO::setIRQ() "setIRQ()".
+ *
+ * The awaiters hold everything the event needs, in the frame of the task: nothing is allocated.
+ *
+ * @code{cpp}
+ * hal::async::Task<> echo(hal::interfaces::InterfaceUART &uart, hal::interfaces::InterfaceDigitalGPIO &button) {
+ *
+ *     uint8_t line[16];
+ *
+ *     co_await hal::async::waitIRQ(button, hal::peripherals::gpio::IRQ::EDGE_FALL);
+ *
+ *     const hal::async::TransferResult result{co_await hal::async::read(uart, line)};
+ *     co_await hal::async::write(uart, {line, result.count});
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_AWAITABLES_H
+#define EMBEDDEDLIBRARY_AWAITABLES_H
+
+#include <coroutine>
+#include <span>
+
+#include "../commons/commons.h"
+#include "../interfaces/InterfaceDigitalGPIO.h"
+#include "../interfaces/InterfaceUART.h"
+#include "Scheduler.h"
+
+namespace hal::async {
+
+    /**
+     * Let the tasks already scheduled run before resuming.
+     */
+    class Yield {
+    public:
+
+        [[nodiscard]] bool await_ready() const noexcept {
+
+            return false;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle) const {
+
+            Scheduler::getInstance().schedule(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * Resume the task at a deadline.
+     */
+    class Delay {
+    public:
+
+        /**
+         * @param us delay in microseconds, counted from the construction
+         */
+        explicit Delay(const uint64_t us) : m_timer{Scheduler::now() + us, {}, nullptr} {}
+
+        [[nodiscard]] bool await_ready() const noexcept {
+
+            return false;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle) {
+
+            m_timer.handle = handle;
+            Scheduler::getInstance().addTimer(m_timer);
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        Scheduler::Timer m_timer;   ///< Node of the timer list
+    };
+
+    /**
+     * Result of an asynchronous UART transfer.
+     */
+    struct TransferResult {
+
+        enum Error error;   ///< Error::NONE if every byte was transferred
+        size_t count;       ///< Number of bytes transferred
+    };
+
+    /**
+     * Run an asynchronous UART transfer, the task is resumed by its completion callback.
+     */
+    class UARTTransfer {
+    public:
+
+        UARTTransfer(interfaces::InterfaceUART &uart, const std::span<const uint8_t> data) :
+                m_uart{uart}, m_tx{data}, m_rx{}, m_result{Error::NONE, 0} {}
+
+        UARTTransfer(interfaces::InterfaceUART &uart, const std::span<uint8_t> data) :
+                m_uart{uart}, m_tx{}, m_rx{data}, m_result{Error::NONE, 0} {}
+
+        [[nodiscard]] bool await_ready() const noexcept {
+
+            return false;
+        }
+
+        /**
+         * @return false if the transfer could not start, the task goes on straight away
+         */
+        bool await_suspend(const std::coroutine_handle<> handle) {
+
+            m_handle = handle;
+
+            if(m_rx.data() != nullptr ? m_uart.readAsync(m_rx, complete, this) : m_uart.writeAsync(m_tx, complete, this)) {
+
+                m_result = {m_uart.getLastError(), 0};
+                return false;
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] TransferResult await_resume() const noexcept {
+
+            return m_result;
+        }
+
+    private:
+
+        static void complete(const enum Error error, const size_t count, void * const context) {
+
+            auto * const transfer{static_cast<UARTTransfer *>(context)};
+
+            transfer->m_result = {error, count};
+            Scheduler::getInstance().schedule(transfer->m_handle);
+        }
+
+        interfaces::InterfaceUART &m_uart;
+        std::span<const uint8_t> m_tx;      ///< Data to send
+        std::span<uint8_t> m_rx;            ///< Buffer receiving the data, used if not null
+        TransferResult m_result;            ///< Set by the completion callback
+        std::coroutine_handle<> m_handle;   ///< Task waiting for the transfer
+    };
+
+    /**
+     * Wait for a GPIO interrupt, the interrupt is detached as soon as it is raised.
+     */
+    class IRQWait {
+    public:
+
+        IRQWait(interfaces::InterfaceDigitalGPIO &gpio, const enum peripherals::gpio::IRQ gpio_irq) :
+                m_gpio{gpio}, m_gpio_irq{gpio_irq}, m_error{Error::NONE} {}
+
+        [[nodiscard]] bool await_ready() const noexcept {
+
+            return false;
+        }
+
+        /**
+         * @return false if the interrupt could not be attached, the task goes on straight away
+         */
+        bool await_suspend(const std::coroutine_handle<> handle) {
+
+            m_handle = handle;
+
+            if(m_gpio.setIRQ(m_gpio_irq, raised, this)) {
+
+                m_error = m_gpio.getLastError();
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @return Error::NONE once the interrupt was raised, the error of setIRQ() otherwise
+         */
+        [[nodiscard]] enum Error await_resume() const noexcept {
+
+            return m_error;
+        }
+
+    private:
+
+        static void raised(const uint gpio_pin, const enum peripherals::gpio::IRQ gpio_irq, void * const context) {
+
+            (void)gpio_pin;
+            (void)gpio_irq;
+
+            auto * const wait{static_cast<IRQWait *>(context)};
+
+            // Detach first, a level interrupt would be raised again until the task runs
+            (void)wait->m_gpio.setIRQ(peripherals::gpio::IRQ::NONE);
+            Scheduler::getInstance().schedule(wait->m_handle);
+        }
+
+        interfaces::InterfaceDigitalGPIO &m_gpio;
+        enum peripherals::gpio::IRQ m_gpio_irq;     ///< Condition waited for
+        enum Error m_error;                         ///< Error of setIRQ()
+        std::coroutine_handle<> m_handle;           ///< Task waiting for the interrupt
+    };
+
+    /**
+     * @return awaiter resuming the task once the other scheduled tasks ran
+     */
+    inline Yield yield() {
+
+        return {};
+    }
+
+    /**
+     * @param ms delay in milliseconds
+     * @return awaiter resuming the task after the delay
+     */
+    inline Delay delay(const uint32_t ms) {
+
+        return Delay{static_cast<uint64_t>(ms) * 1'000U};
+    }
+
+    /**
+     * @param uart UART receiving the data
+     * @param buffer buffer receiving the data, the transfer completes when it is full
+     * @return awaiter resuming the task with the @ref hal::async::TransferResult "TransferResult"
+     */
+    inline UARTTransfer read(interfaces::InterfaceUART &uart, const std::span<uint8_t> buffer) {
+
+        return {uart, buffer};
+    }
+
+    /**
+     * @param uart UART sending the data
+     * @param buffer data to send
+     * @return awaiter resuming the task with the @ref hal::async::TransferResult "TransferResult"
+     */
+    inline UARTTransfer write(interfaces::InterfaceUART &uart, const std::span<const uint8_t> buffer) {
+
+        return {uart, buffer};
+    }
+
+    /**
+     * @param gpio pin to watch
+     * @param gpio_irq condition to wait for
+     * @return awaiter resuming the task when the interrupt is raised, with Error::NONE or the error of setIRQ()
+     */
+    inline IRQWait waitIRQ(interfaces::InterfaceDigitalGPIO &gpio, const enum peripherals::gpio::IRQ gpio_irq) {
+
+        return {gpio, gpio_irq};
+    }
+
+} // namespace hal::async
+
+#endif //EMBEDDEDLIBRARY_AWAITABLES_H
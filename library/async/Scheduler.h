@@ -0,0 +1,234 @@
+/**
+ * @file Scheduler.h
+ * @brief Provide a heap-free single core scheduler running @ref hal::async::Task "Task" coroutines
+ *
+ * The @ref hal::async::Scheduler "Scheduler" resumes the tasks whose awaited event happened: a timer that expired,
+ * or a handle given to @ref hal::async::Scheduler::schedule() "schedule()" by an interrupt (UART transfer completed,
+ * GPIO edge...). It never resumes a task from an interrupt, only from @ref hal::async::Scheduler::run() "run()",
+ * and sleeps in between.
+ *
+ * - The ready queue holds @ref hal::async::SCHEDULER_QUEUE_SIZE "SCHEDULER_QUEUE_SIZE" handles, enough for every frame
+ *   of the pool since a task waits for one event at a time.
+ * - The timers are nodes of a sorted list, stored in the awaiters, so in the frames of the tasks.
+ *
+ * On host the scheduler is the executor of the tests and the benchmarks.
+ *
+ * @code{cpp}
+ * hal::async::Task<> blink(hal::interfaces::InterfaceDigitalGPIO &led) {
+ *
+ *     while(true) {
+ *         led.toggle();
+ *         co_await hal::async::delay(500);
+ *     }
+ * }
+ *
+ * auto &scheduler{hal::async::Scheduler::getInstance()};
+ * scheduler.spawn(blink(led));
+ * scheduler.run();
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_SCHEDULER_H
+#define EMBEDDEDLIBRARY_SCHEDULER_H
+
+#include <coroutine>
+#include <limits>
+
+#include "../clock/Clock.h"
+#include "../commons/commons.h"
+#include "../data_structures/SpscRing.h"
+#include "../traits/Singleton.h"
+#include "Task.h"
+
+#ifdef HAL_RP2040
+#include "Scheduler_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Scheduler_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::async {
+
+    constexpr size_t SCHEDULER_QUEUE_SIZE{HAL_SCHEDULER_QUEUE_SIZE};    ///< size of the ready queue
+
+    static_assert(SCHEDULER_QUEUE_SIZE >= COROUTINE_FRAMES, "The ready queue must hold a handle per coroutine frame");
+
+    /**
+     * Run the tasks on one core.
+     */
+    class Scheduler : public traits::Singleton {
+    public:
+
+        /**
+         * Task waiting for a deadline, node of the timer list.
+         */
+        struct Timer {
+
+            uint64_t deadline;                  ///< Time in microseconds
+            std::coroutine_handle<> handle;     ///< Task resumed at the deadline
+            Timer *next;                        ///< Next timer, by deadline
+        };
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~Scheduler() override =default;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Run a task, its frame is released when it returns.
+         *
+         * @param task task to run
+         * @return whether an error occurred, true if the task is invalid (no frame)
+         */
+        bool spawn(Task<> &&task) {
+
+            m_last_error = Error::NONE;
+
+            if(!task) {
+
+                m_last_error = Error::TOOSMALL;
+                return true;
+            }
+
+            m_tasks++;
+            schedule(task.spawn(m_tasks));
+
+            return false;
+        }
+
+        /**
+         * Resume a task at the next run of the scheduler.
+         *
+         * @note Can be called from an interrupt, a task must be scheduled at most once per suspension.
+         *
+         * @param handle suspended task
+         */
+        void schedule(const std::coroutine_handle<> handle) {
+
+            {
+                const detail::SchedulerIO::CriticalSection section{};
+                m_ready.push(handle);
+            }
+
+            detail::SchedulerIO::notify();
+        }
+
+        /**
+         * Resume a task at a deadline.
+         *
+         * @param timer timer of the task, must stay valid until it is resumed
+         */
+        void addTimer(Timer &timer) {
+
+            Timer **position{&m_timers};
+
+            // Tasks with the same deadline are resumed in order
+            while(*position != nullptr and (*position)->deadline <= timer.deadline) {
+                position = &(*position)->next;
+            }
+
+            timer.next = *position;
+            *position = &timer;
+        }
+
+        /**
+         * Resume the tasks whose timer expired, then the tasks scheduled before the call.
+         *
+         * @return number of tasks resumed
+         */
+        size_t runOnce() {
+
+            size_t resumed{0};
+
+            for(const uint64_t now{clock::now_us()}; m_timers != nullptr and m_timers->deadline <= now; resumed++) {
+
+                Timer * const timer{m_timers};
+                m_timers = timer->next;
+                timer->handle.resume();
+            }
+
+            // The tasks scheduled by the ones resumed here wait for the next run
+            for(size_t count{m_ready.size()}; count > 0; count--, resumed++) {
+
+                std::coroutine_handle<> handle;
+                bool popped;
+
+                {
+                    const detail::SchedulerIO::CriticalSection section{};
+                    popped = m_ready.pop(handle);
+                }
+
+                if(!popped) {
+                    break;
+                }
+
+                handle.resume();
+            }
+
+            return resumed;
+        }
+
+        /**
+         * Run the tasks until every spawned task returned, sleeping while none can be resumed.
+         */
+        void run() {
+
+            while(m_tasks > 0) {
+
+                if(runOnce() == 0) {
+                    detail::SchedulerIO::wait(m_timers != nullptr ? m_timers->deadline : std::numeric_limits<uint64_t>::max());
+                }
+            }
+        }
+
+        /**
+         * @return number of spawned tasks that did not return yet
+         */
+        [[nodiscard]] size_t getTaskCount() const {
+
+            return m_tasks;
+        }
+
+        /**
+         * @return time used by the timers, @ref hal::clock::now_us() "now_us()"
+         */
+        [[nodiscard]] static uint64_t now() {
+
+            return clock::now_us();
+        }
+
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+        static Scheduler &getInstance() {
+
+            static Scheduler s_scheduler{};
+            return s_scheduler;
+        }
+
+    protected:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        Scheduler() : m_ready{}, m_timers{nullptr}, m_tasks{0}, m_last_error{Error::NONE} {}
+
+        data_structures::SpscRing<std::coroutine_handle<>, SCHEDULER_QUEUE_SIZE> m_ready;  ///< Tasks to resume
+        Timer *m_timers;    ///< Timers sorted by deadline
+        size_t m_tasks;     ///< Spawned tasks that did not return yet
+
+        enum Error m_last_error;
+    };
+
+} // namespace hal::async
+
+#endif //EMBEDDEDLIBRARY_SCHEDULER_H
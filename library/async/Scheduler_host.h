@@ -0,0 +1,80 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_SCHEDULER_HOST_H
+#define EMBEDDEDLIBRARY_SCHEDULER_HOST_H
+
+#include "../commons/commons.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+namespace hal::async::detail {
+
+    /**
+     * Host executor of the scheduler: the "interrupts" are the UART transfer thread and the simulated GPIO,
+     * the scheduler sleeps on a condition variable until one of them wakes it up or the next timer expires.
+     */
+    struct SchedulerIO {
+
+        /**
+         * Section where the ready queue is accessed, by the scheduler or an "interrupt".
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_lock{s_queue_mutex} {}
+
+        private:
+
+            std::lock_guard<std::mutex> m_lock;
+        };
+
+        /**
+         * Wake the scheduler up, or prevent the next wait() from sleeping.
+         */
+        static void notify() {
+
+            {
+                const std::lock_guard<std::mutex> lock{s_wait_mutex};
+                s_pending = true;
+            }
+
+            s_event.notify_one();
+        }
+
+        /**
+         * Sleep until notify() is called or the deadline is reached.
+         *
+         * @param deadline time in microseconds, std::numeric_limits<uint64_t>::max() to wait for notify() only
+         */
+        static void wait(const uint64_t deadline) {
+
+            std::unique_lock<std::mutex> lock{s_wait_mutex};
+
+            if(deadline == std::numeric_limits<uint64_t>::max()) {
+
+                s_event.wait(lock, []() { return s_pending; });
+            } else {
+
+                const std::chrono::steady_clock::time_point time_point{std::chrono::microseconds{deadline}};
+                s_event.wait_until(lock, time_point, []() { return s_pending; });
+            }
+
+            s_pending = false;
+        }
+
+    private:
+
+        inline static std::mutex s_queue_mutex{};           ///< Stand in for masking the interrupts
+        inline static std::mutex s_wait_mutex{};            ///< Protect s_pending
+        inline static std::condition_variable s_event{};    ///< Stand in for the event register
+        inline static bool s_pending{false};                ///< Whether notify() was called since the last wait()
+    };
+
+} // namespace hal::async::detail
+
+#endif //EMBEDDEDLIBRARY_SCHEDULER_HOST_H
@@ -0,0 +1,71 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_SCHEDULER_RP2040_H
+#define EMBEDDEDLIBRARY_SCHEDULER_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <limits>
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include <pico/time.h>
+
+namespace hal::async::detail {
+
+    /**
+     * Access to the core running the scheduler: the interrupts wake it up with SEV, it sleeps in WFE.
+     */
+    struct SchedulerIO {
+
+        /**
+         * Section where the ready queue is accessed, by the scheduler or an interrupt.
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_status{save_and_disable_interrupts()} {}
+
+            ~CriticalSection() {
+
+                restore_interrupts(m_status);
+            }
+
+            CriticalSection(const CriticalSection &)=delete;
+            CriticalSection &operator=(const CriticalSection &)=delete;
+
+        private:
+
+            uint32_t m_status;  ///< Interrupt state before the section
+        };
+
+        /**
+         * Wake the scheduler up, or prevent the next wait() from sleeping.
+         */
+        static void notify() {
+
+            __sev();
+        }
+
+        /**
+         * Sleep until an event or the deadline.
+         *
+         * @param deadline time in microseconds, std::numeric_limits<uint64_t>::max() to wait for an event only
+         */
+        static void wait(const uint64_t deadline) {
+
+            if(deadline == std::numeric_limits<uint64_t>::max()) {
+
+                __wfe();
+            } else {
+
+                best_effort_wfe_or_timeout(from_us_since_boot(deadline));
+            }
+        }
+    };
+
+} // namespace hal::async::detail
+
+#endif //EMBEDDEDLIBRARY_SCHEDULER_RP2040_H
@@ -0,0 +1,322 @@
+/**
+ * @file Task.h
+ * @brief Provide the coroutine type run by the @ref hal::async::Scheduler "Scheduler"
+ *
+ * A @ref hal::async::Task "Task" is a C++20 coroutine that starts suspended. It is either given to the scheduler with
+ * @ref hal::async::Scheduler::spawn() "spawn()", or awaited by another task, which resumes once it returns:
+ * protocols are written linearly, one step per co_await.
+ *
+ * There is no heap: the frames come from a static pool of @ref hal::async::COROUTINE_FRAMES "COROUTINE_FRAMES" blocks
+ * of @ref hal::async::COROUTINE_FRAME_SIZE "COROUTINE_FRAME_SIZE" bytes. When the pool is empty, or the frame too big,
+ * the task is invalid (false when converted to bool).
+ *
+ * @code{cpp}
+ * hal::async::Task<uint8_t> readCommand(hal::interfaces::InterfaceUART &uart) {
+ *
+ *     uint8_t command{0};
+ *     co_await hal::async::read(uart, {&command, 1});
+ *     co_return command;
+ * }
+ *
+ * hal::async::Task<> serve(hal::interfaces::InterfaceUART &uart) {
+ *
+ *     while(true) {
+ *         const uint8_t command{co_await readCommand(uart)};
+ *         ...
+ *     }
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_TASK_H
+#define EMBEDDEDLIBRARY_TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "../commons/commons.h"
+#include "../data_structures/BitSet.h"
+
+namespace hal::async {
+
+    constexpr size_t COROUTINE_FRAMES{HAL_COROUTINE_FRAMES};            ///< number of frames of the pool
+    constexpr size_t COROUTINE_FRAME_SIZE{HAL_COROUTINE_FRAME_SIZE};    ///< size of a frame in bytes
+
+    class Scheduler;
+
+    namespace detail {
+
+        /**
+         * Static pool of coroutine frames, used from thread context only.
+         */
+        class FramePool {
+        public:
+
+            /**
+             * @param size size of the frame
+             * @return free block, nullptr if the frame is too big or the pool is empty
+             */
+            static void *allocate(const size_t size) noexcept {
+
+                const size_t index{s_used.findFirstClear()};
+
+                if(size > COROUTINE_FRAME_SIZE or index >= COROUTINE_FRAMES) {
+
+                    return nullptr;
+                }
+
+                s_used.set(index);
+
+                return s_frames[index].bytes;
+            }
+
+            static void deallocate(void * const frame) noexcept {
+
+                s_used.clear(static_cast<size_t>(static_cast<Frame *>(frame) - s_frames));
+            }
+
+            /**
+             * @return number of frames in use
+             */
+            [[nodiscard]] static size_t getUsed() {
+
+                return s_used.count();
+            }
+
+        private:
+
+            struct Frame {
+
+                alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) std::byte bytes[COROUTINE_FRAME_SIZE];
+            };
+
+            inline static Frame s_frames[COROUTINE_FRAMES]{};
+            inline static data_structures::BitSet<COROUTINE_FRAMES> s_used{};   ///< Frames in use
+        };
+
+        /**
+         * Part of the promise shared by every result type.
+         */
+        struct PromiseBase {
+
+            /**
+             * Resume the task awaiting this one, or release a spawned task.
+             */
+            struct FinalAwaiter {
+
+                [[nodiscard]] bool await_ready() const noexcept {
+
+                    return false;
+                }
+
+                template<typename P>
+                std::coroutine_handle<> await_suspend(const std::coroutine_handle<P> handle) noexcept {
+
+                    PromiseBase &promise{handle.promise()};
+
+                    if(promise.m_continuation) {
+
+                        return promise.m_continuation;
+                    }
+
+                    if(promise.m_spawned != nullptr) {
+
+                        (*promise.m_spawned)--;
+                        handle.destroy();
+                    }
+
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            static void *operator new(const size_t size) noexcept {
+
+                return FramePool::allocate(size);
+            }
+
+            static void operator delete(void * const frame) noexcept {
+
+                FramePool::deallocate(frame);
+            }
+
+            [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+
+                return {};
+            }
+
+            [[nodiscard]] FinalAwaiter final_suspend() const noexcept {
+
+                return {};
+            }
+
+            void unhandled_exception() const noexcept {
+
+                std::terminate();
+            }
+
+            std::coroutine_handle<> m_continuation{};   ///< Task awaiting this one
+            size_t *m_spawned{nullptr};                 ///< Task counter of the scheduler for a spawned task
+        };
+
+        template<typename T>
+        struct Promise : PromiseBase {
+
+            void return_value(T value) {
+
+                m_value = std::move(value);
+            }
+
+            T m_value{};    ///< Result of the task
+        };
+
+        template<>
+        struct Promise<void> : PromiseBase {
+
+            void return_void() const noexcept {}
+        };
+
+    } // namespace detail
+
+    /**
+     * Coroutine run by the scheduler.
+     *
+     * @tparam T result of the task, given by co_return
+     */
+    template<typename T=void>
+    class [[nodiscard]] Task {
+    public:
+
+        struct promise_type : detail::Promise<T> {
+
+            Task get_return_object() {
+
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            static Task get_return_object_on_allocation_failure() {
+
+                return Task{};
+            }
+        };
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        Task() : m_handle{} {}
+
+        Task(Task &&other) noexcept : m_handle{std::exchange(other.m_handle, {})} {}
+
+        Task(const Task &)=delete;
+
+        ~Task() {
+
+            if(m_handle) {
+
+                m_handle.destroy();
+            }
+        }
+
+        //****************************************************************
+        //                           Operators
+        //****************************************************************
+
+        Task &operator=(Task &&other) noexcept {
+
+            if(this != &other) {
+
+                if(m_handle) {
+                    m_handle.destroy();
+                }
+
+                m_handle = std::exchange(other.m_handle, {});
+            }
+
+            return *this;
+        }
+
+        Task &operator=(const Task &)=delete;
+
+        /**
+         * @return whether the task got a frame
+         */
+        explicit operator bool() const {
+
+            return static_cast<bool>(m_handle);
+        }
+
+        /**
+         * Start the task and suspend the caller until it returns.
+         * An invalid task returns a default constructed result straight away.
+         */
+        auto operator co_await() && noexcept {
+
+            struct Awaiter {
+
+                [[nodiscard]] bool await_ready() const noexcept {
+
+                    return !m_handle or m_handle.done();
+                }
+
+                std::coroutine_handle<> await_suspend(const std::coroutine_handle<> caller) noexcept {
+
+                    m_handle.promise().m_continuation = caller;
+
+                    return m_handle;
+                }
+
+                T await_resume() noexcept {
+
+                    if constexpr (!std::is_void_v<T>) {
+                        return m_handle ? std::move(m_handle.promise().m_value) : T{};
+                    }
+                }
+
+                std::coroutine_handle<promise_type> m_handle;
+            };
+
+            return Awaiter{m_handle};
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * @return whether the task returned
+         */
+        [[nodiscard]] bool isDone() const {
+
+            return m_handle and m_handle.done();
+        }
+
+    private:
+
+        friend class Scheduler;
+
+        explicit Task(const std::coroutine_handle<promise_type> handle) : m_handle{handle} {}
+
+        /**
+         * Hand the frame over to the scheduler, it is released when the task returns.
+         *
+         * @param tasks counter decremented when the task returns
+         * @return the coroutine
+         */
+        std::coroutine_handle<> spawn(size_t &tasks) {
+
+            m_handle.promise().m_spawned = &tasks;
+
+            return std::exchange(m_handle, {});
+        }
+
+        std::coroutine_handle<promise_type> m_handle;  ///< Coroutine owned by the task
+    };
+
+} // namespace hal::async
+
+#endif //EMBEDDEDLIBRARY_TASK_H
@@ -0,0 +1,652 @@
+/**
+ * @file BusScheduler.h
+ * @brief Provide the schedulers sharing an I2C or SPI bus between many drivers
+ *
+ * Drivers calling the bus one after the other each wait for their own transfer and leave the bus idle in between.
+ * Instead, they submit @ref hal::bus::Request "Request" to the scheduler of the bus and are called back once done:
+ *
+ * - The requests wait in one FIFO per @ref hal::bus::Priority "Priority", the highest priority goes first.
+ * - Up to @ref hal::peripherals::BUS_BATCH_SIZE "BUS_BATCH_SIZE" requests are started at once, as one list of I2C
+ *   transactions or as queued SPI transactions, and run back to back with DMA.
+ * - On I2C, reads of contiguous registers of the same device that follow each other are coalesced into one
+ *   transaction: one address, one register pointer and one repeated start for all of them.
+ * - The time between the submission and the completion is recorded per device, see
+ *   @ref hal::bus::DeviceLatency "DeviceLatency".
+ *
+ * @code{cpp}
+ * auto &scheduler{hal::bus::I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+ *
+ * const uint8_t accel_reg{0x3B};
+ * uint8_t accel[6];
+ * hal::bus::I2CRequest accel_request{{0x68, {&accel_reg, 1}, accel}, hal::bus::Priority::HIGH, on_accel};
+ *
+ * scheduler.submit(accel_request);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_BUSSCHEDULER_H
+#define EMBEDDEDLIBRARY_BUSSCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "../commons/commons.h"
+#include "../clock/Clock.h"
+#include "../peripherals/I2C.h"
+#include "../peripherals/SPI.h"
+
+#ifdef HAL_RP2040
+#include "BusScheduler_rp2040.h"
+#elif defined(HAL_HOST)
+#include "BusScheduler_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::bus {
+
+    /**
+     * Priority of a request, the requests of the same priority run in submission order.
+     */
+    enum class Priority : uint8_t {
+
+        HIGH,
+        NORMAL,
+        LOW
+    };
+
+    constexpr size_t PRIORITIES{3};     ///< Number of priorities
+
+    /**
+     * Function called when a request completes.
+     *
+     * @warning On RP2040 it runs in interrupt context, keep it short: the next batch starts once it returns.
+     *
+     * @param error Error::NONE if the request succeeded, the error of its transaction otherwise
+     * @param context pointer given with the request
+     */
+    using RequestCallback = void (*)(Error error, void *context);
+
+    /**
+     * Transaction submitted to a scheduler, owned by the driver.
+     *
+     * @note The request and its buffers must stay valid until its callback is called, it may be submitted again
+     * from there.
+     *
+     * @tparam T transaction of the bus
+     */
+    template<typename T>
+    struct Request {
+
+        T transaction;                          ///< What to exchange with the device
+        Priority priority{Priority::NORMAL};    ///< Priority of the request
+        RequestCallback callback{nullptr};      ///< Called once the request completes, may be nullptr
+        void *context{nullptr};                 ///< Given back to the callback
+        enum Error error{Error::NONE};          ///< Set once the request completes
+
+        Request *next{nullptr};                 ///< Used by the scheduler, next request of the same priority
+        uint64_t submitted{0};                  ///< Used by the scheduler, time of the submission in microseconds
+    };
+
+    using I2CRequest = Request<peripherals::i2c::Transaction>;     ///< Request for an I2C device
+    using SPIRequest = Request<peripherals::spi::Transaction>;     ///< Request for an SPI device, the callback of its transaction is used by the scheduler
+
+    /**
+     * Latency of the requests of a device, from their submission to their completion.
+     */
+    struct DeviceLatency {
+
+        uint32_t requests;      ///< Requests completed
+        uint32_t mean_latency;  ///< Mean latency, in microseconds
+        uint32_t max_latency;   ///< Longest latency, in microseconds
+    };
+
+    /**
+     * Queues and latencies shared by the schedulers of the buses.
+     *
+     * @tparam T transaction of the bus
+     * @tparam Devices number of devices the bus addresses
+     */
+    template<typename T, size_t Devices>
+    class BusScheduler : public traits::Singleton {
+    public:
+
+        /**
+         * Determine if requests are queued or running.
+         *
+         * @return true until the last request completed
+         */
+        [[nodiscard]] bool isBusy() const {
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+
+            return m_running or std::any_of(std::begin(m_queues), std::end(m_queues), [](const Queue &queue) {
+                return queue.head != nullptr;
+            });
+        }
+
+        /**
+         * @param device device, see the scheduler of the bus
+         * @return latency of its requests since the last reset
+         */
+        [[nodiscard]] DeviceLatency getLatency(const size_t device) const {
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+
+            if(device >= Devices or m_latencies[device].requests == 0) {
+                return {0, 0, 0};
+            }
+
+            const Latency &latency{m_latencies[device]};
+
+            return {latency.requests, static_cast<uint32_t>(latency.total / latency.requests), latency.max};
+        }
+
+        void resetLatency() {
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+
+            std::fill(std::begin(m_latencies), std::end(m_latencies), Latency{});
+        }
+
+        /**
+         * Get the last error that occurred.
+         *
+         * @return last error
+         */
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+
+        BusScheduler() : m_queues{}, m_latencies{}, m_batch{}, m_count{0}, m_running{false}, m_starting{false},
+          m_last_error{Error::NONE} {}
+
+        /**
+         * Queue a request.
+         */
+        void push(Request<T> &request) {
+
+            request.next = nullptr;
+            request.error = Error::NONE;
+            request.submitted = clock::now_us();
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+            Queue &queue{m_queues[static_cast<size_t>(request.priority) % PRIORITIES]};
+
+            if(queue.tail == nullptr) {
+                queue.head = &request;
+            } else {
+                queue.tail->next = &request;
+            }
+
+            queue.tail = &request;
+        }
+
+        /**
+         * Move the next requests into m_batch, unless a batch is running.
+         *
+         * @param max number of requests at most
+         * @return number of requests taken, the batch runs until finish() if not zero
+         */
+        size_t take(const size_t max) {
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+
+            if(m_running) {
+                return 0;
+            }
+
+            m_count = 0;
+
+            for(Queue &queue : m_queues) {
+
+                while(queue.head != nullptr and m_count < max) {
+
+                    m_batch[m_count++] = queue.head;
+                    queue.head = queue.head->next;
+                }
+
+                if(queue.head == nullptr) {
+                    queue.tail = nullptr;
+                }
+            }
+
+            m_running = m_count > 0;
+
+            return m_count;
+        }
+
+        /**
+         * Start batches until one is left running or the queues are empty. Called while it loops, by a batch completing
+         * before it was started or by a callback submitting again, it returns and the loop takes the next batch, so
+         * the stack does not grow with the number of batches.
+         *
+         * @param max number of requests of a batch at most
+         * @param launch function starting the batch taken, given its number of requests
+         */
+        template<typename Launch>
+        void run(const size_t max, const Launch &launch) {
+
+            {
+                const detail::BusSchedulerIO::CriticalSection section{};
+
+                if(m_starting) {
+                    return;
+                }
+
+                m_starting = true;
+            }
+
+            while(true) {
+
+                size_t count;
+
+                {
+                    const detail::BusSchedulerIO::CriticalSection section{};
+
+                    // Left with the batch still running, its completion starts the next one
+                    count = take(max);
+
+                    if(count == 0) {
+                        m_starting = false;
+                        return;
+                    }
+                }
+
+                launch(count);
+            }
+        }
+
+        /**
+         * Record the latencies of the batch and call the callbacks, then end the batch.
+         *
+         * @param device function giving the device of a request
+         */
+        template<typename Device>
+        void finish(const Device &device) {
+
+            const uint64_t now{clock::now_us()};
+            Request<T> *done[peripherals::BUS_BATCH_SIZE];
+            const size_t count{m_count};
+
+            {
+                const detail::BusSchedulerIO::CriticalSection section{};
+
+                for(size_t i{0}; i < count; i++) {
+
+                    done[i] = m_batch[i];
+
+                    const size_t index{device(*done[i])};
+
+                    if(index < Devices) {
+
+                        Latency &latency{m_latencies[index]};
+                        const auto elapsed{static_cast<uint32_t>(std::min<uint64_t>(now - done[i]->submitted, UINT32_MAX))};
+
+                        latency.requests++;
+                        latency.total += elapsed;
+                        latency.max = std::max(latency.max, elapsed);
+                    }
+                }
+            }
+
+            // A callback may submit its request again, it waits for the next batch
+            for(size_t i{0}; i < count; i++) {
+
+                if(done[i]->callback != nullptr) {
+                    done[i]->callback(done[i]->error, done[i]->context);
+                }
+            }
+
+            const detail::BusSchedulerIO::CriticalSection section{};
+            m_running = false;
+        }
+
+        /**
+         * Requests of one priority, in submission order.
+         */
+        struct Queue {
+
+            Request<T> *head;   ///< Next request to run
+            Request<T> *tail;   ///< Last request submitted
+        };
+
+        /**
+         * Latency of the requests of one device.
+         */
+        struct Latency {
+
+            uint32_t requests{0};   ///< Requests completed
+            uint64_t total{0};      ///< Sum of their latencies
+            uint32_t max{0};        ///< Longest latency
+        };
+
+        Queue m_queues[PRIORITIES];                                 ///< Requests waiting, by priority
+        Latency m_latencies[Devices];                               ///< Latencies, by device
+        Request<T> *m_batch[peripherals::BUS_BATCH_SIZE];           ///< Requests running
+        size_t m_count;                                             ///< Number of requests running
+        bool m_running;                                             ///< Whether a batch runs
+        bool m_starting;                                            ///< Whether run() is looping
+
+        enum Error m_last_error;
+    };
+
+    /**
+     * Scheduler of an I2C bus, the devices are the 7 bits addresses.
+     */
+    class I2CScheduler : public BusScheduler<peripherals::i2c::Transaction, 128> {
+    public:
+
+        /**
+         * Queue a request and start it if the bus is free.
+         *
+         * @param request request, its transaction is checked like the ones of a list, see
+         * @ref hal::interfaces::InterfaceI2C::transfer() "transfer()"
+         * @return whether an error occurred, the request is not queued then
+         */
+        bool submit(I2CRequest &request) {
+
+            const peripherals::i2c::Transaction &transaction{request.transaction};
+            const size_t length{transaction.write.size() + transaction.read.size()};
+
+            m_last_error = Error::NONE;
+
+            if(!peripherals::i2c::isValidAddress(transaction.address)) {
+                m_last_error = Error::ERROR;
+            } else if(length == 0) {
+                m_last_error = Error::TOOSMALL;
+            } else if(length > peripherals::I2C_MAX_TRANSFER) {
+                m_last_error = Error::TOOBIG;
+            }
+
+            if(m_last_error != Error::NONE) {
+
+                request.error = m_last_error;
+                return true;
+            }
+
+            push(request);
+            start();
+
+            return false;
+        }
+
+        static I2CScheduler &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case peripherals::I2C_INSTANCE0:
+                    static I2CScheduler s_scheduler_instance0{peripherals::i2c::I2C::getInstance(instance)};
+                    return s_scheduler_instance0;
+
+                case peripherals::I2C_INSTANCE1:
+                    static I2CScheduler s_scheduler_instance1{peripherals::i2c::I2C::getInstance(instance)};
+                    return s_scheduler_instance1;
+            }
+        }
+
+    protected:
+
+        explicit I2CScheduler(interfaces::InterfaceI2C &i2c)
+        : BusScheduler(), m_i2c{i2c}, m_groups{}, m_group_count{0}, m_transactions{}, m_scratch{} {}
+
+        /**
+         * Requests of the batch executed by one transaction.
+         */
+        struct Group {
+
+            size_t first;       ///< Index of the first request in m_batch
+            size_t count;       ///< Number of requests, more than one if they are coalesced
+            size_t length;      ///< Bytes read by all of them
+        };
+
+        interfaces::InterfaceI2C &m_i2c;    ///< Bus of the scheduler
+
+        Group m_groups[peripherals::BUS_BATCH_SIZE];                                ///< Transactions of the batch
+        size_t m_group_count;                                                       ///< Number of transactions of the batch
+        peripherals::i2c::Transaction m_transactions[peripherals::BUS_BATCH_SIZE];  ///< List given to the bus
+        uint8_t m_scratch[peripherals::BUS_BATCH_SIZE][peripherals::I2C_MAX_TRANSFER];  ///< Bytes read by the coalesced transactions
+
+    private:
+
+        /**
+         * @return whether a request is a read of registers: one byte written, the register, then bytes read
+         */
+        static bool isRegisterRead(const I2CRequest &request) {
+
+            return request.transaction.write.size() == 1 and !request.transaction.read.empty();
+        }
+
+        /**
+         * @return whether a request reads the registers right after the ones of a group, from the same device
+         */
+        bool extends(const Group &group, const I2CRequest &request) const {
+
+            const I2CRequest &first{*m_batch[group.first]};
+
+            return isRegisterRead(first) and isRegisterRead(request)
+                   and request.transaction.address == first.transaction.address
+                   and request.transaction.write[0] == first.transaction.write[0] + group.length
+                   and group.length + request.transaction.read.size() < peripherals::I2C_MAX_TRANSFER;
+        }
+
+        /**
+         * Start the next batches while the bus is free.
+         */
+        void start() {
+
+            run(peripherals::BUS_BATCH_SIZE, [this](const size_t count) { launch(count); });
+        }
+
+        /**
+         * Group the requests of the batch into transactions and start them.
+         *
+         * @param count number of requests of the batch
+         */
+        void launch(const size_t count) {
+
+            m_group_count = 0;
+
+            for(size_t i{0}; i < count; i++) {
+
+                if(m_group_count > 0 and extends(m_groups[m_group_count - 1], *m_batch[i])) {
+
+                    m_groups[m_group_count - 1].count++;
+                    m_groups[m_group_count - 1].length += m_batch[i]->transaction.read.size();
+                } else {
+
+                    m_groups[m_group_count++] = {i, 1, m_batch[i]->transaction.read.size()};
+                }
+            }
+
+            for(size_t g{0}; g < m_group_count; g++) {
+
+                const Group &group{m_groups[g]};
+
+                m_transactions[g] = m_batch[group.first]->transaction;
+
+                if(group.count > 1) {
+                    m_transactions[g].read = {m_scratch[g], group.length};
+                }
+
+                // Overwritten once executed, left if the bus gives up before
+                m_transactions[g].error = Error::AGAIN;
+            }
+
+            const std::span<peripherals::i2c::Transaction> transactions{m_transactions, m_group_count};
+
+            // Without DMA, or with the bus taken by a direct call, the batch runs now. Not in an interrupt though, the
+            // transactions are left with Error::AGAIN then.
+            if(m_i2c.transferAsync(transactions, onComplete, this)) {
+
+                if(!detail::BusSchedulerIO::inInterrupt()) {
+                    m_i2c.transfer(transactions);
+                }
+
+                complete();
+            }
+        }
+
+        static void onComplete(const Error, const size_t, void * const context) {
+
+            auto &scheduler{*static_cast<I2CScheduler *>(context)};
+
+            scheduler.complete();
+            scheduler.start();
+        }
+
+        /**
+         * Give the result of every transaction to its requests and end the batch.
+         */
+        void complete() {
+
+            for(size_t g{0}; g < m_group_count; g++) {
+
+                const Group &group{m_groups[g]};
+                const enum Error error{m_transactions[g].error};
+                size_t offset{0};
+
+                for(size_t i{group.first}; i < group.first + group.count; i++) {
+
+                    I2CRequest &request{*m_batch[i]};
+
+                    if(group.count > 1 and error == Error::NONE) {
+                        std::memcpy(request.transaction.read.data(), m_scratch[g] + offset, request.transaction.read.size());
+                    }
+
+                    offset += request.transaction.read.size();
+                    request.transaction.error = error;
+                    request.error = error;
+                }
+            }
+
+            finish([](const I2CRequest &request) { return static_cast<size_t>(request.transaction.address); });
+        }
+    };
+
+    /**
+     * Scheduler of an SPI bus, the devices are the pins of the chip selects, NUMBER_GPIO_PIN for the requests
+     * without one.
+     */
+    class SPIScheduler : public BusScheduler<peripherals::spi::Transaction, NUMBER_GPIO_PIN + 1> {
+    public:
+
+        /**
+         * Queue a request and start it if the bus is free.
+         *
+         * @param request request, the callback and context of its transaction are replaced
+         * @return whether an error occurred
+         */
+        bool submit(SPIRequest &request) {
+
+            m_last_error = Error::NONE;
+
+            push(request);
+            start();
+
+            return false;
+        }
+
+        static SPIScheduler &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case peripherals::SPI_INSTANCE0:
+                    static SPIScheduler s_scheduler_instance0{peripherals::spi::SPI::getInstance(instance)};
+                    return s_scheduler_instance0;
+
+                case peripherals::SPI_INSTANCE1:
+                    static SPIScheduler s_scheduler_instance1{peripherals::spi::SPI::getInstance(instance)};
+                    return s_scheduler_instance1;
+            }
+        }
+
+    protected:
+
+        explicit SPIScheduler(interfaces::InterfaceSPI &spi) : BusScheduler(), m_spi{spi}, m_remaining{0} {}
+
+        interfaces::InterfaceSPI &m_spi;        ///< Bus of the scheduler
+        std::atomic<size_t> m_remaining;        ///< Transactions of the batch still running
+
+    private:
+
+        /**
+         * Start the next batches while the bus is free.
+         */
+        void start() {
+
+            run(std::min(peripherals::BUS_BATCH_SIZE, peripherals::SPI_QUEUE_SIZE), [this](const size_t count) { launch(count); });
+        }
+
+        /**
+         * Queue the transactions of the batch to the SPI, which runs them back to back.
+         *
+         * @param count number of requests of the batch
+         */
+        void launch(const size_t count) {
+
+            // One more for the loop, so the batch does not complete while it is queued
+            m_remaining.store(count + 1, std::memory_order_relaxed);
+
+            for(size_t i{0}; i < count; i++) {
+
+                peripherals::spi::Transaction &transaction{m_batch[i]->transaction};
+
+                transaction.callback = onTransaction;
+                transaction.context = this;
+
+                // Not started, it completes with its error
+                if(m_spi.transferAsync(transaction)) {
+
+                    transaction.error = m_spi.getLastError();
+                    transactionDone();
+                }
+            }
+
+            transactionDone();
+        }
+
+        static void onTransaction(const Error, const size_t, void * const context) {
+
+            auto &scheduler{*static_cast<SPIScheduler *>(context)};
+
+            if(scheduler.transactionDone()) {
+                scheduler.start();
+            }
+        }
+
+        /**
+         * @return whether it was the last transaction of the batch, which is complete then
+         */
+        bool transactionDone() {
+
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return false;
+            }
+
+            complete();
+
+            return true;
+        }
+
+        void complete() {
+
+            for(size_t i{0}; i < m_count; i++) {
+                m_batch[i]->error = m_batch[i]->transaction.error;
+            }
+
+            finish([](const SPIRequest &request) {
+                return request.transaction.cs != nullptr ? static_cast<size_t>(request.transaction.cs->getPin()) : static_cast<size_t>(NUMBER_GPIO_PIN);
+            });
+        }
+    };
+
+} // namespace hal::bus
+
+#endif //EMBEDDEDLIBRARY_BUSSCHEDULER_H
@@ -0,0 +1,43 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_BUSSCHEDULER_HOST_H
+#define EMBEDDEDLIBRARY_BUSSCHEDULER_HOST_H
+
+#include "../commons/commons.h"
+
+#include <mutex>
+
+namespace hal::bus::detail {
+
+    struct BusSchedulerIO {
+
+        /**
+         * Section where the queues are modified, by the drivers or the completion of a batch.
+         * Recursive: on host the fake buses complete a batch before starting it returns.
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_lock{s_mutex} {}
+
+        private:
+
+            std::lock_guard<std::recursive_mutex> m_lock;
+        };
+
+        /**
+         * @return false, the fake buses complete from the caller or from their own thread
+         */
+        static bool inInterrupt() {
+
+            return false;
+        }
+
+        inline static std::recursive_mutex s_mutex{};  ///< Taken by every CriticalSection
+    };
+
+} // namespace hal::bus::detail
+
+#endif //EMBEDDEDLIBRARY_BUSSCHEDULER_HOST_H
@@ -0,0 +1,47 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_BUSSCHEDULER_RP2040_H
+#define EMBEDDEDLIBRARY_BUSSCHEDULER_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/sync.h>
+#include <pico/platform.h>
+
+namespace hal::bus::detail {
+
+    struct BusSchedulerIO {
+
+        /**
+         * Section where the queues are modified, by the drivers or the completion of a batch in the DMA or I2C
+         * interrupt.
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_status{save_and_disable_interrupts()} {}
+
+            ~CriticalSection() {
+
+                restore_interrupts(m_status);
+            }
+
+        private:
+
+            uint32_t m_status;
+        };
+
+        /**
+         * @return whether the core runs an exception handler, where a blocking transfer must not run
+         */
+        static bool inInterrupt() {
+
+            return __get_current_exception() != 0;
+        }
+    };
+
+} // namespace hal::bus::detail
+
+#endif //EMBEDDEDLIBRARY_BUSSCHEDULER_RP2040_H
@@ -0,0 +1,137 @@
+/**
+ * @file Clock.h
+ * @brief Provide a monotonic time, a cycle counter and drift-free sleeps
+ *
+ * - @ref hal::clock::now_us() "now_us()" is the time since boot in microseconds: the 64 bits counter of the TIMER
+ *   block on RP2040, CLOCK_MONOTONIC on host.
+ * - @ref hal::clock::now_cycles() "now_cycles()" counts the cycles of the core, to measure short code paths:
+ *   the SysTick extended to 64 bits on RP2040, nanoseconds on host.
+ * - @ref hal::clock::Clock "Clock" is a std::chrono clock on top of now_us(), so
+ *   @ref hal::clock::Duration "Duration" and @ref hal::clock::TimePoint "TimePoint" work with the chrono literals
+ *   and casts.
+ * - @ref hal::clock::sleep_until() "sleep_until()" sleeps until a deadline. A periodic loop adding its period to
+ *   the previous deadline does not drift, unlike a loop sleeping for its period after doing its work.
+ *
+ * @code{cpp}
+ * using namespace std::chrono_literals;
+ *
+ * hal::clock::TimePoint deadline{hal::clock::Clock::now()};
+ *
+ * while(true) {
+ *
+ *     const uint64_t start{hal::clock::now_cycles()};
+ *     sample();
+ *     const uint64_t cycles{hal::clock::now_cycles() - start};
+ *
+ *     deadline += 10ms;
+ *     hal::clock::sleep_until(deadline);
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_CLOCK_H
+#define EMBEDDEDLIBRARY_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+
+#include "../commons/commons.h"
+
+#ifdef HAL_RP2040
+#include "Clock_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Clock_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::clock {
+
+    /**
+     * Monotonic clock counting microseconds since boot, meets the std::chrono Clock requirements.
+     */
+    struct Clock {
+
+        using rep = int64_t;
+        using period = std::micro;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<Clock>;
+
+        static constexpr bool is_steady{true};
+
+        static time_point now() noexcept {
+
+            return time_point{duration{static_cast<rep>(detail::ClockIO::now())}};
+        }
+    };
+
+    using Duration = Clock::duration;       ///< microseconds
+    using TimePoint = Clock::time_point;    ///< microseconds since boot
+
+    /**
+     * @return time since boot in microseconds
+     */
+    inline uint64_t now_us() {
+
+        return detail::ClockIO::now();
+    }
+
+    /**
+     * @return cycles counted since boot, see @ref hal::clock::cycles_frequency() "cycles_frequency()"
+     */
+    inline uint64_t now_cycles() {
+
+        return detail::ClockIO::cycles();
+    }
+
+    /**
+     * @return number of cycles per second: clk_sys on RP2040, 10^9 on host
+     */
+    inline uint64_t cycles_frequency() {
+
+        return detail::ClockIO::frequency();
+    }
+
+    /**
+     * Convert a number of cycles to a duration, rounded down to the microsecond.
+     *
+     * @param cycles number of cycles
+     * @return duration of the cycles
+     */
+    inline Duration cycles_to_duration(const uint64_t cycles) {
+
+        const uint64_t frequency{cycles_frequency()};
+
+        // Split to not overflow the multiplication
+        return Duration{static_cast<Duration::rep>(cycles / frequency * 1'000'000U + cycles % frequency * 1'000'000U / frequency)};
+    }
+
+    /**
+     * Sleep until a deadline, returns straight away if it is already reached.
+     *
+     * @param deadline time to wake up at
+     */
+    inline void sleep_until(const TimePoint deadline) {
+
+        const Duration::rep us{deadline.time_since_epoch().count()};
+
+        if(us > 0) {
+            detail::ClockIO::sleepUntil(static_cast<uint64_t>(us));
+        }
+    }
+
+    /**
+     * Sleep for a duration.
+     *
+     * @param duration time to sleep, any std::chrono duration, rounded up to the microsecond
+     */
+    template<typename Rep, typename Period>
+    void sleep_for(const std::chrono::duration<Rep, Period> duration) {
+
+        sleep_until(Clock::now() + std::chrono::ceil<Duration>(duration));
+    }
+
+} // namespace hal::clock
+
+#endif //EMBEDDEDLIBRARY_CLOCK_H
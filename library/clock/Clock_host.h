@@ -0,0 +1,63 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_CLOCK_HOST_H
+#define EMBEDDEDLIBRARY_CLOCK_HOST_H
+
+#include "../commons/commons.h"
+
+#include <cerrno>
+#include <ctime>
+
+namespace hal::clock::detail {
+
+    /**
+     * Access to the monotonic clock of Linux. A cycle is a nanosecond, the resolution of clock_gettime.
+     */
+    struct ClockIO {
+
+        /**
+         * @return time since boot in microseconds
+         */
+        static uint64_t now() {
+
+            return cycles() / 1'000U;
+        }
+
+        /**
+         * @return time since boot in nanoseconds
+         */
+        static uint64_t cycles() {
+
+            timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+
+            return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000U + static_cast<uint64_t>(ts.tv_nsec);
+        }
+
+        /**
+         * @return number of cycles per second
+         */
+        static uint64_t frequency() {
+
+            return 1'000'000'000U;
+        }
+
+        /**
+         * Sleep until a time is reached.
+         *
+         * @param us time since boot in microseconds
+         */
+        static void sleepUntil(const uint64_t us) {
+
+            const timespec ts{static_cast<time_t>(us / 1'000'000U), static_cast<long>((us % 1'000'000U) * 1'000U)};
+
+            // The deadline is absolute, an interrupted sleep goes on with the same one
+            while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+        }
+    };
+
+} // namespace hal::clock::detail
+
+#endif //EMBEDDEDLIBRARY_CLOCK_HOST_H
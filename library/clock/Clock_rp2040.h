@@ -0,0 +1,103 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_CLOCK_RP2040_H
+#define EMBEDDEDLIBRARY_CLOCK_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/clocks.h>
+#include <hardware/exception.h>
+#include <hardware/structs/scb.h>
+#include <hardware/structs/systick.h>
+#include <hardware/timer.h>
+#include <pico/time.h>
+
+namespace hal::clock::detail {
+
+    /**
+     * Access to the RP2040 timers: the 64 bits microsecond counter of the TIMER block, and the SysTick of the
+     * core counting the cycles of clk_sys.
+     *
+     * The SysTick only has 24 bits (134 ms at 125 MHz), its exception counts the wraps to extend it to 64 bits.
+     * It is started before main() by a static initialiser.
+     */
+    struct ClockIO {
+
+        /**
+         * @return time since boot in microseconds
+         */
+        static uint64_t now() {
+
+            return time_us_64();
+        }
+
+        /**
+         * @return cycles of clk_sys since the start of the SysTick
+         */
+        static uint64_t cycles() {
+
+            uint32_t wraps;
+            uint32_t current;
+
+            do {
+                wraps = s_wraps;
+                current = systick_hw->cvr;
+            } while(wraps != s_wraps);
+
+            // Wrapped while the exception is masked, it is pending and not counted yet
+            if(scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS) {
+
+                wraps++;
+                current = systick_hw->cvr;
+            }
+
+            return (static_cast<uint64_t>(wraps) << 24U) + (RELOAD - current);
+        }
+
+        /**
+         * @return number of cycles per second
+         */
+        static uint64_t frequency() {
+
+            return clock_get_hz(clk_sys);
+        }
+
+        /**
+         * Sleep until a time is reached.
+         *
+         * @param us time since boot in microseconds
+         */
+        static void sleepUntil(const uint64_t us) {
+
+            ::sleep_until(from_us_since_boot(us));
+        }
+
+    private:
+
+        static constexpr uint32_t RELOAD{0x00FF'FFFFU};     ///< SysTick counts down from 2^24 - 1
+
+        static void wrapped() {
+
+            s_wraps++;
+        }
+
+        static bool start() {
+
+            exception_set_exclusive_handler(SYSTICK_EXCEPTION, wrapped);
+
+            systick_hw->rvr = RELOAD;
+            systick_hw->cvr = 0;
+            systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_TICKINT_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+            return true;
+        }
+
+        inline static volatile uint32_t s_wraps{0};     ///< Number of SysTick wraps
+        inline static const bool s_started{start()};    ///< Start the SysTick before main()
+    };
+
+} // namespace hal::clock::detail
+
+#endif //EMBEDDEDLIBRARY_CLOCK_RP2040_H
@@ -27,6 +27,8 @@
 
 #ifdef HAL_RP2040
 #include "commons_rp2040.h"
+#elif defined(HAL_HOST)
+#include "commons_host.h"
 //#elif defined(HAL_ATMEGA328) || defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) // NOTE: NOT IMPLEMENTED YET
 //#include "commons_atmega328p.h"
 #else
@@ -37,6 +39,7 @@
  * These are implemented in platform specific headers
  *      namespace hal::peripherals {
  *          enum UARTInstance : uint8_t {}; which list number of UART instance
+ *          enum PioUARTInstance : uint8_t {}; which list number of UART instance run by a PIO
  *          enum SPIInstance : uint8_t {}; which list number of SPI instance
  *          enum I2CInstance : uint8_t {}; which list number of I2C instance
  *          and so on
@@ -48,6 +51,62 @@
  *
  **********************************************************************************************************************/
 
+#ifndef HAL_UART_RX_BUFFER_SIZE
+#define HAL_UART_RX_BUFFER_SIZE 256U    ///< size of the uart rx ring in buffered mode, must be a power of two
+#endif
+
+#ifndef HAL_UART_TX_BUFFER_SIZE
+#define HAL_UART_TX_BUFFER_SIZE 256U    ///< size of the uart tx ring in buffered mode, must be a power of two
+#endif
+
+#ifndef HAL_I2C_MAX_TRANSFER
+#define HAL_I2C_MAX_TRANSFER 64U        ///< bytes written plus read by one i2c transaction, sizes the DMA command buffer
+#endif
+
+#ifndef HAL_SPI_QUEUE_SIZE
+#define HAL_SPI_QUEUE_SIZE 8U           ///< spi transactions queued by transferAsync(), must be a power of two
+#endif
+
+#ifndef HAL_BUS_BATCH_SIZE
+#define HAL_BUS_BATCH_SIZE 8U           ///< bus scheduler requests started at once, without the CPU in between
+#endif
+
+#ifndef HAL_GPIO_EVENT_QUEUE_SIZE
+#define HAL_GPIO_EVENT_QUEUE_SIZE 64U   ///< size of the gpio interrupt event queue, must be a power of two
+#endif
+
+#ifndef HAL_COROUTINE_FRAMES
+#define HAL_COROUTINE_FRAMES 8U         ///< number of coroutine frames of the scheduler pool
+#endif
+
+#ifndef HAL_COROUTINE_FRAME_SIZE
+#define HAL_COROUTINE_FRAME_SIZE 512U   ///< size in bytes of a coroutine frame of the scheduler pool
+#endif
+
+#ifndef HAL_SCHEDULER_QUEUE_SIZE
+#define HAL_SCHEDULER_QUEUE_SIZE 16U    ///< size of the scheduler ready queue, must be a power of two at least HAL_COROUTINE_FRAMES
+#endif
+
+#ifndef HAL_TIMER_SLOTS
+#define HAL_TIMER_SLOTS 32U             ///< number of timers of a timer wheel
+#endif
+
+#ifndef HAL_TIMER_TICK_US
+#define HAL_TIMER_TICK_US 1'000U        ///< resolution of a timer wheel in microseconds
+#endif
+
+// #define HAL_TRACE                    ///< define to compile the HAL_TRACE_SCOPE probes in, they are removed otherwise
+
+#ifndef HAL_TRACE_BUFFER_SIZE
+#define HAL_TRACE_BUFFER_SIZE 256U      ///< number of trace events kept per core, must be a power of two
+#endif
+
+#ifndef HAL_TRACE_NAMES
+#define HAL_TRACE_NAMES 64U             ///< number of distinct probe names a trace export can hold
+#endif
+
+// #define HAL_STATS                    ///< define to compile the peripheral statistics counters in, they are removed otherwise
+
 namespace hal {
 
     // ****************************************************************
@@ -60,6 +119,13 @@ namespace hal {
         constexpr uint I2C_DEFAULT_BAUD_RATE{400'000U};       ///< i2c default baud rate
         constexpr uint SPI_DEFAULT_BAUD_RATE{50'000'000U};    ///< spi default baud rate
 
+        constexpr size_t UART_RX_BUFFER_SIZE{HAL_UART_RX_BUFFER_SIZE};  ///< uart rx ring size in buffered mode
+        constexpr size_t UART_TX_BUFFER_SIZE{HAL_UART_TX_BUFFER_SIZE};  ///< uart tx ring size in buffered mode
+        constexpr size_t I2C_MAX_TRANSFER{HAL_I2C_MAX_TRANSFER};        ///< i2c bytes written plus read per transaction
+        constexpr size_t SPI_QUEUE_SIZE{HAL_SPI_QUEUE_SIZE};            ///< spi transactions queued at most
+        constexpr size_t BUS_BATCH_SIZE{HAL_BUS_BATCH_SIZE};            ///< bus scheduler requests per batch
+        constexpr size_t GPIO_EVENT_QUEUE_SIZE{HAL_GPIO_EVENT_QUEUE_SIZE};  ///< gpio interrupt event queue size
+
         namespace gpio {
 
             /**
@@ -108,6 +174,17 @@ namespace hal {
                 EDGE_RISE
             };
 
+            /**
+             * Function called from the GPIO interrupt handler.
+             *
+             * @warning It runs in interrupt context, keep it short.
+             *
+             * @param gpio_pin pin that raised the interrupt
+             * @param gpio_irq condition that raised the interrupt
+             * @param context pointer given when the callback was attached
+             */
+            using IRQCallback = void (*)(uint gpio_pin, IRQ gpio_irq, void *context);
+
             enum class SlewRate : uint8_t {
                 SLOW,
                 FAST
@@ -145,6 +222,62 @@ namespace hal {
 
     }; // enum class Error
 
+    namespace peripherals::uart {
+
+        /**
+         * Function called when an asynchronous UART transfer completes.
+         *
+         * @warning On RP2040 it runs in interrupt context, on host in the transfer thread, keep it short.
+         *
+         * @param error Error::NONE if every byte was transferred, Error::ERROR otherwise
+         * @param count number of bytes transferred
+         * @param context pointer given when the transfer was started
+         */
+        using TransferCallback = void (*)(Error error, size_t count, void *context);
+
+    } // namespace peripherals::uart
+
+    namespace peripherals::i2c {
+
+        /**
+         * Function called when an asynchronous list of I2C transactions completes.
+         *
+         * @warning On RP2040 it runs in interrupt context, keep it short.
+         *
+         * @param error Error::NONE if every transaction succeeded, the error of the first one that failed otherwise
+         * @param count number of transactions executed
+         * @param context pointer given when the transfer was started
+         */
+        using TransferCallback = void (*)(Error error, size_t count, void *context);
+
+        /**
+         * Function called when the master of an I2C slave wrote registers.
+         *
+         * @warning On RP2040 it runs in interrupt context, keep it short.
+         *
+         * @param offset first register written
+         * @param length number of registers written, they are already in the register map
+         * @param context pointer given when the slave was initialised
+         */
+        using RegisterCallback = void (*)(size_t offset, size_t length, void *context);
+
+    } // namespace peripherals::i2c
+
+    namespace peripherals::spi {
+
+        /**
+         * Function called when a queued SPI transaction completes.
+         *
+         * @warning On RP2040 it runs in interrupt context, keep it short.
+         *
+         * @param error Error::NONE if the transaction completed, Error::ERROR otherwise
+         * @param count number of bytes exchanged
+         * @param context pointer given with the transaction
+         */
+        using TransferCallback = void (*)(Error error, size_t count, void *context);
+
+    } // namespace peripherals::spi
+
     /**
 	 * Set a bit in a bitset.
 	 *
@@ -163,7 +296,7 @@ namespace hal {
 	 */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void set_bit(T1 &bit_set, const T2 pos) {
+    constexpr void set_bit(T1 &bit_set, const T2 pos) {
 
         bit_set |= 1U << pos;
     }
@@ -186,7 +319,7 @@ namespace hal {
 	 */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void clear_bit(T1 &bit_set, const T2 pos) {
+    constexpr void clear_bit(T1 &bit_set, const T2 pos) {
 
         bit_set &= ~(1U << pos);
     }
@@ -211,7 +344,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void toggle_bit(T1 &bit_set, const T2 pos) {
+    constexpr void toggle_bit(T1 &bit_set, const T2 pos) {
 
         bit_set ^= 1U << pos;
     }
@@ -236,7 +369,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline bool check_bit(const T1 &bit_set, const T2 pos) {
+    constexpr bool check_bit(const T1 &bit_set, const T2 pos) {
 
         return (bit_set >> pos) & 1U;
     }
@@ -262,7 +395,7 @@ namespace hal {
      */
     template<typename T1, typename T2, typename T3>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2> and concepts::is_bitwiseable<T3>
-    inline void set_bits_pos(T1 &bit_set, const T2 pos, const T3 bit_mask) {
+    constexpr void set_bits_pos(T1 &bit_set, const T2 pos, const T3 bit_mask) {
 
         bit_set = (bit_set & (~(bit_mask << pos))) | (bit_mask<<pos);
     }
@@ -285,7 +418,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void set_bits(T1 &bit_set, const T2 bit_mask) {
+    constexpr void set_bits(T1 &bit_set, const T2 bit_mask) {
 
         bit_set = (bit_set & (~bit_mask)) | (bit_mask);
     }
@@ -308,7 +441,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void clear_bits(T1 &bit_set, const T2 bit_mask) {
+    constexpr void clear_bits(T1 &bit_set, const T2 bit_mask) {
 
         bit_set &= ~bit_mask;
     }
@@ -331,7 +464,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline void toggle_bits(T1 &bit_set, const T2 bit_mask) {
+    constexpr void toggle_bits(T1 &bit_set, const T2 bit_mask) {
 
         bit_set ^= bit_mask;
     }
@@ -347,7 +480,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires concepts::is_bitwiseable<T1> and concepts::is_bitwiseable<T2>
-    inline bool check_bits(const T1 &bit_set, const T2 bit_mask) {
+    constexpr bool check_bits(const T1 &bit_set, const T2 bit_mask) {
 
         return (bit_set & bit_mask) == bit_mask;
     }
@@ -390,7 +523,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires std::totally_ordered<T1> and std::totally_ordered<T2>
-    auto min(T1 a, T2 b) {
+    constexpr auto min(T1 a, T2 b) {
 
         return (a < b ? a : b);
     }
@@ -408,7 +541,7 @@ namespace hal {
      */
     template<typename T1, typename T2>
     requires std::equality_comparable<T1> and std::equality_comparable<T2>
-    auto max(T1 a, T2 b) {
+    constexpr auto max(T1 a, T2 b) {
 
         return (a > b ? a : b);
     }
@@ -425,6 +558,8 @@ namespace hal {
      * ts >> buffer; // Unpack it into buffer
      * @endcode
      *
+     * @see hal::serialization::BufferWriter and hal::serialization::BufferReader to serialize several values
+     * into one buffer with an explicit byte order.
      */
     class TypeSerializer {
     public:
@@ -689,4 +824,7 @@ namespace hal {
 
 } // namespace hal
 
+// Span counterparts of the bit functions, they rely on the helpers above
+#include "commons_bits.h"
+
 #endif //EMBEDDED_LIBRARY_COMMONS_H
@@ -0,0 +1,518 @@
+/**
+ * @file commons_bits.h
+ * @brief Provide bulk bit manipulation functions working on spans
+ *
+ * These are the span counterparts of @ref hal::set_bits() "set_bits", @ref hal::clear_bits() "clear_bits",
+ * @ref hal::toggle_bits() "toggle_bits" and @ref hal::check_bit() "check_bit", for bitmaps too large to fit in a
+ * single integer (framebuffers, sensor masks ...).
+ *
+ * A span is seen as one large bitmap: bit i is the bit (i % digits) of the element (i / digits), the same
+ * numbering @ref hal::check_bit() "check_bit" uses within one element.
+ *
+ * The work is done one machine word at a time, and one vector at a time when the target has SIMD
+ * (SSE2 or AVX2 on x86, NEON on ARM). Targets without SIMD, such as the Cortex-M0+ of the RP2040,
+ * use the word-at-a-time fallback. Define HAL_BITS_NO_SIMD to force the fallback.
+ *
+ * @code{cpp}
+ * uint8_t framebuffer[128 * 64 / 8]{};
+ *
+ * hal::set_bits(std::span{framebuffer}, uint8_t{0xAA});  // Every byte |= 0xAA
+ * size_t lit{hal::popcount(std::span{framebuffer})};
+ * @endcode
+ */
+
+#ifndef EMBEDDED_LIBRARY_COMMONS_BITS_H
+#define EMBEDDED_LIBRARY_COMMONS_BITS_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#ifndef HAL_BITS_NO_SIMD
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HAL_BITS_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HAL_BITS_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAL_BITS_NEON
+#endif
+#endif
+
+namespace hal {
+
+    namespace detail::bits {
+
+        using word_t = std::uintptr_t;  ///< Native machine word
+
+        enum class Op : uint8_t {
+            SET,
+            CLEAR,
+            TOGGLE
+        };
+
+        /**
+         * Repeat mask over a whole W, following the memory layout of an array of T.
+         */
+        template<std::unsigned_integral W, std::unsigned_integral T>
+        W splat(const T mask) {
+
+            static_assert(sizeof(W) % sizeof(T) == 0, "the element must fit a whole number of times in the word");
+
+            unsigned char bytes[sizeof(W)];
+
+            for(size_t i{0}; i < sizeof(W); i += sizeof(T)) {
+                std::memcpy(bytes + i, &mask, sizeof(T));
+            }
+
+            W word;
+            std::memcpy(&word, bytes, sizeof(W));
+
+            return word;
+        }
+
+        template<Op op, typename V>
+        V apply(const V value, const V mask) {
+
+            if constexpr (op == Op::SET) {
+                return value | mask;
+            } else if constexpr (op == Op::CLEAR) {
+                return value & ~mask;
+            } else {
+                return value ^ mask;
+            }
+        }
+
+        /**
+         * Apply op with mask to every element of bits: vectors first, then words, then the remaining elements.
+         * Elements larger than the word W, e.g. uint64_t on the RP2040, skip the word step.
+         */
+        template<Op op, std::unsigned_integral T, size_t E, std::unsigned_integral W = word_t>
+        void apply(const std::span<T, E> bits, const T mask) {
+
+            auto *data{reinterpret_cast<unsigned char *>(bits.data())};
+            size_t length{bits.size_bytes()};
+
+#if defined(HAL_BITS_AVX2)
+            const __m256i vector_mask{_mm256_set1_epi64x(static_cast<long long>(splat<uint64_t>(mask)))};
+
+            for(; length >= sizeof(__m256i); data += sizeof(__m256i), length -= sizeof(__m256i)) {
+
+                const __m256i value{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data))};
+                __m256i result;
+
+                if constexpr (op == Op::SET) {
+                    result = _mm256_or_si256(value, vector_mask);
+                } else if constexpr (op == Op::CLEAR) {
+                    result = _mm256_andnot_si256(vector_mask, value);
+                } else {
+                    result = _mm256_xor_si256(value, vector_mask);
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(data), result);
+            }
+#elif defined(HAL_BITS_SSE2)
+            const __m128i vector_mask{_mm_set1_epi64x(static_cast<long long>(splat<uint64_t>(mask)))};
+
+            for(; length >= sizeof(__m128i); data += sizeof(__m128i), length -= sizeof(__m128i)) {
+
+                const __m128i value{_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))};
+                __m128i result;
+
+                if constexpr (op == Op::SET) {
+                    result = _mm_or_si128(value, vector_mask);
+                } else if constexpr (op == Op::CLEAR) {
+                    result = _mm_andnot_si128(vector_mask, value);
+                } else {
+                    result = _mm_xor_si128(value, vector_mask);
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(data), result);
+            }
+#elif defined(HAL_BITS_NEON)
+            const uint8x16_t vector_mask{vreinterpretq_u8_u64(vdupq_n_u64(splat<uint64_t>(mask)))};
+
+            for(; length >= sizeof(uint8x16_t); data += sizeof(uint8x16_t), length -= sizeof(uint8x16_t)) {
+
+                const uint8x16_t value{vld1q_u8(data)};
+                uint8x16_t result;
+
+                if constexpr (op == Op::SET) {
+                    result = vorrq_u8(value, vector_mask);
+                } else if constexpr (op == Op::CLEAR) {
+                    result = vbicq_u8(value, vector_mask);
+                } else {
+                    result = veorq_u8(value, vector_mask);
+                }
+
+                vst1q_u8(data, result);
+            }
+#endif
+
+            if constexpr (sizeof(T) <= sizeof(W)) {
+
+                const W word_mask{splat<W>(mask)};
+
+                for(; length >= sizeof(W); data += sizeof(W), length -= sizeof(W)) {
+
+                    W word;
+
+                    std::memcpy(&word, data, sizeof(W));
+                    word = apply<op>(word, word_mask);
+                    std::memcpy(data, &word, sizeof(W));
+                }
+            }
+
+            // Whole elements are left since the vectors and the words are multiples of the element
+            for(; length > 0; data += sizeof(T), length -= sizeof(T)) {
+
+                T element;
+
+                std::memcpy(&element, data, sizeof(T));
+                element = static_cast<T>(apply<op, T>(element, mask));
+                std::memcpy(data, &element, sizeof(T));
+            }
+        }
+
+        /**
+         * Get the n lowest bits set.
+         */
+        template<std::unsigned_integral T>
+        constexpr T low_mask(const size_t n) {
+
+            return n >= std::numeric_limits<T>::digits ? static_cast<T>(~T{0}) : static_cast<T>((T{1} << n) - 1U);
+        }
+
+        /**
+         * Get the digits bits of bits starting at bit pos, bits past the end of the span read as 0.
+         */
+        template<std::unsigned_integral T>
+        constexpr T load(const std::span<const T> bits, const size_t pos) {
+
+            constexpr size_t digits{std::numeric_limits<T>::digits};
+
+            const size_t index{pos / digits};
+            const size_t offset{pos % digits};
+
+            T value{static_cast<T>(bits[index] >> offset)};
+
+            if(offset != 0 and index + 1 < bits.size()) {
+                value = static_cast<T>(value | (bits[index + 1] << (digits - offset)));
+            }
+
+            return value;
+        }
+
+    } // namespace detail::bits
+
+    /**
+     * Set the bit mask in every element of bits.
+     *
+     * @code{cpp}
+     * uint8_t bitmap[]{0x00, 0x0F, 0xF0};
+     * set_bits(std::span{bitmap}, uint8_t{0b11000011});
+     *
+     * // Result: bitmap == {0xC3, 0xCF, 0xF3}
+     * @endcode
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bit fields to modify
+     * @param bit_mask the bit mask to set in each element
+     */
+    template<std::unsigned_integral T, size_t E>
+    requires (!std::is_const_v<T>)
+    void set_bits(const std::span<T, E> bits, const std::type_identity_t<T> bit_mask) {
+
+        detail::bits::apply<detail::bits::Op::SET>(bits, bit_mask);
+    }
+
+    /**
+     * Clear the bit mask in every element of bits.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bit fields to modify
+     * @param bit_mask the bit mask to clear in each element
+     */
+    template<std::unsigned_integral T, size_t E>
+    requires (!std::is_const_v<T>)
+    void clear_bits(const std::span<T, E> bits, const std::type_identity_t<T> bit_mask) {
+
+        detail::bits::apply<detail::bits::Op::CLEAR>(bits, bit_mask);
+    }
+
+    /**
+     * Toggle the bit mask in every element of bits.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bit fields to modify
+     * @param bit_mask the bit mask to toggle in each element
+     */
+    template<std::unsigned_integral T, size_t E>
+    requires (!std::is_const_v<T>)
+    void toggle_bits(const std::span<T, E> bits, const std::type_identity_t<T> bit_mask) {
+
+        detail::bits::apply<detail::bits::Op::TOGGLE>(bits, bit_mask);
+    }
+
+    /**
+     * Count the bits set in bits.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bitmap to count
+     * @return number of bits set
+     */
+    template<std::unsigned_integral T, size_t E>
+    size_t popcount(const std::span<T, E> bits) {
+
+        auto *data{reinterpret_cast<const unsigned char *>(bits.data())};
+        size_t length{bits.size_bytes()};
+        size_t count{0};
+
+#if defined(HAL_BITS_AVX2)
+        // Nibble lookup, the byte counts are summed with SAD every block
+        const __m256i lookup{_mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                              0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4)};
+        const __m256i low_nibble{_mm256_set1_epi8(0x0F)};
+        __m256i total{_mm256_setzero_si256()};
+
+        for(; length >= sizeof(__m256i); data += sizeof(__m256i), length -= sizeof(__m256i)) {
+
+            const __m256i value{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data))};
+            const __m256i low{_mm256_shuffle_epi8(lookup, _mm256_and_si256(value, low_nibble))};
+            const __m256i high{_mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(value, 4), low_nibble))};
+
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+        }
+
+        uint64_t sums[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), total);
+
+        count += static_cast<size_t>(sums[0] + sums[1] + sums[2] + sums[3]);
+#elif defined(HAL_BITS_NEON)
+        for(; length >= sizeof(uint8x16_t); data += sizeof(uint8x16_t), length -= sizeof(uint8x16_t)) {
+
+            // Pairwise widening adds, vaddlvq_u8() is AArch64 only
+            const uint64x2_t sums{vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vcntq_u8(vld1q_u8(data)))))};
+
+            count += static_cast<size_t>(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1));
+        }
+#endif
+
+        for(; length >= sizeof(detail::bits::word_t); data += sizeof(detail::bits::word_t), length -= sizeof(detail::bits::word_t)) {
+
+            detail::bits::word_t word;
+
+            std::memcpy(&word, data, sizeof(word));
+            count += static_cast<size_t>(std::popcount(word));
+        }
+
+        for(; length > 0; data++, length--) {
+
+            count += static_cast<size_t>(std::popcount(*data));
+        }
+
+        return count;
+    }
+
+    /**
+     * Find the first bit set in bits.
+     *
+     * @code{cpp}
+     * uint16_t bitmap[]{0x0000, 0x0000, 0x0010};
+     * size_t pos{find_first_set(std::span{bitmap})};
+     *
+     * // Result: pos == 36
+     * @endcode
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bitmap to search
+     * @return position of the first bit set, the number of bits in the span if none is set
+     */
+    template<std::unsigned_integral T, size_t E>
+    size_t find_first_set(const std::span<T, E> bits) {
+
+        constexpr size_t digits{std::numeric_limits<T>::digits};
+
+        auto *data{reinterpret_cast<const unsigned char *>(bits.data())};
+        size_t length{bits.size_bytes()};
+
+        // Skip the zero blocks, then look for the element within the first non-zero one
+#if defined(HAL_BITS_AVX2)
+        for(; length >= sizeof(__m256i); data += sizeof(__m256i), length -= sizeof(__m256i)) {
+
+            const __m256i value{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data))};
+
+            if(!_mm256_testz_si256(value, value)) {
+                break;
+            }
+        }
+#elif defined(HAL_BITS_SSE2)
+        for(; length >= sizeof(__m128i); data += sizeof(__m128i), length -= sizeof(__m128i)) {
+
+            const __m128i value{_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))};
+
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) != 0xFFFF) {
+                break;
+            }
+        }
+#elif defined(HAL_BITS_NEON)
+        for(; length >= sizeof(uint8x16_t); data += sizeof(uint8x16_t), length -= sizeof(uint8x16_t)) {
+
+            // Both halves folded into one, vmaxvq_u8() is AArch64 only
+            const uint8x16_t value{vld1q_u8(data)};
+
+            if(vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(value), vget_high_u8(value))), 0) != 0) {
+                break;
+            }
+        }
+#endif
+
+        for(; length >= sizeof(detail::bits::word_t); data += sizeof(detail::bits::word_t), length -= sizeof(detail::bits::word_t)) {
+
+            detail::bits::word_t word;
+
+            std::memcpy(&word, data, sizeof(word));
+
+            if(word != 0) {
+                break;
+            }
+        }
+
+        const auto *first{reinterpret_cast<const unsigned char *>(bits.data())};
+
+        for(size_t index{static_cast<size_t>(data - first) / sizeof(T)}; index < bits.size(); index++) {
+
+            if(bits[index] != 0) {
+                return index * digits + static_cast<size_t>(std::countr_zero(bits[index]));
+            }
+        }
+
+        return bits.size() * digits;
+    }
+
+    /**
+     * Copy a range of bits from src to dst, the ranges may start anywhere within an element.
+     *
+     * @code{cpp}
+     * uint8_t src[]{0b11110000, 0b00001111};
+     * uint8_t dst[]{0x00, 0x00};
+     * copy_bits(std::span{dst}, 2, std::span{src}, 4, 8);
+     *
+     * // Result: dst == {0b11111100, 0b00000011}
+     * @endcode
+     *
+     * @warning src and dst must not overlap.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param dst the bitmap to write
+     * @param dst_pos position of the first bit to write
+     * @param src the bitmap to read
+     * @param src_pos position of the first bit to read
+     * @param count number of bits to copy
+     * @return whether an error occurred, true if a range does not fit in its span
+     */
+    template<std::unsigned_integral T, size_t E1, std::unsigned_integral U, size_t E2>
+    requires (!std::is_const_v<T> and std::is_same_v<T, std::remove_const_t<U>>)
+    bool copy_bits(const std::span<T, E1> dst, size_t dst_pos, const std::span<U, E2> src, size_t src_pos, size_t count) {
+
+        constexpr size_t digits{std::numeric_limits<T>::digits};
+
+        if(dst_pos + count > dst.size() * digits or src_pos + count > src.size() * digits) {
+
+            return true;
+        }
+
+        while(count > 0) {
+
+            const size_t index{dst_pos / digits};
+            const size_t offset{dst_pos % digits};
+            const size_t n{hal::min(digits - offset, count)};
+
+            // After the first element, dst is aligned and whole elements are copied
+            const T mask{static_cast<T>(detail::bits::low_mask<T>(n) << offset)};
+            const T value{static_cast<T>(detail::bits::load(std::span<const T>{src}, src_pos) << offset)};
+
+            dst[index] = static_cast<T>((dst[index] & ~mask) | (value & mask));
+
+            dst_pos += n;
+            src_pos += n;
+            count -= n;
+        }
+
+        return false;
+    }
+
+    /**
+     * Shift a bitmap towards its higher positions, bit i moves to bit i + n.
+     * The bits shifted in are 0, the bits shifted past the end are lost.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bitmap to shift
+     * @param n number of positions to shift
+     */
+    template<std::unsigned_integral T, size_t E>
+    requires (!std::is_const_v<T>)
+    void shift_bits_left(const std::span<T, E> bits, const size_t n) {
+
+        constexpr size_t digits{std::numeric_limits<T>::digits};
+
+        const size_t words{hal::min(n / digits, bits.size())};
+        const size_t offset{n % digits};
+
+        for(size_t i{bits.size()}; i-- > words;) {
+
+            T value{static_cast<T>(bits[i - words] << offset)};
+
+            if(offset != 0 and i > words) {
+                value = static_cast<T>(value | (bits[i - words - 1] >> (digits - offset)));
+            }
+
+            bits[i] = value;
+        }
+
+        std::fill_n(bits.begin(), words, T{0});
+    }
+
+    /**
+     * Shift a bitmap towards its lower positions, bit i moves to bit i - n.
+     * The bits shifted in are 0, the bits shifted past the start are lost.
+     *
+     * @tparam T type of the elements. Must be unsigned
+     * @param bits the bitmap to shift
+     * @param n number of positions to shift
+     */
+    template<std::unsigned_integral T, size_t E>
+    requires (!std::is_const_v<T>)
+    void shift_bits_right(const std::span<T, E> bits, const size_t n) {
+
+        constexpr size_t digits{std::numeric_limits<T>::digits};
+
+        const size_t words{hal::min(n / digits, bits.size())};
+        const size_t offset{n % digits};
+        const size_t kept{bits.size() - words};
+
+        for(size_t i{0}; i < kept; i++) {
+
+            T value{static_cast<T>(bits[i + words] >> offset)};
+
+            if(offset != 0 and i + words + 1 < bits.size()) {
+                value = static_cast<T>(value | (bits[i + words + 1] << (digits - offset)));
+            }
+
+            bits[i] = value;
+        }
+
+        std::fill(bits.begin() + static_cast<std::ptrdiff_t>(kept), bits.end(), T{0});
+    }
+
+} // namespace hal
+
+#endif //EMBEDDED_LIBRARY_COMMONS_BITS_H
@@ -10,20 +10,21 @@
 #define EMBEDDED_LIBRARY_COMMONS_CONCEPTS_H
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 namespace hal::concepts {
     /**
-	 *	Concept that check if the type T is serializable.
+	 *	Concept that check if the type T is serializable:
+	 *	an integral type, an enumeration, a float or a double.
 	 *
 	 * @tparam T type to check
 	 * @returns Whether T is serializable
 	 */
     template<typename T>
-    concept is_serializable = requires(T) {
-        {   std::is_integral<T>::value or
-            std::is_same<T, float>::value or
-            std::is_same<T, double>::value };
-    };
+    concept is_serializable = std::is_integral_v<T> or std::is_enum_v<T> or
+                              std::is_same_v<T, float> or std::is_same_v<T, double>;
 
     /**
      * Concept that check if the type T can be used with bitwise operands
@@ -36,6 +37,54 @@ namespace hal::concepts {
         { std::is_integral<T>::value };
     };
 
+    /**
+     * Concept that check if the type T can be used as a digital input,
+     * such as @ref hal::peripherals::gpio::DigitalInOut "DigitalInOut" or @ref hal::peripherals::gpio::Pin "Pin".
+     *
+     * @tparam T type to check
+     * @returns Whether T can be read as a digital input
+     */
+    template<typename T>
+    concept is_digital_input = requires(T gpio) {
+        { gpio.read() } -> std::convertible_to<uint8_t>;
+        { gpio.getPin() } -> std::convertible_to<unsigned int>;
+    };
+
+    /**
+     * Concept that check if the type T can be used as a digital output,
+     * such as @ref hal::peripherals::gpio::DigitalInOut "DigitalInOut" or @ref hal::peripherals::gpio::Pin "Pin".
+     *
+     * @tparam T type to check
+     * @returns Whether T can be written as a digital output
+     */
+    template<typename T>
+    concept is_digital_output = requires(T gpio, const uint8_t value) {
+        gpio.write(value);
+        gpio.toggle();
+        { gpio.getPin() } -> std::convertible_to<unsigned int>;
+    };
+
+    /**
+     * Concept that check if the type T can be used both as a digital input and output.
+     *
+     * @tparam T type to check
+     * @returns Whether T is a digital GPIO
+     */
+    template<typename T>
+    concept is_digital_gpio = is_digital_input<T> and is_digital_output<T>;
+
+    /**
+     * Concept that check if the type T accepts blocks of bytes,
+     * such as @ref hal::interfaces::InterfaceUART "InterfaceUART".
+     *
+     * @tparam T type to check
+     * @returns Whether T can be written a block of bytes
+     */
+    template<typename T>
+    concept is_byte_writer = requires(T &sink, const uint8_t *data, size_t length) {
+        sink.write(data, length);
+    };
+
 } // namespace hal::concepts
 
 #endif //EMBEDDED_LIBRARY_COMMONS_CONCEPTS_H
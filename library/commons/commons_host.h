@@ -0,0 +1,403 @@
+/**
+ * @file commons_host.h
+ * @brief Provide the host (Linux) implementation of the platform specific commons
+ *
+ * This backend allows the peripherals to be built, tested and benchmarked off-target.
+ * The hardware is simulated in memory:
+ * - @ref hal::host::PinBank "PinBank" holds the state of every GPIO pin
+ * - sleep functions are implemented on top of clock_nanosleep
+ */
+
+#ifndef EMBEDDEDLIBRARY_COMMONS_HOST_H
+#define EMBEDDEDLIBRARY_COMMONS_HOST_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <sys/types.h>
+
+#include "../traits/NonMovable.h"
+#include "../traits/Singleton.h"
+
+namespace hal {
+
+    namespace peripherals {
+
+        enum UARTInstance : uint8_t {
+
+            UART_INSTANCE0,
+            UART_INSTANCE1
+        };
+
+        enum PioUARTInstance : uint8_t {
+
+            PIO_UART_INSTANCE0,
+            PIO_UART_INSTANCE1,
+            PIO_UART_INSTANCE2,
+            PIO_UART_INSTANCE3
+        };
+
+        enum SPIInstance : uint8_t {
+
+            SPI_INSTANCE0,
+            SPI_INSTANCE1
+        };
+
+        enum I2CInstance : uint8_t {
+
+            I2C_INSTANCE0,
+            I2C_INSTANCE1
+        };
+
+    } // namespace peripherals
+
+    constexpr size_t CACHE_LINE_SIZE{64U};  ///< typical x86-64 / aarch64 cache line
+
+    enum pin : uint {
+
+        GPIO0 = 0,
+        GPIO1 = 1,
+        GPIO2 = 2,
+        GPIO3 = 3,
+        GPIO4 = 4,
+        GPIO5 = 5,
+        GPIO6 = 6,
+        GPIO7 = 7,
+        GPIO8 = 8,
+        GPIO9 = 9,
+
+        GPIO10 = 10,
+        GPIO11 = 11,
+        GPIO12 = 12,
+        GPIO13 = 13,
+        GPIO14 = 14,
+        GPIO15 = 15,
+        GPIO16 = 16,
+        GPIO17 = 17,
+        GPIO18 = 18,
+        GPIO19 = 19,
+
+        GPIO20 = 20,
+        GPIO21 = 21,
+        GPIO22 = 22,
+        GPIO23 = 23,
+        GPIO24 = 24,
+        GPIO25 = 25,
+        GPIO26 = 26,
+        GPIO27 = 27,
+        GPIO28 = 28,
+        GPIO29 = 29,
+
+        NUMBER_GPIO_PIN,
+    };
+
+    namespace host {
+
+        /**
+         * In-memory model of the GPIO bank.
+         *
+         * Each pin is one bit of a 32 bits word, the same way the RP2040 SIO block does it.
+         * An output pin reads back its output latch, an input pin reads the level driven
+         * by the outside world (see @ref PinBank::drive() "drive()") or its pull.
+         *
+         * @code{cpp}
+         * auto &bank{hal::host::PinBank::getInstance()};
+         * bank.setDirection(hal::GPIO2, false);
+         * bank.drive(hal::GPIO2, true); // Simulate an external device pulling GPIO2 high
+         * @endcode
+         *
+         * The bank is also the simulated interrupt source: every change of level of a pin with an
+         * interrupt enabled calls the callback given to @ref PinBank::setIRQCallback() "setIRQCallback()",
+         * synchronously and in pin order, the same way the RP2040 SDK calls its GPIO callback.
+         */
+        class PinBank : public traits::Singleton {
+        public:
+
+            /**
+             * Get the pin bank shared by every host peripheral.
+             *
+             * @return the pin bank
+             */
+            static PinBank &getInstance() {
+
+                static PinBank s_pin_bank{};
+                return s_pin_bank;
+            }
+
+            /**
+             * Put every pin back to its reset state (input, low, no function).
+             */
+            void reset() {
+
+                m_out.store(0, std::memory_order_relaxed);
+                m_in.store(0, std::memory_order_relaxed);
+                m_oe.store(0, std::memory_order_relaxed);
+                m_used.store(0, std::memory_order_relaxed);
+                m_irq_mask.store(0, std::memory_order_relaxed);
+
+                for(auto &events : m_irq_events) {
+                    events.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Get the level of a pin.
+             *
+             * @param gpio_pin pin to read
+             * @return level of the pin
+             */
+            [[nodiscard]] bool get(const uint gpio_pin) const {
+
+                return (getAll() >> gpio_pin) & 1U;
+            }
+
+            /**
+             * Get the level of every pin.
+             *
+             * @return one bit per pin
+             */
+            [[nodiscard]] uint32_t getAll() const {
+
+                const uint32_t oe{m_oe.load(std::memory_order_relaxed)};
+
+                return (m_out.load(std::memory_order_relaxed) & oe) | (m_in.load(std::memory_order_relaxed) & ~oe);
+            }
+
+            /**
+             * Set the output latch of a pin.
+             *
+             * @param gpio_pin pin to write
+             * @param value level to write
+             */
+            void put(const uint gpio_pin, const bool value) {
+
+                putMasked(1U << gpio_pin, value ? 1U << gpio_pin : 0U);
+            }
+
+            /**
+             * Set the output latch of every pin in mask at once.
+             *
+             * @param mask pins to modify
+             * @param value levels to write, one bit per pin
+             */
+            void putMasked(const uint32_t mask, const uint32_t value) {
+
+                const uint32_t before{getAll()};
+                uint32_t expected{m_out.load(std::memory_order_relaxed)};
+
+                while(!m_out.compare_exchange_weak(expected, (expected & ~mask) | (value & mask), std::memory_order_relaxed)) {}
+
+                raiseIRQs(before);
+            }
+
+            /**
+             * Toggle the output latch of every pin in mask.
+             *
+             * @param mask pins to toggle
+             */
+            void toggleMasked(const uint32_t mask) {
+
+                const uint32_t before{getAll()};
+
+                m_out.fetch_xor(mask, std::memory_order_relaxed);
+
+                raiseIRQs(before);
+            }
+
+            /**
+             * Simulate the outside world driving an input pin.
+             *
+             * @param gpio_pin pin driven
+             * @param value level driven
+             */
+            void drive(const uint gpio_pin, const bool value) {
+
+                const uint32_t before{getAll()};
+
+                if(value) {
+                    m_in.fetch_or(1U << gpio_pin, std::memory_order_relaxed);
+                } else {
+                    m_in.fetch_and(~(1U << gpio_pin), std::memory_order_relaxed);
+                }
+
+                raiseIRQs(before);
+            }
+
+            /**
+             * Set the direction of a pin.
+             *
+             * @param gpio_pin pin to configure
+             * @param out true for an output, false for an input
+             */
+            void setDirection(const uint gpio_pin, const bool out) {
+
+                const uint32_t before{getAll()};
+
+                if(out) {
+                    m_oe.fetch_or(1U << gpio_pin, std::memory_order_relaxed);
+                } else {
+                    m_oe.fetch_and(~(1U << gpio_pin), std::memory_order_relaxed);
+                }
+
+                raiseIRQs(before);
+            }
+
+            /**
+             * Get the direction of a pin.
+             *
+             * @param gpio_pin pin to check
+             * @return true if the pin is an output
+             */
+            [[nodiscard]] bool isOutput(const uint gpio_pin) const {
+
+                return (m_oe.load(std::memory_order_relaxed) >> gpio_pin) & 1U;
+            }
+
+            /**
+             * Set the pulls of a pin. An undriven input reads its pull.
+             *
+             * @param gpio_pin pin to configure
+             * @param up pull up
+             * @param down pull down
+             */
+            void setPulls(const uint gpio_pin, const bool up, const bool down) {
+
+                if(up or down) {
+                    drive(gpio_pin, up);
+                }
+            }
+
+            /**
+             * Claim a pin.
+             *
+             * @param gpio_pin pin to claim
+             */
+            void init(const uint gpio_pin) {
+
+                m_used.fetch_or(1U << gpio_pin, std::memory_order_relaxed);
+                setDirection(gpio_pin, false);
+                put(gpio_pin, false);
+            }
+
+            /**
+             * Release a pin.
+             *
+             * @param gpio_pin pin to release
+             */
+            void deinit(const uint gpio_pin) {
+
+                m_used.fetch_and(~(1U << gpio_pin), std::memory_order_relaxed);
+                setDirection(gpio_pin, false);
+            }
+
+            /**
+             * Whether a pin has been claimed.
+             *
+             * @param gpio_pin pin to check
+             * @return true if the pin is used
+             */
+            [[nodiscard]] bool isUsed(const uint gpio_pin) const {
+
+                return (m_used.load(std::memory_order_relaxed) >> gpio_pin) & 1U;
+            }
+
+            /**
+             * Enable or disable interrupt events of a pin.
+             *
+             * @param gpio_pin pin to configure
+             * @param events events to change, same bits as the RP2040 SDK (1: level low, 2: level high, 4: edge fall, 8: edge rise)
+             * @param enabled whether to enable or disable the events
+             */
+            void setIRQEnabled(const uint gpio_pin, const uint32_t events, const bool enabled) {
+
+                const uint32_t pin_events{enabled ? m_irq_events[gpio_pin].fetch_or(events, std::memory_order_relaxed) | events
+                                                  : m_irq_events[gpio_pin].fetch_and(~events, std::memory_order_relaxed) & ~events};
+
+                if(pin_events != 0) {
+                    m_irq_mask.fetch_or(1U << gpio_pin, std::memory_order_relaxed);
+                } else {
+                    m_irq_mask.fetch_and(~(1U << gpio_pin), std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Set the function called when an enabled interrupt event happens on a pin.
+             *
+             * @param callback function called with the pin and the events that happened
+             */
+            void setIRQCallback(void (* const callback)(uint gpio_pin, uint32_t events)) {
+
+                m_irq_callback.store(callback, std::memory_order_release);
+            }
+
+        protected:
+
+            PinBank() : m_out{0}, m_in{0}, m_oe{0}, m_used{0}, m_irq_mask{0}, m_irq_events{}, m_irq_callback{nullptr} {}
+
+            /**
+             * Call the interrupt callback for every pin with an interrupt enabled whose level changed.
+             *
+             * @note Level interrupts are only raised when the pin reaches the level, not while it stays there.
+             *
+             * @param before levels of the pins before the change
+             */
+            void raiseIRQs(const uint32_t before) {
+
+                const uint32_t irq_mask{m_irq_mask.load(std::memory_order_relaxed)};
+
+                if(irq_mask == 0) {
+                    return;
+                }
+
+                const uint32_t after{getAll()};
+                const uint32_t changed{(before ^ after) & irq_mask};
+                auto * const callback{m_irq_callback.load(std::memory_order_acquire)};
+
+                for(uint gpio_pin{0}; gpio_pin < NUMBER_GPIO_PIN and callback != nullptr; gpio_pin++) {
+
+                    if(!((changed >> gpio_pin) & 1U)) {
+                        continue;
+                    }
+
+                    const bool level{static_cast<bool>((after >> gpio_pin) & 1U)};
+                    const uint32_t events{(level ? 0x2U | 0x8U : 0x1U | 0x4U) & m_irq_events[gpio_pin].load(std::memory_order_relaxed)};
+
+                    if(events != 0) {
+                        callback(gpio_pin, events);
+                    }
+                }
+            }
+
+            std::atomic<uint32_t> m_out;    ///< Output latches
+            std::atomic<uint32_t> m_in;     ///< Levels driven from the outside world
+            std::atomic<uint32_t> m_oe;     ///< Output enables
+            std::atomic<uint32_t> m_used;   ///< Pins claimed by a peripheral
+
+            std::atomic<uint32_t> m_irq_mask;                       ///< Pins with at least one interrupt event enabled
+            std::atomic<uint32_t> m_irq_events[NUMBER_GPIO_PIN];    ///< Interrupt events enabled per pin
+            std::atomic<void (*)(uint, uint32_t)> m_irq_callback;   ///< Interrupt callback
+
+        private:
+
+        };
+
+    } // namespace host
+
+    inline void sleep_micros(uint64_t us) {
+
+        timespec ts{static_cast<time_t>(us / 1'000'000U), static_cast<long>((us % 1'000'000U) * 1'000U)};
+
+        // Sleep the remaining time if interrupted by a signal
+        while(clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {}
+    }
+
+    inline void sleep_millis(uint32_t ms) {
+
+        sleep_micros(static_cast<uint64_t>(ms) * 1'000U);
+    }
+
+} // namespace hal
+
+#endif //EMBEDDEDLIBRARY_COMMONS_HOST_H
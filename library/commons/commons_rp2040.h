@@ -5,10 +5,14 @@
 #ifndef EMBEDDEDLIBRARY_COMMONS_RP2040_H
 #define EMBEDDEDLIBRARY_COMMONS_RP2040_H
 
+#include <bit>
+
 #include "pico/types.h"
 #include "pico/time.h"
 
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
 
 namespace hal {
 
@@ -20,6 +24,14 @@ namespace hal {
             UART_INSTANCE1
         };
 
+        enum PioUARTInstance : uint8_t {
+
+            PIO_UART_INSTANCE0,
+            PIO_UART_INSTANCE1,
+            PIO_UART_INSTANCE2,
+            PIO_UART_INSTANCE3
+        };
+
         enum SPIInstance : uint8_t {
 
             SPI_INSTANCE0,
@@ -34,6 +46,8 @@ namespace hal {
 
     } // namespace peripherals
 
+    constexpr size_t CACHE_LINE_SIZE{sizeof(uint32_t)};  ///< the RP2040 has no data cache, only keep indices word aligned
+
     enum pin : uint {
 
         GPIO0 = 0,
@@ -72,6 +86,75 @@ namespace hal {
         NUMBER_GPIO_PIN,
     };
 
+    namespace detail {
+
+        /**
+         * Called from DMA_IRQ_0 when a channel completed, the interrupt of the channel is already acknowledged.
+         */
+        using DmaHandler = void (*)(uint channel, void *context);
+
+        /**
+         * Single handler of DMA_IRQ_0, shared by the drivers moving bytes with DMA: each one attaches the channels it
+         * claimed, the interrupts of the others are left alone.
+         */
+        class DmaIRQ {
+        public:
+
+            /**
+             * Route the interrupt of a channel to a handler, enabling it is left to the driver.
+             *
+             * @param channel DMA channel claimed by the driver
+             * @param handler called on completion
+             * @param context given back to the handler
+             */
+            static void attach(const uint channel, const DmaHandler handler, void * const context) {
+
+                if(!s_installed) {
+
+                    irq_add_shared_handler(DMA_IRQ_0, dispatch, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+                    irq_set_enabled(DMA_IRQ_0, true);
+                    s_installed = true;
+                }
+
+                s_contexts[channel] = context;
+                s_handlers[channel] = handler;
+            }
+
+            /**
+             * Disable the interrupt of a channel and forget its handler, before the channel is unclaimed.
+             */
+            static void detach(const uint channel) {
+
+                dma_channel_set_irq0_enabled(channel, false);
+                s_handlers[channel] = nullptr;
+            }
+
+        private:
+
+            static void dispatch() {
+
+                uint32_t status{dma_hw->ints0};
+
+                while(status != 0) {
+
+                    const auto channel{static_cast<uint>(std::countr_zero(status))};
+                    status &= status - 1;
+
+                    if(s_handlers[channel] != nullptr) {
+
+                        dma_channel_acknowledge_irq0(channel);
+                        s_handlers[channel](channel, s_contexts[channel]);
+                    }
+                }
+            }
+
+            inline static volatile DmaHandler s_handlers[NUM_DMA_CHANNELS]{};   ///< Handler of each channel, nullptr if not attached
+            inline static void *s_contexts[NUM_DMA_CHANNELS]{};                ///< Context of each handler
+            inline static bool s_installed{false};                              ///< Whether dispatch() is on DMA_IRQ_0
+        };
+
+    } // namespace detail
+
     void sleep_micros(uint64_t us) {
 
         sleep_us(us);
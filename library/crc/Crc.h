@@ -0,0 +1,471 @@
+/**
+ * @file Crc.h
+ * @brief Provide CRC-8, CRC-16 and CRC-32 computed with tables generated at compile time
+ *
+ * A CRC is described by its @ref hal::crc::Parameters "Parameters", the usual ones are provided
+ * (@ref hal::crc::CRC8 "CRC8", @ref hal::crc::CRC16_CCITT_FALSE "CRC16_CCITT_FALSE", @ref hal::crc::CRC32 "CRC32"...).
+ * A @ref hal::crc::Crc "Crc" is fed chunk by chunk, e.g. as the bytes come from a UART, with one of the
+ * @ref hal::crc::Algorithm "Algorithm":
+ * - BITWISE, no table, one shift per bit.
+ * - TABLE, one 256 entries table, one lookup per byte.
+ * - SLICE_BY_8, eight tables, eight bytes per iteration. Default on host.
+ * - DMA, the DMA sniffer of the RP2040 computes the CRC while a DMA channel reads the data, for the CRC-32 and
+ *   the CRC-16-CCITT polynomials. Falls back to TABLE when the sniffer is used by another transfer.
+ *
+ * Every algorithm is constexpr, except DMA outside of constant evaluation.
+ *
+ * @code{cpp}
+ * hal::crc::Crc32 crc;
+ *
+ * while(receiving) {
+ *     const size_t length{uart.read(buffer, sizeof(buffer))};
+ *     crc.update(buffer, length);
+ * }
+ *
+ * if(crc.value() != expected) { ... }
+ *
+ * static_assert(hal::crc::compute<hal::crc::CRC8>(data) == 0xF4);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_CRC_H
+#define EMBEDDEDLIBRARY_CRC_H
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+
+#include "../commons/commons.h"
+
+#ifdef HAL_RP2040
+#include "Crc_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Crc_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::crc {
+
+    /**
+     * Description of a CRC, with the names of the CRC catalogue.
+     * The width of the CRC is the width of T.
+     *
+     * @tparam T unsigned integer holding the CRC
+     */
+    template<std::unsigned_integral T>
+    struct Parameters {
+
+        using value_type = T;
+
+        T polynomial;       ///< Polynomial, without the highest bit
+        T init;             ///< Initial value of the register
+        bool reflected;     ///< Whether the bytes and the result are processed least significant bit first
+        T xor_out;          ///< Value XORed with the result
+        T check;            ///< CRC of "123456789", used by the tests
+    };
+
+    constexpr Parameters<uint8_t> CRC8{0x07, 0x00, false, 0x00, 0xF4};                                       ///< CRC-8/SMBUS
+    constexpr Parameters<uint8_t> CRC8_MAXIM{0x31, 0x00, true, 0x00, 0xA1};                                  ///< CRC-8/MAXIM-DOW, 1-Wire
+    constexpr Parameters<uint16_t> CRC16_CCITT_FALSE{0x1021, 0xFFFF, false, 0x0000, 0x29B1};                 ///< CRC-16/IBM-3740
+    constexpr Parameters<uint16_t> CRC16_XMODEM{0x1021, 0x0000, false, 0x0000, 0x31C3};                      ///< CRC-16/XMODEM
+    constexpr Parameters<uint16_t> CRC16_KERMIT{0x1021, 0x0000, true, 0x0000, 0x2189};                       ///< CRC-16/KERMIT
+    constexpr Parameters<uint16_t> CRC16_MODBUS{0x8005, 0xFFFF, true, 0x0000, 0x4B37};                       ///< CRC-16/MODBUS
+    constexpr Parameters<uint32_t> CRC32{0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF, 0xCBF43926};              ///< CRC-32/ISO-HDLC, Ethernet, zlib
+    constexpr Parameters<uint32_t> CRC32C{0x1EDC6F41, 0xFFFFFFFF, true, 0xFFFFFFFF, 0xE3069283};             ///< CRC-32/ISCSI, Castagnoli
+    constexpr Parameters<uint32_t> CRC32_MPEG2{0x04C11DB7, 0xFFFFFFFF, false, 0x00000000, 0x0376E6E7};       ///< CRC-32/MPEG-2
+
+    /**
+     * Way the CRC is computed, from the smallest to the fastest.
+     */
+    enum class Algorithm : uint8_t {
+        BITWISE,        ///< No table
+        TABLE,          ///< 256 entries table
+        SLICE_BY_8,     ///< 8 tables of 256 entries
+        DMA,            ///< DMA sniffer, CRC-32 and CRC-16-CCITT polynomials only
+    };
+
+#ifdef HAL_RP2040
+    /// The tables stay in flash, slice-by-8 would cost 8 KiB for a CRC-32 and miss the XIP cache
+    constexpr Algorithm DEFAULT_ALGORITHM{Algorithm::TABLE};
+#else
+    constexpr Algorithm DEFAULT_ALGORITHM{Algorithm::SLICE_BY_8};
+#endif
+
+    namespace detail {
+
+        /**
+         * Reverse the bit order of a value.
+         *
+         * @param value value to reverse
+         * @return value with its least significant bit first
+         */
+        template<std::unsigned_integral T>
+        constexpr T reflect(T value) {
+
+            T reflected{0};
+
+            for(size_t i{0}; i < std::numeric_limits<T>::digits; i++) {
+
+                reflected = static_cast<T>((reflected << 1U) | (value & 1U));
+                value = static_cast<T>(value >> 1U);
+            }
+
+            return reflected;
+        }
+
+        /**
+         * Register value after one byte, one bit at a time.
+         * Reflected CRCs keep the register reflected, so that the bytes are never reversed.
+         */
+        template<auto P>
+        constexpr auto updateBitwise(typename decltype(P)::value_type reg, const uint8_t byte) {
+
+            using T = typename decltype(P)::value_type;
+            constexpr size_t width{std::numeric_limits<T>::digits};
+
+            if constexpr (P.reflected) {
+
+                constexpr T polynomial{reflect(P.polynomial)};
+
+                reg = static_cast<T>(reg ^ byte);
+
+                for(size_t i{0}; i < 8; i++) {
+                    reg = static_cast<T>((reg & 1U) != 0 ? (reg >> 1U) ^ polynomial : reg >> 1U);
+                }
+            } else {
+
+                reg = static_cast<T>(reg ^ static_cast<T>(static_cast<T>(byte) << (width - 8)));
+
+                for(size_t i{0}; i < 8; i++) {
+                    reg = static_cast<T>(check_bit(reg, width - 1) ? static_cast<T>(reg << 1U) ^ P.polynomial : reg << 1U);
+                }
+            }
+
+            return reg;
+        }
+
+        /**
+         * Build the tables of slice-by-N.
+         * Table k gives the register after the byte i followed by k zero bytes, table 0 is the usual table.
+         */
+        template<auto P, size_t N>
+        constexpr auto makeTables() {
+
+            using T = typename decltype(P)::value_type;
+            constexpr size_t width{std::numeric_limits<T>::digits};
+
+            std::array<std::array<T, 256>, N> tables{};
+
+            for(size_t i{0}; i < 256; i++) {
+                tables[0][i] = updateBitwise<P>(T{0}, static_cast<uint8_t>(i));
+            }
+
+            for(size_t k{1}; k < N; k++) {
+                for(size_t i{0}; i < 256; i++) {
+
+                    const T previous{tables[k - 1][i]};
+
+                    if constexpr (P.reflected) {
+                        tables[k][i] = static_cast<T>((width > 8 ? previous >> 8U : 0U) ^ tables[0][previous & 0xFFU]);
+                    } else {
+                        tables[k][i] = static_cast<T>((width > 8 ? previous << 8U : 0U) ^ tables[0][(previous >> (width - 8)) & 0xFFU]);
+                    }
+                }
+            }
+
+            return tables;
+        }
+
+        template<auto P, size_t N>
+        inline constexpr auto TABLES{makeTables<P, N>()};
+
+        template<auto P>
+        constexpr auto updateTable(typename decltype(P)::value_type reg, const uint8_t byte) {
+
+            using T = typename decltype(P)::value_type;
+            constexpr size_t width{std::numeric_limits<T>::digits};
+            constexpr auto &table{TABLES<P, 1>[0]};
+
+            if constexpr (P.reflected) {
+                return static_cast<T>((width > 8 ? reg >> 8U : 0U) ^ table[(reg ^ byte) & 0xFFU]);
+            } else {
+                return static_cast<T>((width > 8 ? reg << 8U : 0U) ^ table[((reg >> (width - 8)) ^ byte) & 0xFFU]);
+            }
+        }
+
+        /**
+         * Load 8 bytes with the given byte order, in a single load at runtime.
+         */
+        template<std::endian E>
+        constexpr uint64_t load64(const uint8_t * const data) {
+
+            uint64_t block{0};
+
+            if(std::is_constant_evaluated()) {
+
+                for(size_t i{0}; i < 8; i++) {
+                    block |= static_cast<uint64_t>(data[i]) << (E == std::endian::little ? 8 * i : 56 - 8 * i);
+                }
+            } else {
+
+                memcpy(&block, data, sizeof(block));
+
+                if constexpr (E != std::endian::native) {
+                    block = __builtin_bswap64(block);
+                }
+            }
+
+            return block;
+        }
+
+        /**
+         * Register value after 8 bytes, in 8 independent lookups.
+         * The register is XORed into the first bytes of the block, which works as long as it is at most 64 bits.
+         */
+        template<auto P>
+        constexpr auto updateSliceBy8(const typename decltype(P)::value_type reg, const uint8_t * const data) {
+
+            using T = typename decltype(P)::value_type;
+            constexpr size_t width{std::numeric_limits<T>::digits};
+            constexpr auto &tables{TABLES<P, 8>};
+
+            uint64_t block;
+
+            if constexpr (P.reflected) {
+
+                block = load64<std::endian::little>(data) ^ reg;
+
+                return static_cast<T>(tables[7][block & 0xFFU] ^ tables[6][(block >> 8U) & 0xFFU]
+                                      ^ tables[5][(block >> 16U) & 0xFFU] ^ tables[4][(block >> 24U) & 0xFFU]
+                                      ^ tables[3][(block >> 32U) & 0xFFU] ^ tables[2][(block >> 40U) & 0xFFU]
+                                      ^ tables[1][(block >> 48U) & 0xFFU] ^ tables[0][block >> 56U]);
+            } else {
+
+                block = load64<std::endian::big>(data) ^ (static_cast<uint64_t>(reg) << (64 - width));
+
+                return static_cast<T>(tables[0][block & 0xFFU] ^ tables[1][(block >> 8U) & 0xFFU]
+                                      ^ tables[2][(block >> 16U) & 0xFFU] ^ tables[3][(block >> 24U) & 0xFFU]
+                                      ^ tables[4][(block >> 32U) & 0xFFU] ^ tables[5][(block >> 40U) & 0xFFU]
+                                      ^ tables[6][(block >> 48U) & 0xFFU] ^ tables[7][block >> 56U]);
+            }
+        }
+
+        /**
+         * @return whether the DMA sniffer can compute a CRC, it knows the CRC-32 and the CRC-16-CCITT polynomials
+         */
+        template<auto P>
+        constexpr bool hasSniffer() {
+
+            using T = typename decltype(P)::value_type;
+
+            return (std::is_same_v<T, uint32_t> and P.polynomial == 0x04C11DB7) or (std::is_same_v<T, uint16_t> and P.polynomial == 0x1021);
+        }
+
+        /**
+         * @return mode of the DMA sniffer computing a CRC, the reflected modes reverse the bits of every byte
+         */
+        template<auto P>
+        requires (hasSniffer<P>())
+        constexpr uint32_t snifferMode() {
+
+            if constexpr (std::is_same_v<typename decltype(P)::value_type, uint32_t>) {
+                return P.reflected ? CrcIO::CRC32_REVERSED : CrcIO::CRC32;
+            } else {
+                return P.reflected ? CrcIO::CRC16_REVERSED : CrcIO::CRC16;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * CRC computed incrementally.
+     *
+     * @tparam P @ref hal::crc::Parameters "Parameters" of the CRC
+     * @tparam A algorithm used
+     */
+    template<auto P, Algorithm A=DEFAULT_ALGORITHM>
+    requires (A != Algorithm::DMA or detail::hasSniffer<P>())
+    class Crc {
+    public:
+
+        using value_type = typename decltype(P)::value_type;
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        constexpr Crc() : m_register{initial()} {}
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Add bytes to the CRC.
+         *
+         * @param data bytes to add
+         * @param length number of bytes
+         * @return the CRC, to chain the calls
+         */
+        constexpr Crc &update(const uint8_t * const data, const size_t length) {
+
+            m_register = updateRegister(m_register, data, length);
+
+            return *this;
+        }
+
+        constexpr Crc &update(const std::span<const uint8_t> data) {
+
+            return update(data.data(), data.size());
+        }
+
+        /**
+         * Start adding bytes with the DMA sniffer and return straight away.
+         * The bytes are added synchronously when the sniffer is used by another transfer.
+         *
+         * @note The data must not change and the CRC must not be used until @ref Crc::wait() "wait()" returns.
+         *
+         * @param data bytes to add
+         */
+        void updateAsync(const std::span<const uint8_t> data) requires (A == Algorithm::DMA) {
+
+            if(detail::CrcIO::start(detail::snifferMode<P>(), toSniffer(m_register), data.data(), data.size())) {
+
+                m_register = updateRegister<Algorithm::TABLE>(m_register, data.data(), data.size());
+                return;
+            }
+
+            m_pending = true;
+        }
+
+        /**
+         * @return whether the DMA sniffer is still adding the bytes given to @ref Crc::updateAsync() "updateAsync()"
+         */
+        [[nodiscard]] bool isBusy() const requires (A == Algorithm::DMA) {
+
+            return m_pending and detail::CrcIO::isBusy();
+        }
+
+        /**
+         * Wait for the bytes given to @ref Crc::updateAsync() "updateAsync()".
+         */
+        void wait() requires (A == Algorithm::DMA) {
+
+            if(m_pending) {
+
+                m_register = fromSniffer(detail::CrcIO::finish());
+                m_pending = false;
+            }
+        }
+
+        /**
+         * @return CRC of the bytes added since the construction or the last reset, the CRC can still be updated
+         */
+        [[nodiscard]] constexpr value_type value() const {
+
+            return static_cast<value_type>(m_register ^ P.xor_out);
+        }
+
+        /**
+         * Restart from an empty message.
+         */
+        constexpr void reset() {
+
+            m_register = initial();
+        }
+
+        /**
+         * Compute the CRC of a whole message.
+         *
+         * @param data message
+         * @return CRC of the message
+         */
+        [[nodiscard]] static constexpr value_type compute(const std::span<const uint8_t> data) {
+
+            return Crc{}.update(data).value();
+        }
+
+    private:
+
+        /// Register before the first byte, kept reflected for reflected CRCs
+        static constexpr value_type initial() {
+
+            return P.reflected ? detail::reflect(P.init) : P.init;
+        }
+
+        template<Algorithm B=A>
+        static constexpr value_type updateRegister(value_type reg, const uint8_t *data, size_t length) {
+
+            if constexpr (B == Algorithm::BITWISE) {
+
+                for(size_t i{0}; i < length; i++) {
+                    reg = detail::updateBitwise<P>(reg, data[i]);
+                }
+            } else if constexpr (B == Algorithm::TABLE) {
+
+                for(size_t i{0}; i < length; i++) {
+                    reg = detail::updateTable<P>(reg, data[i]);
+                }
+            } else if constexpr (B == Algorithm::SLICE_BY_8) {
+
+                for(; length >= 8; data += 8, length -= 8) {
+                    reg = detail::updateSliceBy8<P>(reg, data);
+                }
+
+                reg = updateRegister<Algorithm::TABLE>(reg, data, length);
+            } else {
+
+                if(std::is_constant_evaluated() or detail::CrcIO::start(detail::snifferMode<P>(), toSniffer(reg), data, length)) {
+                    return updateRegister<Algorithm::TABLE>(reg, data, length);
+                }
+
+                reg = fromSniffer(detail::CrcIO::finish());
+            }
+
+            return reg;
+        }
+
+        /// The sniffer shifts its register most significant bit first, the bytes are reversed by the hardware
+        static constexpr uint32_t toSniffer(const value_type reg) {
+
+            return P.reflected ? detail::reflect(reg) : reg;
+        }
+
+        static constexpr value_type fromSniffer(const uint32_t reg) {
+
+            const auto value{static_cast<value_type>(reg)};
+
+            return P.reflected ? detail::reflect(value) : value;
+        }
+
+        value_type m_register;      ///< Register of the CRC, before the final XOR
+        bool m_pending{false};      ///< Whether the DMA sniffer holds the register
+    };
+
+    using Crc8 = Crc<CRC8>;
+    using Crc16 = Crc<CRC16_CCITT_FALSE>;
+    using Crc32 = Crc<CRC32>;
+
+    /**
+     * Compute the CRC of a whole message.
+     *
+     * @tparam P @ref hal::crc::Parameters "Parameters" of the CRC
+     * @tparam A algorithm used
+     * @param data message
+     * @return CRC of the message
+     */
+    template<auto P, Algorithm A=DEFAULT_ALGORITHM>
+    [[nodiscard]] constexpr auto compute(const std::span<const uint8_t> data) {
+
+        return Crc<P, A>::compute(data);
+    }
+
+} // namespace hal::crc
+
+#endif //EMBEDDEDLIBRARY_CRC_H
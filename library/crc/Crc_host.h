@@ -0,0 +1,86 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_CRC_HOST_H
+#define EMBEDDEDLIBRARY_CRC_HOST_H
+
+#include "../commons/commons.h"
+
+namespace hal::crc::detail {
+
+    /**
+     * Model of the RP2040 DMA sniffer, so that the DMA algorithm runs on host.
+     * The "transfer" completes in start().
+     */
+    struct CrcIO {
+
+        static constexpr uint32_t CRC32{0x0};           ///< CRC-32, most significant bit first
+        static constexpr uint32_t CRC32_REVERSED{0x1};  ///< CRC-32, bits of every byte reversed
+        static constexpr uint32_t CRC16{0x2};           ///< CRC-16-CCITT, most significant bit first
+        static constexpr uint32_t CRC16_REVERSED{0x3};  ///< CRC-16-CCITT, bits of every byte reversed
+
+        /**
+         * Compute the CRC like the sniffer would.
+         *
+         * @param mode CRC computed by the sniffer
+         * @param seed register of the sniffer before the first byte
+         * @param data bytes to sniff
+         * @param length number of bytes
+         * @return whether an error occurred, true if the sniffer is used
+         */
+        static bool start(const uint32_t mode, const uint32_t seed, const uint8_t * const data, const size_t length) {
+
+            if(s_busy) {
+                return true;
+            }
+
+            const bool crc16{mode == CRC16 or mode == CRC16_REVERSED};
+            const uint32_t polynomial{crc16 ? 0x1021U : 0x04C11DB7U};
+            const uint32_t top{crc16 ? 1U << 15U : 1U << 31U};
+
+            s_register = seed;
+
+            const bool reversed{mode == CRC32_REVERSED or mode == CRC16_REVERSED};
+
+            for(size_t i{0}; i < length; i++) {
+
+                for(size_t bit{0}; bit < 8; bit++) {
+
+                    const bool input{check_bit(data[i], reversed ? bit : 7 - bit)};
+                    const bool feedback{((s_register & top) != 0) != input};
+
+                    s_register = (s_register << 1U) ^ (feedback ? polynomial : 0U);
+                }
+            }
+
+            if(crc16) {
+                s_register &= 0xFFFFU;
+            }
+
+            s_busy = true;
+
+            return false;
+        }
+
+        static bool isBusy() {
+
+            return false;
+        }
+
+        static uint32_t finish() {
+
+            s_busy = false;
+
+            return s_register;
+        }
+
+    private:
+
+        inline static bool s_busy{false};       ///< Whether a "transfer" has not been finished
+        inline static uint32_t s_register{0};   ///< Register of the sniffer
+    };
+
+} // namespace hal::crc::detail
+
+#endif //EMBEDDEDLIBRARY_CRC_HOST_H
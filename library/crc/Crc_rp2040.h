@@ -0,0 +1,98 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_CRC_RP2040_H
+#define EMBEDDEDLIBRARY_CRC_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/dma.h>
+
+namespace hal::crc::detail {
+
+    /**
+     * Access to the DMA sniffer, which computes a CRC of the data read by a DMA channel.
+     * There is a single sniffer, it is used by one transfer at a time.
+     */
+    struct CrcIO {
+
+        static constexpr uint32_t CRC32{DMA_SNIFF_CTRL_CALC_VALUE_CRC32};             ///< CRC-32, most significant bit first
+        static constexpr uint32_t CRC32_REVERSED{DMA_SNIFF_CTRL_CALC_VALUE_CRC32R};   ///< CRC-32, bits of every byte reversed
+        static constexpr uint32_t CRC16{DMA_SNIFF_CTRL_CALC_VALUE_CRC16};             ///< CRC-16-CCITT, most significant bit first
+        static constexpr uint32_t CRC16_REVERSED{DMA_SNIFF_CTRL_CALC_VALUE_CRC16R};   ///< CRC-16-CCITT, bits of every byte reversed
+
+        /**
+         * Start a DMA transfer of the data to a dummy byte with the sniffer enabled.
+         *
+         * @param mode CRC computed by the sniffer
+         * @param seed register of the sniffer before the first byte
+         * @param data bytes to sniff
+         * @param length number of bytes
+         * @return whether an error occurred, true if the sniffer or every DMA channel is used
+         */
+        static bool start(const uint32_t mode, const uint32_t seed, const uint8_t * const data, const size_t length) {
+
+            if(s_channel >= 0) {
+                return true;
+            }
+
+            s_channel = dma_claim_unused_channel(false);
+
+            if(s_channel < 0) {
+                return true;
+            }
+
+            const auto channel{static_cast<uint>(s_channel)};
+            dma_channel_config config{dma_channel_get_default_config(channel)};
+
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+            channel_config_set_read_increment(&config, true);
+            channel_config_set_write_increment(&config, false);
+            channel_config_set_sniff_enable(&config, true);
+
+            dma_sniffer_enable(channel, mode, true);
+            dma_hw->sniff_data = seed;
+
+            dma_channel_configure(channel, &config, &s_sink, data, length, true);
+
+            return false;
+        }
+
+        /**
+         * @return whether the transfer started by start() is running
+         */
+        static bool isBusy() {
+
+            return s_channel >= 0 and dma_channel_is_busy(static_cast<uint>(s_channel));
+        }
+
+        /**
+         * Wait for the transfer started by start() and release the sniffer.
+         *
+         * @return register of the sniffer after the last byte
+         */
+        static uint32_t finish() {
+
+            const auto channel{static_cast<uint>(s_channel)};
+
+            dma_channel_wait_for_finish_blocking(channel);
+
+            const uint32_t reg{dma_hw->sniff_data};
+
+            dma_sniffer_disable();
+            dma_channel_unclaim(channel);
+            s_channel = -1;
+
+            return reg;
+        }
+
+    private:
+
+        inline static int s_channel{-1};    ///< Channel feeding the sniffer, -1 if it is free
+        inline static uint8_t s_sink{0};    ///< Destination of the transfers
+    };
+
+} // namespace hal::crc::detail
+
+#endif //EMBEDDEDLIBRARY_CRC_RP2040_H
@@ -0,0 +1,553 @@
+/**
+ * @file BitSet.h
+ * @brief Provide fixed-capacity bitsets stored in machine words
+ *
+ * @ref hal::data_structures::BitSet "BitSet" replaces the raw arrays handed to the bit helpers of commons.h:
+ * the bits are packed in native machine words, every operation is constexpr, and iterating over the set bits
+ * jumps from one to the next with a count of trailing zeros instead of testing every position.
+ *
+ * @ref hal::data_structures::AtomicBitSet "AtomicBitSet" is the variant shared with interrupt handlers or
+ * the other core: each bit is set, cleared or taken atomically, without a lock.
+ *
+ * @code{cpp}
+ * hal::data_structures::BitSet<hal::NUMBER_GPIO_PIN> used_pins{};
+ * used_pins.set(hal::GPIO4);
+ * used_pins.setRange(hal::GPIO8, 4);
+ *
+ * for(const size_t pin : used_pins) {
+ *     // 4, 8, 9, 10, 11
+ * }
+ *
+ * // Interrupt handler
+ * s_flags.set(EVENT_RX);
+ *
+ * // Main loop
+ * for(const size_t event : s_flags.takeAll()) {
+ *     handle(event);
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_BITSET_H
+#define EMBEDDEDLIBRARY_BITSET_H
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <span>
+
+#include "../commons/commons.h"
+
+namespace hal::data_structures {
+
+    /**
+     * Fixed-capacity bitset stored in machine words.
+     *
+     * @tparam N number of bits
+     * @tparam W type of the words, the native machine word by default
+     */
+    template<size_t N, std::unsigned_integral W = detail::bits::word_t>
+    requires (N > 0)
+    class BitSet {
+    public:
+
+        static constexpr size_t WORD_BITS{std::numeric_limits<W>::digits};    ///< Bits per word
+        static constexpr size_t WORDS{(N + WORD_BITS - 1) / WORD_BITS};         ///< Number of words
+
+        /**
+         * Iterate over the positions of the bits set, in ascending order.
+         */
+        class Iterator {
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const size_t *;
+            using reference = size_t;
+
+            constexpr Iterator() : m_bitset{nullptr}, m_pos{N} {}
+            constexpr Iterator(const BitSet * const bitset, const size_t pos) : m_bitset{bitset}, m_pos{pos} {}
+
+            constexpr size_t operator*() const {
+
+                return m_pos;
+            }
+
+            constexpr Iterator &operator++() {
+
+                m_pos = m_bitset->findNext(m_pos + 1);
+                return *this;
+            }
+
+            constexpr Iterator operator++(int) {
+
+                Iterator previous{*this};
+                ++*this;
+                return previous;
+            }
+
+            constexpr bool operator==(const Iterator &other) const {
+
+                return m_pos == other.m_pos;
+            }
+
+        private:
+
+            const BitSet *m_bitset;
+            size_t m_pos;
+        };
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        constexpr BitSet() : m_words{} {}
+
+        /**
+         * Build a bitset from the low bits of value.
+         *
+         * @param value bits 0 to 63 of the bitset
+         */
+        constexpr explicit BitSet(const uint64_t value) : m_words{} {
+
+            for(size_t i{0}; i < WORDS and i * WORD_BITS < 64; i++) {
+                m_words[i] = static_cast<W>(value >> (i * WORD_BITS));
+            }
+
+            trim();
+        }
+
+        //****************************************************************
+        //                           Operators
+        //****************************************************************
+
+        constexpr bool operator==(const BitSet &other) const =default;
+
+        constexpr BitSet &operator&=(const BitSet &other) {
+
+            for(size_t i{0}; i < WORDS; i++) {
+                m_words[i] &= other.m_words[i];
+            }
+
+            return *this;
+        }
+
+        constexpr BitSet &operator|=(const BitSet &other) {
+
+            for(size_t i{0}; i < WORDS; i++) {
+                m_words[i] |= other.m_words[i];
+            }
+
+            return *this;
+        }
+
+        constexpr BitSet &operator^=(const BitSet &other) {
+
+            for(size_t i{0}; i < WORDS; i++) {
+                m_words[i] ^= other.m_words[i];
+            }
+
+            return *this;
+        }
+
+        constexpr BitSet operator~() const {
+
+            BitSet result{*this};
+
+            for(auto &word : result.m_words) {
+                word = static_cast<W>(~word);
+            }
+
+            result.trim();
+
+            return result;
+        }
+
+        friend constexpr BitSet operator&(BitSet lhs, const BitSet &rhs) {
+
+            return lhs &= rhs;
+        }
+
+        friend constexpr BitSet operator|(BitSet lhs, const BitSet &rhs) {
+
+            return lhs |= rhs;
+        }
+
+        friend constexpr BitSet operator^(BitSet lhs, const BitSet &rhs) {
+
+            return lhs ^= rhs;
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * @note pos must be lower than N.
+         *
+         * @param pos position of the bit to set
+         */
+        constexpr void set(const size_t pos) {
+
+            m_words[pos / WORD_BITS] = static_cast<W>(m_words[pos / WORD_BITS] | bit(pos));
+        }
+
+        constexpr void clear(const size_t pos) {
+
+            m_words[pos / WORD_BITS] = static_cast<W>(m_words[pos / WORD_BITS] & ~bit(pos));
+        }
+
+        constexpr void toggle(const size_t pos) {
+
+            m_words[pos / WORD_BITS] = static_cast<W>(m_words[pos / WORD_BITS] ^ bit(pos));
+        }
+
+        /**
+         * @param pos position of the bit to check
+         * @return whether the bit is set, false if pos is out of range
+         */
+        [[nodiscard]] constexpr bool check(const size_t pos) const {
+
+            return pos < N and check_bit(m_words[pos / WORD_BITS], pos % WORD_BITS);
+        }
+
+        /**
+         * Set count bits starting at first, a word at a time.
+         *
+         * @param first position of the first bit to set
+         * @param count number of bits to set, clamped to the end of the bitset
+         */
+        constexpr void setRange(const size_t first, const size_t count) {
+
+            applyRange(first, count, [](W &word, const W mask) { word = static_cast<W>(word | mask); });
+        }
+
+        /**
+         * Clear count bits starting at first, a word at a time.
+         *
+         * @param first position of the first bit to clear
+         * @param count number of bits to clear, clamped to the end of the bitset
+         */
+        constexpr void clearRange(const size_t first, const size_t count) {
+
+            applyRange(first, count, [](W &word, const W mask) { word = static_cast<W>(word & ~mask); });
+        }
+
+        constexpr void setAll() {
+
+            for(auto &word : m_words) {
+                word = static_cast<W>(~W{0});
+            }
+
+            trim();
+        }
+
+        constexpr void clearAll() {
+
+            for(auto &word : m_words) {
+                word = 0;
+            }
+        }
+
+        /**
+         * @return number of bits set
+         */
+        [[nodiscard]] constexpr size_t count() const {
+
+            size_t total{0};
+
+            for(const auto word : m_words) {
+                total += static_cast<size_t>(std::popcount(word));
+            }
+
+            return total;
+        }
+
+        [[nodiscard]] constexpr bool any() const {
+
+            for(const auto word : m_words) {
+                if(word != 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        [[nodiscard]] constexpr bool none() const {
+
+            return !any();
+        }
+
+        [[nodiscard]] constexpr bool all() const {
+
+            return count() == N;
+        }
+
+        /**
+         * @return position of the first bit set, N if none is set
+         */
+        [[nodiscard]] constexpr size_t findFirst() const {
+
+            return findNext(0);
+        }
+
+        /**
+         * Find the first bit set at or after pos.
+         *
+         * @param pos position to start from
+         * @return position of the bit found, N if none is set
+         */
+        [[nodiscard]] constexpr size_t findNext(const size_t pos) const {
+
+            if(pos >= N) {
+                return N;
+            }
+
+            size_t index{pos / WORD_BITS};
+            W word{static_cast<W>(m_words[index] & (static_cast<W>(~W{0}) << (pos % WORD_BITS)))};
+
+            while(word == 0) {
+
+                if(++index == WORDS) {
+                    return N;
+                }
+
+                word = m_words[index];
+            }
+
+            return index * WORD_BITS + static_cast<size_t>(std::countr_zero(word));
+        }
+
+        /**
+         * Find the first bit cleared, e.g. the first free entry of an allocation table.
+         *
+         * @return position of the first bit cleared, N if every bit is set
+         */
+        [[nodiscard]] constexpr size_t findFirstClear() const {
+
+            for(size_t index{0}; index < WORDS; index++) {
+
+                if(m_words[index] != static_cast<W>(~W{0})) {
+
+                    const size_t pos{index * WORD_BITS + static_cast<size_t>(std::countr_one(m_words[index]))};
+
+                    return pos < N ? pos : N;
+                }
+            }
+
+            return N;
+        }
+
+        [[nodiscard]] constexpr Iterator begin() const {
+
+            return {this, findFirst()};
+        }
+
+        [[nodiscard]] constexpr Iterator end() const {
+
+            return {this, N};
+        }
+
+        /**
+         * Get the words of the bitset, e.g. to use them with the span functions of commons.h.
+         *
+         * @return words, bit i of the bitset is bit (i % WORD_BITS) of word (i / WORD_BITS)
+         */
+        [[nodiscard]] constexpr std::span<const W, WORDS> words() const {
+
+            return std::span<const W, WORDS>{m_words};
+        }
+
+        /**
+         * Get a word of the bitset.
+         *
+         * @param index index of the word
+         * @return word
+         */
+        [[nodiscard]] constexpr W getWord(const size_t index) const {
+
+            return m_words[index];
+        }
+
+        /**
+         * Set a word of the bitset, the bits past N are ignored.
+         *
+         * @param index index of the word
+         * @param word value of the word
+         */
+        constexpr void setWord(const size_t index, const W word) {
+
+            m_words[index] = word;
+            trim();
+        }
+
+        static constexpr size_t size{N};
+
+    private:
+
+        static constexpr W bit(const size_t pos) {
+
+            return static_cast<W>(W{1} << (pos % WORD_BITS));
+        }
+
+        /// Keep the bits past N cleared, so count() and operator==() do not see them
+        constexpr void trim() {
+
+            if constexpr (N % WORD_BITS != 0) {
+                m_words[WORDS - 1] = static_cast<W>(m_words[WORDS - 1] & detail::bits::low_mask<W>(N % WORD_BITS));
+            }
+        }
+
+        template<typename F>
+        constexpr void applyRange(const size_t first, size_t count, F &&apply) {
+
+            if(first >= N) {
+                return;
+            }
+
+            count = hal::min(count, N - first);
+
+            for(size_t pos{first}; count > 0;) {
+
+                const size_t offset{pos % WORD_BITS};
+                const size_t n{hal::min(WORD_BITS - offset, count)};
+
+                apply(m_words[pos / WORD_BITS], static_cast<W>(detail::bits::low_mask<W>(n) << offset));
+
+                pos += n;
+                count -= n;
+            }
+        }
+
+        W m_words[WORDS];
+    };
+
+    /**
+     * Fixed-capacity bitset whose bits are set, cleared and taken atomically.
+     *
+     * Meant for flags shared between an interrupt handler and the main loop, or between the two cores:
+     * each operation is a single read-modify-write of the word holding the bit.
+     *
+     * @note The Cortex-M0+ of the RP2040 has no exclusive access instructions, the read-modify-writes go
+     * through the atomic helpers of the SDK, which briefly mask interrupts.
+     *
+     * @tparam N number of bits
+     * @tparam W type of the words, the native machine word by default
+     */
+    template<size_t N, std::unsigned_integral W = detail::bits::word_t>
+    requires (N > 0)
+    class AtomicBitSet {
+    public:
+
+        static constexpr size_t WORD_BITS{std::numeric_limits<W>::digits};    ///< Bits per word
+        static constexpr size_t WORDS{(N + WORD_BITS - 1) / WORD_BITS};         ///< Number of words
+
+        AtomicBitSet() : m_words{} {}
+
+        AtomicBitSet(const AtomicBitSet &)=delete;
+        AtomicBitSet &operator=(const AtomicBitSet &)=delete;
+
+        /**
+         * @param pos position of the bit to set
+         * @return whether the bit was already set
+         */
+        bool set(const size_t pos) {
+
+            return m_words[pos / WORD_BITS].fetch_or(bit(pos), std::memory_order_acq_rel) & bit(pos);
+        }
+
+        /**
+         * @param pos position of the bit to clear
+         * @return whether the bit was set
+         */
+        bool clear(const size_t pos) {
+
+            return m_words[pos / WORD_BITS].fetch_and(static_cast<W>(~bit(pos)), std::memory_order_acq_rel) & bit(pos);
+        }
+
+        /**
+         * @param pos position of the bit to toggle
+         * @return whether the bit was set
+         */
+        bool toggle(const size_t pos) {
+
+            return m_words[pos / WORD_BITS].fetch_xor(bit(pos), std::memory_order_acq_rel) & bit(pos);
+        }
+
+        [[nodiscard]] bool check(const size_t pos) const {
+
+            return pos < N and (m_words[pos / WORD_BITS].load(std::memory_order_acquire) & bit(pos));
+        }
+
+        /**
+         * Take every bit set, clearing them at once, one word at a time.
+         *
+         * @return bits that were set
+         */
+        BitSet<N, W> takeAll() {
+
+            BitSet<N, W> bits{};
+
+            for(size_t i{0}; i < WORDS; i++) {
+                bits.setWord(i, m_words[i].exchange(0, std::memory_order_acq_rel));
+            }
+
+            return bits;
+        }
+
+        /**
+         * Copy the bits without clearing them.
+         *
+         * @note Each word is read atomically, not the whole bitset.
+         *
+         * @return bits set
+         */
+        [[nodiscard]] BitSet<N, W> load() const {
+
+            BitSet<N, W> bits{};
+
+            for(size_t i{0}; i < WORDS; i++) {
+                bits.setWord(i, m_words[i].load(std::memory_order_acquire));
+            }
+
+            return bits;
+        }
+
+        [[nodiscard]] bool any() const {
+
+            for(const auto &word : m_words) {
+                if(word.load(std::memory_order_acquire) != 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void clearAll() {
+
+            for(auto &word : m_words) {
+                word.store(0, std::memory_order_release);
+            }
+        }
+
+        static constexpr size_t size{N};
+
+    private:
+
+        static constexpr W bit(const size_t pos) {
+
+            return static_cast<W>(W{1} << (pos % WORD_BITS));
+        }
+
+        std::atomic<W> m_words[WORDS];
+    };
+
+} // namespace hal::data_structures
+
+#endif //EMBEDDEDLIBRARY_BITSET_H
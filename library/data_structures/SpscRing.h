@@ -0,0 +1,284 @@
+/**
+ * @file SpscRing.h
+ * @brief Provide a lock-free single producer, single consumer ring buffer
+ *
+ * The ring is meant to move data between an interrupt handler and the main loop,
+ * or between the two cores of the RP2040, without disabling interrupts or taking a lock.
+ * One side only pushes, the other side only pops.
+ *
+ * @code{cpp}
+ * hal::data_structures::SpscRing<uint8_t, 64> ring{};
+ *
+ * // Producer (e.g. an interrupt handler)
+ * ring.push(0x42);
+ *
+ * // Consumer (e.g. the main loop), zero-copy
+ * std::span<const uint8_t> data{ring.popN(16)};
+ * process(data);
+ * ring.commitPop(data.size());
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_SPSCRING_H
+#define EMBEDDEDLIBRARY_SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "../commons/commons.h"
+
+namespace hal::data_structures {
+
+    /**
+     * Lock-free single producer, single consumer ring buffer.
+     *
+     * The head and tail indices run freely and are masked on access, so the whole capacity
+     * is usable. Each index lives on its own cache line, along with the cached copy of the
+     * other index its owner uses to avoid touching the other side's line on every operation.
+     *
+     * @tparam T type of the elements, must be trivially copyable
+     * @tparam N capacity of the ring, must be a power of two
+     */
+    template<typename T, size_t N>
+    requires std::is_trivially_copyable_v<T> and (N > 0 and (N & (N - 1)) == 0)
+    class SpscRing {
+    public:
+
+        SpscRing() : m_head{0}, m_tail_cache{0}, m_tail{0}, m_head_cache{0}, m_buffer{} {}
+
+        // ****************************************************************
+        //                         Producer side
+        // ****************************************************************
+
+        /**
+         * Push an element at the head of the ring.
+         *
+         * @param value element to push
+         * @return false if the ring is full
+         */
+        bool push(const T &value) {
+
+            const size_t head{m_head.load(std::memory_order_relaxed)};
+
+            if(head - m_tail_cache == N) {
+
+                m_tail_cache = m_tail.load(std::memory_order_acquire);
+
+                if(head - m_tail_cache == N) {
+                    return false;
+                }
+            }
+
+            m_buffer[head & MASK] = value;
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * Reserve up to n contiguous free slots at the head of the ring.
+         * Fill them in place then publish them with @ref SpscRing::commitPush() "commitPush()".
+         *
+         * @note The span may be shorter than n when the free space wraps around the end of the storage.
+         *
+         * @param n number of slots wanted
+         * @return contiguous free slots, empty if the ring is full
+         */
+        std::span<T> pushN(const size_t n) {
+
+            const size_t head{m_head.load(std::memory_order_relaxed)};
+
+            if(N - (head - m_tail_cache) < n) {
+
+                m_tail_cache = m_tail.load(std::memory_order_acquire);
+            }
+
+            const size_t free{N - (head - m_tail_cache)};
+            const size_t index{head & MASK};
+
+            return {m_buffer + index, hal::min(hal::min(n, free), N - index)};
+        }
+
+        /**
+         * Publish n slots filled after a call to @ref SpscRing::pushN() "pushN()".
+         *
+         * @param n number of slots to publish, at most the size of the span returned by pushN()
+         */
+        void commitPush(const size_t n) {
+
+            m_head.store(m_head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        }
+
+        /**
+         * Copy as many elements as possible from values into the ring.
+         *
+         * @param values elements to push
+         * @param length number of elements
+         * @return number of elements pushed
+         */
+        size_t write(const T * const values, const size_t length) {
+
+            size_t count{0};
+
+            // At most two spans: up to the end of the storage, then from its start
+            for(size_t i{0}; i < 2 and count < length; i++) {
+
+                const std::span<T> slots{pushN(length - count)};
+
+                std::copy_n(values + count, slots.size(), slots.data());
+                commitPush(slots.size());
+                count += slots.size();
+            }
+
+            return count;
+        }
+
+        // ****************************************************************
+        //                         Consumer side
+        // ****************************************************************
+
+        /**
+         * Pop an element from the tail of the ring.
+         *
+         * @param value element popped
+         * @return false if the ring is empty
+         */
+        bool pop(T &value) {
+
+            const size_t tail{m_tail.load(std::memory_order_relaxed)};
+
+            if(m_head_cache == tail) {
+
+                m_head_cache = m_head.load(std::memory_order_acquire);
+
+                if(m_head_cache == tail) {
+                    return false;
+                }
+            }
+
+            value = m_buffer[tail & MASK];
+            m_tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * Get up to n contiguous elements at the tail of the ring without copying them.
+         * Release them with @ref SpscRing::commitPop() "commitPop()" once they have been used.
+         *
+         * @note The span may be shorter than n when the data wraps around the end of the storage.
+         *
+         * @param n number of elements wanted
+         * @return contiguous elements, empty if the ring is empty
+         */
+        std::span<const T> popN(const size_t n) {
+
+            const size_t tail{m_tail.load(std::memory_order_relaxed)};
+
+            if(m_head_cache - tail < n) {
+
+                m_head_cache = m_head.load(std::memory_order_acquire);
+            }
+
+            const size_t available{m_head_cache - tail};
+            const size_t index{tail & MASK};
+
+            return {m_buffer + index, hal::min(hal::min(n, available), N - index)};
+        }
+
+        /**
+         * Release n elements obtained with @ref SpscRing::popN() "popN()".
+         *
+         * @param n number of elements to release, at most the size of the span returned by popN()
+         */
+        void commitPop(const size_t n) {
+
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        }
+
+        /**
+         * Copy as many elements as possible from the ring into values.
+         *
+         * @param values array receiving the elements
+         * @param length length of the array
+         * @return number of elements popped
+         */
+        size_t read(T * const values, const size_t length) {
+
+            size_t count{0};
+
+            // At most two spans: up to the end of the storage, then from its start
+            for(size_t i{0}; i < 2 and count < length; i++) {
+
+                const std::span<const T> elements{popN(length - count)};
+
+                std::copy_n(elements.data(), elements.size(), values + count);
+                commitPop(elements.size());
+                count += elements.size();
+            }
+
+            return count;
+        }
+
+        // ****************************************************************
+        //                            Observers
+        // ****************************************************************
+
+        /**
+         * Empty the ring.
+         *
+         * @note Must not be called while the producer or the consumer are running.
+         */
+        void clear() {
+
+            m_head.store(0, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+            m_head_cache = 0;
+            m_tail_cache = 0;
+        }
+
+        /**
+         * Get the number of elements in the ring.
+         *
+         * @note The value may be outdated as soon as it is returned if the other side is running.
+         *
+         * @return number of elements
+         */
+        [[nodiscard]] size_t size() const {
+
+            const size_t tail{m_tail.load(std::memory_order_acquire)};
+
+            return m_head.load(std::memory_order_acquire) - tail;
+        }
+
+        [[nodiscard]] bool empty() const {
+
+            return size() == 0;
+        }
+
+        [[nodiscard]] bool full() const {
+
+            return size() == N;
+        }
+
+        static constexpr size_t capacity{N};
+
+    private:
+
+        static constexpr size_t MASK{N - 1};
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head;    ///< Next index to push, only written by the producer
+        size_t m_tail_cache;                                    ///< Producer copy of m_tail
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail;    ///< Next index to pop, only written by the consumer
+        size_t m_head_cache;                                    ///< Consumer copy of m_head
+
+        alignas(CACHE_LINE_SIZE) T m_buffer[N];
+    };
+
+} // namespace hal::data_structures
+
+#endif //EMBEDDEDLIBRARY_SPSCRING_H
@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "../commons/commons.h"
+#include "../stats/Stats.h"
 #include "../traits/NonCopyable.h"
 
 namespace hal::interfaces {
@@ -103,6 +104,10 @@ namespace hal::interfaces {
                 m_gpio_irq = other.m_gpio_irq;
                 m_last_error = other.m_last_error;
 
+#ifdef HAL_STATS
+                m_stats.take(other.m_stats);
+#endif
+
                 // other.m_gpio_pin = 0;
                 // other.m_gpio_dir = ???;
                 // other.m_gpio_pull = Pull::NONE;
@@ -137,6 +142,10 @@ namespace hal::interfaces {
                 m_gpio_func = other.m_gpio_func;
                 m_gpio_irq = other.m_gpio_irq;
 
+#ifdef HAL_STATS
+                m_stats.take(other.m_stats);
+#endif
+
                 // other.m_gpio_pin = 0;
                 // other.m_gpio_dir = ???;
                 // other.m_gpio_pull = Pull::NONE;
@@ -220,6 +229,8 @@ namespace hal::interfaces {
          */
         virtual void toggle() {
 
+            HAL_STATS_ADD(m_stats.toggles, 1);
+
             write(!read());
         }
 
@@ -281,26 +292,58 @@ namespace hal::interfaces {
             return m_gpio_func;
         }
 
-        // /**
-        //  *
-        //  * @param gpio_irq condition on which to raise an interrupt
-        //  */
-        // virtual bool setIRQ(const enum peripherals::gpio::IRQ gpio_irq)=0;
+        /**
+         * Set the condition on which an interrupt is raised.
+         *
+         * Without a callback the interrupts are pushed as timestamped events into the queue of
+         * @ref peripherals::gpio::IRQDispatcher "IRQDispatcher", to be popped from the main loop.
+         *
+         * @param gpio_irq condition on which to raise an interrupt, IRQ::NONE to disable it
+         * @param callback function called from the interrupt, nullptr to queue the events
+         * @param context pointer given back to the callback
+         * @return whether an error occurred
+         */
+        virtual bool setIRQ(const enum peripherals::gpio::IRQ gpio_irq, peripherals::gpio::IRQCallback callback=nullptr, void *context=nullptr)=0;
 
-        // /**
-        //  *
-        //  * @return
-        //  */
-        // virtual enum peripherals::gpio::IRQ getIRQ() const {
+        /**
+         * Get the condition on which an interrupt is raised, see setIRQ().
+         *
+         * @return condition on which the interrupt is raised, IRQ::NONE if disabled
+         */
+        virtual enum peripherals::gpio::IRQ getIRQ() const {
 
-        //     return m_gpio_irq;
-        // }
+            return m_gpio_irq;
+        }
 
         virtual enum Error getLastError() {
 
             return m_last_error;
         }
 
+        /**
+         * Get the counters accumulated since the last resetStats(), see Stats.h.
+         *
+         * @return snapshot of the counters, all zeros unless HAL_STATS is defined
+         */
+        [[nodiscard]] virtual stats::GPIOStats getStats() const {
+
+#ifdef HAL_STATS
+            return {m_stats.writes.get(), m_stats.toggles.get(), 0, 0};
+#else
+            return {};
+#endif
+        }
+
+        /**
+         * Set every counter back to zero.
+         */
+        virtual void resetStats() {
+
+#ifdef HAL_STATS
+            m_stats.reset();
+#endif
+        }
+
     protected:
 
         // ****************************************************************
@@ -316,6 +359,10 @@ namespace hal::interfaces {
 
         enum Error m_last_error;
 
+#ifdef HAL_STATS
+        stats::GPIOCounters m_stats;    ///< Updated by the implementations with HAL_STATS_ADD()
+#endif
+
     private:
     };
 
@@ -0,0 +1,484 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_INTERFACEI2C_H
+#define EMBEDDEDLIBRARY_INTERFACEI2C_H
+
+#include <cstdlib>
+#include <span>
+
+#include "../commons/commons.h"
+#include "../traits/Singleton.h"
+#include "InterfaceDigitalGPIO.h"
+
+namespace hal::peripherals::i2c {
+
+    /**
+     * Register access executed by @ref hal::interfaces::InterfaceI2C::transfer() "transfer()": the bytes of write
+     * are sent, then the bytes of read are received after a repeated start, then a stop ends the transaction.
+     *
+     * @code{cpp}
+     * uint8_t reg{0x3B};
+     * uint8_t sample[6];
+     *
+     * Transaction transaction{0x68, {&reg, 1}, sample}; // Read 6 registers from 0x3B
+     * @endcode
+     */
+    struct Transaction {
+
+        uint8_t address;                    ///< 7 bits address of the device
+        std::span<const uint8_t> write;     ///< Bytes sent first, empty for a plain read
+        std::span<uint8_t> read;            ///< Bytes received after a repeated start, empty for a plain write
+        enum Error error{Error::NONE};      ///< Set once executed, Error::ERROR if the device did not acknowledge
+    };
+
+    /**
+     * Check an address the way the I2C specification reserves them: 0x00 to 0x07 and 0x78 to 0x7F.
+     *
+     * @param address 7 bits address
+     * @return whether a device may use the address
+     */
+    constexpr bool isValidAddress(const uint8_t address) {
+
+        return address >= 0x08U and address < 0x78U;
+    }
+
+    /**
+     * Registers of an I2C slave, served in place from a buffer owned by the application.
+     *
+     * The first byte the master writes after its address selects a register, the next bytes are written from it and
+     * the reads start from it. The register pointer auto-increments and wraps around the buffer. A write is reported
+     * once, as a range, when the master stops or restarts: the bytes are never copied.
+     *
+     * The functions are called by the interrupt handler of the slave, one byte at a time.
+     */
+    class RegisterMap {
+    public:
+
+        /**
+         * @param registers buffer of the registers, at most 256 bytes, must stay valid while the slave runs
+         * @param callback function told about the registers written, may be nullptr
+         * @param context pointer given back to the callback
+         */
+        void attach(const std::span<uint8_t> registers, const RegisterCallback callback, void * const context) {
+
+            m_registers = registers;
+            m_callback = callback;
+            m_context = context;
+            m_pointer = 0;
+            m_dirty_offset = 0;
+            m_dirty_length = 0;
+        }
+
+        /**
+         * The master wrote a byte.
+         *
+         * @param byte byte received
+         * @param first whether it is the first byte after the address, which selects a register
+         */
+        void receive(const uint8_t byte, const bool first) {
+
+            if(first) {
+
+                flush();
+                m_pointer = byte % m_registers.size();
+                return;
+            }
+
+            // The range is reported as soon as the write wraps around
+            if(m_dirty_length > 0 and m_pointer != m_dirty_offset + m_dirty_length) {
+                flush();
+            }
+
+            if(m_dirty_length == 0) {
+                m_dirty_offset = m_pointer;
+            }
+
+            m_registers[m_pointer] = byte;
+            m_dirty_length++;
+            advance();
+        }
+
+        /**
+         * The master reads a byte.
+         *
+         * @return content of the register pointed to
+         */
+        uint8_t transmit() {
+
+            const uint8_t byte{m_registers[m_pointer]};
+            advance();
+
+            return byte;
+        }
+
+        /**
+         * The master stopped or restarted, report the registers written.
+         */
+        void stop() {
+
+            flush();
+        }
+
+        /**
+         * @return register of the next access
+         */
+        [[nodiscard]] size_t getPointer() const {
+
+            return m_pointer;
+        }
+
+    private:
+
+        void advance() {
+
+            m_pointer = m_pointer + 1 < m_registers.size() ? m_pointer + 1 : 0;
+        }
+
+        void flush() {
+
+            if(m_dirty_length > 0 and m_callback != nullptr) {
+                m_callback(m_dirty_offset, m_dirty_length, m_context);
+            }
+
+            m_dirty_length = 0;
+        }
+
+        std::span<uint8_t> m_registers{};       ///< Registers, owned by the application
+        RegisterCallback m_callback{nullptr};   ///< Told about the registers written
+        void *m_context{nullptr};               ///< Given back to the callback
+        size_t m_pointer{0};                    ///< Register of the next access
+        size_t m_dirty_offset{0};               ///< First register written since the last report
+        size_t m_dirty_length{0};               ///< Registers written since the last report
+    };
+
+} // namespace hal::peripherals::i2c
+
+namespace hal::interfaces {
+
+    class InterfaceI2C : public traits::Singleton {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * The destructor must call deinit()
+         */
+        ~InterfaceI2C() override =default;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Initialise the I2C as a master.
+         *
+         * @note Call this function before using an instance of an I2C interface.
+         *
+         * @param sda_pin sda pin
+         * @param scl_pin scl pin
+         * @param baudrate value of the baud rate, e.g. @ref hal::peripherals::I2C_DEFAULT_BAUD_RATE "I2C_DEFAULT_BAUD_RATE"
+         * @return whether an error occurred or not
+         */
+        virtual bool init(uint sda_pin, uint scl_pin, uint baudrate)=0;
+
+        /**
+         * Initialise the I2C as a slave serving a register map, see
+         * @ref hal::peripherals::i2c::RegisterMap "RegisterMap". The master calls are refused until deinit().
+         *
+         * @code{cpp}
+         * uint8_t registers[32]{};
+         * i2c.initSlave(0x42, hal::GPIO4, hal::GPIO5, registers, [](size_t offset, size_t length, void *) {
+         *     // registers[offset] to registers[offset + length - 1] were written
+         * });
+         * @endcode
+         *
+         * @param address 7 bits address the slave answers to
+         * @param sda_pin sda pin
+         * @param scl_pin scl pin
+         * @param registers buffer of the registers, 1 to 256 bytes, must stay valid until deinit()
+         * @param callback function told about the registers written by the master, may be nullptr
+         * @param context pointer given back to the callback
+         * @return whether an error occurred, Error::ERROR for a reserved address, Error::TOOSMALL or Error::TOOBIG
+         * for the size of the registers
+         */
+        virtual bool initSlave(const uint8_t address, const uint sda_pin, const uint scl_pin, const std::span<uint8_t> registers,
+                               const peripherals::i2c::RegisterCallback callback=nullptr, void * const context=nullptr) {
+
+            (void)address;
+            (void)sda_pin;
+            (void)scl_pin;
+            (void)registers;
+            (void)callback;
+            (void)context;
+
+            m_last_error = Error::NOTAVAILABLEONPLATFORM;
+
+            return true;
+        }
+
+        /**
+         * Deinitialise an instance of the I2C.
+         *
+         * @return whether an error occurred or not
+         */
+        virtual bool deinit()=0;
+
+        /**
+         * Send bytes to a device.
+         *
+         * @param address 7 bits address of the device
+         * @param data bytes to send
+         * @param nostop true to keep the bus for the next call, which starts with a repeated start
+         * @return whether an error occurred, Error::ERROR if the device did not acknowledge
+         */
+        virtual bool write(uint8_t address, std::span<const uint8_t> data, bool nostop=false)=0;
+
+        /**
+         * Receive bytes from a device.
+         *
+         * @param address 7 bits address of the device
+         * @param data receive the bytes, its size is the number of bytes to read
+         * @param nostop true to keep the bus for the next call, which starts with a repeated start
+         * @return whether an error occurred, Error::ERROR if the device did not acknowledge
+         */
+        virtual bool read(uint8_t address, std::span<uint8_t> data, bool nostop=false)=0;
+
+        /**
+         * Send bytes then receive bytes after a repeated start, the bus is not released in between.
+         * Usually the register to read, then its content.
+         *
+         * @param address 7 bits address of the device
+         * @param data bytes to send
+         * @param result receive the bytes
+         * @return whether an error occurred
+         */
+        virtual bool writeRead(const uint8_t address, const std::span<const uint8_t> data, const std::span<uint8_t> result) {
+
+            if(data.empty()) {
+                return read(address, result);
+            }
+
+            if(result.empty()) {
+                return write(address, data);
+            }
+
+            return write(address, data, true) or read(address, result);
+        }
+
+        /**
+         * Execute transactions back to back, each one ends with a stop.
+         * A transaction that is not acknowledged does not stop the next ones, its error is set.
+         * The default implementation calls writeRead() for every transaction, the implementations check the whole list
+         * first and execute none of it if a transaction is invalid (see validate()).
+         *
+         * @code{cpp}
+         * Transaction transactions[]{{0x68, {&accel_reg, 1}, accel}, {0x1E, {&mag_reg, 1}, mag}};
+         * i2c.transfer(transactions);
+         * @endcode
+         *
+         * @param transactions transactions to execute, in order
+         * @return whether an error occurred, the error of the first transaction that failed
+         */
+        virtual bool transfer(const std::span<peripherals::i2c::Transaction> transactions) {
+
+            enum Error error{Error::NONE};
+
+            for(peripherals::i2c::Transaction &transaction : transactions) {
+
+                writeRead(transaction.address, transaction.write, transaction.read);
+                transaction.error = m_last_error;
+
+                if(error == Error::NONE) {
+                    error = m_last_error;
+                }
+            }
+
+            m_last_error = error;
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Start executing transactions back to back and return straight away, see transfer().
+         * At most one list runs at a time.
+         *
+         * @note The transactions and their buffers must stay valid until the callback is called.
+         *
+         * @param transactions transactions to execute, in order
+         * @param callback function called when the last transaction completes, nullptr to poll isBusy()
+         * @param context pointer given back to the callback
+         * @return whether an error occurred, Error::AGAIN if a list is already running
+         */
+        virtual bool transferAsync(const std::span<peripherals::i2c::Transaction> transactions, const peripherals::i2c::TransferCallback callback=nullptr, void * const context=nullptr) {
+
+            (void)transactions;
+            (void)callback;
+            (void)context;
+
+            m_last_error = Error::NOTAVAILABLEONPLATFORM;
+
+            return true;
+        }
+
+        /**
+         * Determine if a list started by transferAsync() is running.
+         *
+         * @return true if it is running, false once it completed or was aborted
+         */
+        [[nodiscard]] virtual bool isBusy() const {
+
+            return false;
+        }
+
+        /**
+         * Stop the list started by transferAsync() after the running transaction, its callback is not called.
+         *
+         * @return number of transactions executed
+         */
+        virtual size_t abort() {
+
+            return 0;
+        }
+
+        /**
+         * Set the SDA and SCL pins of the I2C.
+         *
+         * @param sda_pin sda pin
+         * @param scl_pin scl pin
+         * @return whether an error occurred
+         */
+        virtual bool setPins(uint sda_pin, uint scl_pin)=0;
+
+        /**
+         * Set the SDA and SCL pins of the I2C.
+         *
+         * @param sda_pin sda pin
+         * @param scl_pin scl pin
+         * @return whether an error occurred
+         */
+        virtual bool setPins(const interfaces::InterfaceDigitalGPIO &sda_pin, const interfaces::InterfaceDigitalGPIO &scl_pin) {
+
+            return setPins(sda_pin.getPin(), scl_pin.getPin());
+        }
+
+        /**
+         * Set the value of the baud rate as close as possible to the value provided.
+         *
+         * @param baudrate value of the baud rate
+         * @return effective value set
+         */
+        virtual uint setBaudrate(uint baudrate)=0;
+
+        /**
+         * Get the baud rate value
+         *
+         * @return value of the baud rate
+         */
+        [[nodiscard]] virtual uint getBaudrate() const {
+
+            return m_baudrate;
+        }
+
+        /**
+         * Get the role of the I2C on the bus.
+         *
+         * @return Mode::MODE_SLAVE after initSlave(), Mode::MODE_MASTER otherwise
+         */
+        [[nodiscard]] virtual peripherals::i2c::Mode getMode() const {
+
+            return m_mode;
+        }
+
+        /**
+         * Determine if the I2C has been initialised
+         *
+         * @return true if it has been initialised, false otherwise
+         */
+        [[nodiscard]] virtual bool isInitialised() const=0;
+
+        /**
+         * Get the last error that occurred.
+         *
+         * @return last error
+         */
+        [[nodiscard]] virtual enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        InterfaceI2C()
+        : m_sda_pin{0}, m_scl_pin{0}, m_baudrate{0}, m_mode{peripherals::i2c::Mode::MODE_MASTER},
+          m_instance{peripherals::I2C_INSTANCE0}, m_last_error{Error::NONE} {}
+
+        uint m_sda_pin;
+        uint m_scl_pin;
+        uint m_baudrate;
+        peripherals::i2c::Mode m_mode;
+
+        peripherals::I2CInstance m_instance;
+        enum Error m_last_error;
+
+        /**
+         * Check the parameters of initSlave().
+         *
+         * @return Error::ERROR for a reserved address, Error::TOOSMALL or Error::TOOBIG for the size of the registers
+         */
+        [[nodiscard]] static enum Error checkSlave(const uint8_t address, const std::span<uint8_t> registers) {
+
+            if(!peripherals::i2c::isValidAddress(address)) {
+                return Error::ERROR;
+            }
+
+            if(registers.empty()) {
+                return Error::TOOSMALL;
+            }
+
+            return registers.size() > 256 ? Error::TOOBIG : Error::NONE;
+        }
+
+        /**
+         * Check a list of transactions before executing any of them: the address must not be reserved, and the bytes
+         * written plus read must fit in @ref hal::peripherals::I2C_MAX_TRANSFER "I2C_MAX_TRANSFER", at least one.
+         * The error is set into the first invalid transaction and m_last_error.
+         *
+         * @param transactions transactions to check
+         * @return whether a transaction is invalid
+         */
+        bool validate(const std::span<peripherals::i2c::Transaction> transactions) {
+
+            m_last_error = Error::NONE;
+
+            for(peripherals::i2c::Transaction &transaction : transactions) {
+
+                const size_t length{transaction.write.size() + transaction.read.size()};
+
+                if(!peripherals::i2c::isValidAddress(transaction.address)) {
+                    m_last_error = Error::ERROR;
+                } else if(length == 0) {
+                    m_last_error = Error::TOOSMALL;
+                } else if(length > peripherals::I2C_MAX_TRANSFER) {
+                    m_last_error = Error::TOOBIG;
+                }
+
+                if(m_last_error != Error::NONE) {
+
+                    transaction.error = m_last_error;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    };
+
+} // namespace hal::interfaces
+
+#endif //EMBEDDEDLIBRARY_INTERFACEI2C_H
@@ -0,0 +1,296 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_INTERFACESPI_H
+#define EMBEDDEDLIBRARY_INTERFACESPI_H
+
+#include <cstdlib>
+#include <span>
+
+#include "../commons/commons.h"
+#include "../traits/Singleton.h"
+#include "InterfaceDigitalGPIO.h"
+
+namespace hal::peripherals::spi {
+
+    /**
+     * Clock polarity and phase of the SPI
+     */
+    enum class Mode : uint8_t {
+
+        MODE0,  ///< Clock idles low, data sampled on the rising edge
+        MODE1,  ///< Clock idles low, data sampled on the falling edge
+        MODE2,  ///< Clock idles high, data sampled on the falling edge
+        MODE3   ///< Clock idles high, data sampled on the rising edge
+    };
+
+    constexpr uint8_t FILL_BYTE{0xFF};  ///< Byte sent on MOSI when only reading
+
+    /**
+     * Exchange queued by @ref hal::interfaces::InterfaceSPI::transferAsync() "transferAsync()": the chip select is
+     * driven low, the bytes of tx are sent while the bytes of rx are received, then the chip select is driven high.
+     *
+     * @code{cpp}
+     * const uint8_t command[]{0x9F, 0x00, 0x00, 0x00};
+     * uint8_t id[4];
+     *
+     * Transaction transaction{&flash_cs, command, id}; // Read the JEDEC id of a flash
+     * @endcode
+     */
+    struct Transaction {
+
+        interfaces::InterfaceDigitalGPIO *cs;   ///< Chip select, active low, nullptr to drive it by hand
+        std::span<const uint8_t> tx;            ///< Bytes sent, empty to send FILL_BYTE while reading
+        std::span<uint8_t> rx;                  ///< Bytes received, empty to drop them, same size as tx otherwise
+        TransferCallback callback{nullptr};     ///< Called once the transaction completes, may be nullptr
+        void *context{nullptr};                 ///< Given back to the callback
+        enum Error error{Error::NONE};          ///< Set once executed, Error::AGAIN if it was aborted before
+    };
+
+} // namespace hal::peripherals::spi
+
+namespace hal::interfaces {
+
+    class InterfaceSPI : public traits::Singleton {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * The destructor must call deinit()
+         */
+        ~InterfaceSPI() override =default;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Initialise the SPI as a master, in @ref hal::peripherals::spi::Mode::MODE0 "MODE0" with 8 bits frames,
+         * most significant bit first.
+         *
+         * @note Call this function before using an instance of an SPI interface.
+         *
+         * @param sck_pin clock pin
+         * @param mosi_pin output pin
+         * @param miso_pin input pin
+         * @param baudrate value of the baud rate, e.g. @ref hal::peripherals::SPI_DEFAULT_BAUD_RATE "SPI_DEFAULT_BAUD_RATE"
+         * @return whether an error occurred or not
+         */
+        virtual bool init(uint sck_pin, uint mosi_pin, uint miso_pin, uint baudrate)=0;
+
+        /**
+         * Deinitialise an instance of the SPI, the queued transactions are aborted.
+         *
+         * @return whether an error occurred or not
+         */
+        virtual bool deinit()=0;
+
+        /**
+         * Exchange bytes, the chip select is left as it is.
+         *
+         * @param tx bytes sent, empty to send @ref hal::peripherals::spi::FILL_BYTE "FILL_BYTE"
+         * @param rx bytes received, empty to drop them, same size as tx otherwise
+         * @return whether an error occurred, Error::AGAIN while queued transactions run
+         */
+        virtual bool transfer(std::span<const uint8_t> tx, std::span<uint8_t> rx)=0;
+
+        /**
+         * Exchange bytes with a device: its chip select is driven low for the whole exchange.
+         *
+         * @param cs chip select of the device, active low
+         * @param tx bytes sent, empty to send @ref hal::peripherals::spi::FILL_BYTE "FILL_BYTE"
+         * @param rx bytes received, empty to drop them, same size as tx otherwise
+         * @return whether an error occurred
+         */
+        virtual bool transfer(interfaces::InterfaceDigitalGPIO &cs, const std::span<const uint8_t> tx, const std::span<uint8_t> rx) {
+
+            cs.write(0);
+            const bool error{transfer(tx, rx)};
+            cs.write(1);
+
+            return error;
+        }
+
+        /**
+         * Send bytes, the bytes received are dropped.
+         *
+         * @param tx bytes sent
+         * @return whether an error occurred
+         */
+        bool write(const std::span<const uint8_t> tx) {
+
+            return transfer(tx, {});
+        }
+
+        /**
+         * Receive bytes while sending @ref hal::peripherals::spi::FILL_BYTE "FILL_BYTE".
+         *
+         * @param rx bytes received
+         * @return whether an error occurred
+         */
+        bool read(const std::span<uint8_t> rx) {
+
+            return transfer({}, rx);
+        }
+
+        /**
+         * Queue a transaction and return straight away. The queued transactions run back to back, in order, the next
+         * one starts as soon as the previous one completes.
+         *
+         * @note The transaction and its buffers must stay valid until its callback is called.
+         *
+         * @param transaction transaction to queue
+         * @return whether an error occurred, Error::AGAIN if @ref hal::peripherals::SPI_QUEUE_SIZE "SPI_QUEUE_SIZE"
+         * transactions are already queued
+         */
+        virtual bool transferAsync(peripherals::spi::Transaction &transaction) {
+
+            (void)transaction;
+
+            m_last_error = Error::NOTAVAILABLEONPLATFORM;
+
+            return true;
+        }
+
+        /**
+         * Determine if queued transactions are running.
+         *
+         * @return true if some are running, false once the queue is empty
+         */
+        [[nodiscard]] virtual bool isBusy() const {
+
+            return false;
+        }
+
+        /**
+         * Wait for the running transaction, then drop the queued ones: their error is set to Error::AGAIN and their
+         * callbacks are not called.
+         *
+         * @return number of transactions dropped
+         */
+        virtual size_t abort() {
+
+            return 0;
+        }
+
+        /**
+         * Set the pins of the SPI.
+         *
+         * @param sck_pin clock pin
+         * @param mosi_pin output pin
+         * @param miso_pin input pin
+         * @return whether an error occurred
+         */
+        virtual bool setPins(uint sck_pin, uint mosi_pin, uint miso_pin)=0;
+
+        /**
+         * Set the pins of the SPI.
+         *
+         * @param sck_pin clock pin
+         * @param mosi_pin output pin
+         * @param miso_pin input pin
+         * @return whether an error occurred
+         */
+        virtual bool setPins(const interfaces::InterfaceDigitalGPIO &sck_pin, const interfaces::InterfaceDigitalGPIO &mosi_pin, const interfaces::InterfaceDigitalGPIO &miso_pin) {
+
+            return setPins(sck_pin.getPin(), mosi_pin.getPin(), miso_pin.getPin());
+        }
+
+        /**
+         * Set the clock polarity and phase.
+         *
+         * @param mode mode expected by the devices
+         * @return whether an error occurred
+         */
+        virtual bool setMode(peripherals::spi::Mode mode)=0;
+
+        /**
+         * Get the clock polarity and phase.
+         *
+         * @return mode of the SPI
+         */
+        [[nodiscard]] virtual peripherals::spi::Mode getMode() const {
+
+            return m_mode;
+        }
+
+        /**
+         * Set the value of the baud rate as close as possible to the value provided.
+         *
+         * @param baudrate value of the baud rate
+         * @return effective value set
+         */
+        virtual uint setBaudrate(uint baudrate)=0;
+
+        /**
+         * Get the baud rate value
+         *
+         * @return value of the baud rate
+         */
+        [[nodiscard]] virtual uint getBaudrate() const {
+
+            return m_baudrate;
+        }
+
+        /**
+         * Determine if the SPI has been initialised
+         *
+         * @return true if it has been initialised, false otherwise
+         */
+        [[nodiscard]] virtual bool isInitialised() const=0;
+
+        /**
+         * Get the last error that occurred.
+         *
+         * @return last error
+         */
+        [[nodiscard]] virtual enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        InterfaceSPI()
+        : m_sck_pin{0}, m_mosi_pin{0}, m_miso_pin{0}, m_baudrate{0}, m_mode{peripherals::spi::Mode::MODE0},
+          m_instance{peripherals::SPI_INSTANCE0}, m_last_error{Error::NONE} {}
+
+        uint m_sck_pin;
+        uint m_mosi_pin;
+        uint m_miso_pin;
+        uint m_baudrate;
+        peripherals::spi::Mode m_mode;
+
+        peripherals::SPIInstance m_instance;
+        enum Error m_last_error;
+
+        /**
+         * Check the buffers of an exchange: at least one byte, tx and rx of the same size when both are given.
+         *
+         * @param tx bytes sent
+         * @param rx bytes received
+         * @return Error::TOOSMALL if both are empty, Error::ERROR if their sizes differ, Error::NONE otherwise
+         */
+        [[nodiscard]] static enum Error validate(const std::span<const uint8_t> tx, const std::span<uint8_t> rx) {
+
+            if(tx.empty() and rx.empty()) {
+                return Error::TOOSMALL;
+            }
+
+            if(!tx.empty() and !rx.empty() and tx.size() != rx.size()) {
+                return Error::ERROR;
+            }
+
+            return Error::NONE;
+        }
+    };
+
+} // namespace hal::interfaces
+
+#endif //EMBEDDEDLIBRARY_INTERFACESPI_H
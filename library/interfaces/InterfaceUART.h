@@ -6,7 +6,9 @@
 #define EMBEDDEDLIBRARY_INTERFACEUART_H
 
 #include <cstdlib>
+#include <span>
 
+#include "../stats/Stats.h"
 #include "../traits/Singleton.h"
 #include "InterfaceDigitalGPIO.h"
 
@@ -88,6 +90,33 @@ namespace hal::interfaces {
          */
         virtual void write(const uint8_t * const buffer, const size_t length)=0;
 
+        /**
+         * Send several buffers through the UART, one after the other, without gathering them first.
+         * The default implementation calls write() for every buffer.
+         *
+         * @code{cpp}
+         * const std::span<const uint8_t> frame[]{header, payload, crc};
+         * uart.writev(frame);
+         * @endcode
+         *
+         * @param buffers buffers to send, in order
+         */
+        virtual void writev(const std::span<const std::span<const uint8_t>> buffers) {
+
+            enum Error error{Error::NONE};
+
+            for(const std::span<const uint8_t> buffer : buffers) {
+
+                write(buffer.data(), buffer.size());
+
+                if(m_last_error != Error::NONE) {
+                    error = m_last_error;
+                }
+            }
+
+            m_last_error = error;
+        }
+
         /**
          * Set the RX et TX pin of the UART
          *
@@ -133,6 +162,30 @@ namespace hal::interfaces {
             return m_last_error;
         }
 
+        /**
+         * Get the counters accumulated since the last resetStats(), see Stats.h.
+         *
+         * @return snapshot of the counters, all zeros unless HAL_STATS is defined
+         */
+        [[nodiscard]] virtual stats::UARTStats getStats() const {
+
+#ifdef HAL_STATS
+            return m_stats.snapshot();
+#else
+            return {};
+#endif
+        }
+
+        /**
+         * Set every counter back to zero.
+         */
+        virtual void resetStats() {
+
+#ifdef HAL_STATS
+            m_stats.reset();
+#endif
+        }
+
         /**
          * Determine if the UART has been initialised
          *
@@ -172,6 +225,161 @@ namespace hal::interfaces {
          */
         virtual void setHWFlow(bool cts, bool rts)=0;
 
+        /**
+         * Enable or disable the buffered mode.
+         * In buffered mode the FIFOs are emptied and filled from the UART interrupt into ring buffers of
+         * @ref hal::peripherals::UART_RX_BUFFER_SIZE "UART_RX_BUFFER_SIZE" and
+         * @ref hal::peripherals::UART_TX_BUFFER_SIZE "UART_TX_BUFFER_SIZE" bytes,
+         * so the CPU does not have to wait on the FIFOs.
+         *
+         * @param buffered true to enable the buffered mode, false to disable it
+         * @return whether an error occurred
+         */
+        virtual bool setBuffered(const bool buffered) {
+
+            m_last_error = buffered ? Error::NOTAVAILABLEONPLATFORM : Error::NONE;
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Determine if the UART is in buffered mode.
+         *
+         * @return true if the buffered mode is enabled, false otherwise
+         */
+        [[nodiscard]] virtual bool isBuffered() const {
+
+            return false;
+        }
+
+        /**
+         * Read as many bytes as available, up to length, without blocking.
+         *
+         * @param buffer array of data to read
+         * @param length length of the array
+         * @param count number of bytes read
+         * @return Error::AGAIN if no byte was available, Error::NONE otherwise
+         */
+        virtual enum Error tryRead(uint8_t * const buffer, const size_t length, size_t &count) {
+
+            count = 0;
+
+            while(count < length and isReadable()) {
+
+                buffer[count++] = read();
+            }
+
+            m_last_error = (count == 0 and length != 0) ? Error::AGAIN : Error::NONE;
+
+            return m_last_error;
+        }
+
+        /**
+         * Send as many bytes as possible, up to length, without blocking.
+         *
+         * @param buffer array of data to send
+         * @param length length of the array
+         * @param count number of bytes sent
+         * @return Error::AGAIN if no byte could be sent, Error::ERROR if the wire failed, Error::NONE otherwise
+         */
+        virtual enum Error tryWrite(const uint8_t * const buffer, const size_t length, size_t &count) {
+
+            count = 0;
+
+            while(count < length and isWritable()) {
+
+                write(buffer[count++]);
+            }
+
+            m_last_error = (count == 0 and length != 0) ? Error::AGAIN : Error::NONE;
+
+            return m_last_error;
+        }
+
+        /**
+         * Start sending the data in buffer and return straight away.
+         * At most one write is running at a time, next to at most one read.
+         *
+         * @note The buffer must stay valid until the transfer completes.
+         *
+         * @param buffer data to send
+         * @param callback function called when the transfer completes, nullptr to poll isWriteBusy()
+         * @param context pointer given back to the callback
+         * @return whether an error occurred, Error::AGAIN if a write is already running
+         */
+        virtual bool writeAsync(const std::span<const uint8_t> buffer, const peripherals::uart::TransferCallback callback=nullptr, void * const context=nullptr) {
+
+            (void)buffer;
+            (void)callback;
+            (void)context;
+
+            m_last_error = Error::NOTAVAILABLEONPLATFORM;
+
+            return true;
+        }
+
+        /**
+         * Start receiving length bytes into buffer and return straight away.
+         * At most one read is running at a time, next to at most one write.
+         *
+         * @note The buffer must stay valid until the transfer completes.
+         *
+         * @param buffer array receiving the data, the transfer completes when it is full
+         * @param callback function called when the transfer completes, nullptr to poll isReadBusy()
+         * @param context pointer given back to the callback
+         * @return whether an error occurred, Error::AGAIN if a read is already running
+         */
+        virtual bool readAsync(const std::span<uint8_t> buffer, const peripherals::uart::TransferCallback callback=nullptr, void * const context=nullptr) {
+
+            (void)buffer;
+            (void)callback;
+            (void)context;
+
+            m_last_error = Error::NOTAVAILABLEONPLATFORM;
+
+            return true;
+        }
+
+        /**
+         * Determine if a write started by writeAsync() is running.
+         *
+         * @return true if it is running, false once it completed or was aborted
+         */
+        [[nodiscard]] virtual bool isWriteBusy() const {
+
+            return false;
+        }
+
+        /**
+         * Determine if a read started by readAsync() is running.
+         *
+         * @return true if it is running, false once it completed or was aborted
+         */
+        [[nodiscard]] virtual bool isReadBusy() const {
+
+            return false;
+        }
+
+        /**
+         * Stop the write started by writeAsync(), its callback is not called.
+         *
+         * @return number of bytes sent
+         */
+        virtual size_t abortWrite() {
+
+            return 0;
+        }
+
+        /**
+         * Stop the read started by readAsync(), its callback is not called.
+         *
+         * @return number of bytes received
+         */
+        virtual size_t abortRead() {
+
+            return 0;
+        }
+
         // InterfaceUART &getInstance(const uint8_t instance) override =0;
 
     protected:
@@ -189,6 +397,10 @@ namespace hal::interfaces {
         peripherals::UARTInstance m_instance;
         enum Error m_last_error;
 
+#ifdef HAL_STATS
+        stats::UARTCounters m_stats;    ///< Updated by the implementations with HAL_STATS_ADD()
+#endif
+
     private:
 
     };
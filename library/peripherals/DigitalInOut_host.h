@@ -0,0 +1,182 @@
+//
+// Created by marmelade on 17/10/22.
+//
+
+#ifndef EMBEDDEDLIBRARY_DIGITALINOUT_HOST_H
+#define EMBEDDEDLIBRARY_DIGITALINOUT_HOST_H
+
+#include "../commons/commons.h"
+#include "../interfaces/InterfaceDigitalGPIO.h"
+#include "../trace/Trace.h"
+
+#include "GpioIRQ.h"
+
+namespace hal::peripherals::gpio {
+
+    /**
+     * Host implementation of a digital GPIO pin backed by the in-memory @ref hal::host::PinBank "PinBank".
+     */
+    class DigitalInOut : public hal::interfaces::InterfaceDigitalGPIO {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit DigitalInOut(uint gpio_pin) : hal::interfaces::InterfaceDigitalGPIO(gpio_pin, Direction::OUT) {
+
+            // Do not call a virtual member function in constructor or destructor unless it is implemented in the class
+            init();
+        }
+
+        DigitalInOut(DigitalInOut &&other) noexcept : hal::interfaces::InterfaceDigitalGPIO(std::move(other)) {}
+
+        ~DigitalInOut() override {
+
+            // Do not call a virtual member function in constructor or destructor unless it is implemented in the class
+            deinit();
+        };
+
+        //****************************************************************
+        //                           Operators
+        //****************************************************************
+
+        DigitalInOut &operator=(DigitalInOut &&other) noexcept {
+
+            if(this != &other) {
+
+                deinit();
+                hal::interfaces::InterfaceDigitalGPIO::operator=(std::move(other));
+            }
+
+            return *this;
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        void init() override {
+
+            if( !inited() ) {
+                host::PinBank::getInstance().init(m_gpio_pin);
+                host::PinBank::getInstance().setDirection(m_gpio_pin, m_gpio_dir == Direction::OUT);
+
+                m_gpio_func = Function::GPIO;
+            }
+        }
+
+        void deinit() override {
+
+            if( inited() ) {
+                if(m_gpio_irq != IRQ::NONE) {
+                    setIRQ(IRQ::NONE);
+                }
+
+                host::PinBank::getInstance().deinit(m_gpio_pin);
+
+                m_gpio_func = Function::NONE;
+            }
+        }
+
+        uint8_t read() override {
+
+            return host::PinBank::getInstance().get(m_gpio_pin);
+        }
+
+        void write(const uint8_t value) override {
+
+            HAL_TRACE_SCOPE("gpio.write");
+            HAL_STATS_ADD(m_stats.writes, 1);
+
+            host::PinBank::getInstance().put(m_gpio_pin, value);
+        }
+
+        void toggle() override {
+
+            HAL_STATS_ADD(m_stats.toggles, 1);
+
+            host::PinBank::getInstance().toggleMasked(1U << m_gpio_pin);
+        }
+
+        bool setDirection(const enum Direction gpio_dir) override {
+
+            m_gpio_dir = gpio_dir;
+            host::PinBank::getInstance().setDirection(m_gpio_pin, gpio_dir == Direction::OUT);
+
+            return false;
+        }
+
+        bool setPull(const enum Pull gpio_pull) override {
+
+            m_last_error = Error::NONE;
+
+            if(gpio_pull == Pull::OPEN_DRAIN) {
+
+                m_last_error = Error::NOTAVAILABLEONPLATFORM;
+            } else {
+
+                m_gpio_pull = gpio_pull;
+                host::PinBank::getInstance().setPulls(m_gpio_pin,
+                                                    gpio_pull == Pull::UP,
+                                                    gpio_pull == Pull::DOWN);
+            }
+
+            return m_last_error == Error::NONE;
+        }
+
+        bool setFunction(const enum Function gpio_func) override {
+
+            m_last_error = Error::NONE;
+
+            m_gpio_func = gpio_func;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool setIRQ(const enum IRQ gpio_irq, const IRQCallback callback=nullptr, void * const context=nullptr) override {
+
+            auto &dispatcher{IRQDispatcher::getInstance()};
+
+            m_last_error = Error::NONE;
+
+            if(gpio_irq == IRQ::NONE ? dispatcher.detach(m_gpio_pin) : dispatcher.attach(m_gpio_pin, gpio_irq, callback, context)) {
+
+                m_last_error = dispatcher.getLastError();
+            } else {
+
+                m_gpio_irq = gpio_irq;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Add the interrupt counters of the pin, kept by the @ref IRQDispatcher "IRQDispatcher".
+         */
+        [[nodiscard]] stats::GPIOStats getStats() const override {
+
+            const stats::GPIOStats own{InterfaceDigitalGPIO::getStats()};
+            stats::GPIOStats snapshot{IRQDispatcher::getInstance().getStats(m_gpio_pin)};
+
+            snapshot.writes = own.writes;
+            snapshot.toggles = own.toggles;
+
+            return snapshot;
+        }
+
+        void resetStats() override {
+
+            InterfaceDigitalGPIO::resetStats();
+            IRQDispatcher::getInstance().resetStats(m_gpio_pin);
+        }
+
+    protected:
+
+    private:
+
+    };
+
+} // hal::peripherals
+
+#endif //EMBEDDEDLIBRARY_DIGITALINOUT_HOST_H
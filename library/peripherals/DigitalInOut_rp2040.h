@@ -7,6 +7,9 @@
 
 #include "../commons/commons.h"
 #include "../interfaces/InterfaceDigitalGPIO.h"
+#include "../trace/Trace.h"
+
+#include "GpioIRQ.h"
 
 #include <hardware/gpio.h>
 
@@ -77,6 +80,10 @@ namespace hal::peripherals::gpio {
         void deinit() override {
 
             if( inited() ) {
+                if(m_gpio_irq != IRQ::NONE) {
+                    setIRQ(IRQ::NONE);
+                }
+
                 gpio_deinit(m_gpio_pin);
 
                 m_gpio_func = Function::NONE;
@@ -89,7 +96,21 @@ namespace hal::peripherals::gpio {
         }
 
         void write(const uint8_t value) override {
-            return gpio_put(m_gpio_pin, value);
+
+            HAL_TRACE_SCOPE("gpio.write");
+            HAL_STATS_ADD(m_stats.writes, 1);
+
+            gpio_put(m_gpio_pin, value);
+        }
+
+        /**
+         * Toggle through the XOR alias of the SIO, counted as a toggle only.
+         */
+        void toggle() override {
+
+            HAL_STATS_ADD(m_stats.toggles, 1);
+
+            gpio_xor_mask(1U << m_gpio_pin);
         }
 
         bool setDirection(const enum Direction gpio_dir) override {
@@ -150,6 +171,43 @@ namespace hal::peripherals::gpio {
             return m_last_error != Error::NONE;
         }
 
+        bool setIRQ(const enum IRQ gpio_irq, const IRQCallback callback=nullptr, void * const context=nullptr) override {
+
+            auto &dispatcher{IRQDispatcher::getInstance()};
+
+            m_last_error = Error::NONE;
+
+            if(gpio_irq == IRQ::NONE ? dispatcher.detach(m_gpio_pin) : dispatcher.attach(m_gpio_pin, gpio_irq, callback, context)) {
+
+                m_last_error = dispatcher.getLastError();
+            } else {
+
+                m_gpio_irq = gpio_irq;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Add the interrupt counters of the pin, kept by the @ref IRQDispatcher "IRQDispatcher".
+         */
+        [[nodiscard]] stats::GPIOStats getStats() const override {
+
+            const stats::GPIOStats own{InterfaceDigitalGPIO::getStats()};
+            stats::GPIOStats snapshot{IRQDispatcher::getInstance().getStats(m_gpio_pin)};
+
+            snapshot.writes = own.writes;
+            snapshot.toggles = own.toggles;
+
+            return snapshot;
+        }
+
+        void resetStats() override {
+
+            InterfaceDigitalGPIO::resetStats();
+            IRQDispatcher::getInstance().resetStats(m_gpio_pin);
+        }
+
     protected:
 
     private:
@@ -0,0 +1,305 @@
+/**
+ * @file GpioIRQ.h
+ * @brief Provide the dispatch of the GPIO interrupts
+ *
+ * The GPIO interrupt is shared by every pin. The @ref hal::peripherals::gpio::IRQDispatcher "IRQDispatcher"
+ * looks the pin up in a table and either:
+ * - calls the callback attached to the pin, straight from the interrupt, or
+ * - pushes a timestamped @ref hal::peripherals::gpio::Event "Event" into a lock-free queue, to be processed
+ *   later by the main loop. Events that do not fit in the queue are counted as dropped.
+ *
+ * There is no heap and no std::function: a callback is a function pointer and a context pointer.
+ *
+ * @code{cpp}
+ * using namespace hal::peripherals::gpio;
+ * auto &dispatcher{IRQDispatcher::getInstance()};
+ *
+ * dispatcher.attach(hal::GPIO2, IRQ::EDGE_RISE); // Queued
+ *
+ * Event event;
+ * while(dispatcher.popEvent(event)) {
+ *     handle(event.gpio_pin, event.timestamp);
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_GPIOIRQ_H
+#define EMBEDDEDLIBRARY_GPIOIRQ_H
+
+#include <atomic>
+
+#include "../clock/Clock.h"
+#include "../commons/commons.h"
+#include "../data_structures/SpscRing.h"
+#include "../stats/Stats.h"
+#include "../trace/Trace.h"
+#include "../traits/Singleton.h"
+
+#ifdef HAL_RP2040
+#include "GpioIRQ_rp2040.h"
+#elif defined(HAL_HOST)
+#include "GpioIRQ_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::peripherals::gpio {
+
+    /**
+     * GPIO interrupt recorded by the dispatcher.
+     */
+    struct Event {
+
+        uint64_t timestamp;     ///< Time of the interrupt in microseconds
+        uint8_t gpio_pin;       ///< Pin that raised the interrupt
+        enum IRQ gpio_irq;      ///< Condition that raised the interrupt
+    };
+
+    /**
+     * Dispatch the GPIO interrupts to per-pin callbacks or to an event queue.
+     */
+    class IRQDispatcher : public traits::Singleton {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~IRQDispatcher() override =default;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Enable the interrupt of a pin.
+         * With a callback the interrupt calls it directly, without one the events are queued.
+         *
+         * @param gpio_pin pin to attach
+         * @param gpio_irq condition on which the interrupt is raised
+         * @param callback function called from the interrupt, nullptr to queue the events
+         * @param context pointer given back to the callback
+         * @return whether an error occurred
+         */
+        bool attach(const uint gpio_pin, const enum IRQ gpio_irq, const IRQCallback callback=nullptr, void * const context=nullptr) {
+
+            m_last_error = Error::NONE;
+
+            if(gpio_pin >= NUMBER_GPIO_PIN or gpio_irq == IRQ::NONE) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            // The slot must not change while its interrupt is enabled
+            detach(gpio_pin);
+
+            m_slots[gpio_pin] = {callback, context, gpio_irq};
+            detail::IRQIO::enable(gpio_pin, toEvents(gpio_irq), true, handleIRQ);
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Disable the interrupt of a pin.
+         *
+         * @param gpio_pin pin to detach
+         * @return whether an error occurred
+         */
+        bool detach(const uint gpio_pin) {
+
+            m_last_error = Error::NONE;
+
+            if(gpio_pin >= NUMBER_GPIO_PIN) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(m_slots[gpio_pin].gpio_irq != IRQ::NONE) {
+
+                detail::IRQIO::enable(gpio_pin, toEvents(m_slots[gpio_pin].gpio_irq), false, handleIRQ);
+                m_slots[gpio_pin] = {nullptr, nullptr, IRQ::NONE};
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Get the condition on which the interrupt of a pin is raised.
+         *
+         * @param gpio_pin pin to check
+         * @return condition, IRQ::NONE if the pin is not attached
+         */
+        [[nodiscard]] enum IRQ getIRQ(const uint gpio_pin) const {
+
+            return gpio_pin < NUMBER_GPIO_PIN ? m_slots[gpio_pin].gpio_irq : IRQ::NONE;
+        }
+
+        /**
+         * Pop the oldest queued event.
+         *
+         * @note Must only be called from one context (e.g. the main loop).
+         *
+         * @param event event popped
+         * @return false if there is no event
+         */
+        bool popEvent(Event &event) {
+
+            if(!m_events.pop(event)) {
+                return false;
+            }
+
+            HAL_STATS_RAISE(m_stats[event.gpio_pin].max_latency, clock::now_us() - event.timestamp);
+
+            return true;
+        }
+
+        /**
+         * @return number of queued events
+         */
+        [[nodiscard]] size_t getPendingEvents() const {
+
+            return m_events.size();
+        }
+
+        /**
+         * @return number of events dropped because the queue was full
+         */
+        [[nodiscard]] uint32_t getDroppedEvents() const {
+
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        void resetDroppedEvents() {
+
+            m_dropped.store(0, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+        /**
+         * Get the interrupt counters of a pin, see Stats.h.
+         *
+         * @param gpio_pin pin to check
+         * @return interrupts dispatched and longest wait of a queued event, the other fields are zeros,
+         * all zeros unless HAL_STATS is defined
+         */
+        [[nodiscard]] stats::GPIOStats getStats(const uint gpio_pin) const {
+
+#ifdef HAL_STATS
+            if(gpio_pin < NUMBER_GPIO_PIN) {
+                return {0, 0, m_stats[gpio_pin].irqs.get(), m_stats[gpio_pin].max_latency.get()};
+            }
+#else
+            (void)gpio_pin;
+#endif
+
+            return {};
+        }
+
+        /**
+         * Set the interrupt counters of a pin back to zero.
+         *
+         * @param gpio_pin pin to reset
+         */
+        void resetStats(const uint gpio_pin) {
+
+#ifdef HAL_STATS
+            if(gpio_pin < NUMBER_GPIO_PIN) {
+                m_stats[gpio_pin].reset();
+            }
+#else
+            (void)gpio_pin;
+#endif
+        }
+
+        /**
+         * Dispatch the interrupt of a pin.
+         *
+         * @note Called from the GPIO interrupt.
+         *
+         * @param gpio_pin pin that raised the interrupt
+         * @param events events that happened, as reported by the platform
+         */
+        void dispatch(const uint gpio_pin, const uint32_t events) {
+
+            const Slot &slot{m_slots[gpio_pin]};
+
+            if(slot.gpio_irq == IRQ::NONE or (events & toEvents(slot.gpio_irq)) == 0) {
+
+                return;
+            }
+
+            HAL_STATS_ADD(m_stats[gpio_pin].irqs, 1);
+
+            if(slot.callback != nullptr) {
+
+                slot.callback(gpio_pin, slot.gpio_irq, slot.context);
+            } else if(!m_events.push({clock::now_us(), static_cast<uint8_t>(gpio_pin), slot.gpio_irq})) {
+
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        static IRQDispatcher &getInstance() {
+
+            static IRQDispatcher s_dispatcher{};
+            return s_dispatcher;
+        }
+
+        /**
+         * Convert an interrupt condition into the platform event bit.
+         *
+         * @param gpio_irq condition
+         * @return event bit, 0 for IRQ::NONE
+         */
+        static constexpr uint32_t toEvents(const enum IRQ gpio_irq) {
+
+            // LEVEL_LOW, LEVEL_HIGH, EDGE_FALL and EDGE_RISE follow the bit order of the RP2040 registers
+            return gpio_irq == IRQ::NONE ? 0U : 1U << (static_cast<uint>(gpio_irq) - 1U);
+        }
+
+    protected:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        IRQDispatcher() : m_slots{}, m_events{}, m_dropped{0}, m_last_error{Error::NONE} {}
+
+        /**
+         * Entry of an attached pin.
+         */
+        struct Slot {
+
+            IRQCallback callback;   ///< Called from the interrupt, nullptr to queue the events
+            void *context;          ///< Given back to the callback
+            enum IRQ gpio_irq;      ///< Condition attached, IRQ::NONE if the pin is not attached
+        };
+
+        static void handleIRQ(const uint gpio_pin, const uint32_t events) {
+
+            HAL_TRACE_SCOPE("gpio.irq");
+
+            getInstance().dispatch(gpio_pin, events);
+        }
+
+        Slot m_slots[NUMBER_GPIO_PIN];  ///< Dispatch table indexed by pin
+
+        data_structures::SpscRing<Event, GPIO_EVENT_QUEUE_SIZE> m_events;  ///< Filled by the interrupt, emptied by popEvent()
+        std::atomic<uint32_t> m_dropped;    ///< Events dropped because the queue was full
+
+#ifdef HAL_STATS
+        stats::IRQCounters m_stats[NUMBER_GPIO_PIN];    ///< Interrupt counters indexed by pin
+#endif
+
+        enum Error m_last_error;
+    };
+
+} // namespace hal::peripherals::gpio
+
+#endif //EMBEDDEDLIBRARY_GPIOIRQ_H
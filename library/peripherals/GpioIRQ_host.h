@@ -0,0 +1,34 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_GPIOIRQ_HOST_H
+#define EMBEDDEDLIBRARY_GPIOIRQ_HOST_H
+
+#include "../commons/commons.h"
+
+namespace hal::peripherals::gpio::detail {
+
+    /**
+     * Access to the simulated GPIO interrupts of the in-memory @ref hal::host::PinBank "PinBank".
+     */
+    struct IRQIO {
+
+        /**
+         * Enable or disable interrupt events of a pin and route them to callback.
+         *
+         * @param gpio_pin pin to configure
+         * @param events events to change (1: level low, 2: level high, 4: edge fall, 8: edge rise)
+         * @param enabled whether to enable or disable the events
+         * @param callback function called from the simulated interrupt
+         */
+        static void enable(const uint gpio_pin, const uint32_t events, const bool enabled, void (* const callback)(uint, uint32_t)) {
+
+            host::PinBank::getInstance().setIRQCallback(callback);
+            host::PinBank::getInstance().setIRQEnabled(gpio_pin, events, enabled);
+        }
+    };
+
+} // namespace hal::peripherals::gpio::detail
+
+#endif //EMBEDDEDLIBRARY_GPIOIRQ_HOST_H
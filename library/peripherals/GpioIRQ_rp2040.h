@@ -0,0 +1,35 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_GPIOIRQ_RP2040_H
+#define EMBEDDEDLIBRARY_GPIOIRQ_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/gpio.h>
+
+namespace hal::peripherals::gpio::detail {
+
+    /**
+     * Access to the GPIO interrupts of the IO bank.
+     */
+    struct IRQIO {
+
+        /**
+         * Enable or disable interrupt events of a pin and route them to callback.
+         *
+         * @param gpio_pin pin to configure
+         * @param events events to change (GPIO_IRQ_LEVEL_LOW, GPIO_IRQ_LEVEL_HIGH, GPIO_IRQ_EDGE_FALL, GPIO_IRQ_EDGE_RISE)
+         * @param enabled whether to enable or disable the events
+         * @param callback function called from the interrupt, shared by every pin of the core
+         */
+        static void enable(const uint gpio_pin, const uint32_t events, const bool enabled, void (* const callback)(uint, uint32_t)) {
+
+            gpio_set_irq_enabled_with_callback(gpio_pin, events, enabled, callback);
+        }
+    };
+
+} // namespace hal::peripherals::gpio::detail
+
+#endif //EMBEDDEDLIBRARY_GPIOIRQ_RP2040_H
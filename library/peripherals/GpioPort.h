@@ -0,0 +1,345 @@
+/**
+ * @file GpioPort.h
+ * @brief Provide parallel access to a group of GPIO pins
+ *
+ * A value is mapped onto a set of pins, bit i of the value driving the i-th pin, and written with a
+ * single masked set/clear so every pin changes at once (no glitchy intermediate states on a parallel bus).
+ * Reading returns the levels of the pins packed the same way.
+ *
+ * - @ref hal::peripherals::gpio::GpioPort "GpioPort" takes its pins as template parameters, the masks are
+ *   computed at compile time and a contiguous, ascending group of pins packs with a single shift.
+ * - @ref hal::peripherals::gpio::GpioBus "GpioBus" takes its pins at run time.
+ *
+ * @code{cpp}
+ * using namespace hal;
+ * peripherals::gpio::GpioPort<GPIO8, GPIO9, GPIO10, GPIO11, GPIO12, GPIO13, GPIO14, GPIO15> lcd_data{};
+ *
+ * lcd_data.write(0xA5); // gpio_put_masked(0xFF00, 0xA500)
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_GPIOPORT_H
+#define EMBEDDEDLIBRARY_GPIOPORT_H
+
+#include <bit>
+
+#include "../commons/commons.h"
+
+#ifdef HAL_RP2040
+#include "GpioPort_rp2040.h"
+#elif defined(HAL_HOST)
+#include "GpioPort_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::peripherals::gpio {
+
+    /**
+     * Group of GPIO pins known at compile time.
+     *
+     * @tparam Pins pins of the port, the first one holds bit 0 of the value
+     */
+    template<hal::pin... Pins>
+    requires (sizeof...(Pins) > 0 and sizeof...(Pins) <= 32 and ((Pins < NUMBER_GPIO_PIN) and ...)
+              and std::popcount(((1U << Pins) | ...)) == sizeof...(Pins))
+    class GpioPort {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * Claim the pins of the port and set their direction.
+         *
+         * @param dir direction of every pin of the port
+         */
+        explicit GpioPort(const enum Direction dir = Direction::OUT) {
+
+            detail::PortIO::init(MASK);
+            setDirection(dir);
+        }
+
+        ~GpioPort() {
+
+            detail::PortIO::deinit(MASK);
+        }
+
+        GpioPort(const GpioPort &)=delete;
+        GpioPort &operator=(const GpioPort &)=delete;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Write a value on the port, every pin is updated at once.
+         *
+         * @param value value to write, bit i drives the i-th pin
+         */
+        static void write(const uint32_t value) {
+
+            detail::PortIO::putMasked(MASK, pack(value));
+        }
+
+        /**
+         * Read the levels of the pins of the port.
+         *
+         * @return levels of the pins, bit i holds the level of the i-th pin
+         */
+        static uint32_t read() {
+
+            return unpack(detail::PortIO::getAll());
+        }
+
+        static void setDirection(const enum Direction dir) {
+
+            detail::PortIO::setDirection(MASK, dir == Direction::OUT);
+        }
+
+        /**
+         * Map a value onto the pins of the port.
+         *
+         * @param value value to map, bit i goes to the i-th pin
+         * @return one bit per GPIO, as expected by the GPIO registers
+         */
+        static constexpr uint32_t pack(const uint32_t value) {
+
+            if constexpr (CONTIGUOUS) {
+
+                return (value << FIRST) & MASK;
+            } else {
+
+                uint32_t word{0};
+                uint i{0};
+
+                ((check_bit(value, i++) ? set_bits_pos(word, Pins, 1U) : void()), ...);
+
+                return word;
+            }
+        }
+
+        /**
+         * Gather the levels of the pins of the port into a value.
+         *
+         * @param levels one bit per GPIO, as read from the GPIO registers
+         * @return value, bit i holds the level of the i-th pin
+         */
+        static constexpr uint32_t unpack(const uint32_t levels) {
+
+            if constexpr (CONTIGUOUS) {
+
+                return (levels & MASK) >> FIRST;
+            } else {
+
+                uint32_t value{0};
+                uint i{0};
+
+                ((check_bit(levels, Pins) ? set_bit(value, i) : void(), i++), ...);
+
+                return value;
+            }
+        }
+
+        static constexpr size_t WIDTH{sizeof...(Pins)};     ///< Number of pins of the port
+        static constexpr uint32_t MASK{((1U << Pins) | ...)};  ///< Pins of the port in the GPIO registers
+
+    private:
+
+        static constexpr uint FIRST{[]() { constexpr uint pins[]{Pins...}; return pins[0]; }()};
+
+        /// Whether the pins are contiguous and ascending, so packing is a shift
+        static constexpr bool CONTIGUOUS{[]() {
+
+            constexpr uint pins[]{Pins...};
+
+            for(uint i{0}; i < WIDTH; i++) {
+
+                if(pins[i] != pins[0] + i) {
+                    return false;
+                }
+            }
+
+            return true;
+        }()};
+    };
+
+    /**
+     * Group of GPIO pins known at run time.
+     */
+    class GpioBus : traits::NonCopyable<GpioBus> {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * Claim the pins of the bus and set their direction.
+         *
+         * @note If a pin is invalid or used twice, or if there are more than 32 pins, no pin is claimed
+         * and @ref GpioBus::getLastError() "getLastError()" reports the error.
+         *
+         * @param pins pins of the bus, the first one holds bit 0 of the value
+         * @param count number of pins
+         * @param dir direction of every pin of the bus
+         */
+        GpioBus(const uint * const pins, const size_t count, const enum Direction dir = Direction::OUT) :
+                m_pins{},
+                m_width{0},
+                m_mask{0},
+                m_first{0},
+                m_contiguous{true},
+                m_last_error{Error::NONE}
+        {
+            if(count > sizeof_array(m_pins)) {
+
+                m_last_error = Error::TOOBIG;
+                return;
+            }
+
+            for(size_t i{0}; i < count; i++) {
+
+                if(pins[i] >= NUMBER_GPIO_PIN or check_bit(m_mask, pins[i])) {
+
+                    m_mask = 0;
+                    m_last_error = Error::ERROR;
+                    return;
+                }
+
+                m_pins[i] = static_cast<uint8_t>(pins[i]);
+                m_contiguous = m_contiguous and pins[i] == pins[0] + i;
+                set_bit(m_mask, pins[i]);
+            }
+
+            m_width = count;
+            m_first = count > 0 ? pins[0] : 0;
+
+            detail::PortIO::init(m_mask);
+            setDirection(dir);
+        }
+
+        /**
+         * Claim the pins of the bus and set their direction.
+         *
+         * @tparam N number of pins
+         * @param pins pins of the bus, the first one holds bit 0 of the value
+         * @param dir direction of every pin of the bus
+         */
+        template<size_t N>
+        explicit GpioBus(const uint (&pins)[N], const enum Direction dir = Direction::OUT) : GpioBus(pins, N, dir) {}
+
+        ~GpioBus() override {
+
+            detail::PortIO::deinit(m_mask);
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Write a value on the bus, every pin is updated at once.
+         *
+         * @param value value to write, bit i drives the i-th pin
+         */
+        void write(const uint32_t value) const {
+
+            detail::PortIO::putMasked(m_mask, pack(value));
+        }
+
+        /**
+         * Read the levels of the pins of the bus.
+         *
+         * @return levels of the pins, bit i holds the level of the i-th pin
+         */
+        [[nodiscard]] uint32_t read() const {
+
+            return unpack(detail::PortIO::getAll());
+        }
+
+        void setDirection(const enum Direction dir) const {
+
+            detail::PortIO::setDirection(m_mask, dir == Direction::OUT);
+        }
+
+        /**
+         * Map a value onto the pins of the bus.
+         *
+         * @param value value to map, bit i goes to the i-th pin
+         * @return one bit per GPIO, as expected by the GPIO registers
+         */
+        [[nodiscard]] uint32_t pack(const uint32_t value) const {
+
+            if(m_contiguous) {
+
+                return (value << m_first) & m_mask;
+            }
+
+            uint32_t word{0};
+
+            for(size_t i{0}; i < m_width; i++) {
+
+                if(check_bit(value, i)) {
+                    set_bits_pos(word, m_pins[i], 1U);
+                }
+            }
+
+            return word;
+        }
+
+        /**
+         * Gather the levels of the pins of the bus into a value.
+         *
+         * @param levels one bit per GPIO, as read from the GPIO registers
+         * @return value, bit i holds the level of the i-th pin
+         */
+        [[nodiscard]] uint32_t unpack(const uint32_t levels) const {
+
+            if(m_contiguous) {
+
+                return (levels & m_mask) >> m_first;
+            }
+
+            uint32_t value{0};
+
+            for(size_t i{0}; i < m_width; i++) {
+
+                if(check_bit(levels, m_pins[i])) {
+                    set_bit(value, i);
+                }
+            }
+
+            return value;
+        }
+
+        [[nodiscard]] size_t getWidth() const {
+
+            return m_width;
+        }
+
+        [[nodiscard]] uint32_t getMask() const {
+
+            return m_mask;
+        }
+
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+
+        uint8_t m_pins[32];     ///< Pins of the bus, the first one holds bit 0
+        size_t m_width;         ///< Number of pins
+        uint32_t m_mask;        ///< Pins of the bus in the GPIO registers
+        uint m_first;           ///< First pin, used when the pins are contiguous
+        bool m_contiguous;      ///< Whether the pins are contiguous and ascending, so packing is a shift
+
+        enum Error m_last_error;
+    };
+
+} // namespace hal::peripherals::gpio
+
+#endif //EMBEDDEDLIBRARY_GPIOPORT_H
@@ -0,0 +1,60 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_GPIOPORT_HOST_H
+#define EMBEDDEDLIBRARY_GPIOPORT_HOST_H
+
+#include "../commons/commons.h"
+
+namespace hal::peripherals::gpio::detail {
+
+    /**
+     * Access to every GPIO of the in-memory @ref hal::host::PinBank "PinBank" at once.
+     */
+    struct PortIO {
+
+        static void init(const uint32_t mask) {
+
+            for(uint gpio_pin{0}; gpio_pin < NUMBER_GPIO_PIN; gpio_pin++) {
+
+                if(check_bit(mask, gpio_pin)) {
+                    host::PinBank::getInstance().init(gpio_pin);
+                }
+            }
+        }
+
+        static void deinit(const uint32_t mask) {
+
+            for(uint gpio_pin{0}; gpio_pin < NUMBER_GPIO_PIN; gpio_pin++) {
+
+                if(check_bit(mask, gpio_pin)) {
+                    host::PinBank::getInstance().deinit(gpio_pin);
+                }
+            }
+        }
+
+        static void setDirection(const uint32_t mask, const bool out) {
+
+            for(uint gpio_pin{0}; gpio_pin < NUMBER_GPIO_PIN; gpio_pin++) {
+
+                if(check_bit(mask, gpio_pin)) {
+                    host::PinBank::getInstance().setDirection(gpio_pin, out);
+                }
+            }
+        }
+
+        static void putMasked(const uint32_t mask, const uint32_t value) {
+
+            host::PinBank::getInstance().putMasked(mask, value);
+        }
+
+        static uint32_t getAll() {
+
+            return host::PinBank::getInstance().getAll();
+        }
+    };
+
+} // namespace hal::peripherals::gpio::detail
+
+#endif //EMBEDDEDLIBRARY_GPIOPORT_HOST_H
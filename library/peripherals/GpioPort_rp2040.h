@@ -0,0 +1,52 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_GPIOPORT_RP2040_H
+#define EMBEDDEDLIBRARY_GPIOPORT_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/gpio.h>
+
+namespace hal::peripherals::gpio::detail {
+
+    /**
+     * Access to every GPIO of the SIO block at once.
+     */
+    struct PortIO {
+
+        static void init(const uint32_t mask) {
+
+            gpio_init_mask(mask);
+        }
+
+        static void deinit(const uint32_t mask) {
+
+            for(uint gpio_pin{0}; gpio_pin < NUMBER_GPIO_PIN; gpio_pin++) {
+
+                if(check_bit(mask, gpio_pin)) {
+                    gpio_deinit(gpio_pin);
+                }
+            }
+        }
+
+        static void setDirection(const uint32_t mask, const bool out) {
+
+            gpio_set_dir_masked(mask, out ? mask : 0U);
+        }
+
+        static void putMasked(const uint32_t mask, const uint32_t value) {
+
+            gpio_put_masked(mask, value);
+        }
+
+        static uint32_t getAll() {
+
+            return gpio_get_all();
+        }
+    };
+
+} // namespace hal::peripherals::gpio::detail
+
+#endif //EMBEDDEDLIBRARY_GPIOPORT_RP2040_H
@@ -0,0 +1,47 @@
+/**
+ * @file I2C.h
+ * @brief Provide the I2C master
+ *
+ * Besides the plain write() and read(), @ref hal::interfaces::InterfaceI2C::writeRead() "writeRead()" addresses a
+ * register and reads it with a repeated start, and @ref hal::interfaces::InterfaceI2C::transfer() "transfer()"
+ * executes a list of @ref hal::peripherals::i2c::Transaction "Transaction" back to back: polling many sensors costs
+ * one call, not one per byte.
+ *
+ * On RP2040 the transactions are driven by two DMA channels and the I2C interrupt,
+ * @ref hal::interfaces::InterfaceI2C::transferAsync() "transferAsync()" returns straight away.
+ * On host the bus is simulated in memory with @ref hal::host::I2CDevice "I2CDevice" instances.
+ *
+ * An instance can also be a slave with @ref hal::interfaces::InterfaceI2C::initSlave() "initSlave()": the interrupt
+ * serves a @ref hal::peripherals::i2c::RegisterMap "RegisterMap" straight from a buffer of the application and reports
+ * the registers the master wrote, the main loop does not copy anything.
+ *
+ * @code{cpp}
+ * auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+ * i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+ *
+ * const uint8_t reg{0x3B};
+ * uint8_t samples[12][6];
+ * hal::peripherals::i2c::Transaction transactions[12];
+ *
+ * for(size_t i{0}; i < 12; i++) {
+ *     transactions[i] = {static_cast<uint8_t>(0x40 + i), {&reg, 1}, samples[i]};
+ * }
+ *
+ * i2c.transferAsync(transactions, on_samples, nullptr);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_I2C_H
+#define EMBEDDEDLIBRARY_I2C_H
+
+#include "../interfaces/InterfaceI2C.h"
+
+#ifdef HAL_RP2040
+#include "I2C_rp2040.h"
+#elif defined(HAL_HOST)
+#include "I2C_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+#endif //EMBEDDEDLIBRARY_I2C_H
@@ -0,0 +1,518 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_I2C_HOST_H
+#define EMBEDDEDLIBRARY_I2C_HOST_H
+
+#include "../commons/commons.h"
+
+#include "I2C.h"
+#include "../trace/Trace.h"
+
+#include <mutex>
+
+namespace hal::host {
+
+    /**
+     * Device simulated on the bus of a host @ref hal::peripherals::i2c::I2C "I2C".
+     * The functions are called with the bus taken, in the order the master drives it.
+     */
+    class I2CDevice {
+    public:
+
+        virtual ~I2CDevice() =default;
+
+        /**
+         * The master sends bytes to the device.
+         *
+         * @param data bytes received
+         * @return whether the device acknowledges, false to NACK
+         */
+        virtual bool onWrite(std::span<const uint8_t> data)=0;
+
+        /**
+         * The master reads bytes from the device.
+         *
+         * @param data bytes to send, its size is the number of bytes the master reads
+         * @return whether the device acknowledges its address, false to NACK
+         */
+        virtual bool onRead(std::span<uint8_t> data)=0;
+
+        /**
+         * The master ends the transaction.
+         */
+        virtual void onStop() {}
+    };
+
+    /**
+     * Sensor-like device: the first byte written selects a register, the next bytes are written from it and the reads
+     * start from it. The register pointer auto-increments and wraps around.
+     *
+     * @code{cpp}
+     * hal::host::I2CRegisterDevice<16> sensor{};
+     * sensor.setRegister(0x0F, 0x68);     // WHO_AM_I
+     * i2c.attach(0x68, sensor);
+     * @endcode
+     *
+     * @tparam Size number of registers
+     */
+    template<size_t Size>
+    class I2CRegisterDevice : public I2CDevice {
+    public:
+
+        static_assert(Size > 0 and Size <= 256, "The registers are addressed by one byte");
+
+        bool onWrite(const std::span<const uint8_t> data) override {
+
+            if(data.empty()) {
+                return true;
+            }
+
+            if(data[0] >= Size) {
+                return false;
+            }
+
+            m_pointer = data[0];
+
+            for(const uint8_t byte : data.subspan(1)) {
+
+                m_registers[m_pointer] = byte;
+                m_pointer = (m_pointer + 1) % Size;
+            }
+
+            return true;
+        }
+
+        bool onRead(const std::span<uint8_t> data) override {
+
+            for(uint8_t &byte : data) {
+
+                byte = m_registers[m_pointer];
+                m_pointer = (m_pointer + 1) % Size;
+            }
+
+            m_reads++;
+
+            return true;
+        }
+
+        void setRegister(const size_t reg, const uint8_t value) {
+
+            m_registers[reg] = value;
+        }
+
+        [[nodiscard]] uint8_t getRegister(const size_t reg) const {
+
+            return m_registers[reg];
+        }
+
+        /**
+         * @return number of reads served, to check a device was polled
+         */
+        [[nodiscard]] size_t getReads() const {
+
+            return m_reads;
+        }
+
+    private:
+
+        uint8_t m_registers[Size]{};    ///< Content of the registers
+        size_t m_pointer{0};            ///< Register of the next access
+        size_t m_reads{0};              ///< Number of reads served
+    };
+
+} // namespace hal::host
+
+namespace hal::peripherals::i2c {
+
+    /**
+     * Host implementation of the I2C master.
+     *
+     * The bus is in memory: devices implementing @ref hal::host::I2CDevice "I2CDevice" are attached to addresses with
+     * @ref I2C::attach() "attach()", an address without a device does not acknowledge.
+     *
+     * @code{cpp}
+     * auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+     * hal::host::I2CRegisterDevice<16> sensor{};
+     *
+     * i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+     * i2c.attach(0x68, sensor);
+     * @endcode
+     *
+     * There is no DMA on the host, @ref I2C::transferAsync() "transferAsync()" executes the transactions and calls
+     * the callback before returning.
+     *
+     * An instance initialised with @ref I2C::initSlave() "initSlave()" is a device for another one: the master
+     * attaches @ref I2C::getSlaveDevice() "getSlaveDevice()" and drives the register map through the same handler
+     * the RP2040 interrupt uses.
+     *
+     * @code{cpp}
+     * auto &master{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+     * auto &slave{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE1)};
+     * uint8_t registers[32]{};
+     *
+     * slave.initSlave(0x42, hal::GPIO6, hal::GPIO7, registers);
+     * master.attach(0x42, slave.getSlaveDevice());
+     * @endcode
+     */
+    class I2C : public interfaces::InterfaceI2C {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~I2C() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        bool init(const uint sda_pin, const uint scl_pin, const uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            m_initialised = true;
+            m_mode = Mode::MODE_MASTER;
+            m_baudrate = baudrate;
+            setPins(sda_pin, scl_pin);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool initSlave(const uint8_t address, const uint sda_pin, const uint scl_pin, const std::span<uint8_t> registers,
+                       const RegisterCallback callback=nullptr, void * const context=nullptr) override {
+
+            m_last_error = checkSlave(address, registers);
+
+            if(m_last_error != Error::NONE) {
+                return true;
+            }
+
+            m_register_map.attach(registers, callback, context);
+            m_initialised = true;
+            m_mode = Mode::MODE_SLAVE;
+            setPins(sda_pin, scl_pin);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            m_last_error = Error::NONE;
+
+            m_initialised = false;
+            m_mode = Mode::MODE_MASTER;
+            m_current = nullptr;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool write(const uint8_t address, const std::span<const uint8_t> data, const bool nostop=false) override {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+            host::I2CDevice * const device{select(address, data.size())};
+
+            if(device != nullptr and !device->onWrite(data)) {
+                m_last_error = Error::ERROR;
+            }
+
+            release(device, nostop);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool read(const uint8_t address, const std::span<uint8_t> data, const bool nostop=false) override {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+            host::I2CDevice * const device{select(address, data.size())};
+
+            if(device != nullptr and !device->onRead(data)) {
+                m_last_error = Error::ERROR;
+            }
+
+            release(device, nostop);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool transfer(const std::span<Transaction> transactions) override {
+
+            HAL_TRACE_SCOPE("i2c.transfer");
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+
+            if(!isInitialised() or m_mode != Mode::MODE_MASTER) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            // Same checks as the DMA path of the RP2040
+            if(validate(transactions)) {
+                return true;
+            }
+
+            return InterfaceI2C::transfer(transactions);
+        }
+
+        /**
+         * Like on RP2040, the errors of the transactions are given to the callback: the call only fails, without
+         * calling it, if the list cannot start.
+         */
+        bool transferAsync(const std::span<Transaction> transactions, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised() or m_mode != Mode::MODE_MASTER) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(validate(transactions)) {
+                return true;
+            }
+
+            InterfaceI2C::transfer(transactions);
+
+            const enum Error error{m_last_error};
+            m_last_error = Error::NONE;
+
+            if(callback != nullptr) {
+                callback(error, transactions.size(), context);
+            }
+
+            return false;
+        }
+
+        using InterfaceI2C::setPins;
+
+        bool setPins(const uint sda_pin, const uint scl_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_sda_pin = sda_pin;
+            m_scl_pin = scl_pin;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? baudrate : m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        /**
+         * Put a simulated device on the bus.
+         *
+         * @param address 7 bits address the device answers to
+         * @param device device, must stay valid until it is detached
+         * @return whether an error occurred, Error::ERROR if the address is reserved or already used
+         */
+        bool attach(const uint8_t address, host::I2CDevice &device) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+
+            m_last_error = Error::NONE;
+
+            if(!isValidAddress(address) or m_devices[address] != nullptr) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            m_devices[address] = &device;
+
+            return false;
+        }
+
+        /**
+         * Remove a simulated device from the bus, the address stops acknowledging.
+         *
+         * @param address address of the device
+         */
+        void detach(const uint8_t address) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_bus_mutex};
+
+            if(address < sizeof_array(m_devices)) {
+                m_devices[address] = nullptr;
+            }
+        }
+
+        /**
+         * Device to attach to a master instance, it serves the register map of initSlave().
+         *
+         * @return device, it does not acknowledge while the instance is not a slave
+         */
+        host::I2CDevice &getSlaveDevice() {
+
+            return m_slave;
+        }
+
+        static I2C &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case I2C_INSTANCE0:
+                    static I2C s_i2c_instance0{static_cast<I2CInstance>(instance)};
+                    return s_i2c_instance0;
+
+                case I2C_INSTANCE1:
+                    static I2C s_i2c_instance1{static_cast<I2CInstance>(instance)};
+                    return s_i2c_instance1;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit I2C(const I2CInstance instance)
+        : InterfaceI2C(), m_initialised{false}, m_devices{}, m_current{nullptr}, m_slave{*this} {
+
+            m_instance = instance;
+        }
+
+        bool m_initialised;                 ///< Whether init() was called
+        host::I2CDevice *m_devices[128];    ///< Devices on the bus, indexed by address
+        host::I2CDevice *m_current;         ///< Device kept by a nostop access, nullptr when the bus is free
+
+        std::recursive_mutex m_bus_mutex;   ///< Taken for a whole transaction, the bus has a single master
+
+        /**
+         * Slave side of the instance, stands in for the interrupt handler of the RP2040.
+         */
+        class Slave : public host::I2CDevice {
+        public:
+
+            explicit Slave(I2C &owner) : m_owner{owner} {}
+
+            bool onWrite(const std::span<const uint8_t> data) override {
+
+                HAL_TRACE_SCOPE("i2c.slave_irq");
+
+                if(!m_owner.isSlave()) {
+                    return false;
+                }
+
+                for(size_t i{0}; i < data.size(); i++) {
+                    m_owner.m_register_map.receive(data[i], i == 0);
+                }
+
+                return true;
+            }
+
+            bool onRead(const std::span<uint8_t> data) override {
+
+                HAL_TRACE_SCOPE("i2c.slave_irq");
+
+                if(!m_owner.isSlave()) {
+                    return false;
+                }
+
+                // A read starts with a start or a restart, which ends a write
+                m_owner.m_register_map.stop();
+
+                for(uint8_t &byte : data) {
+                    byte = m_owner.m_register_map.transmit();
+                }
+
+                return true;
+            }
+
+            void onStop() override {
+
+                if(m_owner.isSlave()) {
+                    m_owner.m_register_map.stop();
+                }
+            }
+
+        private:
+
+            I2C &m_owner;   ///< Instance initialised as a slave
+        };
+
+        RegisterMap m_register_map;     ///< Registers served by the slave
+        Slave m_slave;                  ///< Attached to a master instance
+
+    private:
+
+        [[nodiscard]] bool isSlave() const {
+
+            return isInitialised() and m_mode == Mode::MODE_SLAVE;
+        }
+
+        /**
+         * Address a device, with a repeated start if the bus was kept.
+         *
+         * @return device acknowledging its address, nullptr on error
+         */
+        host::I2CDevice *select(const uint8_t address, const size_t length) {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised() or m_mode != Mode::MODE_MASTER or !isValidAddress(address)) {
+
+                m_last_error = Error::ERROR;
+                return nullptr;
+            }
+
+            // The RP2040 cannot send an address without a byte
+            if(length == 0) {
+
+                m_last_error = Error::TOOSMALL;
+                return nullptr;
+            }
+
+            // A repeated start to another device ends the previous transaction for it
+            if(m_current != nullptr and m_current != m_devices[address]) {
+
+                m_current->onStop();
+            }
+
+            m_current = nullptr;
+
+            if(m_devices[address] == nullptr) {
+
+                m_last_error = Error::ERROR;
+                return nullptr;
+            }
+
+            return m_devices[address];
+        }
+
+        void release(host::I2CDevice * const device, const bool nostop) {
+
+            if(device == nullptr) {
+                return;
+            }
+
+            if(nostop and m_last_error == Error::NONE) {
+
+                m_current = device;
+            } else {
+
+                device->onStop();
+            }
+        }
+    };
+
+} // namespace hal::peripherals::i2c
+
+#endif //EMBEDDEDLIBRARY_I2C_HOST_H
@@ -0,0 +1,539 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_I2C_RP2040_H
+#define EMBEDDEDLIBRARY_I2C_RP2040_H
+
+#include "../commons/commons.h"
+
+#include "I2C.h"
+#include "../trace/Trace.h"
+
+#include <atomic>
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+static inline i2c_inst_t *hal_to_rp2040_inst(hal::peripherals::I2CInstance instance) {
+
+    return instance == hal::peripherals::I2C_INSTANCE0 ? i2c0 : i2c1;
+}
+
+static inline uint hal_to_rp2040_irq(hal::peripherals::I2CInstance instance) {
+
+    return instance == hal::peripherals::I2C_INSTANCE0 ? I2C0_IRQ : I2C1_IRQ;
+}
+
+namespace hal::peripherals::i2c {
+
+    /**
+     * RP2040 implementation of the I2C master.
+     *
+     * write(), read() and writeRead() are blocking and use the SDK. The transaction lists are executed by DMA:
+     * the commands of a transaction (one 16 bits IC_DATA_CMD word per byte, with the RESTART and STOP bits) are
+     * pushed by a channel paced by the TX DREQ, the bytes read are pulled by a channel paced by the RX DREQ.
+     * The STOP_DET interrupt ends a transaction and starts the next one, the CPU is not involved in between.
+     *
+     * As a slave, the interrupt serves the register map one byte at a time: RX_FULL writes the bytes received in
+     * place, RD_REQ answers from the map and STOP_DET or RESTART_DET reports the registers written.
+     */
+    class I2C : public interfaces::InterfaceI2C {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~I2C() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        bool init(const uint sda_pin, const uint scl_pin, const uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            i2c_inst_t *i2c{hal_to_rp2040_inst(m_instance)};
+            const uint irq{hal_to_rp2040_irq(m_instance)};
+
+            m_baudrate = i2c_init(i2c, baudrate);
+            setPins(sda_pin, scl_pin);
+
+            // Only the transaction lists use the interrupt, it is masked in the controller otherwise
+            i2c_get_hw(i2c)->intr_mask = 0;
+            irq_set_exclusive_handler(irq, m_instance == I2C_INSTANCE0 ? irqHandler0 : irqHandler1);
+            irq_set_enabled(irq, true);
+
+            m_initialised = true;
+            m_mode = Mode::MODE_MASTER;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool initSlave(const uint8_t address, const uint sda_pin, const uint scl_pin, const std::span<uint8_t> registers,
+                       const RegisterCallback callback=nullptr, void * const context=nullptr) override {
+
+            m_last_error = checkSlave(address, registers);
+
+            if(m_last_error != Error::NONE) {
+                return true;
+            }
+
+            i2c_inst_t *i2c{hal_to_rp2040_inst(m_instance)};
+            const uint irq{hal_to_rp2040_irq(m_instance)};
+
+            m_register_map.attach(registers, callback, context);
+
+            m_baudrate = i2c_init(i2c, I2C_DEFAULT_BAUD_RATE);
+            i2c_set_slave_mode(i2c, true, address);
+            setPins(sda_pin, scl_pin);
+
+            // Interrupt on every byte received, every byte requested and the end of every transfer
+            i2c_get_hw(i2c)->intr_mask = I2C_IC_INTR_MASK_M_RX_FULL_BITS | I2C_IC_INTR_MASK_M_RD_REQ_BITS
+                                       | I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_RESTART_DET_BITS;
+            irq_set_exclusive_handler(irq, m_instance == I2C_INSTANCE0 ? irqHandler0 : irqHandler1);
+            irq_set_enabled(irq, true);
+
+            m_initialised = true;
+            m_mode = Mode::MODE_SLAVE;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            abort();
+
+            m_last_error = Error::NONE;
+
+            i2c_inst_t *i2c{hal_to_rp2040_inst(m_instance)};
+            const uint irq{hal_to_rp2040_irq(m_instance)};
+
+            i2c_get_hw(i2c)->intr_mask = 0;
+            irq_set_enabled(irq, false);
+            irq_remove_handler(irq, m_instance == I2C_INSTANCE0 ? irqHandler0 : irqHandler1);
+            i2c_deinit(i2c);
+
+            m_initialised = false;
+            m_mode = Mode::MODE_MASTER;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool write(const uint8_t address, const std::span<const uint8_t> data, const bool nostop=false) override {
+
+            m_last_error = checkAccess(address, data.size());
+
+            if(m_last_error == Error::NONE
+               and i2c_write_blocking(hal_to_rp2040_inst(m_instance), address, data.data(), data.size(), nostop) < 0) {
+
+                m_last_error = Error::ERROR;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool read(const uint8_t address, const std::span<uint8_t> data, const bool nostop=false) override {
+
+            m_last_error = checkAccess(address, data.size());
+
+            if(m_last_error == Error::NONE
+               and i2c_read_blocking(hal_to_rp2040_inst(m_instance), address, data.data(), data.size(), nostop) < 0) {
+
+                m_last_error = Error::ERROR;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * Execute the transactions by DMA and wait for the last one.
+         * Falls back to one writeRead() per transaction when no DMA channel is free.
+         */
+        bool transfer(const std::span<Transaction> transactions) override {
+
+            HAL_TRACE_SCOPE("i2c.transfer");
+
+            if(transferAsync(transactions)) {
+
+                if(m_last_error == Error::NOTAVAILABLEONPLATFORM) {
+                    return InterfaceI2C::transfer(transactions);
+                }
+
+                return true;
+            }
+
+            while(isBusy()) {
+                tight_loop_contents();
+            }
+
+            m_last_error = m_list.error;
+
+            return m_last_error != Error::NONE;
+        }
+
+        /**
+         * @return whether an error occurred, Error::NOTAVAILABLEONPLATFORM if no DMA channel is free
+         */
+        bool transferAsync(const std::span<Transaction> transactions, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised() or m_mode != Mode::MODE_MASTER) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(isBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(validate(transactions)) {
+                return true;
+            }
+
+            if(transactions.empty()) {
+
+                if(callback != nullptr) {
+                    callback(Error::NONE, 0, context);
+                }
+
+                return false;
+            }
+
+            const int tx_channel{dma_claim_unused_channel(false)};
+            const int rx_channel{tx_channel < 0 ? -1 : dma_claim_unused_channel(false)};
+
+            if(rx_channel < 0) {
+
+                if(tx_channel >= 0) {
+                    dma_channel_unclaim(static_cast<uint>(tx_channel));
+                }
+
+                m_last_error = Error::NOTAVAILABLEONPLATFORM;
+                return true;
+            }
+
+            m_list.transactions = transactions;
+            m_list.index = 0;
+            m_list.error = Error::NONE;
+            m_list.callback = callback;
+            m_list.context = context;
+            m_list.tx_channel = static_cast<uint>(tx_channel);
+            m_list.rx_channel = static_cast<uint>(rx_channel);
+            m_list.stop = false;
+            m_busy.store(true, std::memory_order_release);
+
+            i2c_get_hw(hal_to_rp2040_inst(m_instance))->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+            startTransaction();
+
+            return false;
+        }
+
+        [[nodiscard]] bool isBusy() const override {
+
+            return m_busy.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Wait for the running transaction, a few bytes on the bus, then stop the list.
+         */
+        size_t abort() override {
+
+            if(!isBusy()) {
+
+                return 0;
+            }
+
+            m_list.stop = true;
+
+            while(isBusy()) {
+                tight_loop_contents();
+            }
+
+            return m_list.index;
+        }
+
+        using InterfaceI2C::setPins;
+
+        bool setPins(const uint sda_pin, const uint scl_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_sda_pin = sda_pin;
+            m_scl_pin = scl_pin;
+
+            gpio_set_function(m_sda_pin, GPIO_FUNC_I2C);
+            gpio_set_function(m_scl_pin, GPIO_FUNC_I2C);
+            gpio_pull_up(m_sda_pin);
+            gpio_pull_up(m_scl_pin);
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? i2c_set_baudrate(hal_to_rp2040_inst(m_instance), baudrate) : m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        /**
+         * Complete the running transaction and start the next one.
+         *
+         * @note Called from the I2C interrupt.
+         */
+        void handleIRQ() {
+
+            if(m_mode == Mode::MODE_SLAVE) {
+
+                handleSlaveIRQ();
+                return;
+            }
+
+            HAL_TRACE_SCOPE("i2c.irq");
+
+            i2c_hw_t *hw{i2c_get_hw(hal_to_rp2040_inst(m_instance))};
+            const uint32_t status{hw->intr_stat};
+
+            // Not acknowledged: the controller flushes its TX FIFO and sends a stop, do not feed it more commands
+            if(status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+
+                m_list.nack = true;
+                dma_channel_abort(m_list.tx_channel);
+                static_cast<void>(hw->clr_tx_abrt);
+            }
+
+            if((status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) == 0) {
+
+                return;
+            }
+
+            static_cast<void>(hw->clr_stop_det);
+
+            Transaction &transaction{m_list.transactions[m_list.index]};
+
+            if(m_list.nack) {
+
+                dma_channel_abort(m_list.rx_channel);
+
+                while(hw->rxflr > 0) {
+                    static_cast<void>(hw->data_cmd);
+                }
+
+                transaction.error = Error::ERROR;
+            } else {
+
+                // The last byte read may still be on its way to memory
+                while(dma_channel_is_busy(m_list.rx_channel)) {
+                    tight_loop_contents();
+                }
+
+                transaction.error = Error::NONE;
+            }
+
+            if(m_list.error == Error::NONE) {
+                m_list.error = transaction.error;
+            }
+
+            m_list.index++;
+
+            if(m_list.index < m_list.transactions.size() and !m_list.stop) {
+
+                startTransaction();
+                return;
+            }
+
+            finish();
+        }
+
+        static I2C &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case I2C_INSTANCE0:
+                    static I2C s_i2c_instance0{static_cast<I2CInstance>(instance)};
+                    return s_i2c_instance0;
+
+                case I2C_INSTANCE1:
+                    static I2C s_i2c_instance1{static_cast<I2CInstance>(instance)};
+                    return s_i2c_instance1;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit I2C(const I2CInstance instance)
+        : InterfaceI2C(), m_initialised{false}, m_busy{false} {
+
+            m_instance = instance;
+        }
+
+        /**
+         * List of transactions executed by DMA.
+         */
+        struct List {
+
+            std::span<Transaction> transactions{};  ///< Transactions to execute
+            size_t index{0};                        ///< Running transaction
+            enum Error error{Error::NONE};          ///< Error of the first transaction that failed
+            TransferCallback callback{nullptr};     ///< Called from the interrupt once the list completes
+            void *context{nullptr};                 ///< Given back to the callback
+            uint tx_channel{0};                     ///< DMA channel pushing the commands
+            uint rx_channel{0};                     ///< DMA channel pulling the bytes read
+            volatile bool nack{false};              ///< Whether the running transaction was not acknowledged
+            volatile bool stop{false};              ///< Whether abort() asked to stop after the running transaction
+        };
+
+        bool m_initialised;             ///< Whether init() was called
+        std::atomic<bool> m_busy;       ///< Whether a list is running
+        List m_list;                    ///< List started by transferAsync()
+
+        uint16_t m_commands[I2C_MAX_TRANSFER]{};    ///< IC_DATA_CMD words of the running transaction
+
+        RegisterMap m_register_map;     ///< Registers served by the slave
+
+    private:
+
+        /**
+         * Check a blocking access, the SDK asserts on them.
+         */
+        [[nodiscard]] enum Error checkAccess(const uint8_t address, const size_t length) const {
+
+            if(!isInitialised() or m_mode != Mode::MODE_MASTER or !isValidAddress(address) or isBusy()) {
+                return isBusy() ? Error::AGAIN : Error::ERROR;
+            }
+
+            return length == 0 ? Error::TOOSMALL : Error::NONE;
+        }
+
+        /**
+         * Program the DMA channels for the running transaction.
+         */
+        void startTransaction() {
+
+            i2c_inst_t *i2c{hal_to_rp2040_inst(m_instance)};
+            i2c_hw_t *hw{i2c_get_hw(i2c)};
+            const Transaction &transaction{m_list.transactions[m_list.index]};
+            size_t count{0};
+
+            for(const uint8_t byte : transaction.write) {
+                m_commands[count++] = byte;
+            }
+
+            for(size_t i{0}; i < transaction.read.size(); i++) {
+                m_commands[count++] = static_cast<uint16_t>(I2C_IC_DATA_CMD_CMD_BITS | (i == 0 and !transaction.write.empty() ? I2C_IC_DATA_CMD_RESTART_BITS : 0U));
+            }
+
+            m_commands[count - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+            m_list.nack = false;
+
+            // The target address can only change while the controller is disabled
+            hw->enable = 0;
+            hw->tar = transaction.address;
+            hw->enable = 1;
+
+            // The SDK would otherwise send a restart on its next blocking access
+            i2c->restart_on_next = false;
+
+            if(!transaction.read.empty()) {
+
+                dma_channel_config config{dma_channel_get_default_config(m_list.rx_channel)};
+                channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+                channel_config_set_read_increment(&config, false);
+                channel_config_set_write_increment(&config, true);
+                channel_config_set_dreq(&config, i2c_get_dreq(i2c, false));
+                dma_channel_configure(m_list.rx_channel, &config, transaction.read.data(), &hw->data_cmd, transaction.read.size(), true);
+            }
+
+            // 16 bits writes to an APB register are replicated on both halves, bits 8 to 10 are the command
+            dma_channel_config config{dma_channel_get_default_config(m_list.tx_channel)};
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+            channel_config_set_read_increment(&config, true);
+            channel_config_set_write_increment(&config, false);
+            channel_config_set_dreq(&config, i2c_get_dreq(i2c, true));
+            dma_channel_configure(m_list.tx_channel, &config, &hw->data_cmd, m_commands, count, true);
+        }
+
+        /**
+         * Serve the register map, the bytes received are drained before a stop reports them.
+         */
+        void handleSlaveIRQ() {
+
+            HAL_TRACE_SCOPE("i2c.slave_irq");
+
+            i2c_hw_t *hw{i2c_get_hw(hal_to_rp2040_inst(m_instance))};
+            const uint32_t status{hw->intr_stat};
+
+            if(status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
+
+                while(hw->rxflr > 0) {
+
+                    const uint32_t data{hw->data_cmd};
+                    m_register_map.receive(static_cast<uint8_t>(data & I2C_IC_DATA_CMD_DAT_BITS), (data & I2C_IC_DATA_CMD_FIRST_DATA_BYTE_BITS) != 0);
+                }
+            }
+
+            // The controller stretches the clock until the byte is written
+            if(status & I2C_IC_INTR_STAT_R_RD_REQ_BITS) {
+
+                hw->data_cmd = m_register_map.transmit();
+                static_cast<void>(hw->clr_rd_req);
+            }
+
+            if(status & (I2C_IC_INTR_STAT_R_STOP_DET_BITS | I2C_IC_INTR_STAT_R_RESTART_DET_BITS)) {
+
+                static_cast<void>(hw->clr_stop_det);
+                static_cast<void>(hw->clr_restart_det);
+                m_register_map.stop();
+            }
+        }
+
+        void finish() {
+
+            i2c_get_hw(hal_to_rp2040_inst(m_instance))->intr_mask = 0;
+
+            dma_channel_unclaim(m_list.tx_channel);
+            dma_channel_unclaim(m_list.rx_channel);
+
+            const bool notify{!m_list.stop and m_list.callback != nullptr};
+
+            m_busy.store(false, std::memory_order_release);
+
+            if(notify) {
+                m_list.callback(m_list.error, m_list.index, m_list.context);
+            }
+        }
+
+        static void irqHandler0() {
+
+            getInstance(I2C_INSTANCE0).handleIRQ();
+        }
+
+        static void irqHandler1() {
+
+            getInstance(I2C_INSTANCE1).handleIRQ();
+        }
+    };
+
+} // namespace hal::peripherals::i2c
+
+#endif //EMBEDDEDLIBRARY_I2C_RP2040_H
@@ -0,0 +1,18 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_PIN_H
+#define EMBEDDEDLIBRARY_PIN_H
+
+#include "../commons/commons.h"
+
+#ifdef HAL_RP2040
+#include "Pin_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Pin_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+#endif //EMBEDDEDLIBRARY_PIN_H
@@ -0,0 +1,103 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_PIN_HOST_H
+#define EMBEDDEDLIBRARY_PIN_HOST_H
+
+#include "../commons/commons.h"
+
+namespace hal::peripherals::gpio {
+
+    /**
+     * Host implementation of a GPIO pin resolved at compile time, backed by the in-memory
+     * @ref hal::host::PinBank "PinBank".
+     *
+     * @tparam P GPIO number
+     * @tparam D direction of the pin, only an output can be written
+     */
+    template<hal::pin P, Direction D>
+    requires (P < NUMBER_GPIO_PIN)
+    class Pin {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        Pin() {
+
+            init();
+        }
+
+        ~Pin() {
+
+            deinit();
+        }
+
+        Pin(const Pin &)=delete;
+        Pin &operator=(const Pin &)=delete;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        static void init() {
+
+            host::PinBank::getInstance().init(P);
+            host::PinBank::getInstance().setDirection(P, D == Direction::OUT);
+        }
+
+        static void deinit() {
+
+            host::PinBank::getInstance().deinit(P);
+        }
+
+        static uint8_t read() {
+
+            return host::PinBank::getInstance().get(P);
+        }
+
+        static void write(const uint8_t value) requires (D == Direction::OUT) {
+
+            host::PinBank::getInstance().putMasked(MASK, value ? MASK : 0U);
+        }
+
+        static void high() requires (D == Direction::OUT) {
+
+            host::PinBank::getInstance().putMasked(MASK, MASK);
+        }
+
+        static void low() requires (D == Direction::OUT) {
+
+            host::PinBank::getInstance().putMasked(MASK, 0U);
+        }
+
+        static void toggle() requires (D == Direction::OUT) {
+
+            host::PinBank::getInstance().toggleMasked(MASK);
+        }
+
+        static bool setPull(const enum Pull gpio_pull) {
+
+            host::PinBank::getInstance().setPulls(P, gpio_pull == Pull::UP, gpio_pull == Pull::DOWN);
+
+            return gpio_pull != Pull::OPEN_DRAIN;
+        }
+
+        static constexpr uint getPin() noexcept {
+
+            return P;
+        }
+
+        static constexpr enum Direction getDirection() noexcept {
+
+            return D;
+        }
+
+        static constexpr uint32_t MASK{1U << P};  ///< Bit of the pin in the pin bank
+    };
+
+} // hal::peripherals::gpio
+
+#endif //EMBEDDEDLIBRARY_PIN_HOST_H
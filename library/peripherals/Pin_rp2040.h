@@ -0,0 +1,114 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_PIN_RP2040_H
+#define EMBEDDEDLIBRARY_PIN_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/gpio.h>
+
+namespace hal::peripherals::gpio {
+
+    /**
+     * GPIO pin resolved at compile time.
+     *
+     * Unlike @ref DigitalInOut "DigitalInOut" there is no virtual function and no member: the pin number and
+     * its direction are template parameters, so every operation inlines to a single SIO register access.
+     * Generic drivers accept either kind of pin through @ref hal::concepts::is_digital_output "is_digital_output"
+     * and @ref hal::concepts::is_digital_input "is_digital_input".
+     *
+     * @code{cpp}
+     * hal::peripherals::gpio::Pin<hal::GPIO25, hal::peripherals::gpio::Direction::OUT> led{};
+     * led.toggle(); // sio_hw->gpio_togl = 1U << 25
+     * @endcode
+     *
+     * @tparam P GPIO number
+     * @tparam D direction of the pin, only an output can be written
+     */
+    template<hal::pin P, Direction D>
+    requires (P < NUMBER_GPIO_PIN)
+    class Pin {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        Pin() {
+
+            init();
+        }
+
+        ~Pin() {
+
+            deinit();
+        }
+
+        Pin(const Pin &)=delete;
+        Pin &operator=(const Pin &)=delete;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        static void init() {
+
+            gpio_init(P);
+            gpio_set_dir(P, D == Direction::OUT);
+        }
+
+        static void deinit() {
+
+            gpio_deinit(P);
+        }
+
+        static uint8_t read() {
+
+            return gpio_get(P);
+        }
+
+        static void write(const uint8_t value) requires (D == Direction::OUT) {
+
+            gpio_put(P, value);
+        }
+
+        static void high() requires (D == Direction::OUT) {
+
+            gpio_set_mask(MASK);
+        }
+
+        static void low() requires (D == Direction::OUT) {
+
+            gpio_clr_mask(MASK);
+        }
+
+        static void toggle() requires (D == Direction::OUT) {
+
+            gpio_xor_mask(MASK);
+        }
+
+        static bool setPull(const enum Pull gpio_pull) {
+
+            gpio_set_pulls(P, gpio_pull == Pull::UP, gpio_pull == Pull::DOWN);
+
+            return gpio_pull != Pull::OPEN_DRAIN;
+        }
+
+        static constexpr uint getPin() noexcept {
+
+            return P;
+        }
+
+        static constexpr enum Direction getDirection() noexcept {
+
+            return D;
+        }
+
+        static constexpr uint32_t MASK{1U << P};  ///< Bit of the pin in the SIO registers
+    };
+
+} // hal::peripherals::gpio
+
+#endif //EMBEDDEDLIBRARY_PIN_RP2040_H
@@ -0,0 +1,71 @@
+/**
+ * @file PioUART.h
+ * @brief Provide the UARTs run by the PIO, beyond the hardware ones
+ *
+ * A @ref hal::peripherals::uart::PioUART "PioUART" implements @ref hal::interfaces::InterfaceUART "InterfaceUART"
+ * with two PIO state machines: one shifts the frames out on the TX pin, the other samples the RX pin and shifts the
+ * frames in. Frames are 8N1. Each PIO block has four state machines, so two links fit on each block. With the two
+ * hardware UARTs, a board gets up to @ref hal::peripherals::uart::SERIAL_LINKS "SERIAL_LINKS" serial links.
+ *
+ * @ref hal::peripherals::uart::getSerial() "getSerial()" returns any of them by number, hardware ones first, so a
+ * driver takes an @ref hal::interfaces::InterfaceUART "InterfaceUART" and does not care which one it got.
+ *
+ * On RP2040 writeAsync() and readAsync() feed and empty the FIFOs of the state machines with DMA, paced by their DREQ.
+ * On host the state machines are modelled bit by bit, see @ref hal::host::PioSerializer "PioSerializer": the TX pin
+ * of a link is wired to the RX pin of whatever link listens on the same pin number.
+ *
+ * @code{cpp}
+ * auto &gps{hal::peripherals::uart::getSerial(2)}; // PIO_UART_INSTANCE0
+ * gps.init(hal::GPIO6, hal::GPIO7, 9'600);
+ *
+ * uint8_t sentence[82];
+ * gps.readAsync(sentence, on_sentence);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_PIOUART_H
+#define EMBEDDEDLIBRARY_PIOUART_H
+
+#include "../interfaces/InterfaceUART.h"
+#include "UART.h"
+
+namespace hal::peripherals::uart {
+
+    constexpr size_t PIO_UART_FIFO_DEPTH{8};        ///< Both FIFOs of a state machine are joined into one direction
+    constexpr uint PIO_UART_CYCLES_PER_BIT{8};      ///< PIO cycles the programs spend on each bit
+
+} // namespace hal::peripherals::uart
+
+#ifdef HAL_RP2040
+#include "PioUART_rp2040.h"
+#elif defined(HAL_HOST)
+#include "PioUART_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::peripherals::uart {
+
+    constexpr uint8_t SERIAL_LINKS{UART_INSTANCE1 + 1 + PIO_UART_INSTANCE3 + 1};    ///< Hardware and PIO UARTs
+
+    /**
+     * Get a serial link by number: the hardware UARTs first, then the PIO ones.
+     *
+     * @param link number of the link, below SERIAL_LINKS
+     * @return UART instance of the link, the one of PIO_UART_INSTANCE0 if link is out of range
+     */
+    inline interfaces::InterfaceUART &getSerial(const uint8_t link) {
+
+        constexpr uint8_t HARDWARE_LINKS{UART_INSTANCE1 + 1};
+
+        if(link < HARDWARE_LINKS) {
+
+            return UART::getInstance(link);
+        }
+
+        return PioUART::getInstance(static_cast<uint8_t>(link - HARDWARE_LINKS));
+    }
+
+} // namespace hal::peripherals::uart
+
+#endif //EMBEDDEDLIBRARY_PIOUART_H
@@ -0,0 +1,655 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_PIOUART_HOST_H
+#define EMBEDDEDLIBRARY_PIOUART_HOST_H
+
+#include "../commons/commons.h"
+
+#include "PioUART.h"
+#include "../data_structures/SpscRing.h"
+#include "../trace/Trace.h"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace hal::host {
+
+    /**
+     * Bit level model of the uart_tx and uart_rx programs run by the state machines of a
+     * @ref hal::peripherals::uart::PioUART "PioUART".
+     *
+     * Frames are 8N1: a start bit low, 8 data bits least significant first, then a stop bit high. The line idles high.
+     * The model moves one bit per bit period where the programs spend
+     * @ref hal::peripherals::uart::PIO_UART_CYCLES_PER_BIT "PIO_UART_CYCLES_PER_BIT" cycles.
+     */
+    class PioSerializer {
+    public:
+
+        static constexpr size_t FRAME_BITS{10};     ///< Start bit, 8 data bits and stop bit
+
+        /**
+         * What the RX program did with the bit sampled.
+         */
+        enum class Event : uint8_t {
+
+            NONE,           ///< Nothing pushed yet
+            BYTE,           ///< A frame completed, its byte is pushed to the RX FIFO
+            FRAMING_ERROR   ///< The stop bit was low, the byte is dropped until the line returns high
+        };
+
+        /**
+         * Levels shifted out by the TX program for a byte.
+         *
+         * @param byte data bits
+         * @return levels of the line, the start bit in bit 0
+         */
+        [[nodiscard]] static constexpr uint16_t frame(const uint8_t byte) {
+
+            return static_cast<uint16_t>(1U << (FRAME_BITS - 1) | static_cast<uint>(byte) << 1);
+        }
+
+        /**
+         * Sample the line in the middle of a bit period, like the RX program does.
+         *
+         * @param level level of the line
+         * @param byte set to the byte received when Event::BYTE is returned
+         * @return what happened to the frame
+         */
+        Event sample(const bool level, uint8_t &byte) {
+
+            switch(m_state) {
+                case State::IDLE:
+                    if(!level) {
+
+                        m_shift = 0;
+                        m_bits = 0;
+                        m_state = State::DATA;
+                    }
+                    break;
+
+                case State::DATA:
+                    m_shift = static_cast<uint8_t>(m_shift >> 1 | static_cast<uint>(level) << 7);
+
+                    if(++m_bits == 8) {
+                        m_state = State::STOP;
+                    }
+                    break;
+
+                case State::STOP:
+                    if(level) {
+
+                        byte = m_shift;
+                        m_state = State::IDLE;
+                        return Event::BYTE;
+                    }
+
+                    // Either a framing error or a break, wait for the line to idle before looking for a start bit
+                    m_state = State::WAIT_IDLE;
+                    return Event::FRAMING_ERROR;
+
+                case State::WAIT_IDLE:
+                    if(level) {
+                        m_state = State::IDLE;
+                    }
+                    break;
+            }
+
+            return Event::NONE;
+        }
+
+        /**
+         * Restart the RX program, a frame being received is lost.
+         */
+        void reset() {
+
+            m_state = State::IDLE;
+        }
+
+    private:
+
+        enum class State : uint8_t {
+
+            IDLE,       ///< wait 0 pin: waiting for a start bit
+            DATA,       ///< in pins, 1: shifting the data bits in
+            STOP,       ///< jmp pin: checking the stop bit
+            WAIT_IDLE   ///< wait 1 pin: waiting for the line after a framing error
+        };
+
+        State m_state{State::IDLE};
+        uint8_t m_shift{0};     ///< Input shift register
+        uint8_t m_bits{0};      ///< Data bits shifted in
+    };
+
+    /**
+     * Receiving end of a wire, see @ref PioWires "PioWires".
+     */
+    class PioReceiver {
+    public:
+
+        virtual ~PioReceiver() =default;
+
+        /**
+         * Sample the wire once per bit period.
+         *
+         * @param level level of the wire
+         */
+        virtual void sample(bool level)=0;
+    };
+
+    /**
+     * Wires between the PIO state machines of the host, one per GPIO pin.
+     *
+     * A TX state machine drives the wire of its pin, one level per bit period. The RX state machine attached to the
+     * same pin samples it straight away, so wiring two links only takes crossing their pins. The levels driven on a
+     * wire nobody listens to are captured, and given back by @ref PioWires::take() "take()".
+     *
+     * @code{cpp}
+     * auto &wires{hal::host::PioWires::getInstance()};
+     *
+     * // Feed a frame with a low stop bit to the link listening on GPIO6
+     * for(size_t i{0}; i < hal::host::PioSerializer::FRAME_BITS; i++) {
+     *     wires.drive(hal::GPIO6, i > 0 and i < 4);
+     * }
+     * @endcode
+     *
+     * @note Every access to the wires and to the links using them holds @ref PioWires::getMutex() "getMutex()".
+     */
+    class PioWires : public traits::Singleton {
+    public:
+
+        /**
+         * Get the wires shared by every host PIO UART.
+         *
+         * @return the wires
+         */
+        static PioWires &getInstance() {
+
+            static PioWires s_pio_wires{};
+            return s_pio_wires;
+        }
+
+        /**
+         * Drive a wire for one bit period.
+         *
+         * @param pin pin of the wire
+         * @param level level driven
+         */
+        void drive(const uint pin, const bool level) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_mutex};
+
+            if(m_receivers[pin] != nullptr) {
+
+                m_receivers[pin]->sample(level);
+            } else {
+
+                m_captured[pin].push_back(level);
+            }
+        }
+
+        /**
+         * Take the levels driven on a wire nobody listens to.
+         *
+         * @param pin pin of the wire
+         * @return levels driven since the last call, in order
+         */
+        std::vector<bool> take(const uint pin) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_mutex};
+
+            std::vector<bool> levels;
+            levels.swap(m_captured[pin]);
+
+            return levels;
+        }
+
+        /**
+         * Listen to a wire.
+         *
+         * @param pin pin of the wire
+         * @param receiver RX state machine sampling it
+         * @return whether an error occurred, another receiver already listens to the wire
+         */
+        bool attach(const uint pin, PioReceiver * const receiver) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_mutex};
+
+            if(m_receivers[pin] != nullptr and m_receivers[pin] != receiver) {
+
+                return true;
+            }
+
+            m_receivers[pin] = receiver;
+
+            return false;
+        }
+
+        /**
+         * Stop listening to a wire.
+         *
+         * @param pin pin of the wire
+         * @param receiver RX state machine sampling it, nothing is done if another one listens
+         */
+        void detach(const uint pin, const PioReceiver * const receiver) {
+
+            const std::lock_guard<std::recursive_mutex> lock{m_mutex};
+
+            if(m_receivers[pin] == receiver) {
+                m_receivers[pin] = nullptr;
+            }
+        }
+
+        /**
+         * Get the lock held while the wires move bits. The receivers are called with it held.
+         *
+         * @return mutex of the wires
+         */
+        std::recursive_mutex &getMutex() {
+
+            return m_mutex;
+        }
+
+    protected:
+
+        PioWires() : m_receivers{} {}
+
+        std::recursive_mutex m_mutex;   ///< Protect the wires and the links using them
+        std::array<PioReceiver *, NUMBER_GPIO_PIN> m_receivers;         ///< RX state machine per wire, or nullptr
+        std::array<std::vector<bool>, NUMBER_GPIO_PIN> m_captured;      ///< Levels driven on the wires without receiver
+    };
+
+} // namespace hal::host
+
+namespace hal::peripherals::uart {
+
+    /**
+     * Host implementation of the PIO UART.
+     *
+     * The state machines are modelled by @ref hal::host::PioSerializer "PioSerializer" on
+     * @ref hal::host::PioWires "PioWires": write() shifts every frame out at once on the wire of the TX pin, and the
+     * link listening on it decodes it while it is driven. The TX FIFO is never full.
+     * The RX FIFO holds @ref PIO_UART_FIFO_DEPTH "PIO_UART_FIFO_DEPTH" bytes, the bytes received while it is full are
+     * dropped and counted as overruns.
+     *
+     * @code{cpp}
+     * auto &left{hal::peripherals::uart::PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE0)};
+     * auto &right{hal::peripherals::uart::PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE1)};
+     * left.init(hal::GPIO6, hal::GPIO7, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+     * right.init(hal::GPIO7, hal::GPIO6, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+     *
+     * left.write('a');
+     * right.read(); // 'a'
+     * @endcode
+     *
+     * There is no DMA on the host: writeAsync() completes before returning, readAsync() takes the bytes from the RX
+     * FIFO, then from the RX state machine, and calls its callback from the thread driving the wire.
+     */
+    class PioUART : public interfaces::InterfaceUART, protected host::PioReceiver {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~PioUART() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * @return whether an error occurred, Error::ERROR if another link already listens on rx_pin
+         */
+        bool init(const uint rx_pin, const uint tx_pin, const uint baudrate) override {
+
+            const std::lock_guard<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            m_last_error = Error::NONE;
+
+            m_initialised = true;
+            m_baudrate = baudrate;
+            m_serializer.reset();
+
+            if(setPins(rx_pin, tx_pin)) {
+
+                m_initialised = false;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            const std::lock_guard<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            abortRead();
+
+            m_last_error = Error::NONE;
+
+            host::PioWires::getInstance().detach(m_rx_pin, this);
+
+            uint8_t byte;
+            while(m_rx_fifo.pop(byte)) {}
+
+            m_initialised = false;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint8_t read() override {
+
+            uint8_t byte{0};
+            read(&byte, 1);
+
+            return byte;
+        }
+
+        void read(uint8_t * const buffer, const size_t length) override {
+
+            HAL_TRACE_SCOPE("piouart.read");
+
+            std::unique_lock<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            for(size_t i{0}; i < length; i++) {
+
+                m_rx_event.wait(lock, [this]() { return !m_rx_fifo.empty(); });
+                m_rx_fifo.pop(buffer[i]);
+            }
+
+            HAL_STATS_ADD(m_stats.bytes_read, length);
+
+            m_last_error = Error::NONE;
+        }
+
+        void write(const uint8_t buffer) override {
+
+            write(&buffer, 1);
+        }
+
+        void write(const uint8_t * const buffer, const size_t length) override {
+
+            HAL_TRACE_SCOPE("piouart.write");
+
+            auto &wires{host::PioWires::getInstance()};
+            const std::lock_guard<std::recursive_mutex> lock{wires.getMutex()};
+
+            for(size_t i{0}; i < length; i++) {
+
+                const uint16_t frame{host::PioSerializer::frame(buffer[i])};
+
+                for(size_t bit{0}; bit < host::PioSerializer::FRAME_BITS; bit++) {
+                    wires.drive(m_tx_pin, (frame >> bit & 1U) != 0);
+                }
+            }
+
+            HAL_STATS_ADD(m_stats.bytes_written, length);
+
+            m_last_error = Error::NONE;
+        }
+
+        bool writeAsync(const std::span<const uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            write(buffer.data(), buffer.size());
+
+            if(callback != nullptr) {
+                callback(Error::NONE, buffer.size(), context);
+            }
+
+            return false;
+        }
+
+        bool readAsync(const std::span<uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            const std::lock_guard<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(isReadBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            m_rx_transfer = {buffer, 0, callback, context, true};
+
+            // The DMA empties the RX FIFO first
+            uint8_t byte;
+            while(m_rx_transfer.count < buffer.size() and m_rx_fifo.pop(byte)) {
+                m_rx_transfer.buffer[m_rx_transfer.count++] = byte;
+            }
+
+            if(m_rx_transfer.count == buffer.size()) {
+                finishRead();
+            }
+
+            return false;
+        }
+
+        [[nodiscard]] bool isReadBusy() const override {
+
+            return m_rx_transfer.running;
+        }
+
+        size_t abortRead() override {
+
+            const std::lock_guard<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            if(!m_rx_transfer.running) {
+
+                return 0;
+            }
+
+            m_rx_transfer.running = false;
+            HAL_STATS_ADD(m_stats.bytes_read, m_rx_transfer.count);
+
+            return m_rx_transfer.count;
+        }
+
+        using InterfaceUART::setPins;
+
+        /**
+         * @return whether an error occurred, Error::ERROR if another link already listens on rx_pin
+         */
+        bool setPins(const uint rx_pin, const uint tx_pin) override {
+
+            auto &wires{host::PioWires::getInstance()};
+            const std::lock_guard<std::recursive_mutex> lock{wires.getMutex()};
+
+            m_last_error = Error::NONE;
+
+            if(isInitialised()) {
+
+                wires.detach(m_rx_pin, this);
+
+                if(wires.attach(rx_pin, this)) {
+
+                    m_last_error = Error::ERROR;
+                    return true;
+                }
+            }
+
+            m_rx_pin = rx_pin;
+            m_tx_pin = tx_pin;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? baudrate : m_baudrate;
+        }
+
+        [[nodiscard]] uint getBaudrate() const override {
+
+            return m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        [[nodiscard]] bool isReadable() const override {
+
+            const std::lock_guard<std::recursive_mutex> lock{host::PioWires::getInstance().getMutex()};
+
+            return !m_rx_fifo.empty();
+        }
+
+        [[nodiscard]] bool isWritable() const override {
+
+            return isInitialised();
+        }
+
+        /**
+         * The programs only shift 8N1 frames, other formats are ignored.
+         */
+        void setFormat(const uint data_bits, const uint stop_bits, const Parity parity) const override {
+
+            (void)data_bits;
+            (void)stop_bits;
+            (void)parity;
+        }
+
+        /**
+         * The programs have no flow control pins, nothing is done.
+         */
+        void setHWFlow(const bool cts, const bool rts) override {
+
+            (void)cts;
+            (void)rts;
+        }
+
+        static PioUART &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case PIO_UART_INSTANCE0:
+                    static PioUART s_pio_uart_instance0{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance0;
+
+                case PIO_UART_INSTANCE1:
+                    static PioUART s_pio_uart_instance1{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance1;
+
+                case PIO_UART_INSTANCE2:
+                    static PioUART s_pio_uart_instance2{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance2;
+
+                case PIO_UART_INSTANCE3:
+                    static PioUART s_pio_uart_instance3{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance3;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit PioUART(const PioUARTInstance instance)
+        : InterfaceUART(), m_pio_instance{instance}, m_initialised{false} {}
+
+        /**
+         * Read started by readAsync().
+         */
+        struct Transfer {
+
+            std::span<uint8_t> buffer;              ///< Filled by the RX state machine
+            size_t count{0};                        ///< Bytes received so far
+            TransferCallback callback{nullptr};     ///< Called once the buffer is full
+            void *context{nullptr};                 ///< Given back to the callback
+            bool running{false};                    ///< Whether the read is running
+        };
+
+        PioUARTInstance m_pio_instance;     ///< State machines used, on RP2040
+        bool m_initialised;                 ///< Whether init() was called
+
+        host::PioSerializer m_serializer;   ///< RX state machine
+        data_structures::SpscRing<uint8_t, PIO_UART_FIFO_DEPTH> m_rx_fifo;  ///< Filled by the RX state machine
+        std::condition_variable_any m_rx_event;     ///< Wake read() once a byte is pushed to the RX FIFO
+        Transfer m_rx_transfer;             ///< Started by readAsync()
+
+    private:
+
+        /**
+         * Run the RX state machine for one bit period, with the lock of the wires held.
+         */
+        void sample(const bool level) override {
+
+            uint8_t byte{0};
+
+            switch(m_serializer.sample(level, byte)) {
+                case host::PioSerializer::Event::BYTE:
+                    receive(byte);
+                    break;
+
+                case host::PioSerializer::Event::FRAMING_ERROR:
+                    HAL_STATS_ADD(m_stats.framing_errors, 1);
+                    break;
+
+                case host::PioSerializer::Event::NONE:
+                    break;
+            }
+        }
+
+        void receive(const uint8_t byte) {
+
+            if(m_rx_transfer.running) {
+
+                m_rx_transfer.buffer[m_rx_transfer.count++] = byte;
+
+                if(m_rx_transfer.count == m_rx_transfer.buffer.size()) {
+                    finishRead();
+                }
+
+                return;
+            }
+
+            if(!m_rx_fifo.push(byte)) {
+
+                HAL_STATS_ADD(m_stats.overruns, 1);
+                return;
+            }
+
+            m_rx_event.notify_all();
+        }
+
+        /// The transfer is over before the callback, which may start the next one
+        void finishRead() {
+
+            m_rx_transfer.running = false;
+            HAL_STATS_ADD(m_stats.bytes_read, m_rx_transfer.count);
+
+            if(m_rx_transfer.callback != nullptr) {
+                m_rx_transfer.callback(Error::NONE, m_rx_transfer.count, m_rx_transfer.context);
+            }
+        }
+    };
+
+} // namespace hal::peripherals::uart
+
+#endif //EMBEDDEDLIBRARY_PIOUART_HOST_H
@@ -0,0 +1,652 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_PIOUART_RP2040_H
+#define EMBEDDEDLIBRARY_PIOUART_RP2040_H
+
+#include "../commons/commons.h"
+
+#include "PioUART.h"
+#include "../trace/Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+
+static inline PIO hal_to_rp2040_pio(hal::peripherals::PioUARTInstance instance) {
+
+    return instance < hal::peripherals::PIO_UART_INSTANCE2 ? pio0 : pio1;
+}
+
+namespace hal::peripherals::uart::detail {
+
+    /**
+     * 8N1 transmitter, 8 cycles per bit. The stop bit is asserted while pulling the next byte, so the line idles high.
+     *
+     *     .program uart_tx
+     *     .side_set 1 opt
+     *         pull       side 1 [7]
+     *         set x, 7   side 0 [7]
+     *     bitloop:
+     *         out pins, 1
+     *         jmp x-- bitloop   [6]
+     */
+    inline constexpr uint16_t UART_TX_INSTRUCTIONS[]{
+        0x9fa0, //  0: pull   block           side 1 [7]
+        0xf727, //  1: set    x, 7            side 0 [7]
+        0x6001, //  2: out    pins, 1
+        0x0642, //  3: jmp    x--, 2                 [6]
+    };
+
+    /**
+     * 8N1 receiver, 8 cycles per bit, sampling in the middle of each bit. A low stop bit raises the IRQ flag 4 of the
+     * state machine, the byte is dropped and the program waits for the line to return high.
+     *
+     *     .program uart_rx
+     *     start:
+     *         wait 0 pin 0
+     *         set x, 7    [10]
+     *     bitloop:
+     *         in pins, 1
+     *         jmp x-- bitloop [6]
+     *         jmp pin good_stop
+     *         irq 4 rel
+     *         wait 1 pin 0
+     *         jmp start
+     *     good_stop:
+     *         push
+     */
+    inline constexpr uint16_t UART_RX_INSTRUCTIONS[]{
+        0x2020, //  0: wait   0 pin, 0
+        0xea27, //  1: set    x, 7                   [10]
+        0x4001, //  2: in     pins, 1
+        0x0642, //  3: jmp    x--, 2                 [6]
+        0x00c8, //  4: jmp    pin, 8
+        0xc014, //  5: irq    nowait 4 rel
+        0x20a0, //  6: wait   1 pin, 0
+        0x0000, //  7: jmp    0
+        0x8020, //  8: push   block
+    };
+
+    inline const pio_program_t UART_TX_PROGRAM{
+        .instructions = UART_TX_INSTRUCTIONS,
+        .length = std::size(UART_TX_INSTRUCTIONS),
+        .origin = -1,
+    };
+
+    inline const pio_program_t UART_RX_PROGRAM{
+        .instructions = UART_RX_INSTRUCTIONS,
+        .length = std::size(UART_RX_INSTRUCTIONS),
+        .origin = -1,
+    };
+
+    constexpr uint RX_FRAMING_IRQ{4};   ///< IRQ flag raised by uart_rx, relative to the state machine
+
+} // namespace hal::peripherals::uart::detail
+
+namespace hal::peripherals::uart {
+
+    /**
+     * RP2040 implementation of the PIO UART.
+     *
+     * Instances 0 and 1 run on pio0, 2 and 3 on pio1. Each one takes two state machines, 2 * (instance % 2) shifts the
+     * frames out with uart_tx and the next one shifts them in with uart_rx. Both programs are loaded once per PIO
+     * block, by the first init() on it, and take 13 of its 32 instructions. The FIFOs of each state machine are joined,
+     * so the TX and the RX FIFO hold @ref PIO_UART_FIFO_DEPTH "PIO_UART_FIFO_DEPTH" bytes each.
+     *
+     * The blocking read() and write() move the bytes with the CPU, writeAsync() and readAsync() with a DMA channel
+     * paced by the DREQ of the state machine, claimed for the transfer only.
+     *
+     * @note Framing errors only raise a sticky flag, they are counted when read() or the DMA interrupt look at it,
+     * at most one per look.
+     */
+    class PioUART : public interfaces::InterfaceUART {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~PioUART() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * @return whether an error occurred, Error::ERROR if the state machines are claimed or the PIO block has no
+         * room left for the programs
+         */
+        bool init(const uint rx_pin, const uint tx_pin, const uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+
+            if(pio_sm_is_claimed(pio, txMachine()) or pio_sm_is_claimed(pio, rxMachine()) or loadPrograms(pio)) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            pio_sm_claim(pio, txMachine());
+            pio_sm_claim(pio, rxMachine());
+
+            m_rx_pin = rx_pin;
+            m_tx_pin = tx_pin;
+            m_baudrate = baudrate;
+
+            startMachines();
+
+            m_initialised = true;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            abortWrite();
+            abortRead();
+
+            m_last_error = Error::NONE;
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+
+            pio_sm_set_enabled(pio, txMachine(), false);
+            pio_sm_set_enabled(pio, rxMachine(), false);
+            pio_sm_unclaim(pio, txMachine());
+            pio_sm_unclaim(pio, rxMachine());
+
+            m_initialised = false;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint8_t read() override {
+
+            uint8_t byte{0};
+            read(&byte, 1);
+
+            return byte;
+        }
+
+        void read(uint8_t * const buffer, const size_t length) override {
+
+            HAL_TRACE_SCOPE("piouart.read");
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+
+            for(size_t i{0}; i < length; i++) {
+
+                // The byte is shifted in from the left of the ISR
+                buffer[i] = static_cast<uint8_t>(pio_sm_get_blocking(pio, rxMachine()) >> 24);
+            }
+
+            countFramingErrors();
+            HAL_STATS_ADD(m_stats.bytes_read, length);
+
+            m_last_error = Error::NONE;
+        }
+
+        void write(const uint8_t buffer) override {
+
+            write(&buffer, 1);
+        }
+
+        void write(const uint8_t * const buffer, const size_t length) override {
+
+            HAL_TRACE_SCOPE("piouart.write");
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+            bool stalled{false};
+
+            for(size_t i{0}; i < length; i++) {
+
+                while(pio_sm_is_tx_fifo_full(pio, txMachine())) {
+                    stalled = true;
+                    tight_loop_contents();
+                }
+
+                pio_sm_put(pio, txMachine(), buffer[i]);
+            }
+
+            HAL_STATS_ADD(m_stats.bytes_written, length);
+
+            if(stalled) {
+                HAL_STATS_ADD(m_stats.tx_stalls, 1);
+            }
+
+            m_last_error = Error::NONE;
+        }
+
+        bool writeAsync(const std::span<const uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+
+            // A byte written to the FIFO is replicated on the 4 lanes, uart_tx shifts out the low one
+            return startTransfer(m_tx_transfer, &pio->txf[txMachine()], buffer.data(), buffer.size(),
+                                 pio_get_dreq(pio, txMachine(), true), callback, context);
+        }
+
+        bool readAsync(const std::span<uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+
+            // Only read the top lane of the FIFO, where uart_rx shifted the byte in
+            const volatile uint8_t *fifo{reinterpret_cast<const volatile uint8_t *>(&pio->rxf[rxMachine()]) + 3};
+
+            return startTransfer(m_rx_transfer, buffer.data(), fifo, buffer.size(),
+                                 pio_get_dreq(pio, rxMachine(), false), callback, context);
+        }
+
+        [[nodiscard]] bool isWriteBusy() const override {
+
+            return m_tx_transfer.channel.load(std::memory_order_acquire) >= 0;
+        }
+
+        [[nodiscard]] bool isReadBusy() const override {
+
+            return m_rx_transfer.channel.load(std::memory_order_acquire) >= 0;
+        }
+
+        size_t abortWrite() override {
+
+            return abortTransfer(m_tx_transfer);
+        }
+
+        size_t abortRead() override {
+
+            return abortTransfer(m_rx_transfer);
+        }
+
+        using InterfaceUART::setPins;
+
+        bool setPins(const uint rx_pin, const uint tx_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_rx_pin = rx_pin;
+            m_tx_pin = tx_pin;
+
+            // The pins are part of the configuration of the state machines, restart them
+            if(isInitialised()) {
+                startMachines();
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            if(!isInitialised()) {
+
+                return m_baudrate;
+            }
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+            uint16_t div_int;
+            uint8_t div_frac;
+
+            m_baudrate = clockDivider(baudrate, div_int, div_frac);
+
+            pio_sm_set_clkdiv_int_frac(pio, txMachine(), div_int, div_frac);
+            pio_sm_set_clkdiv_int_frac(pio, rxMachine(), div_int, div_frac);
+
+            return m_baudrate;
+        }
+
+        [[nodiscard]] uint getBaudrate() const override {
+
+            return m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        [[nodiscard]] bool isReadable() const override {
+
+            return !pio_sm_is_rx_fifo_empty(hal_to_rp2040_pio(m_pio_instance), rxMachine());
+        }
+
+        [[nodiscard]] bool isWritable() const override {
+
+            return !pio_sm_is_tx_fifo_full(hal_to_rp2040_pio(m_pio_instance), txMachine());
+        }
+
+        /**
+         * The programs only shift 8N1 frames, other formats are ignored.
+         */
+        void setFormat(const uint data_bits, const uint stop_bits, const Parity parity) const override {
+
+            (void)data_bits;
+            (void)stop_bits;
+            (void)parity;
+        }
+
+        /**
+         * The programs have no flow control pins, nothing is done.
+         */
+        void setHWFlow(const bool cts, const bool rts) override {
+
+            (void)cts;
+            (void)rts;
+        }
+
+        /**
+         * Complete the DMA transfer moved by a channel.
+         *
+         * @param channel channel of the transfer, its interrupt is acknowledged
+         * @note Called from the DMA_IRQ_0 handler, see @ref hal::detail::DmaIRQ "DmaIRQ".
+         */
+        void handleDmaIRQ(const uint channel) {
+
+            HAL_TRACE_SCOPE("piouart.dma_irq");
+
+            Transfer &transfer{m_tx_transfer.channel.load(std::memory_order_relaxed) == static_cast<int>(channel) ? m_tx_transfer : m_rx_transfer};
+
+            releaseChannel(transfer);
+
+            if(&transfer == &m_tx_transfer) {
+                HAL_STATS_ADD(m_stats.bytes_written, transfer.length);
+            } else {
+                countFramingErrors();
+                HAL_STATS_ADD(m_stats.bytes_read, transfer.length);
+            }
+
+            if(transfer.callback != nullptr) {
+
+                transfer.callback(Error::NONE, transfer.length, transfer.context);
+            }
+        }
+
+        static PioUART &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case PIO_UART_INSTANCE0:
+                    static PioUART s_pio_uart_instance0{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance0;
+
+                case PIO_UART_INSTANCE1:
+                    static PioUART s_pio_uart_instance1{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance1;
+
+                case PIO_UART_INSTANCE2:
+                    static PioUART s_pio_uart_instance2{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance2;
+
+                case PIO_UART_INSTANCE3:
+                    static PioUART s_pio_uart_instance3{static_cast<PioUARTInstance>(instance)};
+                    return s_pio_uart_instance3;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit PioUART(const PioUARTInstance instance)
+        : InterfaceUART(), m_pio_instance{instance}, m_initialised{false} {}
+
+        /**
+         * Asynchronous transfer in one direction.
+         */
+        struct Transfer {
+
+            std::atomic<int> channel{-1};           ///< DMA channel moving the bytes, -1 when idle
+            size_t length{0};                       ///< Number of bytes to move
+            TransferCallback callback{nullptr};     ///< Called from the DMA interrupt on completion
+            void *context{nullptr};                 ///< Given back to the callback
+        };
+
+        PioUARTInstance m_pio_instance;     ///< Selects the PIO block and the state machines
+        bool m_initialised;                 ///< Whether init() was called
+
+        Transfer m_tx_transfer;     ///< Started by writeAsync()
+        Transfer m_rx_transfer;     ///< Started by readAsync()
+
+        inline static std::array<int, 2> s_tx_offset{-1, -1};   ///< Where uart_tx is loaded, per PIO block
+        inline static std::array<int, 2> s_rx_offset{-1, -1};   ///< Where uart_rx is loaded, per PIO block
+
+    private:
+
+        [[nodiscard]] uint txMachine() const {
+
+            return 2U * (m_pio_instance % 2U);
+        }
+
+        [[nodiscard]] uint rxMachine() const {
+
+            return txMachine() + 1;
+        }
+
+        /**
+         * Load both programs on a PIO block, unless they already are.
+         *
+         * @return whether an error occurred, no room left on the block
+         */
+        static bool loadPrograms(PIO pio) {
+
+            const uint index{pio_get_index(pio)};
+
+            if(s_tx_offset[index] >= 0) {
+
+                return false;
+            }
+
+            if(!pio_can_add_program(pio, &detail::UART_TX_PROGRAM) or !pio_can_add_program(pio, &detail::UART_RX_PROGRAM)) {
+
+                return true;
+            }
+
+            s_tx_offset[index] = static_cast<int>(pio_add_program(pio, &detail::UART_TX_PROGRAM));
+            s_rx_offset[index] = static_cast<int>(pio_add_program(pio, &detail::UART_RX_PROGRAM));
+
+            return false;
+        }
+
+        /**
+         * Compute the clock divider of the state machines, in 8.8 fixed point.
+         *
+         * @param baudrate baud rate wanted
+         * @param div_int integer part of the divider
+         * @param div_frac fractional part of the divider, in 1/256
+         * @return effective baud rate
+         */
+        static uint clockDivider(const uint baudrate, uint16_t &div_int, uint8_t &div_frac) {
+
+            const uint64_t clock{clock_get_hz(clk_sys)};
+            const uint64_t bit_rate{static_cast<uint64_t>(baudrate) * PIO_UART_CYCLES_PER_BIT};
+            uint64_t divider{(clock * 256U + bit_rate / 2U) / bit_rate};
+
+            divider = std::clamp<uint64_t>(divider, 256U, 0xFFFFU * 256U);
+
+            div_int = static_cast<uint16_t>(divider >> 8);
+            div_frac = static_cast<uint8_t>(divider);
+
+            return static_cast<uint>(clock * 256U / (divider * PIO_UART_CYCLES_PER_BIT));
+        }
+
+        /**
+         * Configure both state machines for the pins and the baud rate, then start them.
+         */
+        void startMachines() {
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+            const uint index{pio_get_index(pio)};
+            const auto tx_offset{static_cast<uint>(s_tx_offset[index])};
+            const auto rx_offset{static_cast<uint>(s_rx_offset[index])};
+            uint16_t div_int;
+            uint8_t div_frac;
+
+            m_baudrate = clockDivider(m_baudrate, div_int, div_frac);
+
+            pio_sm_set_enabled(pio, txMachine(), false);
+            pio_sm_set_enabled(pio, rxMachine(), false);
+
+            // TX: the pin is driven by out and by the side set, it idles high
+            pio_sm_set_pins_with_mask(pio, txMachine(), 1U << m_tx_pin, 1U << m_tx_pin);
+            pio_sm_set_pindirs_with_mask(pio, txMachine(), 1U << m_tx_pin, 1U << m_tx_pin);
+            pio_gpio_init(pio, m_tx_pin);
+
+            pio_sm_config tx_config{pio_get_default_sm_config()};
+            sm_config_set_wrap(&tx_config, tx_offset, tx_offset + static_cast<uint>(std::size(detail::UART_TX_INSTRUCTIONS)) - 1);
+            sm_config_set_sideset(&tx_config, 2, true, false);
+            sm_config_set_out_shift(&tx_config, true, false, 32);
+            sm_config_set_out_pins(&tx_config, m_tx_pin, 1);
+            sm_config_set_sideset_pins(&tx_config, m_tx_pin);
+            sm_config_set_fifo_join(&tx_config, PIO_FIFO_JOIN_TX);
+            sm_config_set_clkdiv_int_frac(&tx_config, div_int, div_frac);
+            pio_sm_init(pio, txMachine(), tx_offset, &tx_config);
+
+            // RX: the pin is sampled by in, wait and jmp pin
+            pio_sm_set_consecutive_pindirs(pio, rxMachine(), m_rx_pin, 1, false);
+            pio_gpio_init(pio, m_rx_pin);
+            gpio_pull_up(m_rx_pin);
+
+            pio_sm_config rx_config{pio_get_default_sm_config()};
+            sm_config_set_wrap(&rx_config, rx_offset, rx_offset + static_cast<uint>(std::size(detail::UART_RX_INSTRUCTIONS)) - 1);
+            sm_config_set_in_pins(&rx_config, m_rx_pin);
+            sm_config_set_jmp_pin(&rx_config, m_rx_pin);
+            sm_config_set_in_shift(&rx_config, true, false, 32);
+            sm_config_set_fifo_join(&rx_config, PIO_FIFO_JOIN_RX);
+            sm_config_set_clkdiv_int_frac(&rx_config, div_int, div_frac);
+            pio_sm_init(pio, rxMachine(), rx_offset, &rx_config);
+
+            pio_interrupt_clear(pio, detail::RX_FRAMING_IRQ + rxMachine());
+
+            pio_set_sm_mask_enabled(pio, (1U << txMachine()) | (1U << rxMachine()), true);
+        }
+
+        /// The flag of uart_rx is sticky, several framing errors in a row count once
+        void countFramingErrors() {
+
+            PIO pio{hal_to_rp2040_pio(m_pio_instance)};
+            const uint flag{detail::RX_FRAMING_IRQ + rxMachine()};
+
+            if(pio_interrupt_get(pio, flag)) {
+
+                pio_interrupt_clear(pio, flag);
+                HAL_STATS_ADD(m_stats.framing_errors, 1);
+            }
+        }
+
+        /**
+         * Program a DMA channel paced by the DREQ of a state machine, one byte per request.
+         * Only the FIFO end of the transfer is fixed, the memory end is incremented.
+         */
+        bool startTransfer(Transfer &transfer, volatile void * const write_address, const volatile void * const read_address,
+                           const size_t length, const uint dreq, const TransferCallback callback, void * const context) {
+
+            const bool tx{&transfer == &m_tx_transfer};
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(transfer.channel.load(std::memory_order_acquire) >= 0) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(length == 0) {
+
+                if(callback != nullptr) {
+                    callback(Error::NONE, 0, context);
+                }
+
+                return false;
+            }
+
+            const int channel{dma_claim_unused_channel(false)};
+
+            if(channel < 0) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            dma_channel_config config{dma_channel_get_default_config(static_cast<uint>(channel))};
+
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+            channel_config_set_read_increment(&config, tx);
+            channel_config_set_write_increment(&config, !tx);
+            channel_config_set_dreq(&config, dreq);
+
+            transfer.length = length;
+            transfer.callback = callback;
+            transfer.context = context;
+            transfer.channel.store(channel, std::memory_order_release);
+
+            hal::detail::DmaIRQ::attach(static_cast<uint>(channel), dmaIRQHandler, this);
+            dma_channel_set_irq0_enabled(static_cast<uint>(channel), true);
+            dma_channel_configure(static_cast<uint>(channel), &config, write_address, read_address, length, true);
+
+            return false;
+        }
+
+        size_t abortTransfer(Transfer &transfer) {
+
+            const int channel{transfer.channel.load(std::memory_order_acquire)};
+
+            if(channel < 0) {
+
+                return 0;
+            }
+
+            // Disable the interrupt first, an abort can raise it (RP2040-E13)
+            dma_channel_set_irq0_enabled(static_cast<uint>(channel), false);
+            dma_channel_abort(static_cast<uint>(channel));
+            dma_channel_acknowledge_irq0(static_cast<uint>(channel));
+
+            const size_t remaining{dma_channel_hw_addr(static_cast<uint>(channel))->transfer_count};
+
+            releaseChannel(transfer);
+
+            if(&transfer == &m_tx_transfer) {
+                HAL_STATS_ADD(m_stats.bytes_written, transfer.length - remaining);
+            } else {
+                HAL_STATS_ADD(m_stats.bytes_read, transfer.length - remaining);
+            }
+
+            return transfer.length - remaining;
+        }
+
+        static void releaseChannel(Transfer &transfer) {
+
+            const auto channel{static_cast<uint>(transfer.channel.load(std::memory_order_relaxed))};
+
+            hal::detail::DmaIRQ::detach(channel);
+            dma_channel_unclaim(channel);
+            transfer.channel.store(-1, std::memory_order_release);
+        }
+
+        static void dmaIRQHandler(const uint channel, void * const context) {
+
+            static_cast<PioUART *>(context)->handleDmaIRQ(channel);
+        }
+    };
+
+} // namespace hal::peripherals::uart
+
+#endif //EMBEDDEDLIBRARY_PIOUART_RP2040_H
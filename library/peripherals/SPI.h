@@ -0,0 +1,44 @@
+/**
+ * @file SPI.h
+ * @brief Provide the SPI master
+ *
+ * @ref hal::interfaces::InterfaceSPI::transfer() "transfer()" exchanges bytes full duplex, optionally with the chip
+ * select of a device, any @ref hal::interfaces::InterfaceDigitalGPIO "InterfaceDigitalGPIO", driven low around it.
+ * @ref hal::interfaces::InterfaceSPI::transferAsync() "transferAsync()" queues a
+ * @ref hal::peripherals::spi::Transaction "Transaction": the queued transactions run back to back, the next one
+ * starts as soon as the previous one completes, so the bus stays busy while the CPU does something else.
+ *
+ * On RP2040 every exchange is moved by two DMA channels, one per direction: at 50 MHz the CPU cannot feed the FIFOs
+ * byte per byte. The DMA interrupt completes a queued transaction and starts the next one.
+ * On host the bus loops MOSI back to MISO, or is wired to a @ref hal::host::SPIDevice "SPIDevice".
+ *
+ * @code{cpp}
+ * auto &spi{hal::peripherals::spi::SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+ * spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+ *
+ * hal::peripherals::gpio::DigitalInOut display_cs{hal::GPIO17};
+ * display_cs.write(1);
+ *
+ * hal::peripherals::spi::Transaction lines[4];
+ *
+ * for(size_t i{0}; i < 4; i++) {
+ *     lines[i] = {&display_cs, framebuffer[i], {}};
+ *     spi.transferAsync(lines[i]);
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_SPI_H
+#define EMBEDDEDLIBRARY_SPI_H
+
+#include "../interfaces/InterfaceSPI.h"
+
+#ifdef HAL_RP2040
+#include "SPI_rp2040.h"
+#elif defined(HAL_HOST)
+#include "SPI_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+#endif //EMBEDDEDLIBRARY_SPI_H
@@ -0,0 +1,381 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_SPI_HOST_H
+#define EMBEDDEDLIBRARY_SPI_HOST_H
+
+#include "../commons/commons.h"
+
+#include "SPI.h"
+#include "../data_structures/SpscRing.h"
+#include "../trace/Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace hal::host {
+
+    /**
+     * Device simulated on the bus of a host @ref hal::peripherals::spi::SPI "SPI".
+     */
+    class SPIDevice {
+    public:
+
+        virtual ~SPIDevice() =default;
+
+        /**
+         * Exchange one frame: the master shifts a byte out on MOSI while the device shifts one out on MISO.
+         *
+         * @param mosi byte sent by the master
+         * @return byte sent by the device
+         */
+        virtual uint8_t exchange(uint8_t mosi)=0;
+    };
+
+    /**
+     * MOSI wired to MISO: every byte sent is received back.
+     */
+    class SPILoopback : public SPIDevice {
+    public:
+
+        uint8_t exchange(const uint8_t mosi) override {
+
+            return mosi;
+        }
+    };
+
+} // namespace hal::host
+
+namespace hal::peripherals::spi {
+
+    /**
+     * Host implementation of the SPI master.
+     *
+     * The bus is in memory and loops MOSI back to MISO, unless a @ref hal::host::SPIDevice "SPIDevice" is plugged
+     * with @ref SPI::setDevice() "setDevice()".
+     *
+     * @code{cpp}
+     * auto &spi{hal::peripherals::spi::SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+     * spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+     *
+     * const uint8_t tx[]{1, 2, 3};
+     * uint8_t rx[3];
+     * spi.transfer(tx, rx); // rx == {1, 2, 3}
+     * @endcode
+     *
+     * The queued transactions are served by a thread started with the first one, it stands in for the DMA
+     * and calls the callbacks.
+     */
+    class SPI : public interfaces::InterfaceSPI {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~SPI() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        bool init(const uint sck_pin, const uint mosi_pin, const uint miso_pin, const uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            m_initialised = true;
+            m_baudrate = baudrate;
+            m_mode = Mode::MODE0;
+            setPins(sck_pin, mosi_pin, miso_pin);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            abort();
+            stopTransferThread();
+
+            m_last_error = Error::NONE;
+
+            m_initialised = false;
+
+            return m_last_error != Error::NONE;
+        }
+
+        using InterfaceSPI::transfer;
+
+        bool transfer(const std::span<const uint8_t> tx, const std::span<uint8_t> rx) override {
+
+            HAL_TRACE_SCOPE("spi.transfer");
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(isBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            m_last_error = validate(tx, rx);
+
+            if(m_last_error == Error::NONE) {
+                exchange(tx, rx);
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool transferAsync(Transaction &transaction) override {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            m_last_error = validate(transaction.tx, transaction.rx);
+
+            if(m_last_error != Error::NONE) {
+
+                transaction.error = m_last_error;
+                return true;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{m_transfer_mutex};
+
+                if(!m_queue.push(&transaction)) {
+
+                    m_last_error = Error::AGAIN;
+                    return true;
+                }
+
+                m_pending.fetch_add(1, std::memory_order_release);
+            }
+
+            if(!m_transfer_thread.joinable()) {
+
+                m_transfer_thread = std::thread{&SPI::serveTransactions, this};
+            }
+
+            m_transfer_event.notify_all();
+
+            return false;
+        }
+
+        [[nodiscard]] bool isBusy() const override {
+
+            return m_pending.load(std::memory_order_acquire) > 0;
+        }
+
+        size_t abort() override {
+
+            std::unique_lock<std::mutex> lock{m_transfer_mutex};
+
+            // The thread does not start another transaction once it is set
+            m_abort = true;
+            m_transfer_event.wait(lock, [this]() { return !m_running; });
+
+            size_t dropped{0};
+            Transaction *transaction;
+
+            while(m_queue.pop(transaction)) {
+
+                transaction->error = Error::AGAIN;
+                dropped++;
+            }
+
+            m_pending.fetch_sub(dropped, std::memory_order_release);
+            m_abort = false;
+
+            return dropped;
+        }
+
+        using InterfaceSPI::setPins;
+
+        bool setPins(const uint sck_pin, const uint mosi_pin, const uint miso_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_sck_pin = sck_pin;
+            m_mosi_pin = mosi_pin;
+            m_miso_pin = miso_pin;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool setMode(const Mode mode) override {
+
+            m_last_error = Error::NONE;
+
+            m_mode = mode;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? baudrate : m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        /**
+         * Plug a simulated device on the bus, in place of the loopback.
+         *
+         * @note Call it while no transaction is queued.
+         *
+         * @param device device, nullptr to loop MOSI back to MISO again
+         */
+        void setDevice(host::SPIDevice * const device) {
+
+            m_device = device != nullptr ? device : &m_loopback;
+        }
+
+        static SPI &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case SPI_INSTANCE0:
+                    static SPI s_spi_instance0{static_cast<SPIInstance>(instance)};
+                    return s_spi_instance0;
+
+                case SPI_INSTANCE1:
+                    static SPI s_spi_instance1{static_cast<SPIInstance>(instance)};
+                    return s_spi_instance1;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit SPI(const SPIInstance instance)
+        : InterfaceSPI(), m_initialised{false}, m_loopback{}, m_device{&m_loopback} {
+
+            m_instance = instance;
+        }
+
+        bool m_initialised;             ///< Whether init() was called
+        host::SPILoopback m_loopback;   ///< Device used when none is plugged
+        host::SPIDevice *m_device;      ///< Device on the bus
+
+        data_structures::SpscRing<Transaction *, SPI_QUEUE_SIZE> m_queue;  ///< Filled by transferAsync(), emptied by the thread
+        std::atomic<size_t> m_pending{0};   ///< Transactions queued or running, decreased once their callback returns
+
+        std::thread m_transfer_thread;              ///< Stand in for the DMA
+        std::mutex m_transfer_mutex;                ///< Protect the queue and the flags below
+        std::condition_variable m_transfer_event;   ///< Wake the thread, or abort() once a transaction completes
+        bool m_running{false};                      ///< Whether the thread is executing a transaction
+        bool m_abort{false};                        ///< Whether abort() waits for the running transaction
+        bool m_transfer_stop{false};                ///< Whether the thread must stop
+
+    private:
+
+        void exchange(const std::span<const uint8_t> tx, const std::span<uint8_t> rx) {
+
+            const size_t length{std::max(tx.size(), rx.size())};
+
+            for(size_t i{0}; i < length; i++) {
+
+                const uint8_t miso{m_device->exchange(tx.empty() ? FILL_BYTE : tx[i])};
+
+                if(!rx.empty()) {
+                    rx[i] = miso;
+                }
+            }
+        }
+
+        void stopTransferThread() {
+
+            if(!m_transfer_thread.joinable()) {
+
+                return;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{m_transfer_mutex};
+                m_transfer_stop = true;
+            }
+
+            m_transfer_event.notify_all();
+            m_transfer_thread.join();
+
+            m_transfer_stop = false;
+        }
+
+        /**
+         * Body of the transfer thread: execute the queued transactions in order, without the lock, and call their
+         * callbacks.
+         */
+        void serveTransactions() {
+
+            std::unique_lock<std::mutex> lock{m_transfer_mutex};
+
+            while(true) {
+
+                m_transfer_event.wait(lock, [this]() {
+                    return m_transfer_stop or (!m_abort and !m_queue.empty());
+                });
+
+                if(m_transfer_stop) {
+
+                    return;
+                }
+
+                Transaction *transaction;
+                m_queue.pop(transaction);
+                m_running = true;
+
+                lock.unlock();
+
+                if(transaction->cs != nullptr) {
+                    transaction->cs->write(0);
+                }
+
+                exchange(transaction->tx, transaction->rx);
+
+                if(transaction->cs != nullptr) {
+                    transaction->cs->write(1);
+                }
+
+                transaction->error = Error::NONE;
+
+                if(transaction->callback != nullptr) {
+                    transaction->callback(Error::NONE, std::max(transaction->tx.size(), transaction->rx.size()), transaction->context);
+                }
+
+                lock.lock();
+
+                m_running = false;
+                m_pending.fetch_sub(1, std::memory_order_release);
+                m_transfer_event.notify_all();
+            }
+        }
+    };
+
+} // namespace hal::peripherals::spi
+
+#endif //EMBEDDEDLIBRARY_SPI_HOST_H
@@ -0,0 +1,393 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_SPI_RP2040_H
+#define EMBEDDEDLIBRARY_SPI_RP2040_H
+
+#include "../commons/commons.h"
+
+#include "SPI.h"
+#include "../data_structures/SpscRing.h"
+#include "../trace/Trace.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/spi.h"
+#include "hardware/sync.h"
+
+static inline spi_inst_t *hal_to_rp2040_inst(hal::peripherals::SPIInstance instance) {
+
+    return instance == hal::peripherals::SPI_INSTANCE0 ? spi0 : spi1;
+}
+
+namespace hal::peripherals::spi {
+
+    /**
+     * RP2040 implementation of the SPI master.
+     *
+     * Every exchange is moved by two DMA channels claimed by init(): one feeds the TX FIFO from tx, or repeats
+     * FILL_BYTE, the other empties the RX FIFO into rx, or into a scratch byte. Both are paced by the DREQ of the SPI
+     * and started together. The RX channel completes last, once the last frame is shifted in: its interrupt
+     * completes a queued transaction and starts the next one.
+     *
+     * @note An instance is meant to be used from one core, transferAsync() masks the interrupts of the calling core
+     * only.
+     */
+    class SPI : public interfaces::InterfaceSPI {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~SPI() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * @return whether an error occurred, Error::ERROR if two DMA channels are not free
+         */
+        bool init(const uint sck_pin, const uint mosi_pin, const uint miso_pin, const uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            const int tx_channel{dma_claim_unused_channel(false)};
+            const int rx_channel{tx_channel < 0 ? -1 : dma_claim_unused_channel(false)};
+
+            if(rx_channel < 0) {
+
+                if(tx_channel >= 0) {
+                    dma_channel_unclaim(static_cast<uint>(tx_channel));
+                }
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            m_tx_channel = static_cast<uint>(tx_channel);
+            m_rx_channel = static_cast<uint>(rx_channel);
+
+            m_baudrate = spi_init(hal_to_rp2040_inst(m_instance), baudrate);
+            setPins(sck_pin, mosi_pin, miso_pin);
+            setMode(Mode::MODE0);
+
+            hal::detail::DmaIRQ::attach(m_rx_channel, dmaIRQHandler, this);
+
+            m_initialised = true;
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            abort();
+
+            m_last_error = Error::NONE;
+
+            hal::detail::DmaIRQ::detach(m_rx_channel);
+            dma_channel_unclaim(m_tx_channel);
+            dma_channel_unclaim(m_rx_channel);
+            spi_deinit(hal_to_rp2040_inst(m_instance));
+
+            m_initialised = false;
+
+            return m_last_error != Error::NONE;
+        }
+
+        using InterfaceSPI::transfer;
+
+        bool transfer(const std::span<const uint8_t> tx, const std::span<uint8_t> rx) override {
+
+            HAL_TRACE_SCOPE("spi.transfer");
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(isBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            m_last_error = validate(tx, rx);
+
+            if(m_last_error == Error::NONE) {
+
+                startExchange(tx, rx, false);
+                dma_channel_wait_for_finish_blocking(m_rx_channel);
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool transferAsync(Transaction &transaction) override {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            m_last_error = validate(transaction.tx, transaction.rx);
+
+            if(m_last_error != Error::NONE) {
+
+                transaction.error = m_last_error;
+                return true;
+            }
+
+            // The interrupt pops the queue and clears m_running, it must not run in between
+            const uint32_t status{save_and_disable_interrupts()};
+
+            if(!m_queue.push(&transaction)) {
+
+                m_last_error = Error::AGAIN;
+            } else if(!m_running.load(std::memory_order_relaxed)) {
+
+                m_running.store(true, std::memory_order_release);
+                startNext();
+            }
+
+            restore_interrupts(status);
+
+            return m_last_error != Error::NONE;
+        }
+
+        [[nodiscard]] bool isBusy() const override {
+
+            return m_running.load(std::memory_order_acquire);
+        }
+
+        size_t abort() override {
+
+            if(!isBusy()) {
+
+                return 0;
+            }
+
+            m_dropped = 0;
+            m_abort = true;
+
+            while(isBusy()) {
+                tight_loop_contents();
+            }
+
+            m_abort = false;
+
+            return m_dropped;
+        }
+
+        using InterfaceSPI::setPins;
+
+        bool setPins(const uint sck_pin, const uint mosi_pin, const uint miso_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_sck_pin = sck_pin;
+            m_mosi_pin = mosi_pin;
+            m_miso_pin = miso_pin;
+
+            gpio_set_function(m_sck_pin, GPIO_FUNC_SPI);
+            gpio_set_function(m_mosi_pin, GPIO_FUNC_SPI);
+            gpio_set_function(m_miso_pin, GPIO_FUNC_SPI);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool setMode(const Mode mode) override {
+
+            m_last_error = Error::NONE;
+
+            m_mode = mode;
+
+            const auto cpol{static_cast<spi_cpol_t>(mode == Mode::MODE2 or mode == Mode::MODE3)};
+            const auto cpha{static_cast<spi_cpha_t>(mode == Mode::MODE1 or mode == Mode::MODE3)};
+
+            spi_set_format(hal_to_rp2040_inst(m_instance), 8, cpol, cpha, SPI_MSB_FIRST);
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? spi_set_baudrate(hal_to_rp2040_inst(m_instance), baudrate) : m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_initialised;
+        }
+
+        /**
+         * Complete the running transaction and start the next one.
+         *
+         * @note Called from the DMA_IRQ_0 handler once the RX channel completed, see
+         * @ref hal::detail::DmaIRQ "DmaIRQ".
+         */
+        void handleDmaIRQ() {
+
+            if(!isBusy()) {
+
+                return;
+            }
+
+            HAL_TRACE_SCOPE("spi.dma_irq");
+
+            Transaction &done{*m_current};
+
+            if(done.cs != nullptr) {
+                done.cs->write(1);
+            }
+
+            done.error = Error::NONE;
+
+            if(m_abort) {
+
+                Transaction *transaction;
+
+                while(m_queue.pop(transaction)) {
+
+                    transaction->error = Error::AGAIN;
+                    m_dropped++;
+                }
+            }
+
+            // Start the next transaction before the callback, the bus does not wait for it
+            bool started{startNext()};
+
+            if(done.callback != nullptr) {
+                done.callback(Error::NONE, std::max(done.tx.size(), done.rx.size()), done.context);
+            }
+
+            // The callback may have queued a transaction
+            if(!started) {
+                started = !m_abort and startNext();
+            }
+
+            if(!started) {
+
+                dma_channel_set_irq0_enabled(m_rx_channel, false);
+                m_running.store(false, std::memory_order_release);
+            }
+        }
+
+        static SPI &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case SPI_INSTANCE0:
+                    static SPI s_spi_instance0{static_cast<SPIInstance>(instance)};
+                    return s_spi_instance0;
+
+                case SPI_INSTANCE1:
+                    static SPI s_spi_instance1{static_cast<SPIInstance>(instance)};
+                    return s_spi_instance1;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit SPI(const SPIInstance instance)
+        : InterfaceSPI(), m_initialised{false}, m_tx_channel{0}, m_rx_channel{0}, m_current{nullptr} {
+
+            m_instance = instance;
+        }
+
+        bool m_initialised;     ///< Whether init() was called
+        uint m_tx_channel;      ///< DMA channel feeding the TX FIFO
+        uint m_rx_channel;      ///< DMA channel emptying the RX FIFO, its interrupt ends an exchange
+
+        uint8_t m_fill{FILL_BYTE};  ///< Repeated on MOSI when tx is empty
+        uint8_t m_scratch{0};       ///< Receive the bytes when rx is empty
+
+        data_structures::SpscRing<Transaction *, SPI_QUEUE_SIZE> m_queue;  ///< Filled by transferAsync(), emptied by the interrupt
+        Transaction *m_current;                 ///< Transaction moved by the DMA
+        std::atomic<bool> m_running{false};     ///< Whether queued transactions are running
+        volatile bool m_abort{false};           ///< Whether abort() waits for the running transaction
+        volatile size_t m_dropped{0};           ///< Transactions dropped by abort()
+
+    private:
+
+        /**
+         * Program both channels for an exchange and start them at once.
+         *
+         * @param irq whether the RX channel raises DMA_IRQ_0 on completion
+         */
+        void startExchange(const std::span<const uint8_t> tx, const std::span<uint8_t> rx, const bool irq) {
+
+            spi_inst_t *spi{hal_to_rp2040_inst(m_instance)};
+            const size_t length{std::max(tx.size(), rx.size())};
+
+            dma_channel_config tx_config{dma_channel_get_default_config(m_tx_channel)};
+            channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+            channel_config_set_read_increment(&tx_config, !tx.empty());
+            channel_config_set_write_increment(&tx_config, false);
+            channel_config_set_dreq(&tx_config, spi_get_dreq(spi, true));
+            dma_channel_configure(m_tx_channel, &tx_config, &spi_get_hw(spi)->dr, tx.empty() ? &m_fill : tx.data(), length, false);
+
+            dma_channel_config rx_config{dma_channel_get_default_config(m_rx_channel)};
+            channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+            channel_config_set_read_increment(&rx_config, false);
+            channel_config_set_write_increment(&rx_config, !rx.empty());
+            channel_config_set_dreq(&rx_config, spi_get_dreq(spi, false));
+            dma_channel_configure(m_rx_channel, &rx_config, rx.empty() ? &m_scratch : rx.data(), &spi_get_hw(spi)->dr, length, false);
+
+            // A blocking exchange leaves the raw interrupt of the channel set
+            dma_channel_acknowledge_irq0(m_rx_channel);
+            dma_channel_set_irq0_enabled(m_rx_channel, irq);
+
+            dma_start_channel_mask((1U << m_tx_channel) | (1U << m_rx_channel));
+        }
+
+        /**
+         * Pop the next queued transaction, drive its chip select low and start it.
+         *
+         * @return whether a transaction was started
+         */
+        bool startNext() {
+
+            if(!m_queue.pop(m_current)) {
+
+                return false;
+            }
+
+            if(m_current->cs != nullptr) {
+                m_current->cs->write(0);
+            }
+
+            startExchange(m_current->tx, m_current->rx, true);
+
+            return true;
+        }
+
+        static void dmaIRQHandler(const uint, void * const context) {
+
+            static_cast<SPI *>(context)->handleDmaIRQ();
+        }
+    };
+
+} // namespace hal::peripherals::spi
+
+#endif //EMBEDDEDLIBRARY_SPI_RP2040_H
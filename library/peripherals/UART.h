@@ -9,6 +9,8 @@
 
 #ifdef HAL_RP2040
 #include "UART_rp2040.h"
+#elif defined(HAL_HOST)
+#include "UART_host.h"
 // #elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) // NOTE: NOT IMPLEMENTED YET
 // #include "UART_atmega328p.h"
 #else
@@ -0,0 +1,850 @@
+//
+// Created by marmelade on 30/10/22.
+//
+
+#ifndef EMBEDDEDLIBRARY_UART_HOST_H
+#define EMBEDDEDLIBRARY_UART_HOST_H
+
+#include "../commons/commons.h"
+
+#include "UART.h"
+#include "../data_structures/SpscRing.h"
+#include "../trace/Trace.h"
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <mutex>
+#include <poll.h>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace hal::peripherals::uart {
+
+    /**
+     * Host implementation of the UART.
+     *
+     * The wire is a Linux socketpair: the UART owns one end, the other end is given
+     * by @ref UART::getPeer() "getPeer()" so a test or a benchmark can play the remote device.
+     *
+     * @code{cpp}
+     * auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+     * uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+     *
+     * uart.write('a');
+     * char c;
+     * ::read(uart.getPeer(), &c, 1); // c == 'a'
+     * @endcode
+     *
+     * In buffered mode there is no interrupt on the host, @ref UART::raiseIRQ() "raiseIRQ()" stands in for it:
+     * it moves the bytes between the socket and the rings the same way the RP2040 interrupt handler does.
+     *
+     * The asynchronous transfers are served by a thread started with the first one, it stands in for the DMA
+     * and calls the callbacks.
+     */
+    class UART : public interfaces::InterfaceUART {
+    public:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~UART() override {
+
+            if(isInitialised()) {
+
+                deinit();
+            }
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        bool init(uint rx_pin, uint tx_pin, uint baudrate) override {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised()) {
+
+                int fds[2];
+
+                if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+
+                    m_last_error = Error::ERROR;
+                    return true;
+                }
+
+                m_fd = fds[0];
+                m_peer_fd = fds[1];
+                m_closed.store(false, std::memory_order_relaxed);
+            }
+
+            m_baudrate = baudrate;
+            setPins(rx_pin, tx_pin);
+            setFormat(8, 1, Parity::PARITY_NONE);
+
+            return m_last_error != Error::NONE;
+        }
+
+        bool deinit() override {
+
+            abortWrite();
+            abortRead();
+            stopTransferThread();
+
+            if(m_buffered) {
+
+                setBuffered(false);
+            }
+
+            m_last_error = Error::NONE;
+
+            if(m_fd >= 0) {
+
+                close(m_fd);
+                close(m_peer_fd);
+            }
+
+            m_fd = -1;
+            m_peer_fd = -1;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint8_t read() override {
+
+            uint8_t byte{0};
+
+            read(&byte, 1);
+
+            return byte;
+        }
+
+        void read(uint8_t *buffer, const size_t length) override {
+
+            // The bytes belong to the buffer of readAsync()
+            if(isReadBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
+
+            if(m_buffered) {
+
+                for(size_t received{0}, count{0}; received < length; received += count) {
+
+                    if(tryRead(buffer + received, length - received, count) == Error::AGAIN) {
+
+                        // Nothing more will come, poll() would not wait anymore
+                        if(m_closed.load(std::memory_order_acquire)) {
+
+                            m_last_error = Error::ERROR;
+                            return;
+                        }
+
+                        waitEvents(POLLIN);
+                        raiseIRQ();
+                    }
+                }
+
+                m_last_error = Error::NONE;
+                return;
+            }
+
+            m_last_error = Error::NONE;
+
+            for(size_t received{0}; received < length;) {
+
+                const ssize_t ret{::read(m_fd, buffer + received, length - received)};
+
+                if(ret <= 0) {
+
+                    if(ret < 0 and errno == EINTR) {
+                        continue;
+                    }
+
+                    m_last_error = Error::ERROR;
+                    return;
+                }
+
+                received += static_cast<size_t>(ret);
+                HAL_STATS_ADD(m_stats.bytes_read, ret);
+            }
+        }
+
+        void write(const uint8_t buffer) override {
+
+            write(&buffer, 1);
+        }
+
+        void write(const uint8_t * const buffer, const size_t length) override {
+
+            HAL_TRACE_SCOPE("uart.write");
+
+            // Its bytes would be interleaved with the ones of writeAsync()
+            if(isWriteBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
+
+            bool stalled{false};
+
+            if(m_buffered) {
+
+                for(size_t sent{0}, count{0}; sent < length; sent += count) {
+
+                    const enum Error error{tryWrite(buffer + sent, length - sent, count)};
+
+                    // The wire is closed, poll() would not wait anymore
+                    if(error == Error::ERROR) {
+                        break;
+                    }
+
+                    if(error == Error::AGAIN) {
+                        stalled = true;
+                        waitEvents(POLLOUT);
+                        raiseIRQ();
+                    }
+                }
+
+                if(stalled) {
+                    HAL_STATS_ADD(m_stats.tx_stalls, 1);
+                }
+
+                return;
+            }
+
+            m_last_error = Error::NONE;
+
+            // Do not block in send(), to tell when the wire is full
+            for(size_t sent{0}; sent < length;) {
+
+                const ssize_t ret{send(m_fd, buffer + sent, length - sent, MSG_DONTWAIT | MSG_NOSIGNAL)};
+
+                if(ret < 0) {
+
+                    if(errno == EAGAIN) {
+                        stalled = true;
+                        waitEvents(POLLOUT);
+                        continue;
+                    }
+
+                    if(errno == EINTR) {
+                        continue;
+                    }
+
+                    m_last_error = Error::ERROR;
+                    break;
+                }
+
+                sent += static_cast<size_t>(ret);
+                HAL_STATS_ADD(m_stats.bytes_written, ret);
+            }
+
+            if(stalled) {
+                HAL_STATS_ADD(m_stats.tx_stalls, 1);
+            }
+        }
+
+        /**
+         * Send several buffers with sendmsg(), as many as possible per system call.
+         * The buffered mode writes them one after the other into the TX ring.
+         * Nothing is sent while writeAsync() runs, the error is Error::AGAIN then.
+         */
+        void writev(const std::span<const std::span<const uint8_t>> buffers) override {
+
+            HAL_TRACE_SCOPE("uart.writev");
+
+            // Its bytes would be interleaved with the ones of the transfer
+            if(isWriteBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
+
+            if(m_buffered) {
+
+                InterfaceUART::writev(buffers);
+                return;
+            }
+
+            m_last_error = Error::NONE;
+
+            // Next byte to send: buffers[index][offset]
+            size_t index{0};
+            size_t offset{0};
+            bool stalled{false};
+
+            while(true) {
+
+                while(index < buffers.size() and offset == buffers[index].size()) {
+                    index++;
+                    offset = 0;
+                }
+
+                iovec iov[WRITEV_BATCH];
+                size_t count{0};
+
+                for(size_t i{index}; i < buffers.size() and count < WRITEV_BATCH; i++) {
+
+                    const size_t skip{i == index ? offset : 0};
+
+                    if(buffers[i].size() > skip) {
+                        iov[count++] = {const_cast<uint8_t *>(buffers[i].data() + skip), buffers[i].size() - skip};
+                    }
+                }
+
+                if(count == 0) {
+
+                    if(stalled) {
+                        HAL_STATS_ADD(m_stats.tx_stalls, 1);
+                    }
+
+                    return;
+                }
+
+                msghdr message{};
+                message.msg_iov = iov;
+                message.msg_iovlen = count;
+
+                const ssize_t ret{sendmsg(m_fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL)};
+
+                if(ret < 0) {
+
+                    if(errno == EAGAIN) {
+                        stalled = true;
+                        waitEvents(POLLOUT);
+                        continue;
+                    }
+
+                    if(errno == EINTR) {
+                        continue;
+                    }
+
+                    m_last_error = Error::ERROR;
+                    return;
+                }
+
+                HAL_STATS_ADD(m_stats.bytes_written, ret);
+
+                // Skip what was sent, a partial send can stop in the middle of a buffer
+                for(auto sent{static_cast<size_t>(ret)}; sent > 0;) {
+
+                    const size_t step{hal::min(sent, buffers[index].size() - offset)};
+
+                    offset += step;
+                    sent -= step;
+
+                    if(offset == buffers[index].size()) {
+                        index++;
+                        offset = 0;
+                    }
+                }
+            }
+        }
+
+        bool writeAsync(const std::span<const uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            return startTransfer(m_tx_transfer, buffer, callback, context);
+        }
+
+        bool readAsync(const std::span<uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            return startTransfer(m_rx_transfer, buffer, callback, context);
+        }
+
+        [[nodiscard]] bool isWriteBusy() const override {
+
+            return m_tx_transfer.busy.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] bool isReadBusy() const override {
+
+            return m_rx_transfer.busy.load(std::memory_order_acquire);
+        }
+
+        size_t abortWrite() override {
+
+            return abortTransfer(m_tx_transfer);
+        }
+
+        size_t abortRead() override {
+
+            return abortTransfer(m_rx_transfer);
+        }
+
+        using InterfaceUART::setPins;
+
+        bool setPins(const uint rx_pin, const uint tx_pin) override {
+
+            m_last_error = Error::NONE;
+
+            m_rx_pin = rx_pin;
+            m_tx_pin = tx_pin;
+
+            return m_last_error != Error::NONE;
+        }
+
+        uint setBaudrate(const uint baudrate) override {
+
+            return m_baudrate = isInitialised() ? baudrate : m_baudrate;
+        }
+
+        [[nodiscard]] uint getBaudrate() const override {
+
+            return m_baudrate;
+        }
+
+        [[nodiscard]] bool isInitialised() const override {
+
+            return m_fd >= 0;
+        }
+
+        [[nodiscard]] bool isReadable() const override {
+
+            return checkEvents(POLLIN);
+        }
+
+        [[nodiscard]] bool isWritable() const override {
+
+            return checkEvents(POLLOUT);
+        }
+
+        void setFormat(uint data_bits, uint stop_bits, peripherals::uart::Parity parity)  const override {
+
+            // The socketpair carries whole bytes, the frame format has no effect
+            (void)data_bits;
+            (void)stop_bits;
+            (void)parity;
+        }
+
+        void setHWFlow(bool cts, bool rts) override {
+
+            // The socketpair is always flow controlled
+            (void)cts;
+            (void)rts;
+        }
+
+        bool setBuffered(const bool buffered) override {
+
+            m_last_error = Error::NONE;
+
+            if(buffered == m_buffered) {
+
+                return false;
+            }
+
+            // The transfer thread and the rings would both use the socket
+            if(buffered and (isWriteBusy() or isReadBusy())) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(buffered) {
+
+                m_rx_ring.clear();
+                m_tx_ring.clear();
+                m_buffered = true;
+            } else {
+
+                // No interrupt will drain what is left to send, do it here
+                while(!m_tx_ring.empty() and m_last_error == Error::NONE) {
+                    waitEvents(POLLOUT);
+                    raiseIRQ();
+                }
+
+                m_buffered = false;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        [[nodiscard]] bool isBuffered() const override {
+
+            return m_buffered;
+        }
+
+        enum Error tryRead(uint8_t * const buffer, const size_t length, size_t &count) override {
+
+            if(!m_buffered) {
+
+                return InterfaceUART::tryRead(buffer, length, count);
+            }
+
+            count = m_rx_ring.read(buffer, length);
+
+            m_last_error = (count == 0 and length != 0) ? Error::AGAIN : Error::NONE;
+
+            return m_last_error;
+        }
+
+        enum Error tryWrite(const uint8_t * const buffer, const size_t length, size_t &count) override {
+
+            if(!m_buffered) {
+
+                return InterfaceUART::tryWrite(buffer, length, count);
+            }
+
+            count = 0;
+
+            if(m_closed.load(std::memory_order_acquire)) {
+
+                m_last_error = Error::ERROR;
+                return m_last_error;
+            }
+
+            m_last_error = Error::NONE;
+            count = m_tx_ring.write(buffer, length);
+
+            // Prime the TX FIFO like the RP2040 implementation does, with the "interrupt" masked
+            {
+                const std::lock_guard<std::mutex> lock{m_irq_mutex};
+                fillTxFifo();
+            }
+
+            // Left as fillTxFifo() set it when the wire failed
+            if(m_last_error == Error::NONE and count == 0 and length != 0) {
+                m_last_error = Error::AGAIN;
+            }
+
+            return m_last_error;
+        }
+
+        /**
+         * Simulate the UART interrupt in buffered mode.
+         * Move the bytes waiting on the wire into the RX ring and send the TX ring, at most one
+         * FIFO worth of bytes each way.
+         *
+         * @note Bytes that do not fit in the RX ring are left on the wire.
+         */
+        void raiseIRQ() {
+
+            const std::lock_guard<std::mutex> lock{m_irq_mutex};
+
+            if(!m_buffered or !isInitialised()) {
+
+                return;
+            }
+
+            // Receive straight into the RX ring
+            const std::span<uint8_t> slots{m_rx_ring.pushN(FIFO_DEPTH)};
+            const ssize_t ret{slots.empty() ? 0 : recv(m_fd, slots.data(), slots.size(), MSG_DONTWAIT)};
+
+            if(ret > 0) {
+
+                m_rx_ring.commitPush(static_cast<size_t>(ret));
+                HAL_STATS_ADD(m_stats.bytes_read, ret);
+            } else if(ret == 0 and !slots.empty()) {
+
+                // The remote end closed the wire
+                m_closed.store(true, std::memory_order_release);
+            } else if(slots.empty() and checkEvents(POLLIN)) {
+
+                // The RP2040 would drop the bytes, they are only left on the wire here
+                HAL_STATS_ADD(m_stats.overruns, 1);
+            }
+
+            fillTxFifo();
+        }
+
+        /**
+         * Get the file descriptor of the remote end of the wire.
+         *
+         * @return file descriptor of the remote end, -1 if the UART is not initialised
+         */
+        [[nodiscard]] int getPeer() const {
+
+            return m_peer_fd;
+        }
+
+        static UART &getInstance(const uint8_t instance) {
+
+            switch(instance) {
+                default:
+                case UART_INSTANCE0:
+                    static UART s_uart_instance0{static_cast<UARTInstance>(instance)};
+                    return s_uart_instance0;
+
+                case UART_INSTANCE1:
+                    static UART s_uart_instance1{static_cast<UARTInstance>(instance)};
+                    return s_uart_instance1;
+            }
+        }
+
+    protected:
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        explicit UART(const peripherals::UARTInstance instance)
+        : InterfaceUART(), m_fd{-1}, m_peer_fd{-1}, m_buffered{false} {
+
+            m_instance = instance;
+        }
+
+        int m_fd;       ///< UART end of the wire
+        int m_peer_fd;  ///< Remote end of the wire
+
+        bool m_buffered;                    ///< Whether the rings are used
+        std::mutex m_irq_mutex;             ///< Stand in for masking the interrupt
+        std::atomic<bool> m_closed{false};  ///< Whether the remote end closed the wire, seen by raiseIRQ() or fillTxFifo()
+
+        data_structures::SpscRing<uint8_t, UART_RX_BUFFER_SIZE> m_rx_ring;  ///< Filled by raiseIRQ(), emptied by tryRead()
+        data_structures::SpscRing<uint8_t, UART_TX_BUFFER_SIZE> m_tx_ring;  ///< Filled by tryWrite(), emptied by raiseIRQ()
+
+        static constexpr size_t FIFO_DEPTH{32}; ///< Depth of the RP2040 UART FIFOs
+        static constexpr int TRANSFER_POLL_PERIOD{10};  ///< Longest wait of the transfer thread on the socket, in ms
+        static constexpr size_t WRITEV_BATCH{16};       ///< Buffers given to a single sendmsg()
+
+        /**
+         * Asynchronous transfer in one direction.
+         *
+         * @tparam T uint8_t for a read, const uint8_t for a write
+         */
+        template<typename T>
+        struct Transfer {
+
+            std::span<T> data{};                    ///< Bytes to move
+            size_t count{0};                        ///< Bytes moved so far
+            TransferCallback callback{nullptr};     ///< Called from the transfer thread on completion
+            void *context{nullptr};                 ///< Given back to the callback
+            std::atomic<bool> busy{false};          ///< Whether the transfer is running
+        };
+
+        Transfer<const uint8_t> m_tx_transfer;  ///< Started by writeAsync()
+        Transfer<uint8_t> m_rx_transfer;        ///< Started by readAsync()
+
+        std::thread m_transfer_thread;              ///< Stand in for the DMA
+        std::mutex m_transfer_mutex;                ///< Protect the transfers, held while the thread moves bytes
+        std::condition_variable m_transfer_event;   ///< Wake the thread when a transfer starts or it must stop
+        bool m_transfer_stop{false};                ///< Whether the thread must stop
+
+    private:
+
+        template<typename T>
+        bool startTransfer(Transfer<T> &transfer, const std::span<T> data, const TransferCallback callback, void * const context) {
+
+            m_last_error = Error::NONE;
+
+            if(!isInitialised() or m_buffered) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(transfer.busy.load(std::memory_order_acquire)) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(data.empty()) {
+
+                if(callback != nullptr) {
+                    callback(Error::NONE, 0, context);
+                }
+
+                return false;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{m_transfer_mutex};
+
+                transfer.data = data;
+                transfer.count = 0;
+                transfer.callback = callback;
+                transfer.context = context;
+                transfer.busy.store(true, std::memory_order_release);
+            }
+
+            if(!m_transfer_thread.joinable()) {
+
+                m_transfer_thread = std::thread{&UART::serveTransfers, this};
+            }
+
+            m_transfer_event.notify_one();
+
+            return false;
+        }
+
+        template<typename T>
+        size_t abortTransfer(Transfer<T> &transfer) {
+
+            // The thread only moves bytes with the lock held, none move once it is released
+            const std::lock_guard<std::mutex> lock{m_transfer_mutex};
+
+            if(!transfer.busy.load(std::memory_order_relaxed)) {
+
+                return 0;
+            }
+
+            transfer.busy.store(false, std::memory_order_release);
+
+            return transfer.count;
+        }
+
+        void stopTransferThread() {
+
+            if(!m_transfer_thread.joinable()) {
+
+                return;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{m_transfer_mutex};
+                m_transfer_stop = true;
+            }
+
+            m_transfer_event.notify_one();
+            m_transfer_thread.join();
+
+            m_transfer_stop = false;
+        }
+
+        /**
+         * Body of the transfer thread: wait for the socket to be ready and move as many bytes as it accepts,
+         * then call the callbacks of the transfers that completed, without the lock.
+         */
+        void serveTransfers() {
+
+            std::unique_lock<std::mutex> lock{m_transfer_mutex};
+
+            while(true) {
+
+                m_transfer_event.wait(lock, [this]() {
+                    return m_transfer_stop or m_tx_transfer.busy.load(std::memory_order_relaxed) or m_rx_transfer.busy.load(std::memory_order_relaxed);
+                });
+
+                if(m_transfer_stop) {
+
+                    return;
+                }
+
+                pollfd pfd{m_fd, 0, 0};
+                pfd.events = static_cast<short>((m_tx_transfer.busy ? POLLOUT : 0) | (m_rx_transfer.busy ? POLLIN : 0));
+
+                lock.unlock();
+                poll(&pfd, 1, TRANSFER_POLL_PERIOD);
+                lock.lock();
+
+                const Completion tx{(pfd.revents & (POLLOUT | POLLERR | POLLHUP)) ? moveBytes(m_tx_transfer) : Completion{}};
+                const Completion rx{(pfd.revents & (POLLIN | POLLERR | POLLHUP)) ? moveBytes(m_rx_transfer) : Completion{}};
+
+                lock.unlock();
+
+                for(const Completion &completion : {tx, rx}) {
+
+                    if(completion.done and completion.callback != nullptr) {
+                        completion.callback(completion.error, completion.count, completion.context);
+                    }
+                }
+
+                lock.lock();
+            }
+        }
+
+        /**
+         * Transfer that completed, its callback is called once the lock is released.
+         */
+        struct Completion {
+
+            bool done{false};
+            enum Error error{Error::NONE};
+            size_t count{0};
+            TransferCallback callback{nullptr};
+            void *context{nullptr};
+        };
+
+        template<typename T>
+        Completion moveBytes(Transfer<T> &transfer) {
+
+            if(!transfer.busy.load(std::memory_order_relaxed)) {
+
+                return {};
+            }
+
+            ssize_t ret;
+
+            if constexpr (std::is_const_v<T>) {
+                ret = send(m_fd, transfer.data.data() + transfer.count, transfer.data.size() - transfer.count, MSG_DONTWAIT | MSG_NOSIGNAL);
+            } else {
+                ret = recv(m_fd, transfer.data.data() + transfer.count, transfer.data.size() - transfer.count, MSG_DONTWAIT);
+            }
+
+            enum Error error{Error::NONE};
+
+            if(ret > 0) {
+
+                transfer.count += static_cast<size_t>(ret);
+
+                if constexpr (std::is_const_v<T>) {
+                    HAL_STATS_ADD(m_stats.bytes_written, ret);
+                } else {
+                    HAL_STATS_ADD(m_stats.bytes_read, ret);
+                }
+            } else if(ret == 0 or (errno != EAGAIN and errno != EINTR)) {
+
+                // The remote end is gone
+                error = Error::ERROR;
+            }
+
+            if(error == Error::NONE and transfer.count < transfer.data.size()) {
+
+                return {};
+            }
+
+            transfer.busy.store(false, std::memory_order_release);
+
+            return {true, error, transfer.count, transfer.callback, transfer.context};
+        }
+
+        void fillTxFifo() {
+
+            // Send straight from the TX ring, only release what the wire accepted
+            const std::span<const uint8_t> data{m_tx_ring.popN(FIFO_DEPTH)};
+
+            if(data.empty()) {
+
+                return;
+            }
+
+            const ssize_t ret{send(m_fd, data.data(), data.size(), MSG_DONTWAIT | MSG_NOSIGNAL)};
+
+            if(ret > 0) {
+
+                m_tx_ring.commitPop(static_cast<size_t>(ret));
+                HAL_STATS_ADD(m_stats.bytes_written, ret);
+            } else if(ret < 0 and errno != EAGAIN and errno != EINTR) {
+
+                // Nothing will be sent anymore
+                if(errno == EPIPE or errno == ECONNRESET) {
+                    m_closed.store(true, std::memory_order_release);
+                }
+
+                m_last_error = Error::ERROR;
+            }
+        }
+
+        void waitEvents(const short events) const {
+
+            pollfd pfd{m_fd, events, 0};
+
+            poll(&pfd, 1, -1);
+        }
+
+        [[nodiscard]] bool checkEvents(const short events) const {
+
+            pollfd pfd{m_fd, events, 0};
+
+            return isInitialised() and poll(&pfd, 1, 0) == 1 and (pfd.revents & events);
+        }
+
+    };
+
+} // namespace hal::peripherals::uart
+
+#endif //EMBEDDEDLIBRARY_UART_HOST_H
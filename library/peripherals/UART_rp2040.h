@@ -8,7 +8,13 @@
 #include "../commons/commons.h"
 
 #include "UART.h"
+#include "../data_structures/SpscRing.h"
+#include "../trace/Trace.h"
 
+#include <atomic>
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "hardware/uart.h"
 
 static inline uart_inst *hal_to_rp2040_inst(hal::peripherals::UARTInstance instance) {
@@ -16,6 +22,11 @@ static inline uart_inst *hal_to_rp2040_inst(hal::peripherals::UARTInstance insta
     return instance == hal::peripherals::UART_INSTANCE0 ? uart0 : uart1;
 }
 
+static inline uint hal_to_rp2040_irq(hal::peripherals::UARTInstance instance) {
+
+    return instance == hal::peripherals::UART_INSTANCE0 ? UART0_IRQ : UART1_IRQ;
+}
+
 namespace hal::peripherals::uart {
 
     class UART : public interfaces::InterfaceUART {
@@ -24,7 +35,7 @@ namespace hal::peripherals::uart {
         //                   Constructors and Destructor
         //****************************************************************
 
-        UART(UART &&other) noexcept {
+        UART(UART &&other) noexcept : m_buffered{false} {
 
             if(this != &other) {
                 m_rx_pin = other.m_rx_pin;
@@ -90,6 +101,14 @@ namespace hal::peripherals::uart {
 
         bool deinit() override {
 
+            abortWrite();
+            abortRead();
+
+            if(m_buffered) {
+
+                setBuffered(false);
+            }
+
             uart_deinit(hal_to_rp2040_inst(m_instance));
 
             return m_last_error != Error::NONE;
@@ -97,25 +116,310 @@ namespace hal::peripherals::uart {
 
         uint8_t read() override {
 
-            return uart_getc(hal_to_rp2040_inst(m_instance));
+            uint8_t byte{0};
+            read(&byte, 1);
+
+            return byte;
         }
 
         void read(uint8_t *buffer, const size_t length) override {
 
-            uart_read_blocking(hal_to_rp2040_inst(m_instance), buffer, length);
+            // The bytes belong to the buffer of readAsync()
+            if(isReadBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
+
+            if(m_buffered) {
+
+                for(size_t received{0}, count{0}; received < length; received += count) {
+
+                    if(tryRead(buffer + received, length - received, count) == Error::AGAIN) {
+                        tight_loop_contents();
+                    }
+                }
+
+                m_last_error = Error::NONE;
+                return;
+            }
+
+            // Like uart_read_blocking(), but keeps the error bits of the data register
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+            for(size_t i{0}; i < length; i++) {
+
+                while(!uart_is_readable(uart)) {
+                    tight_loop_contents();
+                }
+
+                buffer[i] = receive(uart_get_hw(uart)->dr);
+            }
+
+            m_last_error = Error::NONE;
         }
 
         void write(const uint8_t buffer) override {
 
-            uart_putc(hal_to_rp2040_inst(m_instance), buffer);
+            write(&buffer, 1);
         }
 
         void write(const uint8_t * const buffer, const size_t length) override {
 
-            for(size_t i{0}; i < length; i++) {
+            HAL_TRACE_SCOPE("uart.write");
+
+            // Its bytes would be interleaved with the ones of writeAsync()
+            if(isWriteBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
 
-                uart_putc(hal_to_rp2040_inst(m_instance), buffer[i]);
+            bool stalled{false};
+
+            if(m_buffered) {
+
+                for(size_t sent{0}, count{0}; sent < length; sent += count) {
+
+                    if(tryWrite(buffer + sent, length - sent, count) == Error::AGAIN) {
+                        stalled = true;
+                        tight_loop_contents();
+                    }
+                }
+            } else {
+
+                // Like uart_write_blocking(), but tells when the TX FIFO is full
+                uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+                for(size_t i{0}; i < length; i++) {
+
+                    while(!uart_is_writable(uart)) {
+                        stalled = true;
+                        tight_loop_contents();
+                    }
+
+                    uart_get_hw(uart)->dr = buffer[i];
+                }
+
+                HAL_STATS_ADD(m_stats.bytes_written, length);
+            }
+
+            if(stalled) {
+                HAL_STATS_ADD(m_stats.tx_stalls, 1);
             }
+
+            m_last_error = Error::NONE;
+        }
+
+        /**
+         * Send several buffers with two DMA channels: a data channel paced by the UART DREQ, and a control channel
+         * loading the address and length of the next buffer into it each time it completes.
+         * Falls back to one write() per buffer in buffered mode or when no DMA channel is free.
+         * Nothing is sent while writeAsync() runs, the error is Error::AGAIN then.
+         */
+        void writev(const std::span<const std::span<const uint8_t>> buffers) override {
+
+            HAL_TRACE_SCOPE("uart.writev");
+
+            // Both would feed the TX FIFO
+            if(isWriteBusy()) {
+
+                m_last_error = Error::AGAIN;
+                return;
+            }
+
+            const int data_channel{m_buffered ? -1 : dma_claim_unused_channel(false)};
+            const int control_channel{data_channel < 0 ? -1 : dma_claim_unused_channel(false)};
+
+            if(control_channel < 0) {
+
+                if(data_channel >= 0) {
+                    dma_channel_unclaim(static_cast<uint>(data_channel));
+                }
+
+                InterfaceUART::writev(buffers);
+                return;
+            }
+
+            const auto data{static_cast<uint>(data_channel)};
+            const auto control{static_cast<uint>(control_channel)};
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+            // Quiet: the data channel only raises its interrupt flag on the null descriptor that ends the chain
+            dma_channel_config data_config{dma_channel_get_default_config(data)};
+            channel_config_set_transfer_data_size(&data_config, DMA_SIZE_8);
+            channel_config_set_read_increment(&data_config, true);
+            channel_config_set_write_increment(&data_config, false);
+            channel_config_set_dreq(&data_config, uart_get_dreq(uart, true));
+            channel_config_set_chain_to(&data_config, control);
+            channel_config_set_irq_quiet(&data_config, true);
+            dma_channel_configure(data, &data_config, &uart_get_hw(uart)->dr, nullptr, 0, false);
+
+            // Each descriptor is written to TRANS_COUNT and READ_ADDR_TRIG, the write address wraps every 8 bytes
+            dma_channel_config control_config{dma_channel_get_default_config(control)};
+            channel_config_set_transfer_data_size(&control_config, DMA_SIZE_32);
+            channel_config_set_read_increment(&control_config, true);
+            channel_config_set_write_increment(&control_config, true);
+            channel_config_set_ring(&control_config, true, 3);
+
+            Descriptor descriptors[WRITEV_BATCH + 1];
+
+            for(size_t first{0}; first < buffers.size(); first += WRITEV_BATCH) {
+
+                size_t count{0};
+
+                for(const std::span<const uint8_t> buffer : buffers.subspan(first, hal::min(WRITEV_BATCH, buffers.size() - first))) {
+
+                    if(!buffer.empty()) {
+                        descriptors[count++] = {static_cast<uint32_t>(buffer.size()), buffer.data()};
+                    }
+                }
+
+                if(count == 0) {
+                    continue;
+                }
+
+                for(size_t i{0}; i < count; i++) {
+                    HAL_STATS_ADD(m_stats.bytes_written, descriptors[i].length);
+                }
+
+                descriptors[count] = {0, nullptr};
+
+                dma_hw->intr = 1U << data;
+                dma_channel_configure(control, &control_config, &dma_hw->ch[data].al3_transfer_count, descriptors, 2, true);
+
+                while((dma_hw->intr & (1U << data)) == 0) {
+                    tight_loop_contents();
+                }
+
+                dma_hw->intr = 1U << data;
+            }
+
+            dma_channel_unclaim(control);
+            dma_channel_unclaim(data);
+
+            m_last_error = Error::NONE;
+        }
+
+        bool writeAsync(const std::span<const uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+            return startTransfer(m_tx_transfer, &uart_get_hw(uart)->dr, buffer.data(), buffer.size(), uart_get_dreq(uart, true), callback, context);
+        }
+
+        bool readAsync(const std::span<uint8_t> buffer, const TransferCallback callback=nullptr, void * const context=nullptr) override {
+
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+            return startTransfer(m_rx_transfer, buffer.data(), &uart_get_hw(uart)->dr, buffer.size(), uart_get_dreq(uart, false), callback, context);
+        }
+
+        [[nodiscard]] bool isWriteBusy() const override {
+
+            return m_tx_transfer.channel.load(std::memory_order_acquire) >= 0;
+        }
+
+        [[nodiscard]] bool isReadBusy() const override {
+
+            return m_rx_transfer.channel.load(std::memory_order_acquire) >= 0;
+        }
+
+        size_t abortWrite() override {
+
+            return abortTransfer(m_tx_transfer);
+        }
+
+        size_t abortRead() override {
+
+            return abortTransfer(m_rx_transfer);
+        }
+
+        bool setBuffered(const bool buffered) override {
+
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+            const uint irq{hal_to_rp2040_irq(m_instance)};
+            const irq_handler_t handler{m_instance == UART_INSTANCE0 ? irqHandler0 : irqHandler1};
+
+            m_last_error = Error::NONE;
+
+            if(buffered == m_buffered) {
+
+                return false;
+            }
+
+            // The DMA and the interrupt would both service the FIFOs
+            if(buffered and (isWriteBusy() or isReadBusy())) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(buffered) {
+
+                m_rx_ring.clear();
+                m_tx_ring.clear();
+                m_buffered = true;
+
+                irq_set_exclusive_handler(irq, handler);
+                uart_set_irq_enables(uart, true, false);
+                irq_set_enabled(irq, true);
+            } else {
+
+                // Let the interrupt drain what is left to send
+                while(!m_tx_ring.empty()) {
+                    tight_loop_contents();
+                }
+
+                irq_set_enabled(irq, false);
+                uart_set_irq_enables(uart, false, false);
+                irq_remove_handler(irq, handler);
+
+                m_buffered = false;
+            }
+
+            return m_last_error != Error::NONE;
+        }
+
+        [[nodiscard]] bool isBuffered() const override {
+
+            return m_buffered;
+        }
+
+        enum Error tryRead(uint8_t * const buffer, const size_t length, size_t &count) override {
+
+            if(!m_buffered) {
+
+                return InterfaceUART::tryRead(buffer, length, count);
+            }
+
+            count = m_rx_ring.read(buffer, length);
+
+            m_last_error = (count == 0 and length != 0) ? Error::AGAIN : Error::NONE;
+
+            return m_last_error;
+        }
+
+        enum Error tryWrite(const uint8_t * const buffer, const size_t length, size_t &count) override {
+
+            if(!m_buffered) {
+
+                return InterfaceUART::tryWrite(buffer, length, count);
+            }
+
+            const uint irq{hal_to_rp2040_irq(m_instance)};
+
+            count = m_tx_ring.write(buffer, length);
+
+            // Prime the TX FIFO, the interrupt takes over once it drains. The interrupt is masked
+            // because the handler also pops the TX ring.
+            irq_set_enabled(irq, false);
+            fillTxFifo();
+            irq_set_enabled(irq, true);
+
+            m_last_error = (count == 0 and length != 0) ? Error::AGAIN : Error::NONE;
+
+            return m_last_error;
         }
 
         bool setPins(const uint rx_pin, const uint tx_pin) override {
@@ -166,6 +470,54 @@ namespace hal::peripherals::uart {
             uart_set_hw_flow(hal_to_rp2040_inst(m_instance), cts, rts);
         }
 
+        /**
+         * Handle the UART interrupt in buffered mode.
+         * Move the received bytes from the RX FIFO into the RX ring and refill the TX FIFO from the TX ring.
+         *
+         * @note Bytes received while the RX ring is full are dropped, and counted as overruns.
+         */
+        void handleIRQ() {
+
+            HAL_TRACE_SCOPE("uart.irq");
+
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+
+            while(uart_is_readable(uart)) {
+
+                if(!m_rx_ring.push(receive(uart_get_hw(uart)->dr))) {
+                    HAL_STATS_ADD(m_stats.overruns, 1);
+                }
+            }
+
+            fillTxFifo();
+        }
+
+        /**
+         * Complete the asynchronous transfer moved by a DMA channel.
+         *
+         * @param channel channel of the transfer, its interrupt is acknowledged
+         * @note Called from the DMA_IRQ_0 handler, see @ref hal::detail::DmaIRQ "DmaIRQ".
+         */
+        void handleDmaIRQ(const uint channel) {
+
+            HAL_TRACE_SCOPE("uart.dma_irq");
+
+            Transfer &transfer{m_tx_transfer.channel.load(std::memory_order_relaxed) == static_cast<int>(channel) ? m_tx_transfer : m_rx_transfer};
+
+            releaseChannel(transfer);
+
+            if(&transfer == &m_tx_transfer) {
+                HAL_STATS_ADD(m_stats.bytes_written, transfer.length);
+            } else {
+                HAL_STATS_ADD(m_stats.bytes_read, transfer.length);
+            }
+
+            if(transfer.callback != nullptr) {
+
+                transfer.callback(Error::NONE, transfer.length, transfer.context);
+            }
+        }
+
         static UART &getInstance(const uint8_t instance) {
 
             switch(instance) {
@@ -186,7 +538,186 @@ namespace hal::peripherals::uart {
         //****************************************************************
 
         explicit UART(const peripherals::UARTInstance instance)
-        : InterfaceUART() {}
+        : InterfaceUART(), m_buffered{false} {
+
+            m_instance = instance;
+        }
+
+        /**
+         * Buffer of writev(), in the order of the TRANS_COUNT and READ_ADDR_TRIG registers of alias 3.
+         */
+        struct Descriptor {
+
+            uint32_t length;        ///< Number of bytes, 0 with a null address ends the chain
+            const uint8_t *data;    ///< First byte
+        };
+
+        static constexpr size_t WRITEV_BATCH{8};    ///< Buffers chained per DMA sequence, more are sent in several sequences
+
+        /**
+         * Asynchronous transfer in one direction.
+         */
+        struct Transfer {
+
+            std::atomic<int> channel{-1};           ///< DMA channel moving the bytes, -1 when idle
+            size_t length{0};                       ///< Number of bytes to move
+            TransferCallback callback{nullptr};     ///< Called from the DMA interrupt on completion
+            void *context{nullptr};                 ///< Given back to the callback
+        };
+
+        /**
+         * Program a DMA channel paced by the UART DREQ, one byte per request.
+         * Only the FIFO end of the transfer is fixed, the memory end is incremented.
+         */
+        bool startTransfer(Transfer &transfer, volatile void * const write_address, const volatile void * const read_address,
+                           const size_t length, const uint dreq, const TransferCallback callback, void * const context) {
+
+            const bool tx{&transfer == &m_tx_transfer};
+
+            m_last_error = Error::NONE;
+
+            if(m_buffered) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            if(transfer.channel.load(std::memory_order_acquire) >= 0) {
+
+                m_last_error = Error::AGAIN;
+                return true;
+            }
+
+            if(length == 0) {
+
+                if(callback != nullptr) {
+                    callback(Error::NONE, 0, context);
+                }
+
+                return false;
+            }
+
+            const int channel{dma_claim_unused_channel(false)};
+
+            if(channel < 0) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            dma_channel_config config{dma_channel_get_default_config(static_cast<uint>(channel))};
+
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+            channel_config_set_read_increment(&config, tx);
+            channel_config_set_write_increment(&config, !tx);
+            channel_config_set_dreq(&config, dreq);
+
+            transfer.length = length;
+            transfer.callback = callback;
+            transfer.context = context;
+            transfer.channel.store(channel, std::memory_order_release);
+
+            hal::detail::DmaIRQ::attach(static_cast<uint>(channel), dmaIRQHandler, this);
+            dma_channel_set_irq0_enabled(static_cast<uint>(channel), true);
+            dma_channel_configure(static_cast<uint>(channel), &config, write_address, read_address, length, true);
+
+            return false;
+        }
+
+        size_t abortTransfer(Transfer &transfer) {
+
+            const int channel{transfer.channel.load(std::memory_order_acquire)};
+
+            if(channel < 0) {
+
+                return 0;
+            }
+
+            // Disable the interrupt first, an abort can raise it (RP2040-E13)
+            dma_channel_set_irq0_enabled(static_cast<uint>(channel), false);
+            dma_channel_abort(static_cast<uint>(channel));
+            dma_channel_acknowledge_irq0(static_cast<uint>(channel));
+
+            const size_t remaining{dma_channel_hw_addr(static_cast<uint>(channel))->transfer_count};
+
+            releaseChannel(transfer);
+
+            if(&transfer == &m_tx_transfer) {
+                HAL_STATS_ADD(m_stats.bytes_written, transfer.length - remaining);
+            } else {
+                HAL_STATS_ADD(m_stats.bytes_read, transfer.length - remaining);
+            }
+
+            return transfer.length - remaining;
+        }
+
+        static void releaseChannel(Transfer &transfer) {
+
+            const auto channel{static_cast<uint>(transfer.channel.load(std::memory_order_relaxed))};
+
+            hal::detail::DmaIRQ::detach(channel);
+            dma_channel_unclaim(channel);
+            transfer.channel.store(-1, std::memory_order_release);
+        }
+
+        void fillTxFifo() {
+
+            uart_inst *uart{hal_to_rp2040_inst(m_instance)};
+            uint8_t byte;
+
+            while(uart_is_writable(uart) and m_tx_ring.pop(byte)) {
+
+                uart_get_hw(uart)->dr = byte;
+                HAL_STATS_ADD(m_stats.bytes_written, 1);
+            }
+
+            // Only ask for more room in the TX FIFO while there is something left to send
+            uart_set_irq_enables(uart, true, !m_tx_ring.empty());
+        }
+
+        /**
+         * Count a byte read from the data register and its error bits.
+         *
+         * @param dr value of UARTDR
+         * @return byte received
+         */
+        uint8_t receive(const uint32_t dr) {
+
+            HAL_STATS_ADD(m_stats.bytes_read, 1);
+
+            if(dr & (UART_UARTDR_OE_BITS | UART_UARTDR_BE_BITS | UART_UARTDR_PE_BITS | UART_UARTDR_FE_BITS)) {
+
+                HAL_STATS_ADD(m_stats.overruns, (dr & UART_UARTDR_OE_BITS) != 0);
+                HAL_STATS_ADD(m_stats.breaks, (dr & UART_UARTDR_BE_BITS) != 0);
+                HAL_STATS_ADD(m_stats.parity_errors, (dr & UART_UARTDR_PE_BITS) != 0);
+                HAL_STATS_ADD(m_stats.framing_errors, (dr & UART_UARTDR_FE_BITS) != 0);
+            }
+
+            return static_cast<uint8_t>(dr);
+        }
+
+        static void irqHandler0() {
+
+            getInstance(UART_INSTANCE0).handleIRQ();
+        }
+
+        static void irqHandler1() {
+
+            getInstance(UART_INSTANCE1).handleIRQ();
+        }
+
+        static void dmaIRQHandler(const uint channel, void * const context) {
+
+            static_cast<UART *>(context)->handleDmaIRQ(channel);
+        }
+
+        bool m_buffered;    ///< Whether the FIFOs are serviced by the interrupt
+
+        data_structures::SpscRing<uint8_t, UART_RX_BUFFER_SIZE> m_rx_ring;  ///< Filled by the interrupt, emptied by tryRead()
+        data_structures::SpscRing<uint8_t, UART_TX_BUFFER_SIZE> m_tx_ring;  ///< Filled by tryWrite(), emptied by the interrupt
+
+        Transfer m_tx_transfer;     ///< Started by writeAsync()
+        Transfer m_rx_transfer;     ///< Started by readAsync()
 
     };
 
@@ -0,0 +1,581 @@
+/**
+ * @file BufferSerializer.h
+ * @brief Provide an endian-aware serializer writing into and reading from caller-provided buffers
+ *
+ * @ref hal::serialization::BufferWriter "BufferWriter" and @ref hal::serialization::BufferReader "BufferReader"
+ * move any @ref hal::concepts::is_serializable "serializable" value straight between a variable and a
+ * std::span at a cursor, in the byte order of the wire, without intermediate object or clearing.
+ *
+ * Errors are sticky: once a value did not fit (Error::TOOSMALL) every following operation is refused, so a
+ * whole packet can be chained and checked once.
+ *
+ * @code{cpp}
+ * using namespace hal::serialization;
+ *
+ * uint8_t frame[serialized_size_v<uint8_t, uint32_t, float>];
+ * BufferWriter writer{frame, Endian::BIG};
+ * writer << uint8_t{0x01} << timestamp << temperature;
+ *
+ * BufferReader reader{writer.getWritten(), Endian::BIG};
+ * reader >> id >> timestamp >> temperature;
+ *
+ * if(reader.getLastError() != hal::Error::NONE) {
+ *     // Truncated frame
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_BUFFERSERIALIZER_H
+#define EMBEDDEDLIBRARY_BUFFERSERIALIZER_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "../commons/commons.h"
+
+namespace hal::serialization {
+
+    /**
+     * Byte order of the values in the buffer.
+     */
+    enum class Endian : uint8_t {
+        LITTLE,
+        BIG
+    };
+
+    /// Byte order of the platform
+    constexpr Endian NATIVE_ENDIAN{std::endian::native == std::endian::big ? Endian::BIG : Endian::LITTLE};
+
+    /**
+     * Number of bytes taken by a group of values once serialized.
+     *
+     * @tparam Ts types of the values
+     */
+    template<concepts::is_serializable... Ts>
+    constexpr size_t serialized_size_v{(sizeof(Ts) + ... + 0)};
+
+    namespace detail {
+
+        template<size_t S> struct uint_of_size;
+        template<> struct uint_of_size<1> { using type = uint8_t; };
+        template<> struct uint_of_size<2> { using type = uint16_t; };
+        template<> struct uint_of_size<4> { using type = uint32_t; };
+        template<> struct uint_of_size<8> { using type = uint64_t; };
+
+        /// Unsigned integer with the size of T, holding its representation
+        template<concepts::is_serializable T>
+        using raw_t = typename uint_of_size<sizeof(T)>::type;
+
+        template<concepts::is_serializable T>
+        constexpr raw_t<T> toRaw(const T value) {
+
+            if constexpr (std::is_enum_v<T>) {
+                return static_cast<raw_t<T>>(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return value ? 1U : 0U;
+            } else {
+                return std::bit_cast<raw_t<T>>(value);
+            }
+        }
+
+        template<concepts::is_serializable T>
+        constexpr T fromRaw(const raw_t<T> raw) {
+
+            if constexpr (std::is_enum_v<T>) {
+                return static_cast<T>(static_cast<std::underlying_type_t<T>>(raw));
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return raw != 0;
+            } else {
+                return std::bit_cast<T>(raw);
+            }
+        }
+
+        /**
+         * Reverse the bytes of an unsigned integer.
+         */
+        template<std::unsigned_integral T>
+        constexpr T byteswap(const T value) {
+
+            if constexpr (sizeof(T) == 1) {
+                return value;
+            } else {
+
+                T result{0};
+
+                for(size_t i{0}; i < sizeof(T); i++) {
+                    result = static_cast<T>(result | static_cast<T>(static_cast<T>(value >> (8U * i)) & 0xFFU) << (8U * (sizeof(T) - 1 - i)));
+                }
+
+                return result;
+            }
+        }
+
+        /**
+         * Store the representation of a value in the given byte order.
+         */
+        template<concepts::is_serializable T>
+        constexpr void store(uint8_t * const data, const T value, const Endian endian) {
+
+            const raw_t<T> raw{toRaw(value)};
+
+            if(std::is_constant_evaluated()) {
+
+                for(size_t i{0}; i < sizeof(T); i++) {
+                    data[endian == Endian::LITTLE ? i : sizeof(T) - 1 - i] = static_cast<uint8_t>(raw >> (8U * i));
+                }
+            } else {
+
+                // A single, possibly unaligned, store
+                const raw_t<T> ordered{endian == NATIVE_ENDIAN ? raw : byteswap(raw)};
+                std::memcpy(data, &ordered, sizeof(T));
+            }
+        }
+
+        /**
+         * Load the representation of a value in the given byte order.
+         */
+        template<concepts::is_serializable T>
+        constexpr T load(const uint8_t * const data, const Endian endian) {
+
+            raw_t<T> raw{0};
+
+            if(std::is_constant_evaluated()) {
+
+                for(size_t i{0}; i < sizeof(T); i++) {
+                    raw = static_cast<raw_t<T>>(raw | static_cast<raw_t<T>>(static_cast<raw_t<T>>(data[endian == Endian::LITTLE ? i : sizeof(T) - 1 - i]) << (8U * i)));
+                }
+            } else {
+
+                std::memcpy(&raw, data, sizeof(T));
+                raw = endian == NATIVE_ENDIAN ? raw : byteswap(raw);
+            }
+
+            return fromRaw<T>(raw);
+        }
+
+    } // namespace detail
+
+    /**
+     * Serialize values into a caller-provided buffer.
+     */
+    class BufferWriter {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * @param buffer buffer receiving the values, it must outlive the writer
+         * @param endian byte order of the values in the buffer
+         */
+        constexpr explicit BufferWriter(const std::span<uint8_t> buffer, const Endian endian = Endian::LITTLE) :
+                m_buffer{buffer},
+                m_position{0},
+                m_endian{endian},
+                m_last_error{Error::NONE}
+        {}
+
+        //****************************************************************
+        //                           Operators
+        //****************************************************************
+
+        /**
+         * Write a value, check @ref BufferWriter::getLastError() "getLastError()" once the chain is done.
+         *
+         * @param value value to write
+         * @return instance of this class
+         */
+        template<concepts::is_serializable T>
+        constexpr BufferWriter &operator<<(const T value) {
+
+            (void)write(value);
+            return *this;
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Write values at the cursor, there is a single bounds check for the whole group.
+         *
+         * @param values values to write
+         * @return whether an error occurred, nothing is written if they do not all fit
+         */
+        template<concepts::is_serializable... Ts>
+        constexpr bool write(const Ts... values) {
+
+            uint8_t *data{claim(serialized_size_v<Ts...>)};
+
+            if(data == nullptr) {
+
+                return true;
+            }
+
+            ((detail::store(data, values, m_endian), data += sizeof(Ts)), ...);
+
+            return false;
+        }
+
+        /**
+         * Copy raw bytes at the cursor.
+         *
+         * @param bytes bytes to copy
+         * @return whether an error occurred, nothing is written if they do not fit
+         */
+        constexpr bool writeBytes(const std::span<const uint8_t> bytes) {
+
+            uint8_t * const data{claim(bytes.size())};
+
+            if(data == nullptr) {
+
+                return true;
+            }
+
+            std::copy(bytes.begin(), bytes.end(), data);
+
+            return false;
+        }
+
+        /**
+         * Reserve bytes at the cursor to be filled in place, e.g. a payload produced by another module.
+         *
+         * @param length number of bytes to reserve
+         * @return reserved bytes, empty if they do not fit
+         */
+        constexpr std::span<uint8_t> reserve(const size_t length) {
+
+            uint8_t * const data{claim(length)};
+
+            return data == nullptr ? std::span<uint8_t>{} : std::span<uint8_t>{data, length};
+        }
+
+        /**
+         * Move the cursor, e.g. to go back and fill a length field once the payload is written.
+         *
+         * @param position new position of the cursor
+         * @return whether an error occurred, true if position is past the end of the buffer
+         */
+        constexpr bool setPosition(const size_t position) {
+
+            if(position > m_buffer.size()) {
+
+                m_last_error = Error::TOOSMALL;
+                return true;
+            }
+
+            m_position = position;
+
+            return false;
+        }
+
+        [[nodiscard]] constexpr size_t getPosition() const {
+
+            return m_position;
+        }
+
+        [[nodiscard]] constexpr size_t getRemaining() const {
+
+            return m_buffer.size() - m_position;
+        }
+
+        /**
+         * @return bytes written so far, from the start of the buffer to the cursor
+         */
+        [[nodiscard]] constexpr std::span<uint8_t> getWritten() const {
+
+            return m_buffer.first(m_position);
+        }
+
+        /**
+         * Rewind the cursor and clear the error.
+         */
+        constexpr void reset() {
+
+            m_position = 0;
+            m_last_error = Error::NONE;
+        }
+
+        constexpr void setEndian(const Endian endian) {
+
+            m_endian = endian;
+        }
+
+        [[nodiscard]] constexpr Endian getEndian() const {
+
+            return m_endian;
+        }
+
+        [[nodiscard]] constexpr enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+
+        /**
+         * Advance the cursor over length bytes.
+         *
+         * @return start of the bytes, nullptr if they do not fit or a previous operation failed
+         */
+        constexpr uint8_t *claim(const size_t length) {
+
+            // Keep the error of the operation that failed first
+            if(m_last_error != Error::NONE) {
+
+                return nullptr;
+            }
+
+            if(length > m_buffer.size() - m_position) {
+
+                m_last_error = Error::TOOSMALL;
+                return nullptr;
+            }
+
+            uint8_t * const data{m_buffer.data() + m_position};
+            m_position += length;
+
+            return data;
+        }
+
+        std::span<uint8_t> m_buffer;    ///< Buffer receiving the values
+        size_t m_position;              ///< Cursor, next byte to write
+        Endian m_endian;                ///< Byte order of the values in the buffer
+
+        enum Error m_last_error;
+    };
+
+    /**
+     * Deserialize values from a caller-provided buffer.
+     */
+    class BufferReader {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * @param buffer buffer holding the values, it must outlive the reader
+         * @param endian byte order of the values in the buffer
+         */
+        constexpr explicit BufferReader(const std::span<const uint8_t> buffer, const Endian endian = Endian::LITTLE) :
+                m_buffer{buffer},
+                m_position{0},
+                m_endian{endian},
+                m_last_error{Error::NONE}
+        {}
+
+        //****************************************************************
+        //                           Operators
+        //****************************************************************
+
+        /**
+         * Read a value, check @ref BufferReader::getLastError() "getLastError()" once the chain is done.
+         *
+         * @param value value read, left untouched on error
+         * @return instance of this class
+         */
+        template<concepts::is_serializable T>
+        constexpr BufferReader &operator>>(T &value) {
+
+            (void)read(value);
+            return *this;
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Read values at the cursor, there is a single bounds check for the whole group.
+         *
+         * @param values values read, left untouched on error
+         * @return whether an error occurred, nothing is read if the buffer is too short
+         */
+        template<concepts::is_serializable... Ts>
+        constexpr bool read(Ts &... values) {
+
+            const uint8_t *data{claim(serialized_size_v<Ts...>)};
+
+            if(data == nullptr) {
+
+                return true;
+            }
+
+            ((values = detail::load<Ts>(data, m_endian), data += sizeof(Ts)), ...);
+
+            return false;
+        }
+
+        /**
+         * Read a value at the cursor.
+         *
+         * @tparam T type of the value
+         * @param fallback value returned on error
+         * @return value read, fallback on error
+         */
+        template<concepts::is_serializable T>
+        constexpr T get(const T fallback = T{}) {
+
+            T value{fallback};
+            (void)read(value);
+
+            return value;
+        }
+
+        /**
+         * Copy raw bytes from the cursor.
+         *
+         * @param bytes bytes read, the whole span is filled
+         * @return whether an error occurred, nothing is read if the buffer is too short
+         */
+        constexpr bool readBytes(const std::span<uint8_t> bytes) {
+
+            const uint8_t * const data{claim(bytes.size())};
+
+            if(data == nullptr) {
+
+                return true;
+            }
+
+            std::copy_n(data, bytes.size(), bytes.begin());
+
+            return false;
+        }
+
+        /**
+         * Get bytes at the cursor without copying them, e.g. a payload handed to another module.
+         *
+         * @param length number of bytes wanted
+         * @return bytes, empty if the buffer is too short
+         */
+        constexpr std::span<const uint8_t> view(const size_t length) {
+
+            const uint8_t * const data{claim(length)};
+
+            return data == nullptr ? std::span<const uint8_t>{} : std::span<const uint8_t>{data, length};
+        }
+
+        /**
+         * Get bytes at the cursor without consuming them, e.g. to decode a variable length value.
+         *
+         * @param length maximum number of bytes wanted
+         * @return up to length bytes, fewer if the end of the buffer is reached
+         */
+        [[nodiscard]] constexpr std::span<const uint8_t> peek(const size_t length) const {
+
+            return m_last_error != Error::NONE ? std::span<const uint8_t>{}
+                                               : m_buffer.subspan(m_position, hal::min(length, getRemaining()));
+        }
+
+        /**
+         * @param length number of bytes to skip
+         * @return whether an error occurred
+         */
+        constexpr bool skip(const size_t length) {
+
+            return claim(length) == nullptr;
+        }
+
+        constexpr bool setPosition(const size_t position) {
+
+            if(position > m_buffer.size()) {
+
+                m_last_error = Error::TOOSMALL;
+                return true;
+            }
+
+            m_position = position;
+
+            return false;
+        }
+
+        [[nodiscard]] constexpr size_t getPosition() const {
+
+            return m_position;
+        }
+
+        [[nodiscard]] constexpr size_t getRemaining() const {
+
+            return m_buffer.size() - m_position;
+        }
+
+        /**
+         * Rewind the cursor and clear the error.
+         */
+        constexpr void reset() {
+
+            m_position = 0;
+            m_last_error = Error::NONE;
+        }
+
+        constexpr void setEndian(const Endian endian) {
+
+            m_endian = endian;
+        }
+
+        [[nodiscard]] constexpr Endian getEndian() const {
+
+            return m_endian;
+        }
+
+        [[nodiscard]] constexpr enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+        /**
+         * Mark the reader as failed, e.g. from a codec built on top of it that found malformed data.
+         * Every following operation is refused until @ref BufferReader::reset() "reset()".
+         *
+         * @param error error to report
+         */
+        constexpr void fail(const enum Error error) {
+
+            m_last_error = error;
+        }
+
+    protected:
+
+        /**
+         * Advance the cursor over length bytes.
+         *
+         * @return start of the bytes, nullptr if the buffer is too short or a previous operation failed
+         */
+        constexpr const uint8_t *claim(const size_t length) {
+
+            // Keep the error of the operation that failed first
+            if(m_last_error != Error::NONE) {
+
+                return nullptr;
+            }
+
+            if(length > m_buffer.size() - m_position) {
+
+                m_last_error = Error::TOOSMALL;
+                return nullptr;
+            }
+
+            const uint8_t * const data{m_buffer.data() + m_position};
+            m_position += length;
+
+            return data;
+        }
+
+        std::span<const uint8_t> m_buffer;  ///< Buffer holding the values
+        size_t m_position;                  ///< Cursor, next byte to read
+        Endian m_endian;                    ///< Byte order of the values in the buffer
+
+        enum Error m_last_error;
+    };
+
+} // namespace hal::serialization
+
+#endif //EMBEDDEDLIBRARY_BUFFERSERIALIZER_H
@@ -0,0 +1,406 @@
+/**
+ * @file Cobs.h
+ * @brief Provide Consistent Overhead Byte Stuffing (COBS) framing
+ *
+ * COBS removes every 0x00 from a frame for at most one extra byte per 254, so 0x00 can delimit the frames
+ * on a byte stream such as a UART: a receiver that joins mid-stream or loses bytes resynchronises on the
+ * next 0x00.
+ *
+ * - @ref hal::serialization::CobsEncoder "CobsEncoder" streams a frame into any
+ *   @ref hal::concepts::is_byte_writer "byte writer" (e.g. an @ref hal::interfaces::InterfaceUART "UART")
+ *   through a single 255 bytes block, without holding the whole frame.
+ * - @ref hal::serialization::CobsDecoder "CobsDecoder" rebuilds the frames from the received bytes, one at a time
+ *   or a block at a time.
+ * - @ref hal::serialization::cobsEncode() "cobsEncode()" and @ref hal::serialization::cobsDecode() "cobsDecode()"
+ *   work on whole buffers.
+ *
+ * @code{cpp}
+ * auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+ * hal::serialization::CobsEncoder encoder{uart};
+ *
+ * encoder.write(header, sizeof(header));
+ * encoder.write(payload, payload_length);
+ * encoder.end();  // Last block and the 0x00 delimiter
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_COBS_H
+#define EMBEDDEDLIBRARY_COBS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "../commons/commons.h"
+
+namespace hal::serialization {
+
+    /// Delimiter of the COBS frames
+    constexpr uint8_t COBS_DELIMITER{0x00};
+
+    /// Longest run of non-zero bytes in a COBS block
+    constexpr size_t COBS_BLOCK_SIZE{254};
+
+    /**
+     * Maximum size of a COBS encoded frame, without the delimiter.
+     *
+     * @param length size of the frame before encoding
+     * @return size of the encoded frame in the worst case
+     */
+    constexpr size_t cobsMaxEncodedSize(const size_t length) {
+
+        return length + length / COBS_BLOCK_SIZE + 1;
+    }
+
+    /**
+     * Encode frames on the fly into a byte writer.
+     *
+     * @tparam Sink type of the writer, anything with write(const uint8_t *, size_t)
+     */
+    template<concepts::is_byte_writer Sink>
+    class CobsEncoder {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * @param sink writer receiving the encoded bytes, it must outlive the encoder
+         */
+        explicit CobsEncoder(Sink &sink) : m_sink{sink}, m_block{}, m_length{0} {}
+
+        CobsEncoder(const CobsEncoder &)=delete;
+        CobsEncoder &operator=(const CobsEncoder &)=delete;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Add bytes to the current frame, complete blocks are sent to the sink as soon as they are known.
+         *
+         * @param data bytes to add
+         * @param length number of bytes
+         */
+        void write(const uint8_t * const data, const size_t length) {
+
+            const uint8_t * const last{data + length};
+
+            for(const uint8_t *begin{data}; begin < last;) {
+
+                // Copy the run of non-zero bytes up to the next 0x00 or the end of the block
+                const uint8_t * const window_end{begin + hal::min(static_cast<size_t>(last - begin), COBS_BLOCK_SIZE - m_length)};
+                const uint8_t * const end{std::find(begin, window_end, COBS_DELIMITER)};
+
+                std::copy(begin, end, m_block + 1 + m_length);
+                m_length += static_cast<size_t>(end - begin);
+                begin = end;
+
+                // A 0x00 right after a full block is not part of it, the next pass encodes it
+                if(end < window_end) {
+
+                    flush();
+                    begin++;
+                } else if(m_length == COBS_BLOCK_SIZE) {
+
+                    flush();
+                }
+            }
+        }
+
+        void write(const std::span<const uint8_t> data) {
+
+            write(data.data(), data.size());
+        }
+
+        void write(const uint8_t byte) {
+
+            write(&byte, 1);
+        }
+
+        /**
+         * Send the last block of the frame followed by the delimiter.
+         */
+        void end() {
+
+            flush();
+
+            const uint8_t delimiter{COBS_DELIMITER};
+            m_sink.write(&delimiter, 1);
+        }
+
+    private:
+
+        /// Send the current block, its code byte is the distance to the next 0x00
+        void flush() {
+
+            m_block[0] = static_cast<uint8_t>(m_length + 1);
+            m_sink.write(m_block, m_length + 1);
+            m_length = 0;
+        }
+
+        Sink &m_sink;                           ///< Writer receiving the encoded bytes
+        uint8_t m_block[COBS_BLOCK_SIZE + 1];   ///< Code byte then the bytes of the block
+        size_t m_length;                        ///< Number of bytes in the block
+    };
+
+    /**
+     * Rebuild frames from a COBS encoded byte stream.
+     */
+    class CobsDecoder {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        /**
+         * @param frame buffer receiving the decoded frames, it must outlive the decoder
+         */
+        explicit CobsDecoder(const std::span<uint8_t> frame) :
+                m_frame{frame},
+                m_length{0},
+                m_remaining{0},
+                m_code{0xFF},
+                m_discard{false},
+                m_last_error{Error::NONE}
+        {}
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Decode a received byte.
+         *
+         * @param byte byte received
+         * @return Error::NONE when a frame is complete, see @ref CobsDecoder::getFrame() "getFrame()",
+         * Error::AGAIN while the frame is not complete,
+         * Error::TOOBIG if the frame does not fit in the buffer, Error::ERROR if it is malformed.
+         * After an error the bytes are dropped until the next delimiter.
+         */
+        enum Error decode(const uint8_t byte) {
+
+            if(byte == COBS_DELIMITER) {
+
+                const bool discarded{m_discard};
+                const bool truncated{m_remaining > 0};
+                const size_t length{m_length};
+
+                restart();
+
+                if(discarded or (length == 0 and !truncated)) {
+
+                    // End of a dropped frame, or an empty frame used to resynchronise
+                    return Error::AGAIN;
+                }
+
+                m_last_error = truncated ? Error::ERROR : Error::NONE;
+
+                if(!truncated) {
+                    m_size = length;
+                }
+
+                return m_last_error;
+            }
+
+            if(m_discard) {
+
+                return Error::AGAIN;
+            }
+
+            if(m_remaining == 0) {
+
+                // Code byte, the previous block ended with an implicit 0x00 unless it was a full block
+                if(m_code != 0xFF and !append(COBS_DELIMITER)) {
+                    return drop(Error::TOOBIG);
+                }
+
+                m_code = byte;
+                m_remaining = static_cast<uint8_t>(byte - 1);
+
+                return Error::AGAIN;
+            }
+
+            m_remaining--;
+
+            return append(byte) ? Error::AGAIN : drop(Error::TOOBIG);
+        }
+
+        /**
+         * Decode received bytes up to the end of the first complete frame.
+         *
+         * @param data bytes received
+         * @param consumed number of bytes used, decode the rest once the frame has been processed
+         * @return same as @ref CobsDecoder::decode(uint8_t) "decode()" for the last byte used
+         */
+        enum Error decode(const std::span<const uint8_t> data, size_t &consumed) {
+
+            enum Error error{Error::AGAIN};
+
+            for(consumed = 0; consumed < data.size();) {
+
+                error = decode(data[consumed++]);
+
+                if(error != Error::AGAIN) {
+                    break;
+                }
+            }
+
+            return error;
+        }
+
+        /**
+         * @return last complete frame, valid until the next byte is decoded
+         */
+        [[nodiscard]] std::span<const uint8_t> getFrame() const {
+
+            return m_frame.first(m_size);
+        }
+
+        /**
+         * Drop the frame being received.
+         */
+        void reset() {
+
+            restart();
+            m_size = 0;
+            m_last_error = Error::NONE;
+        }
+
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    private:
+
+        /// Start a new frame, the first code byte has no implicit 0x00 before it
+        void restart() {
+
+            m_length = 0;
+            m_remaining = 0;
+            m_code = 0xFF;
+            m_discard = false;
+        }
+
+        bool append(const uint8_t byte) {
+
+            if(m_length == m_frame.size()) {
+                return false;
+            }
+
+            m_frame[m_length++] = byte;
+
+            return true;
+        }
+
+        enum Error drop(const enum Error error) {
+
+            m_discard = true;
+            m_last_error = error;
+
+            return error;
+        }
+
+        std::span<uint8_t> m_frame;     ///< Buffer receiving the frame
+        size_t m_length{0};             ///< Bytes decoded in the current frame
+        size_t m_size{0};               ///< Size of the last complete frame
+        uint8_t m_remaining;            ///< Bytes left in the current block
+        uint8_t m_code;                 ///< Code byte of the current block
+        bool m_discard;                 ///< Whether the bytes are dropped until the next delimiter
+
+        enum Error m_last_error;
+    };
+
+    /**
+     * Encode a whole frame.
+     *
+     * @param data frame to encode
+     * @param encoded buffer receiving the encoded frame, without the delimiter
+     * @param length size of the encoded frame
+     * @return Error::NONE, Error::TOOSMALL if encoded is too small
+     */
+    inline enum Error cobsEncode(const std::span<const uint8_t> data, const std::span<uint8_t> encoded, size_t &length) {
+
+        size_t code_position{0};
+        uint8_t code{1};
+
+        length = 1;
+
+        for(const uint8_t byte : data) {
+
+            if(length >= encoded.size()) {
+                return Error::TOOSMALL;
+            }
+
+            if(byte != COBS_DELIMITER) {
+
+                encoded[length++] = byte;
+                code++;
+            }
+
+            if(byte == COBS_DELIMITER or code == 0xFF) {
+
+                encoded[code_position] = code;
+                code_position = length++;
+                code = 1;
+            }
+        }
+
+        if(code_position >= encoded.size()) {
+            return Error::TOOSMALL;
+        }
+
+        encoded[code_position] = code;
+
+        return Error::NONE;
+    }
+
+    /**
+     * Decode a whole frame, in place if encoded and data are the same buffer.
+     *
+     * @param encoded encoded frame, without the delimiter
+     * @param data buffer receiving the frame
+     * @param length size of the frame
+     * @return Error::NONE, Error::TOOSMALL if data is too small, Error::ERROR if the frame is malformed
+     */
+    inline enum Error cobsDecode(const std::span<const uint8_t> encoded, const std::span<uint8_t> data, size_t &length) {
+
+        length = 0;
+
+        for(size_t i{0}; i < encoded.size();) {
+
+            const uint8_t code{encoded[i++]};
+
+            if(code == COBS_DELIMITER or i + code - 1 > encoded.size()) {
+                return Error::ERROR;
+            }
+
+            if(length + code - 1 > data.size()) {
+                return Error::TOOSMALL;
+            }
+
+            // Reading always runs ahead of writing, so decoding in place is safe
+            std::copy_n(encoded.begin() + static_cast<std::ptrdiff_t>(i), code - 1, data.begin() + static_cast<std::ptrdiff_t>(length));
+            length += code - 1U;
+            i += code - 1U;
+
+            if(code != 0xFF and i < encoded.size()) {
+
+                if(length >= data.size()) {
+                    return Error::TOOSMALL;
+                }
+
+                data[length++] = COBS_DELIMITER;
+            }
+        }
+
+        return Error::NONE;
+    }
+
+} // namespace hal::serialization
+
+#endif //EMBEDDEDLIBRARY_COBS_H
@@ -0,0 +1,344 @@
+/**
+ * @file Schema.h
+ * @brief Provide compile-time message schemas encoding and decoding structs with a fixed layout
+ *
+ * A @ref hal::serialization::Schema "Schema" lists the fields of a message as types. Their offsets and the
+ * size of the message are computed at compile time, and encode/decode expand to one store or load per field,
+ * with no runtime dispatch. Every field is checked against @ref hal::concepts::is_serializable "is_serializable"
+ * when the schema is declared.
+ *
+ * - @ref hal::serialization::Field "Field" maps a member of the struct onto sizeof(member) bytes.
+ * - @ref hal::serialization::BitField "BitField" packs several members into one integer, a few bits each.
+ * - @ref hal::serialization::Padding "Padding" reserves bytes, written as 0 and skipped when decoding.
+ *
+ * @code{cpp}
+ * struct Telemetry {
+ *     uint8_t id;
+ *     uint32_t timestamp;
+ *     float temperature;
+ *     uint8_t mode;
+ *     bool armed;
+ * };
+ *
+ * using namespace hal::serialization;
+ * using TelemetrySchema = Schema<Endian::BIG,
+ *         Field<&Telemetry::id>,
+ *         Field<&Telemetry::timestamp>,
+ *         Field<&Telemetry::temperature>,
+ *         BitField<uint8_t, Bits<&Telemetry::mode, 3>, Bits<&Telemetry::armed, 1>>>;
+ *
+ * uint8_t frame[TelemetrySchema::SIZE];      // 10 bytes
+ * TelemetrySchema::encode(telemetry, frame);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_SCHEMA_H
+#define EMBEDDEDLIBRARY_SCHEMA_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "../commons/commons.h"
+#include "BufferSerializer.h"
+
+namespace hal::serialization {
+
+    namespace detail {
+
+        template<typename M>
+        struct member_traits;
+
+        template<typename C, typename T>
+        struct member_traits<T C::*> {
+            using class_type = C;
+            using value_type = T;
+        };
+
+    } // namespace detail
+
+    /**
+     * Field of a message, stored on sizeof(member) bytes.
+     *
+     * @tparam Member pointer to the member of the struct, e.g. &Telemetry::timestamp
+     */
+    template<auto Member>
+    requires std::is_member_object_pointer_v<decltype(Member)>
+             and concepts::is_serializable<typename detail::member_traits<decltype(Member)>::value_type>
+    struct Field {
+
+        using class_type = typename detail::member_traits<decltype(Member)>::class_type;
+        using value_type = typename detail::member_traits<decltype(Member)>::value_type;
+
+        static constexpr size_t SIZE{sizeof(value_type)};
+
+        static constexpr void encode(uint8_t * const data, const class_type &object, const Endian endian) {
+
+            detail::store(data, object.*Member, endian);
+        }
+
+        static constexpr void decode(const uint8_t * const data, class_type &object, const Endian endian) {
+
+            object.*Member = detail::load<value_type>(data, endian);
+        }
+    };
+
+    /**
+     * Member of a @ref hal::serialization::BitField "BitField" stored on Width bits.
+     *
+     * @tparam Member pointer to the member of the struct, must be an integral type, an enumeration or a bool
+     * @tparam Width number of bits, the upper bits of the value are dropped when encoding and signed values
+     * are sign extended when decoding
+     */
+    template<auto Member, size_t Width>
+    requires std::is_member_object_pointer_v<decltype(Member)> and (Width > 0)
+             and (std::is_integral_v<typename detail::member_traits<decltype(Member)>::value_type>
+                  or std::is_enum_v<typename detail::member_traits<decltype(Member)>::value_type>)
+    struct Bits {
+
+        using class_type = typename detail::member_traits<decltype(Member)>::class_type;
+        using value_type = typename detail::member_traits<decltype(Member)>::value_type;
+
+        static constexpr size_t WIDTH{Width};
+
+        template<std::unsigned_integral S>
+        static constexpr S get(const class_type &object) {
+
+            return static_cast<S>(static_cast<S>(detail::toRaw(object.*Member)) & hal::detail::bits::low_mask<S>(Width));
+        }
+
+        template<std::unsigned_integral S>
+        static constexpr void set(class_type &object, const S bits) {
+
+            using raw_type = detail::raw_t<value_type>;
+            using integer_type = typename std::conditional_t<std::is_enum_v<value_type>,
+                                                             std::underlying_type<value_type>,
+                                                             std::type_identity<value_type>>::type;
+
+            auto raw{static_cast<raw_type>(bits)};
+
+            // Sign extend negative values
+            if constexpr (std::is_signed_v<integer_type> and Width < std::numeric_limits<raw_type>::digits) {
+                if(check_bit(bits, Width - 1)) {
+                    raw = static_cast<raw_type>(raw | ~hal::detail::bits::low_mask<raw_type>(Width));
+                }
+            }
+
+            object.*Member = detail::fromRaw<value_type>(raw);
+        }
+    };
+
+    /**
+     * Several members packed into one integer, the first one in the lowest bits.
+     *
+     * @tparam Storage integer holding the bits, sent with the byte order of the schema
+     * @tparam Members @ref hal::serialization::Bits "Bits" packed in the integer, their widths must fit in it
+     */
+    template<std::unsigned_integral Storage, typename... Members>
+    requires (sizeof...(Members) > 0) and ((Members::WIDTH + ...) <= std::numeric_limits<Storage>::digits)
+    struct BitField {
+
+        using class_type = std::common_type_t<typename Members::class_type...>;
+
+        static constexpr size_t SIZE{sizeof(Storage)};
+
+        static constexpr void encode(uint8_t * const data, const class_type &object, const Endian endian) {
+
+            Storage word{0};
+            size_t pos{0};
+
+            ((set_bits_pos(word, pos, Members::template get<Storage>(object)), pos += Members::WIDTH), ...);
+
+            detail::store(data, word, endian);
+        }
+
+        static constexpr void decode(const uint8_t * const data, class_type &object, const Endian endian) {
+
+            const Storage word{detail::load<Storage>(data, endian)};
+            size_t pos{0};
+
+            ((Members::set(object, static_cast<Storage>((word >> pos) & hal::detail::bits::low_mask<Storage>(Members::WIDTH))),
+              pos += Members::WIDTH), ...);
+        }
+    };
+
+    /**
+     * Reserved bytes, written as 0 and skipped when decoding.
+     *
+     * @tparam Size number of bytes
+     */
+    template<size_t Size>
+    struct Padding {
+
+        static constexpr size_t SIZE{Size};
+
+        template<typename C>
+        static constexpr void encode(uint8_t * const data, const C &, const Endian) {
+
+            for(size_t i{0}; i < Size; i++) {
+                data[i] = 0;
+            }
+        }
+
+        template<typename C>
+        static constexpr void decode(const uint8_t * const, C &, const Endian) {}
+    };
+
+    /**
+     * Fixed layout of a message.
+     *
+     * @tparam E byte order of the fields
+     * @tparam Fields fields of the message, in wire order
+     */
+    template<Endian E, typename... Fields>
+    requires (sizeof...(Fields) > 0)
+    class Schema {
+
+        template<typename F>
+        struct class_of {
+            using type = void;
+        };
+
+        template<typename F>
+        requires requires { typename F::class_type; }
+        struct class_of<F> {
+            using type = typename F::class_type;
+        };
+
+        template<typename... Cs>
+        struct first_class {
+            using type = void;
+        };
+
+        template<typename C, typename... Cs>
+        struct first_class<C, Cs...> {
+            using type = std::conditional_t<std::is_void_v<C>, typename first_class<Cs...>::type, C>;
+        };
+
+    public:
+
+        /// Struct described by the schema
+        using object_type = typename first_class<typename class_of<Fields>::type...>::type;
+
+        static_assert(!std::is_void_v<object_type>, "A schema needs at least one field mapped onto a member");
+        static_assert(((std::is_void_v<typename class_of<Fields>::type> or std::is_same_v<typename class_of<Fields>::type, object_type>) and ...),
+                      "Every field of a schema must belong to the same struct");
+
+        static constexpr size_t SIZE{(Fields::SIZE + ...)};     ///< Size of the message in bytes
+        static constexpr Endian ENDIAN{E};                      ///< Byte order of the fields
+
+        /// Offset of every field in the message
+        static constexpr std::array<size_t, sizeof...(Fields)> OFFSETS{[]() {
+
+            std::array<size_t, sizeof...(Fields)> offsets{};
+            const size_t sizes[]{Fields::SIZE...};
+
+            for(size_t i{1}; i < offsets.size(); i++) {
+                offsets[i] = offsets[i - 1] + sizes[i - 1];
+            }
+
+            return offsets;
+        }()};
+
+        /**
+         * Encode a message.
+         *
+         * @param object struct to encode
+         * @param buffer buffer receiving the message, at least SIZE bytes
+         * @return whether an error occurred, true if the buffer is too small
+         */
+        static constexpr bool encode(const object_type &object, const std::span<uint8_t> buffer) {
+
+            if(buffer.size() < SIZE) {
+
+                return true;
+            }
+
+            encodeFields(object, buffer.data(), std::index_sequence_for<Fields...>{});
+
+            return false;
+        }
+
+        /**
+         * Decode a message.
+         *
+         * @param buffer buffer holding the message, at least SIZE bytes
+         * @param object struct receiving the fields, left untouched on error
+         * @return whether an error occurred, true if the buffer is too small
+         */
+        static constexpr bool decode(const std::span<const uint8_t> buffer, object_type &object) {
+
+            if(buffer.size() < SIZE) {
+
+                return true;
+            }
+
+            decodeFields(buffer.data(), object, std::index_sequence_for<Fields...>{});
+
+            return false;
+        }
+
+        /**
+         * Encode a message at the cursor of a writer.
+         *
+         * @param writer writer receiving the message
+         * @param object struct to encode
+         * @return whether an error occurred, see @ref BufferWriter::getLastError() "getLastError()"
+         */
+        static constexpr bool write(BufferWriter &writer, const object_type &object) {
+
+            const std::span<uint8_t> data{writer.reserve(SIZE)};
+
+            if(data.empty()) {
+
+                return true;
+            }
+
+            encodeFields(object, data.data(), std::index_sequence_for<Fields...>{});
+
+            return false;
+        }
+
+        /**
+         * Decode a message at the cursor of a reader.
+         *
+         * @param reader reader holding the message
+         * @param object struct receiving the fields, left untouched on error
+         * @return whether an error occurred, see @ref BufferReader::getLastError() "getLastError()"
+         */
+        static constexpr bool read(BufferReader &reader, object_type &object) {
+
+            const std::span<const uint8_t> data{reader.view(SIZE)};
+
+            if(data.empty()) {
+
+                return true;
+            }
+
+            decodeFields(data.data(), object, std::index_sequence_for<Fields...>{});
+
+            return false;
+        }
+
+    private:
+
+        template<size_t... Is>
+        static constexpr void encodeFields(const object_type &object, uint8_t * const data, std::index_sequence<Is...>) {
+
+            (Fields::encode(data + OFFSETS[Is], object, E), ...);
+        }
+
+        template<size_t... Is>
+        static constexpr void decodeFields(const uint8_t * const data, object_type &object, std::index_sequence<Is...>) {
+
+            (Fields::decode(data + OFFSETS[Is], object, E), ...);
+        }
+    };
+
+} // namespace hal::serialization
+
+#endif //EMBEDDEDLIBRARY_SCHEMA_H
@@ -0,0 +1,219 @@
+/**
+ * @file Varint.h
+ * @brief Provide LEB128 variable length integers and ZigZag encoding
+ *
+ * A varint stores 7 bits per byte, the high bit telling whether another byte follows, so small values take
+ * a single byte instead of sizeof(T). Signed values are ZigZag encoded first (0, -1, 1, -2 ... become
+ * 0, 1, 2, 3 ...) so small negative values stay small too.
+ *
+ * @code{cpp}
+ * using namespace hal::serialization;
+ *
+ * uint8_t frame[64];
+ * BufferWriter writer{frame};
+ * writeVarint(writer, uint32_t{300});    // 2 bytes: 0xAC 0x02
+ * writeVarint(writer, int16_t{-3});      // 1 byte: 0x05
+ *
+ * BufferReader reader{writer.getWritten()};
+ * uint32_t count;
+ * int16_t offset;
+ * readVarint(reader, count);
+ * readVarint(reader, offset);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_VARINT_H
+#define EMBEDDEDLIBRARY_VARINT_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "../commons/commons.h"
+#include "BufferSerializer.h"
+
+namespace hal::serialization {
+
+    /**
+     * Maximum number of bytes of the varint of a T.
+     *
+     * @tparam T integral type
+     */
+    template<std::integral T>
+    constexpr size_t varint_max_size_v{(std::numeric_limits<std::make_unsigned_t<T>>::digits + 6) / 7};
+
+    /**
+     * Map a signed value onto an unsigned one, small magnitudes giving small values.
+     *
+     * @param value signed value
+     * @return 2 * value for positive values, -2 * value - 1 for negative ones
+     */
+    template<std::signed_integral T>
+    constexpr std::make_unsigned_t<T> zigzagEncode(const T value) {
+
+        using U = std::make_unsigned_t<T>;
+
+        return static_cast<U>(static_cast<U>(value) << 1U) ^ static_cast<U>(value < 0 ? ~U{0} : U{0});
+    }
+
+    /**
+     * Revert @ref hal::serialization::zigzagEncode() "zigzagEncode()".
+     *
+     * @param value ZigZag encoded value
+     * @return signed value
+     */
+    template<std::unsigned_integral U>
+    constexpr std::make_signed_t<U> zigzagDecode(const U value) {
+
+        return static_cast<std::make_signed_t<U>>(static_cast<U>(value >> 1U) ^ static_cast<U>(-static_cast<U>(value & 1U)));
+    }
+
+    /**
+     * Number of bytes of the varint of value.
+     *
+     * @param value unsigned value
+     * @return number of bytes
+     */
+    template<std::unsigned_integral U>
+    constexpr size_t varintSize(const U value) {
+
+        size_t size{1};
+
+        for(U rest{static_cast<U>(value >> 7U)}; rest != 0; rest = static_cast<U>(rest >> 7U)) {
+            size++;
+        }
+
+        return size;
+    }
+
+    /**
+     * Encode an unsigned value as a varint.
+     *
+     * @param value value to encode
+     * @param data buffer receiving the varint, at least varint_max_size_v<U> bytes
+     * @return number of bytes written
+     */
+    template<std::unsigned_integral U>
+    constexpr size_t encodeVarint(U value, uint8_t * const data) {
+
+        size_t length{0};
+
+        while(value >= 0x80U) {
+
+            data[length++] = static_cast<uint8_t>(value | 0x80U);
+            value = static_cast<U>(value >> 7U);
+        }
+
+        data[length++] = static_cast<uint8_t>(value);
+
+        return length;
+    }
+
+    /**
+     * Decode a varint.
+     *
+     * @param data bytes holding the varint
+     * @param value value decoded, left untouched on error
+     * @param length number of bytes consumed
+     * @return Error::NONE, Error::TOOSMALL if the varint is truncated, Error::TOOBIG if it does not fit in a U
+     */
+    template<std::unsigned_integral U>
+    constexpr enum Error decodeVarint(const std::span<const uint8_t> data, U &value, size_t &length) {
+
+        constexpr size_t digits{std::numeric_limits<U>::digits};
+
+        U result{0};
+
+        for(size_t i{0}; i < data.size(); i++) {
+
+            const size_t shift{7 * i};
+            const uint8_t bits{static_cast<uint8_t>(data[i] & 0x7FU)};
+
+            const bool more{check_bit(data[i], 7U)};
+
+            // The bits past the width of U must be 0, and no byte can follow the last one U can hold
+            if((shift + 7 > digits and (bits >> (digits - shift)) != 0) or (more and shift + 7 >= digits)) {
+
+                return Error::TOOBIG;
+            }
+
+            result = static_cast<U>(result | static_cast<U>(static_cast<U>(bits) << shift));
+
+            if(!more) {
+
+                value = result;
+                length = i + 1;
+
+                return Error::NONE;
+            }
+        }
+
+        return Error::TOOSMALL;
+    }
+
+    /**
+     * Write an integer as a varint at the cursor of a writer, signed values are ZigZag encoded.
+     *
+     * @param writer writer receiving the varint
+     * @param value value to write
+     * @return whether an error occurred, see @ref BufferWriter::getLastError() "getLastError()"
+     */
+    template<std::integral T>
+    constexpr bool writeVarint(BufferWriter &writer, const T value) {
+
+        if constexpr (std::is_signed_v<T>) {
+
+            return writeVarint(writer, zigzagEncode(value));
+        } else {
+
+            uint8_t data[varint_max_size_v<T>]{};
+
+            return writer.writeBytes(std::span<const uint8_t>{data, encodeVarint(value, data)});
+        }
+    }
+
+    /**
+     * Read a varint at the cursor of a reader, signed values are ZigZag decoded.
+     *
+     * @param reader reader holding the varint
+     * @param value value read, left untouched on error
+     * @return whether an error occurred, see @ref BufferReader::getLastError() "getLastError()"
+     */
+    template<std::integral T>
+    constexpr bool readVarint(BufferReader &reader, T &value) {
+
+        if constexpr (std::is_signed_v<T>) {
+
+            std::make_unsigned_t<T> encoded{};
+
+            if(readVarint(reader, encoded)) {
+                return true;
+            }
+
+            value = zigzagDecode(encoded);
+
+            return false;
+        } else {
+
+            size_t length{0};
+
+            if(reader.getLastError() != Error::NONE) {
+                return true;
+            }
+
+            if(const enum Error error{decodeVarint(reader.peek(varint_max_size_v<T>), value, length)}; error != Error::NONE) {
+
+                reader.fail(error);
+                return true;
+            }
+
+            return reader.skip(length);
+        }
+    }
+
+} // namespace hal::serialization
+
+#endif //EMBEDDEDLIBRARY_VARINT_H
@@ -0,0 +1,205 @@
+/**
+ * @file Stats.h
+ * @brief Provide the statistics counters of the peripherals
+ *
+ * getLastError() only tells about the last call. The counters accumulate what happened since the last reset,
+ * e.g. the bytes moved by a UART, the times it had to wait for room in its TX FIFO or lost received bytes, to spot a
+ * saturated link or a stall under load without a debugger.
+ *
+ * - The counters are updated with relaxed atomic operations, from the code or the interrupts, and read as a
+ *   snapshot: @ref hal::stats::UARTStats "UARTStats" or @ref hal::stats::GPIOStats "GPIOStats".
+ * - They are compiled in only when HAL_STATS is defined. Otherwise the counters are not stored,
+ *   @ref HAL_STATS_ADD "HAL_STATS_ADD" and @ref HAL_STATS_RAISE "HAL_STATS_RAISE" expand to nothing and the
+ *   snapshots are all zeros.
+ *
+ * @code{cpp}
+ * const hal::stats::UARTStats stats{uart.getStats()};
+ *
+ * if(stats.overruns > 0) {
+ *     // The main loop does not read fast enough
+ * }
+ *
+ * uart.resetStats();
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_STATS_H
+#define EMBEDDEDLIBRARY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "../commons/commons.h"
+
+#ifdef HAL_RP2040
+#include "Stats_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Stats_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::stats {
+
+    /**
+     * Snapshot of the counters of a UART.
+     */
+    struct UARTStats {
+
+        uint32_t bytes_read;        ///< Bytes received from the wire
+        uint32_t bytes_written;     ///< Bytes sent on the wire
+        uint32_t tx_stalls;         ///< Writes that had to wait for room in the TX FIFO or ring
+        uint32_t overruns;          ///< Times received bytes were lost, or would have been, because no room was left
+        uint32_t framing_errors;    ///< Bytes received without a valid stop bit
+        uint32_t parity_errors;     ///< Bytes received with a wrong parity
+        uint32_t breaks;            ///< Break conditions received
+    };
+
+    /**
+     * Snapshot of the counters of a GPIO pin.
+     */
+    struct GPIOStats {
+
+        uint32_t writes;            ///< Calls to write()
+        uint32_t toggles;           ///< Calls to toggle()
+        uint32_t irqs;              ///< Interrupts dispatched for the pin
+        uint32_t max_irq_latency;   ///< Longest time a queued interrupt waited before being popped, in microseconds
+    };
+
+    /**
+     * Counter updated from the code and the interrupts, read at any time.
+     */
+    class Counter {
+    public:
+
+        /**
+         * @param value amount to add, wraps around at 2^32
+         */
+        void add(const uint32_t value=1) {
+
+            detail::StatsIO::add(m_value, value);
+        }
+
+        /**
+         * Keep the largest value seen.
+         *
+         * @param value new value
+         */
+        void raise(const uint32_t value) {
+
+            detail::StatsIO::raise(m_value, value);
+        }
+
+        [[nodiscard]] uint32_t get() const {
+
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        void reset() {
+
+            m_value.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * Take the value of another counter, which is reset.
+         *
+         * @param other counter of a moved peripheral
+         */
+        void take(Counter &other) {
+
+            m_value.store(other.get(), std::memory_order_relaxed);
+            other.reset();
+        }
+
+    private:
+
+        std::atomic<uint32_t> m_value{0};   ///< Value of the counter
+    };
+
+    /**
+     * Counters of a UART, see @ref hal::stats::UARTStats "UARTStats".
+     */
+    struct UARTCounters {
+
+        Counter bytes_read;
+        Counter bytes_written;
+        Counter tx_stalls;
+        Counter overruns;
+        Counter framing_errors;
+        Counter parity_errors;
+        Counter breaks;
+
+        [[nodiscard]] UARTStats snapshot() const {
+
+            return {bytes_read.get(), bytes_written.get(), tx_stalls.get(), overruns.get(),
+                    framing_errors.get(), parity_errors.get(), breaks.get()};
+        }
+
+        void reset() {
+
+            for(Counter *counter : {&bytes_read, &bytes_written, &tx_stalls, &overruns, &framing_errors, &parity_errors, &breaks}) {
+                counter->reset();
+            }
+        }
+    };
+
+    /**
+     * Counters of a GPIO pin kept by the pin itself, the interrupts are counted per pin by the dispatcher.
+     */
+    struct GPIOCounters {
+
+        Counter writes;
+        Counter toggles;
+
+        void reset() {
+
+            writes.reset();
+            toggles.reset();
+        }
+
+        void take(GPIOCounters &other) {
+
+            writes.take(other.writes);
+            toggles.take(other.toggles);
+        }
+    };
+
+    /**
+     * Counters of the interrupts of a GPIO pin.
+     */
+    struct IRQCounters {
+
+        Counter irqs;
+        Counter max_latency;
+
+        void reset() {
+
+            irqs.reset();
+            max_latency.reset();
+        }
+    };
+
+} // namespace hal::stats
+
+#ifdef HAL_STATS
+/**
+ * Add to a counter, removed unless HAL_STATS is defined: the arguments are not evaluated then.
+ *
+ * @param counter @ref hal::stats::Counter "Counter" to increase
+ * @param value amount to add
+ */
+#define HAL_STATS_ADD(counter, value) (counter).add(static_cast<uint32_t>(value))
+
+/**
+ * Keep the largest value seen in a counter, removed unless HAL_STATS is defined.
+ *
+ * @param counter @ref hal::stats::Counter "Counter" to raise
+ * @param value new value
+ */
+#define HAL_STATS_RAISE(counter, value) (counter).raise(static_cast<uint32_t>(value))
+#else
+#define HAL_STATS_ADD(counter, value) static_cast<void>(0)
+#define HAL_STATS_RAISE(counter, value) static_cast<void>(0)
+#endif
+
+#endif //EMBEDDEDLIBRARY_STATS_H
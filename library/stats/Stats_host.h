@@ -0,0 +1,42 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_STATS_HOST_H
+#define EMBEDDEDLIBRARY_STATS_HOST_H
+
+#include "../commons/commons.h"
+
+#include <atomic>
+
+namespace hal::stats::detail {
+
+    /**
+     * Host counters: the threads update them with relaxed atomic operations.
+     */
+    struct StatsIO {
+
+        /**
+         * @param counter counter to increase
+         * @param value amount to add
+         */
+        static void add(std::atomic<uint32_t> &counter, const uint32_t value) {
+
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * @param counter counter keeping the largest value seen
+         * @param value new value
+         */
+        static void raise(std::atomic<uint32_t> &counter, const uint32_t value) {
+
+            uint32_t current{counter.load(std::memory_order_relaxed)};
+
+            while(value > current and !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+    };
+
+} // namespace hal::stats::detail
+
+#endif //EMBEDDEDLIBRARY_STATS_HOST_H
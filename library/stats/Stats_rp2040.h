@@ -0,0 +1,53 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_STATS_RP2040_H
+#define EMBEDDEDLIBRARY_STATS_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <atomic>
+
+#include <hardware/sync.h>
+
+namespace hal::stats::detail {
+
+    /**
+     * RP2040 counters: the Cortex-M0+ has no atomic read-modify-write, the relaxed load and store are done with the
+     * interrupts masked for a few cycles. A counter is updated from a single core, the core owning the peripheral.
+     */
+    struct StatsIO {
+
+        /**
+         * @param counter counter to increase
+         * @param value amount to add
+         */
+        static void add(std::atomic<uint32_t> &counter, const uint32_t value) {
+
+            const uint32_t status{save_and_disable_interrupts()};
+
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+
+            restore_interrupts(status);
+        }
+
+        /**
+         * @param counter counter keeping the largest value seen
+         * @param value new value
+         */
+        static void raise(std::atomic<uint32_t> &counter, const uint32_t value) {
+
+            const uint32_t status{save_and_disable_interrupts()};
+
+            if(value > counter.load(std::memory_order_relaxed)) {
+                counter.store(value, std::memory_order_relaxed);
+            }
+
+            restore_interrupts(status);
+        }
+    };
+
+} // namespace hal::stats::detail
+
+#endif //EMBEDDEDLIBRARY_STATS_RP2040_H
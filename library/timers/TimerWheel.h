@@ -0,0 +1,603 @@
+/**
+ * @file TimerWheel.h
+ * @brief Provide a hierarchical timer wheel multiplexing one-shot and periodic timers on one core
+ *
+ * Instead of blocking the core with @ref hal::sleep_millis() "sleep_millis()", the code starts timers and the
+ * @ref hal::timers::TimerWheel "TimerWheel" calls them back from @ref hal::timers::TimerWheel::runPending() "runPending()",
+ * called from the main loop or from a hardware alarm interrupt (see
+ * @ref hal::timers::TimerWheel::enableAlarm() "enableAlarm()").
+ *
+ * - The timers are @ref hal::timers::TIMER_SLOTS "TIMER_SLOTS" slots allocated with the wheel, nothing is allocated
+ *   at runtime.
+ * - Starting and cancelling a timer is O(1): the timer is linked in the bucket of its expiry tick, on the first of 4
+ *   levels of 64 buckets whose range reaches it. A bucket of a higher level is spread over the lower levels when the
+ *   time reaches it (cascading), the timers beyond the 4 levels (2^24 ticks) wait in an overflow list.
+ * - runPending() jumps from one non-empty bucket to the next, with one bit scan per level: it costs the same after a
+ *   tick or after an hour.
+ * - A periodic timer is rescheduled from its previous expiry, not from the time of the call, so it does not drift.
+ *   A periodic timer late by more than its period skips the missed expiries instead of firing them in a burst.
+ *
+ * On host the time is the one of the @ref hal::host::FakeClock "FakeClock", the timers only expire when a test
+ * advances it.
+ *
+ * @code{cpp}
+ * hal::timers::TimerWheel wheel{};
+ * hal::timers::TimerId blink;
+ *
+ * wheel.startPeriodic(blink, 500'000, [](hal::timers::TimerId, void *context) {
+ *     static_cast<hal::interfaces::InterfaceDigitalGPIO *>(context)->toggle();
+ * }, &led);
+ *
+ * wheel.enableAlarm();    // runPending() is called from the alarm interrupt
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_TIMERWHEEL_H
+#define EMBEDDEDLIBRARY_TIMERWHEEL_H
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+#include "../commons/commons.h"
+#include "../traits/NonCopyable.h"
+#include "../traits/NonMovable.h"
+
+#ifdef HAL_RP2040
+#include "TimerWheel_rp2040.h"
+#elif defined(HAL_HOST)
+#include "TimerWheel_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::timers {
+
+    constexpr size_t TIMER_SLOTS{HAL_TIMER_SLOTS};      ///< number of timers of a wheel
+    constexpr uint64_t TIMER_TICK_US{HAL_TIMER_TICK_US};  ///< resolution of a wheel in microseconds
+
+    static_assert(TIMER_SLOTS > 0 and TIMER_SLOTS < 0xFFFFU, "A timer wheel has between 1 and 65534 slots");
+    static_assert(TIMER_TICK_US > 0, "The tick of a timer wheel cannot be 0");
+
+    /// Identifier of a started timer, never 0 so a default initialised identifier is invalid
+    using TimerId = uint32_t;
+
+    constexpr TimerId INVALID_TIMER{0};     ///< identifier of no timer
+
+    /**
+     * Function called when a timer expires.
+     *
+     * @param timer expired timer, still active for a periodic timer so it can cancel itself
+     * @param context given when the timer was started
+     */
+    using TimerCallback = void (*)(TimerId timer, void *context);
+
+    /**
+     * Hierarchical timer wheel with a resolution of @ref hal::timers::TIMER_TICK_US "TIMER_TICK_US".
+     *
+     * @note On RP2040 the wheel is protected by masking the interrupts, it can be used from the code and the
+     * callbacks while the alarm interrupt runs it.
+     */
+    class TimerWheel : traits::NonCopyable<TimerWheel>, traits::NonMovable<TimerWheel> {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        TimerWheel() : m_slots{}, m_buckets{}, m_occupied{}, m_free{0}, m_current{detail::TimerWheelIO::now() / TIMER_TICK_US},
+                       m_active{0}, m_alarm{detail::TimerWheelIO::NO_ALARM}, m_last_error{Error::NONE} {
+
+            for(uint16_t &bucket : m_buckets) {
+                bucket = NIL;
+            }
+
+            for(size_t i{0}; i < TIMER_SLOTS; i++) {
+
+                m_slots[i].next = i + 1 < TIMER_SLOTS ? static_cast<uint16_t>(i + 1) : NIL;
+                m_slots[i].bucket = NIL;
+                m_slots[i].generation = 1;
+            }
+        }
+
+        ~TimerWheel() override {
+
+            disableAlarm();
+        }
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Start a one-shot timer.
+         *
+         * @param timer receive the identifier of the timer
+         * @param delay_us time before the timer expires in microseconds, rounded up to the tick
+         * @param callback function called when the timer expires
+         * @param context passed to the callback
+         * @return whether an error occurred, see @ref TimerWheel::getLastError() "getLastError()":
+         * Error::TOOSMALL if every slot is used, Error::ERROR if the callback is null
+         */
+        bool start(TimerId &timer, const uint64_t delay_us, const TimerCallback callback, void * const context=nullptr) {
+
+            return add(timer, delay_us, 0, callback, context);
+        }
+
+        /**
+         * Start a periodic timer, it first expires after one period.
+         *
+         * @param timer receive the identifier of the timer
+         * @param period_us period in microseconds, rounded up to the tick
+         * @param callback function called when the timer expires
+         * @param context passed to the callback
+         * @return whether an error occurred, see @ref TimerWheel::getLastError() "getLastError()":
+         * Error::TOOSMALL if every slot is used, Error::ERROR if the callback is null
+         */
+        bool startPeriodic(TimerId &timer, const uint64_t period_us, const TimerCallback callback, void * const context=nullptr) {
+
+            return add(timer, period_us, toTicks(period_us), callback, context);
+        }
+
+        /**
+         * Stop a timer and release its slot.
+         *
+         * @param timer timer to stop
+         * @return whether an error occurred, Error::ERROR if the timer is not active (expired, cancelled or invalid)
+         */
+        bool cancel(const TimerId timer) {
+
+            m_last_error = Error::NONE;
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            if(!isActiveUnlocked(timer)) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            const uint16_t slot{slotOf(timer)};
+
+            unlink(slot);
+            release(slot);
+
+            return false;
+        }
+
+        /**
+         * @param timer timer to check
+         * @return whether the timer waits to expire
+         */
+        [[nodiscard]] bool isActive(const TimerId timer) const {
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            return isActiveUnlocked(timer);
+        }
+
+        /**
+         * @return number of timers waiting to expire
+         */
+        [[nodiscard]] size_t getActiveCount() const {
+
+            return m_active;
+        }
+
+        /**
+         * Call back the timers expired since the last call, in expiry order.
+         *
+         * @note The callbacks are called outside of the critical section, from the context of the caller
+         * (the alarm interrupt if the alarm is enabled).
+         *
+         * @return number of callbacks called
+         */
+        size_t runPending() {
+
+            const uint64_t now{detail::TimerWheelIO::now() / TIMER_TICK_US};
+            size_t fired{0};
+
+            while(true) {
+
+                TimerCallback callback;
+                void *context;
+                TimerId timer;
+
+                {
+                    const detail::TimerWheelIO::CriticalSection section{};
+
+                    uint16_t slot{m_buckets[m_current & MASK]};
+
+                    // Nothing left at the current tick, move to the next tick with something to do
+                    while(slot == NIL) {
+
+                        const uint64_t next{nextEventTick()};
+
+                        if(next > now) {
+
+                            m_current = now > m_current ? now : m_current;
+                            rearm();
+
+                            return fired;
+                        }
+
+                        m_current = next;
+                        cascade();
+
+                        slot = m_buckets[m_current & MASK];
+                    }
+
+                    Slot &expired{m_slots[slot]};
+
+                    callback = expired.callback;
+                    context = expired.context;
+                    timer = idOf(slot);
+
+                    unlink(slot);
+
+                    if(expired.period != 0) {
+
+                        expired.expiry += expired.period;
+
+                        // Late by more than a period, skip the missed expiries
+                        if(expired.expiry <= now) {
+                            expired.expiry += expired.period * ((now - expired.expiry) / expired.period + 1);
+                        }
+
+                        link(slot);
+                    } else {
+
+                        release(slot);
+                    }
+                }
+
+                callback(timer, context);
+                fired++;
+            }
+        }
+
+        /**
+         * @return time in microseconds at which runPending() has something to do (a timer expiring or a bucket to
+         * cascade), std::numeric_limits<uint64_t>::max() if no timer is active
+         */
+        [[nodiscard]] uint64_t getNextDeadline() const {
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            return toDeadline(nextEventTick());
+        }
+
+        /**
+         * Run the wheel from a hardware alarm, programmed on the next deadline after every change.
+         *
+         * @return whether an error occurred, Error::ERROR if no alarm is free
+         */
+        bool enableAlarm() {
+
+            m_last_error = Error::NONE;
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            if(m_alarm == detail::TimerWheelIO::NO_ALARM) {
+
+                m_alarm = detail::TimerWheelIO::claimAlarm();
+
+                if(m_alarm == detail::TimerWheelIO::NO_ALARM) {
+
+                    m_last_error = Error::ERROR;
+                    return true;
+                }
+            }
+
+            rearm();
+
+            return false;
+        }
+
+        /**
+         * Stop running the wheel from the hardware alarm and release it.
+         */
+        void disableAlarm() {
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            if(m_alarm != detail::TimerWheelIO::NO_ALARM) {
+
+                detail::TimerWheelIO::cancelAlarm(m_alarm);
+                detail::TimerWheelIO::unclaimAlarm(m_alarm);
+                m_alarm = detail::TimerWheelIO::NO_ALARM;
+            }
+        }
+
+        [[nodiscard]] enum Error getLastError() const {
+
+            return m_last_error;
+        }
+
+    protected:
+
+        static constexpr uint LEVEL_BITS{6};                        ///< Bits of the expiry tick per level
+        static constexpr uint LEVELS{4};                            ///< Number of levels
+        static constexpr size_t BUCKETS{1U << LEVEL_BITS};          ///< Buckets per level
+        static constexpr uint64_t MASK{BUCKETS - 1};                ///< Bucket of a tick in a level
+        static constexpr size_t OVERFLOW_BUCKET{LEVELS * BUCKETS};  ///< Timers beyond the last level
+        static constexpr uint16_t NIL{0xFFFFU};                     ///< No slot, no bucket
+
+        static_assert(BUCKETS <= std::numeric_limits<uint64_t>::digits, "The occupied buckets of a level must fit in 64 bits");
+
+        /**
+         * Timer slot, node of the circular list of its bucket or of the free list.
+         */
+        struct Slot {
+
+            uint64_t expiry;            ///< Tick at which the timer expires
+            uint64_t period;            ///< Period in ticks, 0 for a one-shot timer
+            TimerCallback callback;     ///< Called when the timer expires
+            void *context;              ///< Passed to the callback
+            uint16_t prev;              ///< Previous slot of the bucket
+            uint16_t next;              ///< Next slot of the bucket or of the free list
+            uint16_t bucket;            ///< Bucket holding the slot, NIL if the slot is free
+            uint16_t generation;        ///< Incremented when the slot is released, invalidates the old identifiers
+        };
+
+        static uint64_t toTicks(const uint64_t us) {
+
+            const uint64_t ticks{(us + TIMER_TICK_US - 1) / TIMER_TICK_US};
+
+            return ticks > 0 ? ticks : 1;
+        }
+
+        static uint64_t toDeadline(const uint64_t tick) {
+
+            return tick == std::numeric_limits<uint64_t>::max() ? tick : tick * TIMER_TICK_US;
+        }
+
+        static uint16_t slotOf(const TimerId timer) {
+
+            return static_cast<uint16_t>(timer & 0xFFFFU);
+        }
+
+        [[nodiscard]] TimerId idOf(const uint16_t slot) const {
+
+            return static_cast<TimerId>(m_slots[slot].generation) << 16U | slot;
+        }
+
+        [[nodiscard]] bool isActiveUnlocked(const TimerId timer) const {
+
+            const uint16_t slot{slotOf(timer)};
+
+            return slot < TIMER_SLOTS and m_slots[slot].bucket != NIL and idOf(slot) == timer;
+        }
+
+        bool add(TimerId &timer, const uint64_t delay_us, const uint64_t period, const TimerCallback callback, void * const context) {
+
+            m_last_error = Error::NONE;
+
+            if(callback == nullptr) {
+
+                m_last_error = Error::ERROR;
+                return true;
+            }
+
+            const detail::TimerWheelIO::CriticalSection section{};
+
+            if(m_free == NIL) {
+
+                m_last_error = Error::TOOSMALL;
+                return true;
+            }
+
+            const uint16_t slot{m_free};
+            Slot &added{m_slots[slot]};
+
+            // Round up so the timer never expires early, after the current tick even if runPending() is late
+            const uint64_t expiry{(detail::TimerWheelIO::now() + delay_us + TIMER_TICK_US - 1) / TIMER_TICK_US};
+
+            m_free = added.next;
+
+            added.expiry = expiry > m_current ? expiry : m_current + 1;
+            added.period = period;
+            added.callback = callback;
+            added.context = context;
+
+            link(slot);
+            m_active++;
+
+            timer = idOf(slot);
+
+            rearm();
+
+            return false;
+        }
+
+        void release(const uint16_t slot) {
+
+            Slot &released{m_slots[slot]};
+
+            released.generation = static_cast<uint16_t>(released.generation + 1U);
+
+            if(released.generation == 0) {
+                released.generation = 1;
+            }
+
+            released.bucket = NIL;
+            released.next = m_free;
+            m_free = slot;
+            m_active--;
+        }
+
+        /**
+         * Link a slot in the bucket of its expiry: the level of the highest digit where the expiry differs from
+         * the current tick, so the bucket is reached before the expiry.
+         */
+        void link(const uint16_t slot) {
+
+            Slot &linked{m_slots[slot]};
+            const uint64_t different{linked.expiry ^ m_current};
+            const uint level{different == 0 ? 0 : static_cast<uint>(std::bit_width(different) - 1) / LEVEL_BITS};
+
+            if(level >= LEVELS) {
+
+                linked.bucket = OVERFLOW_BUCKET;
+            } else {
+
+                const size_t index{(linked.expiry >> (level * LEVEL_BITS)) & MASK};
+
+                linked.bucket = static_cast<uint16_t>(level * BUCKETS + index);
+                m_occupied[level] |= 1ULL << index;
+            }
+
+            uint16_t &head{m_buckets[linked.bucket]};
+
+            // Append, the timers of the same tick expire in the order they were started
+            if(head == NIL) {
+
+                linked.prev = slot;
+                linked.next = slot;
+                head = slot;
+            } else {
+
+                const uint16_t tail{m_slots[head].prev};
+
+                linked.prev = tail;
+                linked.next = head;
+                m_slots[tail].next = slot;
+                m_slots[head].prev = slot;
+            }
+        }
+
+        void unlink(const uint16_t slot) {
+
+            Slot &unlinked{m_slots[slot]};
+            uint16_t &head{m_buckets[unlinked.bucket]};
+
+            if(unlinked.next == slot) {
+
+                head = NIL;
+
+                if(unlinked.bucket != OVERFLOW_BUCKET) {
+                    m_occupied[unlinked.bucket / BUCKETS] &= ~(1ULL << (unlinked.bucket & MASK));
+                }
+            } else {
+
+                m_slots[unlinked.prev].next = unlinked.next;
+                m_slots[unlinked.next].prev = unlinked.prev;
+
+                if(head == slot) {
+                    head = unlinked.next;
+                }
+            }
+        }
+
+        /**
+         * @return next tick after the current one where a level 0 bucket expires or a bucket of a higher level
+         * cascades, std::numeric_limits<uint64_t>::max() if the wheel is empty
+         */
+        [[nodiscard]] uint64_t nextEventTick() const {
+
+            for(uint level{0}; level < LEVELS; level++) {
+
+                const uint shift{level * LEVEL_BITS};
+                const uint64_t digit{(m_current >> shift) & MASK};
+                const uint64_t later{digit == MASK ? 0 : m_occupied[level] & (~0ULL << (digit + 1))};
+
+                if(later != 0) {
+
+                    const uint64_t base{m_current >> (shift + LEVEL_BITS) << (shift + LEVEL_BITS)};
+
+                    return base | static_cast<uint64_t>(std::countr_zero(later)) << shift;
+                }
+            }
+
+            if(m_buckets[OVERFLOW_BUCKET] != NIL) {
+
+                return ((m_current >> (LEVELS * LEVEL_BITS)) + 1) << (LEVELS * LEVEL_BITS);
+            }
+
+            return std::numeric_limits<uint64_t>::max();
+        }
+
+        /**
+         * Spread the buckets reached by the current tick over the lower levels.
+         */
+        void cascade() {
+
+            if((m_current & hal::detail::bits::low_mask<uint64_t>(LEVELS * LEVEL_BITS)) == 0) {
+                relink(OVERFLOW_BUCKET);
+            }
+
+            for(uint level{LEVELS - 1}; level > 0; level--) {
+
+                if((m_current & hal::detail::bits::low_mask<uint64_t>(level * LEVEL_BITS)) == 0) {
+                    relink(level * BUCKETS + ((m_current >> (level * LEVEL_BITS)) & MASK));
+                }
+            }
+        }
+
+        void relink(const size_t bucket) {
+
+            uint16_t slot{m_buckets[bucket]};
+
+            if(slot == NIL) {
+                return;
+            }
+
+            m_buckets[bucket] = NIL;
+
+            if(bucket != OVERFLOW_BUCKET) {
+                m_occupied[bucket / BUCKETS] &= ~(1ULL << (bucket & MASK));
+            }
+
+            // Break the circle, then link every slot again
+            m_slots[m_slots[slot].prev].next = NIL;
+
+            while(slot != NIL) {
+
+                const uint16_t next{m_slots[slot].next};
+
+                link(slot);
+                slot = next;
+            }
+        }
+
+        /**
+         * Program the alarm on the next deadline, if the alarm is enabled.
+         */
+        void rearm() {
+
+            if(m_alarm == detail::TimerWheelIO::NO_ALARM) {
+                return;
+            }
+
+            const uint64_t deadline{toDeadline(nextEventTick())};
+
+            if(deadline == std::numeric_limits<uint64_t>::max()) {
+
+                detail::TimerWheelIO::cancelAlarm(m_alarm);
+                return;
+            }
+
+            // The deadline is already reached when runPending() is late, run it as soon as possible
+            for(uint64_t target{deadline}; detail::TimerWheelIO::setAlarm(m_alarm, target, alarmIRQ, this);
+                target = detail::TimerWheelIO::now() + 1) {}
+        }
+
+        static void alarmIRQ(void * const context) {
+
+            static_cast<TimerWheel *>(context)->runPending();
+        }
+
+        Slot m_slots[TIMER_SLOTS];                  ///< Timers
+        uint16_t m_buckets[LEVELS * BUCKETS + 1];   ///< First slot of every bucket, then of the overflow list
+        uint64_t m_occupied[LEVELS];                ///< Non-empty buckets of every level, one bit per bucket
+        uint16_t m_free;                            ///< First free slot
+        uint64_t m_current;                         ///< Last tick processed
+        size_t m_active;                            ///< Timers waiting to expire
+        uint m_alarm;                               ///< Hardware alarm running the wheel, NO_ALARM if none
+
+        enum Error m_last_error;
+    };
+
+} // namespace hal::timers
+
+#endif //EMBEDDEDLIBRARY_TIMERWHEEL_H
@@ -0,0 +1,278 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_TIMERWHEEL_HOST_H
+#define EMBEDDEDLIBRARY_TIMERWHEEL_HOST_H
+
+#include "../commons/commons.h"
+
+#include <mutex>
+
+namespace hal::host {
+
+    constexpr uint NUMBER_ALARMS{4U};  ///< number of hardware alarms, like the RP2040 timer
+
+    /**
+     * Clock advanced by hand, with the hardware alarms of the RP2040 timer.
+     *
+     * Time only moves in @ref FakeClock::advance() "advance()", so the code timed by it runs
+     * deterministically. An alarm whose target is reached calls its callback synchronously, with the
+     * clock set to the target, the same way the RP2040 alarm interrupt would.
+     *
+     * @code{cpp}
+     * auto &clock{hal::host::FakeClock::getInstance()};
+     * clock.setAlarm(alarm, clock.now() + 1'000, callback, context);
+     * clock.advance(5'000); // callback called at now + 1000
+     * @endcode
+     *
+     * @note The clock is not thread-safe, it is advanced and read from the thread of the test.
+     */
+    class FakeClock : public traits::Singleton {
+    public:
+
+        using AlarmCallback = void (*)(uint alarm, void *context);
+
+        /**
+         * Get the clock shared by the host timer wheels.
+         *
+         * @return the clock
+         */
+        static FakeClock &getInstance() {
+
+            static FakeClock s_fake_clock{};
+            return s_fake_clock;
+        }
+
+        /**
+         * Put the clock back to 0 and release every alarm.
+         */
+        void reset() {
+
+            m_now = 0;
+
+            for(auto &alarm : m_alarms) {
+                alarm = {};
+            }
+        }
+
+        /**
+         * @return time in microseconds
+         */
+        [[nodiscard]] uint64_t now() const {
+
+            return m_now;
+        }
+
+        /**
+         * Move the time forward, calling the alarms reached in order.
+         *
+         * @param us time to add in microseconds
+         */
+        void advance(const uint64_t us) {
+
+            const uint64_t target{m_now + us};
+
+            // An alarm callback may arm an alarm again, look for the next one after each call
+            for(uint alarm{nextAlarm()}; alarm < NUMBER_ALARMS and m_alarms[alarm].target <= target; alarm = nextAlarm()) {
+
+                m_now = m_alarms[alarm].target;
+                m_alarms[alarm].armed = false;
+                m_alarms[alarm].callback(alarm, m_alarms[alarm].context);
+            }
+
+            m_now = target;
+        }
+
+        /**
+         * Claim a free alarm.
+         *
+         * @return alarm claimed, NUMBER_ALARMS if every alarm is used
+         */
+        uint claimAlarm() {
+
+            for(uint alarm{0}; alarm < NUMBER_ALARMS; alarm++) {
+
+                if(!m_alarms[alarm].claimed) {
+
+                    m_alarms[alarm] = {};
+                    m_alarms[alarm].claimed = true;
+                    return alarm;
+                }
+            }
+
+            return NUMBER_ALARMS;
+        }
+
+        /**
+         * Release an alarm, disarming it.
+         *
+         * @param alarm alarm claimed with @ref FakeClock::claimAlarm() "claimAlarm()"
+         */
+        void unclaimAlarm(const uint alarm) {
+
+            m_alarms[alarm] = {};
+        }
+
+        /**
+         * Arm an alarm, replacing its previous target.
+         *
+         * @param alarm alarm claimed with @ref FakeClock::claimAlarm() "claimAlarm()"
+         * @param target time in microseconds
+         * @param callback function called when the target is reached
+         * @param context passed to the callback
+         * @return whether the target is already reached, the alarm is not armed then (like hardware_alarm_set_target)
+         */
+        bool setAlarm(const uint alarm, const uint64_t target, const AlarmCallback callback, void * const context) {
+
+            if(target <= m_now) {
+
+                m_alarms[alarm].armed = false;
+                return true;
+            }
+
+            m_alarms[alarm].target = target;
+            m_alarms[alarm].callback = callback;
+            m_alarms[alarm].context = context;
+            m_alarms[alarm].armed = true;
+
+            return false;
+        }
+
+        /**
+         * Disarm an alarm.
+         *
+         * @param alarm alarm claimed with @ref FakeClock::claimAlarm() "claimAlarm()"
+         */
+        void cancelAlarm(const uint alarm) {
+
+            m_alarms[alarm].armed = false;
+        }
+
+        /**
+         * @param alarm alarm claimed with @ref FakeClock::claimAlarm() "claimAlarm()"
+         * @return whether the alarm waits for its target
+         */
+        [[nodiscard]] bool isAlarmArmed(const uint alarm) const {
+
+            return m_alarms[alarm].armed;
+        }
+
+    protected:
+
+        FakeClock() : m_now{0}, m_alarms{} {}
+
+        /**
+         * @return armed alarm with the earliest target, NUMBER_ALARMS if none
+         */
+        [[nodiscard]] uint nextAlarm() const {
+
+            uint next{NUMBER_ALARMS};
+
+            for(uint alarm{0}; alarm < NUMBER_ALARMS; alarm++) {
+
+                if(m_alarms[alarm].armed and (next == NUMBER_ALARMS or m_alarms[alarm].target < m_alarms[next].target)) {
+                    next = alarm;
+                }
+            }
+
+            return next;
+        }
+
+        struct Alarm {
+
+            uint64_t target;            ///< Time in microseconds
+            AlarmCallback callback;     ///< Called when the target is reached
+            void *context;              ///< Passed to the callback
+            bool claimed;               ///< Whether the alarm is used
+            bool armed;                 ///< Whether the alarm waits for its target
+        };
+
+        uint64_t m_now;                     ///< Time in microseconds
+        Alarm m_alarms[NUMBER_ALARMS];      ///< Hardware alarms
+
+    private:
+
+    };
+
+} // namespace hal::host
+
+namespace hal::timers::detail {
+
+    /**
+     * Access to the simulated timer: the time and the alarms of the @ref hal::host::FakeClock "FakeClock",
+     * so the timers only expire when a test advances it.
+     */
+    struct TimerWheelIO {
+
+        static constexpr uint NO_ALARM{host::NUMBER_ALARMS};    ///< returned when every alarm is used
+
+        /**
+         * Section where the wheel is modified, by the code or the alarm "interrupt".
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_lock{s_mutex} {}
+
+        private:
+
+            std::lock_guard<std::recursive_mutex> m_lock;
+        };
+
+        /**
+         * @return time in microseconds
+         */
+        static uint64_t now() {
+
+            return host::FakeClock::getInstance().now();
+        }
+
+        /**
+         * @return alarm claimed, NO_ALARM if every alarm is used
+         */
+        static uint claimAlarm() {
+
+            return host::FakeClock::getInstance().claimAlarm();
+        }
+
+        static void unclaimAlarm(const uint alarm) {
+
+            host::FakeClock::getInstance().unclaimAlarm(alarm);
+        }
+
+        /**
+         * Arm an alarm.
+         *
+         * @param alarm alarm claimed
+         * @param target time in microseconds
+         * @param callback function called from the alarm "interrupt"
+         * @param context passed to the callback
+         * @return whether the target is already reached, the alarm is not armed then
+         */
+        static bool setAlarm(const uint alarm, const uint64_t target, void (* const callback)(void *), void * const context) {
+
+            s_callbacks[alarm] = callback;
+
+            return host::FakeClock::getInstance().setAlarm(alarm, target, alarmIRQ, context);
+        }
+
+        static void cancelAlarm(const uint alarm) {
+
+            host::FakeClock::getInstance().cancelAlarm(alarm);
+        }
+
+    private:
+
+        static void alarmIRQ(const uint alarm, void * const context) {
+
+            s_callbacks[alarm](context);
+        }
+
+        inline static std::recursive_mutex s_mutex{};                          ///< Stand in for masking the interrupts
+        inline static void (*s_callbacks[host::NUMBER_ALARMS])(void *){};     ///< Callback of every alarm
+    };
+
+} // namespace hal::timers::detail
+
+#endif //EMBEDDEDLIBRARY_TIMERWHEEL_HOST_H
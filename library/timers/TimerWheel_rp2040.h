@@ -0,0 +1,102 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_TIMERWHEEL_RP2040_H
+#define EMBEDDEDLIBRARY_TIMERWHEEL_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+
+namespace hal::timers::detail {
+
+    /**
+     * Access to the RP2040 timer: the 64 bits microsecond counter and its 4 alarms.
+     */
+    struct TimerWheelIO {
+
+        static constexpr uint NO_ALARM{NUM_TIMERS};     ///< returned when every alarm is used
+
+        /**
+         * Section where the wheel is modified, by the code or the alarm interrupt.
+         */
+        class CriticalSection {
+        public:
+
+            CriticalSection() : m_status{save_and_disable_interrupts()} {}
+
+            ~CriticalSection() {
+
+                restore_interrupts(m_status);
+            }
+
+        private:
+
+            uint32_t m_status;
+        };
+
+        /**
+         * @return time in microseconds
+         */
+        static uint64_t now() {
+
+            return time_us_64();
+        }
+
+        /**
+         * @return alarm claimed, NO_ALARM if every alarm is used
+         */
+        static uint claimAlarm() {
+
+            const int alarm{hardware_alarm_claim_unused(false)};
+
+            return alarm < 0 ? NO_ALARM : static_cast<uint>(alarm);
+        }
+
+        static void unclaimAlarm(const uint alarm) {
+
+            hardware_alarm_set_callback(alarm, nullptr);
+            hardware_alarm_unclaim(alarm);
+        }
+
+        /**
+         * Arm an alarm.
+         *
+         * @param alarm alarm claimed
+         * @param target time in microseconds
+         * @param callback function called from the alarm interrupt
+         * @param context passed to the callback
+         * @return whether the target is already reached, the alarm is not armed then
+         */
+        static bool setAlarm(const uint alarm, const uint64_t target, void (* const callback)(void *), void * const context) {
+
+            s_callbacks[alarm] = callback;
+            s_contexts[alarm] = context;
+
+            hardware_alarm_set_callback(alarm, alarmIRQ);
+
+            return hardware_alarm_set_target(alarm, from_us_since_boot(target));
+        }
+
+        static void cancelAlarm(const uint alarm) {
+
+            hardware_alarm_cancel(alarm);
+        }
+
+    private:
+
+        // The SDK callback only gets the alarm number
+        static void alarmIRQ(const uint alarm) {
+
+            s_callbacks[alarm](s_contexts[alarm]);
+        }
+
+        inline static void (*s_callbacks[NUM_TIMERS])(void *){};   ///< Callback of every alarm
+        inline static void *s_contexts[NUM_TIMERS]{};              ///< Context of every alarm
+    };
+
+} // namespace hal::timers::detail
+
+#endif //EMBEDDEDLIBRARY_TIMERWHEEL_RP2040_H
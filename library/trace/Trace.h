@@ -0,0 +1,236 @@
+/**
+ * @file Trace.h
+ * @brief Provide scoped trace probes recording timestamped begin/end events into a ring per core
+ *
+ * @ref HAL_TRACE_SCOPE "HAL_TRACE_SCOPE(name)" records a BEGIN event where it is declared and an END event when the
+ * scope exits. The probes are compiled in only when HAL_TRACE is defined, they expand to nothing otherwise.
+ *
+ * - An event is a timestamp (the low 32 bits of @ref hal::clock::now_cycles() "now_cycles()"), the address of the
+ *   name and a phase. Nothing is formatted or copied while recording.
+ * - Every core writes into its own ring of @ref hal::trace::TRACE_BUFFER_SIZE "TRACE_BUFFER_SIZE" events, the
+ *   oldest events are overwritten: the ring always holds the last events before a problem.
+ * - The rings are sent with @ref hal::trace::exportTrace() "exportTrace()" (TraceExport.h) and converted to the
+ *   Chrome trace format on host with @ref hal::trace::traceToJson() "traceToJson()" (TraceJson.h).
+ *
+ * @code{cpp}
+ * void UART::write(const uint8_t * const buffer, const size_t length) {
+ *
+ *     HAL_TRACE_SCOPE("uart.write");
+ *     ...
+ * }
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_TRACE_H
+#define EMBEDDEDLIBRARY_TRACE_H
+
+#include <atomic>
+#include <span>
+
+#include "../clock/Clock.h"
+#include "../commons/commons.h"
+#include "../traits/Singleton.h"
+
+#ifdef HAL_RP2040
+#include "Trace_rp2040.h"
+#elif defined(HAL_HOST)
+#include "Trace_host.h"
+#else
+#error "No implementation available for your platform"
+#endif
+
+namespace hal::trace {
+
+    constexpr size_t TRACE_BUFFER_SIZE{HAL_TRACE_BUFFER_SIZE};  ///< number of events kept per core
+    constexpr size_t TRACE_NAMES{HAL_TRACE_NAMES};              ///< number of distinct names an export can hold
+    constexpr uint TRACE_CORES{detail::TraceIO::CORES};         ///< number of rings
+
+    static_assert(TRACE_BUFFER_SIZE > 0 and (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0,
+                  "The trace buffer size must be a power of two");
+
+    /**
+     * Phase of an event
+     */
+    enum class Phase : uint8_t {
+
+        BEGIN,
+        END
+    };
+
+    /**
+     * Event recorded by a probe.
+     */
+    struct Event {
+
+        uint32_t timestamp;     ///< Low 32 bits of now_cycles()
+        Phase phase;            ///< Entering or leaving the scope
+        const char *name;       ///< Name of the probe, a string literal
+    };
+
+    /**
+     * Rings of events, one per core.
+     */
+    class Tracer : public traits::Singleton {
+    public:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        ~Tracer() override =default;
+
+        //****************************************************************
+        //                             Functions
+        //****************************************************************
+
+        /**
+         * Record an event in the ring of the calling core, from the code or an interrupt.
+         *
+         * @param name name of the probe, must outlive the tracer (string literal)
+         * @param phase phase of the event
+         */
+        void record(const char * const name, const Phase phase) {
+
+            if(!m_enabled.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            const uint32_t timestamp{static_cast<uint32_t>(clock::now_cycles())};
+            Ring &ring{m_rings[detail::TraceIO::core()]};
+
+            ring.events[detail::TraceIO::claim(ring.head) & (TRACE_BUFFER_SIZE - 1)] = {timestamp, phase, name};
+        }
+
+        /**
+         * Pause or resume the recording, an export pauses it while it reads the rings.
+         *
+         * @param enabled whether the probes record
+         */
+        void setEnabled(const bool enabled) {
+
+            m_enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool isEnabled() const {
+
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Drop every event.
+         */
+        void clear() {
+
+            for(Ring &ring : m_rings) {
+                ring.head = 0;
+            }
+        }
+
+        /**
+         * @param core ring to read
+         * @return number of events recorded in the ring since the last clear(), overwritten ones included
+         */
+        [[nodiscard]] uint32_t getRecorded(const uint core) const {
+
+            return detail::TraceIO::load(m_rings[core].head);
+        }
+
+        /**
+         * Copy the events kept in a ring, oldest first.
+         *
+         * @note Pause the recording first, the events recorded during the copy may be torn otherwise.
+         *
+         * @param core ring to read
+         * @param events receive the events
+         * @param first number of kept events to skip, to read the ring in chunks
+         * @return number of events copied
+         */
+        size_t getEvents(const uint core, const std::span<Event> events, const size_t first=0) const {
+
+            const Ring &ring{m_rings[core]};
+            const uint32_t head{detail::TraceIO::load(ring.head)};
+            const size_t kept{head < TRACE_BUFFER_SIZE ? head : TRACE_BUFFER_SIZE};
+
+            if(first >= kept) {
+                return 0;
+            }
+
+            const size_t count{kept - first < events.size() ? kept - first : events.size()};
+            const size_t oldest{head - kept + first};
+
+            for(size_t i{0}; i < count; i++) {
+                events[i] = ring.events[(oldest + i) & (TRACE_BUFFER_SIZE - 1)];
+            }
+
+            return count;
+        }
+
+        static Tracer &getInstance() {
+
+            static Tracer s_tracer{};
+            return s_tracer;
+        }
+
+    protected:
+
+        //****************************************************************
+        //                   Constructors and Destructor
+        //****************************************************************
+
+        Tracer() : m_rings{}, m_enabled{true} {}
+
+        struct Ring {
+
+            Event events[TRACE_BUFFER_SIZE];    ///< Last events
+            uint32_t head;                      ///< Number of events recorded, the next slot modulo the size
+        };
+
+        Ring m_rings[TRACE_CORES];          ///< Ring of every core
+        std::atomic<bool> m_enabled;        ///< Whether the probes record
+    };
+
+    /**
+     * Record a BEGIN event when built and an END event when destroyed, see @ref HAL_TRACE_SCOPE.
+     */
+    class Scope {
+    public:
+
+        /**
+         * @param name name of the probe, a string literal
+         */
+        template<size_t N>
+        explicit Scope(const char (&name)[N]) : m_name{name} {
+
+            Tracer::getInstance().record(m_name, Phase::BEGIN);
+        }
+
+        Scope(const Scope &)=delete;
+        Scope &operator=(const Scope &)=delete;
+
+        ~Scope() {
+
+            Tracer::getInstance().record(m_name, Phase::END);
+        }
+
+    private:
+
+        const char *m_name;     ///< Name of the probe
+    };
+
+} // namespace hal::trace
+
+#define HAL_TRACE_CONCAT_(a, b) a##b
+#define HAL_TRACE_CONCAT(a, b) HAL_TRACE_CONCAT_(a, b)
+
+#ifdef HAL_TRACE
+/**
+ * Trace the rest of the enclosing scope, removed unless HAL_TRACE is defined.
+ *
+ * @param name name of the probe, a string literal
+ */
+#define HAL_TRACE_SCOPE(name) const ::hal::trace::Scope HAL_TRACE_CONCAT(hal_trace_scope_, __LINE__){name}
+#else
+#define HAL_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif //EMBEDDEDLIBRARY_TRACE_H
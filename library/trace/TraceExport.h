@@ -0,0 +1,212 @@
+/**
+ * @file TraceExport.h
+ * @brief Stream the trace rings over a UART, or any byte writer, in a compact binary format
+ *
+ * The export is a sequence of COBS frames (see Cobs.h), each one ends with 0x00 and starts with its type:
+ *
+ * | Type | Content                                                                                           |
+ * |------|---------------------------------------------------------------------------------------------------|
+ * | 'T'  | version (1 byte, 1), cycles per second (varint), number of cores (1 byte)                         |
+ * | 'N'  | name identifier (varint), then the name (the rest of the frame, not null terminated)              |
+ * | 'E'  | core (1 byte), then events: timestamp delta (varint), identifier << 1 \| phase (varint)           |
+ *
+ * The timestamps are the low 32 bits of the cycle counter, the delta of the first event of an 'E' frame is from 0,
+ * the next ones from the previous event of the frame, modulo 2^32. An event takes 3 to 4 bytes on the wire.
+ *
+ * The 'N' frames are all sent before the first 'E' frame. Events whose name does not fit in the
+ * @ref hal::trace::TRACE_NAMES "TRACE_NAMES" identifiers are dropped.
+ *
+ * @code{cpp}
+ * // After a latency spike
+ * hal::trace::exportTrace(uart);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_TRACEEXPORT_H
+#define EMBEDDEDLIBRARY_TRACEEXPORT_H
+
+#include <cstring>
+#include <span>
+
+#include "../clock/Clock.h"
+#include "../commons/commons.h"
+#include "../serialization/BufferSerializer.h"
+#include "../serialization/Cobs.h"
+#include "../serialization/Varint.h"
+#include "Trace.h"
+
+namespace hal::trace {
+
+    constexpr uint8_t TRACE_FORMAT_VERSION{1};      ///< version sent in the 'T' frame
+    constexpr size_t TRACE_FRAME_SIZE{128};         ///< maximal size of a decoded frame
+    constexpr size_t TRACE_EXPORT_CHUNK{16};        ///< number of events copied from a ring at a time
+
+    /// Type of a trace frame, its first byte
+    enum class FrameType : uint8_t {
+
+        HEADER = 'T',
+        NAME = 'N',
+        EVENTS = 'E'
+    };
+
+    namespace detail {
+
+        /**
+         * Names of the probes met in the rings, the index is the identifier sent on the wire.
+         */
+        class NameTable {
+        public:
+
+            /**
+             * @param name name of a probe
+             * @return identifier of the name, TRACE_NAMES if it is not in the table
+             */
+            [[nodiscard]] size_t find(const char * const name) const {
+
+                for(size_t i{0}; i < m_count; i++) {
+
+                    // Compare the addresses first, the same literal is usually merged by the linker
+                    if(m_names[i] == name or strcmp(m_names[i], name) == 0) {
+                        return i;
+                    }
+                }
+
+                return TRACE_NAMES;
+            }
+
+            /**
+             * @param name name of a probe
+             * @return whether the name was added, false if it is already there or the table is full
+             */
+            bool add(const char * const name) {
+
+                if(m_count == TRACE_NAMES or find(name) != TRACE_NAMES) {
+                    return false;
+                }
+
+                m_names[m_count++] = name;
+
+                return true;
+            }
+
+            [[nodiscard]] size_t size() const {
+
+                return m_count;
+            }
+
+            [[nodiscard]] const char *operator[](const size_t id) const {
+
+                return m_names[id];
+            }
+
+        private:
+
+            const char *m_names[TRACE_NAMES]{};     ///< Names, by identifier
+            size_t m_count{0};                      ///< Number of names
+        };
+
+        template<concepts::is_byte_writer Sink>
+        void sendFrame(Sink &sink, const std::span<const uint8_t> frame) {
+
+            serialization::CobsEncoder<Sink> encoder{sink};
+
+            encoder.write(frame);
+            encoder.end();
+        }
+
+    } // namespace detail
+
+    /**
+     * Send the events kept in every ring, the recording is paused during the export.
+     *
+     * @tparam Sink byte writer, e.g. an @ref hal::interfaces::InterfaceUART "InterfaceUART"
+     * @param sink writer receiving the frames
+     * @return number of events sent
+     */
+    template<concepts::is_byte_writer Sink>
+    size_t exportTrace(Sink &sink) {
+
+        Tracer &tracer{Tracer::getInstance()};
+        const bool enabled{tracer.isEnabled()};
+
+        tracer.setEnabled(false);
+
+        uint8_t frame[TRACE_FRAME_SIZE];
+        serialization::BufferWriter writer{frame};
+        detail::NameTable names{};
+        Event events[TRACE_EXPORT_CHUNK];
+        size_t sent{0};
+
+        writer.write(static_cast<uint8_t>(FrameType::HEADER), TRACE_FORMAT_VERSION);
+        serialization::writeVarint(writer, clock::cycles_frequency());
+        writer.write(static_cast<uint8_t>(TRACE_CORES));
+        detail::sendFrame(sink, writer.getWritten());
+
+        for(uint core{0}; core < TRACE_CORES; core++) {
+            for(size_t first{0}, count{0}; (count = tracer.getEvents(core, events, first)) > 0; first += count) {
+                for(size_t i{0}; i < count; i++) {
+
+                    if(!names.add(events[i].name)) {
+                        continue;
+                    }
+
+                    const size_t length{strnlen(events[i].name, TRACE_FRAME_SIZE - 1 - serialization::varint_max_size_v<size_t>)};
+
+                    writer.reset();
+                    writer.write(static_cast<uint8_t>(FrameType::NAME));
+                    serialization::writeVarint(writer, names.size() - 1);
+                    writer.writeBytes({reinterpret_cast<const uint8_t *>(events[i].name), length});
+                    detail::sendFrame(sink, writer.getWritten());
+                }
+            }
+        }
+
+        for(uint core{0}; core < TRACE_CORES; core++) {
+
+            uint32_t previous{0};
+
+            writer.reset();
+
+            for(size_t first{0}, count{0}; (count = tracer.getEvents(core, events, first)) > 0; first += count) {
+                for(size_t i{0}; i < count; i++) {
+
+                    const size_t id{names.find(events[i].name)};
+
+                    if(id == TRACE_NAMES) {
+                        continue;
+                    }
+
+                    // Start a new frame when the event may not fit
+                    if(writer.getRemaining() < serialization::varint_max_size_v<uint32_t> + serialization::varint_max_size_v<size_t>) {
+
+                        detail::sendFrame(sink, writer.getWritten());
+                        writer.reset();
+                    }
+
+                    if(writer.getPosition() == 0) {
+
+                        writer.write(static_cast<uint8_t>(FrameType::EVENTS), static_cast<uint8_t>(core));
+                        previous = 0;
+                    }
+
+                    serialization::writeVarint(writer, static_cast<uint32_t>(events[i].timestamp - previous));
+                    serialization::writeVarint(writer, id << 1U | static_cast<size_t>(events[i].phase));
+
+                    previous = events[i].timestamp;
+                    sent++;
+                }
+            }
+
+            if(writer.getPosition() > 0) {
+                detail::sendFrame(sink, writer.getWritten());
+            }
+        }
+
+        tracer.setEnabled(enabled);
+
+        return sent;
+    }
+
+} // namespace hal::trace
+
+#endif //EMBEDDEDLIBRARY_TRACEEXPORT_H
@@ -0,0 +1,181 @@
+/**
+ * @file TraceJson.h
+ * @brief Convert an exported trace (see TraceExport.h) to the Chrome trace event format, on host
+ *
+ * The JSON opens in chrome://tracing or https://ui.perfetto.dev, one row per core. The 32 bits timestamps are
+ * unwrapped per core, events more than 2^32 cycles apart (34 s at 125 MHz) cannot be told apart.
+ *
+ * @code{cpp}
+ * std::string json;
+ * hal::trace::traceToJson(captured_bytes, json);
+ * @endcode
+ */
+
+#ifndef EMBEDDEDLIBRARY_TRACEJSON_H
+#define EMBEDDEDLIBRARY_TRACEJSON_H
+
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../commons/commons.h"
+#include "../serialization/BufferSerializer.h"
+#include "../serialization/Cobs.h"
+#include "../serialization/Varint.h"
+#include "TraceExport.h"
+
+namespace hal::trace {
+
+    namespace detail {
+
+        inline void appendJsonString(std::string &json, const std::string_view text) {
+
+            json += '"';
+
+            for(const char c : text) {
+
+                if(c == '"' or c == '\\') {
+
+                    json += '\\';
+                    json += c;
+                } else if(static_cast<unsigned char>(c) < 0x20U) {
+
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    json += escaped;
+                } else {
+
+                    json += c;
+                }
+            }
+
+            json += '"';
+        }
+
+    } // namespace detail
+
+    /**
+     * Convert an exported trace to the Chrome trace event format.
+     *
+     * @param stream bytes received from @ref hal::trace::exportTrace() "exportTrace()", complete frames
+     * @param json receive the JSON document
+     * @return whether an error occurred: a frame could not be decoded, comes before the header, or references
+     * an unknown name. The frames before the error are converted.
+     */
+    inline bool traceToJson(const std::span<const uint8_t> stream, std::string &json) {
+
+        std::vector<std::string> names;
+        std::vector<uint64_t> last;         // Unwrapped timestamp of the last event, per core
+        uint64_t frequency{0};
+        bool error{false};
+        bool first_event{true};
+
+        std::vector<uint8_t> frame(stream.size());
+        serialization::CobsDecoder decoder{frame};
+
+        json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        for(size_t position{0}; position < stream.size() and !error;) {
+
+            size_t consumed{0};
+            const enum Error status{decoder.decode(stream.subspan(position), consumed)};
+
+            position += consumed;
+
+            if(status == Error::AGAIN) {
+                break;
+            }
+
+            if(status != Error::NONE) {
+
+                error = true;
+                break;
+            }
+
+            serialization::BufferReader reader{decoder.getFrame()};
+            uint8_t type{0};
+
+            reader.read(type);
+
+            switch(static_cast<FrameType>(type)) {
+
+                case FrameType::HEADER: {
+
+                    uint8_t version{0};
+                    uint8_t cores{0};
+
+                    error = reader.read(version) or version != TRACE_FORMAT_VERSION
+                            or serialization::readVarint(reader, frequency) or frequency == 0 or reader.read(cores);
+
+                    last.assign(cores, 0);
+                    break;
+                }
+
+                case FrameType::NAME: {
+
+                    size_t id{0};
+                    error = serialization::readVarint(reader, id) or id != names.size();
+
+                    const std::span<const uint8_t> text{reader.view(reader.getRemaining())};
+                    names.emplace_back(text.begin(), text.end());
+                    break;
+                }
+
+                case FrameType::EVENTS: {
+
+                    uint8_t core{0};
+
+                    if(frequency == 0 or reader.read(core) or core >= last.size()) {
+
+                        error = true;
+                        break;
+                    }
+
+                    uint32_t timestamp{0};
+
+                    while(reader.getRemaining() > 0 and !error) {
+
+                        uint32_t delta{0};
+                        size_t tag{0};
+
+                        if(serialization::readVarint(reader, delta) or serialization::readVarint(reader, tag) or (tag >> 1U) >= names.size()) {
+
+                            error = true;
+                            break;
+                        }
+
+                        timestamp += delta;
+
+                        // Unwrap from the previous event of the core, the events are in order
+                        last[core] += static_cast<uint32_t>(timestamp - static_cast<uint32_t>(last[core]));
+
+                        char fields[96];
+                        snprintf(fields, sizeof(fields), ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+                                 (tag & 1U) == static_cast<size_t>(Phase::BEGIN) ? 'B' : 'E',
+                                 static_cast<double>(last[core]) * 1e6 / static_cast<double>(frequency), static_cast<unsigned>(core));
+
+                        json += first_event ? "{\"name\":" : ",{\"name\":";
+                        detail::appendJsonString(json, names[tag >> 1U]);
+                        json += fields;
+
+                        first_event = false;
+                    }
+                    break;
+                }
+
+                default:
+                    error = true;
+                    break;
+            }
+        }
+
+        json += "]}";
+
+        return error;
+    }
+
+} // namespace hal::trace
+
+#endif //EMBEDDEDLIBRARY_TRACEJSON_H
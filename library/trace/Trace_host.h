@@ -0,0 +1,52 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_TRACE_HOST_H
+#define EMBEDDEDLIBRARY_TRACE_HOST_H
+
+#include "../commons/commons.h"
+
+#include <atomic>
+
+namespace hal::trace::detail {
+
+    /**
+     * Host recording: one ring shared by every thread, the slots are claimed with an atomic increment.
+     */
+    struct TraceIO {
+
+        static constexpr uint CORES{1};     ///< number of rings
+
+        /**
+         * @return ring of the caller
+         */
+        static uint core() {
+
+            return 0;
+        }
+
+        /**
+         * Claim the next slot of a ring, from any thread.
+         *
+         * @param head number of events recorded in the ring
+         * @return index of the slot claimed
+         */
+        static uint32_t claim(uint32_t &head) {
+
+            return std::atomic_ref<uint32_t>{head}.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @param head number of events recorded in the ring
+         * @return head, read while the ring may be recorded
+         */
+        static uint32_t load(const uint32_t &head) {
+
+            return std::atomic_ref<const uint32_t>{head}.load(std::memory_order_acquire);
+        }
+    };
+
+} // namespace hal::trace::detail
+
+#endif //EMBEDDEDLIBRARY_TRACE_HOST_H
@@ -0,0 +1,61 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#ifndef EMBEDDEDLIBRARY_TRACE_RP2040_H
+#define EMBEDDEDLIBRARY_TRACE_RP2040_H
+
+#include "../commons/commons.h"
+
+#include <hardware/sync.h>
+#include <pico/platform.h>
+
+namespace hal::trace::detail {
+
+    /**
+     * RP2040 recording: one ring per core, so a ring is only shared between the code and the interrupts of its core.
+     * The Cortex-M0+ has no atomic increment, a slot is claimed with the interrupts masked for a few cycles.
+     */
+    struct TraceIO {
+
+        static constexpr uint CORES{NUM_CORES};     ///< number of rings
+
+        /**
+         * @return ring of the caller
+         */
+        static uint core() {
+
+            return get_core_num();
+        }
+
+        /**
+         * Claim the next slot of the ring of the calling core.
+         *
+         * @param head number of events recorded in the ring
+         * @return index of the slot claimed
+         */
+        static uint32_t claim(uint32_t &head) {
+
+            const uint32_t status{save_and_disable_interrupts()};
+            const uint32_t index{head};
+
+            head = index + 1;
+
+            restore_interrupts(status);
+
+            return index;
+        }
+
+        /**
+         * @param head number of events recorded in the ring
+         * @return head, read while the ring may be recorded
+         */
+        static uint32_t load(const uint32_t &head) {
+
+            return *static_cast<const volatile uint32_t *>(&head);
+        }
+    };
+
+} // namespace hal::trace::detail
+
+#endif //EMBEDDEDLIBRARY_TRACE_RP2040_H
@@ -0,0 +1,199 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "async/Awaitables.h"
+#include "async/Scheduler.h"
+#include "async/Task.h"
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/GpioIRQ.h"
+#include "peripherals/UART.h"
+
+#include <unistd.h>
+
+using hal::async::Scheduler;
+using hal::async::Task;
+
+namespace {
+
+    Task<int> square(const int value) {
+
+        co_return value * value;
+    }
+
+    Task<int> sumOfSquares(const int a, const int b) {
+
+        const int first{co_await square(a)};
+        const int second{co_await square(b)};
+
+        co_return first + second;
+    }
+
+    Task<> store(int &result) {
+
+        result = co_await sumOfSquares(3, 4);
+    }
+
+    Task<> sleepThenLog(const uint32_t ms, const int id, std::vector<int> &log) {
+
+        co_await hal::async::delay(ms);
+        log.push_back(id);
+    }
+
+    Task<> yieldThenLog(const int id, std::vector<int> &log) {
+
+        for(int i{0}; i < 3; i++) {
+            log.push_back(id * 10 + i);
+            co_await hal::async::yield();
+        }
+    }
+
+    Task<> echo(hal::interfaces::InterfaceUART &uart, hal::async::TransferResult &result) {
+
+        uint8_t line[8];
+
+        result = co_await hal::async::read(uart, line);
+
+        if(result.error == hal::Error::NONE) {
+            result = co_await hal::async::write(uart, {line, result.count});
+        }
+    }
+
+    Task<> waitEdge(hal::interfaces::InterfaceDigitalGPIO &gpio, hal::Error &error, bool &done) {
+
+        error = co_await hal::async::waitIRQ(gpio, hal::peripherals::gpio::IRQ::EDGE_RISE);
+        done = true;
+    }
+
+    Task<> driveLater(const uint gpio_pin, const bool &done, bool &early) {
+
+        co_await hal::async::delay(5);
+
+        early = done;
+        hal::host::PinBank::getInstance().drive(gpio_pin, true);
+    }
+
+} // namespace
+
+TEST(Async, nested_tasks) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    int result{0};
+
+    EXPECT_FALSE(scheduler.spawn(store(result)));
+    EXPECT_EQ(scheduler.getTaskCount(), 1U);
+
+    scheduler.run();
+
+    EXPECT_EQ(result, 25);
+    EXPECT_EQ(scheduler.getTaskCount(), 0U);
+    EXPECT_EQ(hal::async::detail::FramePool::getUsed(), 0U);
+}
+
+TEST(Async, delay_order) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    std::vector<int> log;
+
+    const uint64_t start{Scheduler::now()};
+
+    scheduler.spawn(sleepThenLog(30, 3, log));
+    scheduler.spawn(sleepThenLog(10, 1, log));
+    scheduler.spawn(sleepThenLog(20, 2, log));
+
+    scheduler.run();
+
+    EXPECT_EQ(log, (std::vector<int>{1, 2, 3}));
+    EXPECT_GE(Scheduler::now() - start, 30'000U);
+}
+
+TEST(Async, yield_interleaves) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    std::vector<int> log;
+
+    scheduler.spawn(yieldThenLog(1, log));
+    scheduler.spawn(yieldThenLog(2, log));
+
+    scheduler.run();
+
+    EXPECT_EQ(log, (std::vector<int>{10, 20, 11, 21, 12, 22}));
+}
+
+TEST(Async, frame_pool_exhausted) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    std::vector<int> log;
+    size_t spawned{0};
+
+    for(size_t i{0}; i < hal::async::COROUTINE_FRAMES + 2; i++) {
+        if(!scheduler.spawn(sleepThenLog(1, static_cast<int>(i), log))) {
+            spawned++;
+        }
+    }
+
+    EXPECT_EQ(spawned, hal::async::COROUTINE_FRAMES);
+    EXPECT_EQ(scheduler.getLastError(), hal::Error::TOOSMALL);
+    EXPECT_EQ(hal::async::detail::FramePool::getUsed(), hal::async::COROUTINE_FRAMES);
+
+    scheduler.run();
+
+    EXPECT_EQ(log.size(), hal::async::COROUTINE_FRAMES);
+    EXPECT_EQ(hal::async::detail::FramePool::getUsed(), 0U);
+}
+
+TEST(Async, uart_echo) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.setBuffered(false);
+
+    const uint8_t data[8]{'a', 's', 'y', 'n', 'c', '!', '\r', '\n'};
+    uint8_t received[8]{};
+    hal::async::TransferResult result{hal::Error::ERROR, 0};
+
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+
+    scheduler.spawn(echo(uart, result));
+    scheduler.run();
+
+    EXPECT_EQ(result.error, hal::Error::NONE);
+    EXPECT_EQ(result.count, sizeof(data));
+    EXPECT_EQ(::read(uart.getPeer(), received, sizeof(received)), static_cast<ssize_t>(sizeof(received)));
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    uart.deinit();
+}
+
+TEST(Async, gpio_edge) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    auto &dispatcher{hal::peripherals::gpio::IRQDispatcher::getInstance()};
+
+    for(uint gpio_pin{0}; gpio_pin < hal::NUMBER_GPIO_PIN; gpio_pin++) {
+        dispatcher.detach(gpio_pin);
+    }
+
+    hal::host::PinBank::getInstance().reset();
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO6};
+    gpio.setDirection(hal::peripherals::gpio::Direction::IN);
+
+    hal::Error error{hal::Error::ERROR};
+    bool done{false};
+    bool early{true};
+
+    scheduler.spawn(waitEdge(gpio, error, done));
+    scheduler.spawn(driveLater(hal::GPIO6, done, early));
+    scheduler.run();
+
+    EXPECT_FALSE(early);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(error, hal::Error::NONE);
+    EXPECT_EQ(gpio.getIRQ(), hal::peripherals::gpio::IRQ::NONE);
+}
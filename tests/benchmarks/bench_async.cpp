@@ -0,0 +1,81 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "async/Awaitables.h"
+#include "async/Scheduler.h"
+#include "async/Task.h"
+
+using hal::async::Scheduler;
+using hal::async::Task;
+
+namespace {
+
+    Task<> yieldLoop(const int64_t count) {
+
+        for(int64_t i{0}; i < count; i++) {
+            co_await hal::async::yield();
+        }
+    }
+
+    Task<int> value(const int v) {
+
+        co_return v;
+    }
+
+    Task<> awaitLoop(const int64_t count, int &sum) {
+
+        for(int64_t i{0}; i < count; i++) {
+            sum += co_await value(1);
+        }
+    }
+
+    Task<> empty() {
+
+        co_return;
+    }
+
+} // namespace
+
+static void BM_Async_Yield(benchmark::State &state) {
+
+    auto &scheduler{Scheduler::getInstance()};
+
+    for(auto _ : state) {
+        scheduler.spawn(yieldLoop(1'000));
+        scheduler.run();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1'000);
+}
+BENCHMARK(BM_Async_Yield);
+
+static void BM_Async_AwaitTask(benchmark::State &state) {
+
+    auto &scheduler{Scheduler::getInstance()};
+    int sum{0};
+
+    for(auto _ : state) {
+        scheduler.spawn(awaitLoop(1'000, sum));
+        scheduler.run();
+    }
+
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * 1'000);
+}
+BENCHMARK(BM_Async_AwaitTask);
+
+static void BM_Async_SpawnRun(benchmark::State &state) {
+
+    auto &scheduler{Scheduler::getInstance()};
+
+    for(auto _ : state) {
+        scheduler.spawn(empty());
+        scheduler.run();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Async_SpawnRun);
@@ -0,0 +1,216 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "commons/commons.h"
+#include "data_structures/BitSet.h"
+
+#include <bit>
+#include <vector>
+
+// Bitmap of a 128x64 monochrome framebuffer, and larger ones
+static std::vector<uint8_t> makeBitmap(const size_t length) {
+
+    std::vector<uint8_t> bitmap(length);
+
+    for(size_t i{0}; i < length; i++) {
+        bitmap[i] = static_cast<uint8_t>(i * 131U + 7U);
+    }
+
+    return bitmap;
+}
+
+static void BM_Bits_SetBits_PerElement(benchmark::State &state) {
+
+    std::vector<uint8_t> bitmap{makeBitmap(static_cast<size_t>(state.range(0)))};
+
+    for(auto _ : state) {
+
+        for(auto &element : bitmap) {
+            hal::set_bits(element, uint8_t{0xA5});
+        }
+
+        benchmark::DoNotOptimize(bitmap.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_SetBits_PerElement)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_SetBits_Span(benchmark::State &state) {
+
+    std::vector<uint8_t> bitmap{makeBitmap(static_cast<size_t>(state.range(0)))};
+
+    for(auto _ : state) {
+
+        hal::set_bits(std::span{bitmap}, uint8_t{0xA5});
+
+        benchmark::DoNotOptimize(bitmap.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_SetBits_Span)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_Popcount_PerElement(benchmark::State &state) {
+
+    const std::vector<uint8_t> bitmap{makeBitmap(static_cast<size_t>(state.range(0)))};
+
+    for(auto _ : state) {
+
+        size_t count{0};
+
+        for(const auto element : bitmap) {
+            for(uint pos{0}; pos < 8; pos++) {
+                count += hal::check_bit(element, pos);
+            }
+        }
+
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_Popcount_PerElement)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_Popcount_Span(benchmark::State &state) {
+
+    const std::vector<uint8_t> bitmap{makeBitmap(static_cast<size_t>(state.range(0)))};
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(hal::popcount(std::span{bitmap}));
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_Popcount_Span)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_FindFirstSet_PerElement(benchmark::State &state) {
+
+    // Only the last bit is set
+    std::vector<uint8_t> bitmap(static_cast<size_t>(state.range(0) - 1));
+    bitmap.push_back(0x80);
+
+    for(auto _ : state) {
+
+        size_t pos{0};
+
+        while(pos < bitmap.size() * 8 and !hal::check_bit(bitmap.data()[pos / 8], pos % 8)) {
+            pos++;
+        }
+
+        benchmark::DoNotOptimize(pos);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_FindFirstSet_PerElement)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_FindFirstSet_Span(benchmark::State &state) {
+
+    // Only the last bit is set
+    std::vector<uint8_t> bitmap(static_cast<size_t>(state.range(0) - 1));
+    bitmap.push_back(0x80);
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(hal::find_first_set(std::span{bitmap}));
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_FindFirstSet_Span)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_CopyBits_PerBit(benchmark::State &state) {
+
+    const std::vector<uint8_t> src{makeBitmap(static_cast<size_t>(state.range(0)))};
+    std::vector<uint8_t> dst(src.size());
+    const size_t count{(src.size() - 1) * 8};
+
+    for(auto _ : state) {
+
+        // Copy with a 3 bit offset, one bit at a time
+        for(size_t i{0}; i < count; i++) {
+
+            const size_t to{i + 3};
+
+            if(hal::check_bit(src[i / 8], i % 8)) {
+                hal::set_bit(dst[to / 8], to % 8);
+            } else {
+                hal::clear_bit(dst[to / 8], to % 8);
+            }
+        }
+
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_CopyBits_PerBit)->Arg(1024)->Arg(64 * 1024);
+
+static void BM_Bits_CopyBits_Span(benchmark::State &state) {
+
+    const std::vector<uint8_t> src{makeBitmap(static_cast<size_t>(state.range(0)))};
+    std::vector<uint8_t> dst(src.size());
+    const size_t count{(src.size() - 1) * 8};
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(hal::copy_bits(std::span{dst}, 3, std::span{src}, 0, count));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Bits_CopyBits_Span)->Arg(1024)->Arg(64 * 1024);
+
+// Visit the set bits of a sparse 1024 bit event mask
+static void BM_Bits_IterateSet_CheckBit(benchmark::State &state) {
+
+    uint32_t flags[32]{};
+
+    for(size_t pos{0}; pos < 1024; pos += 37) {
+        hal::set_bit(flags[pos / 32], pos % 32);
+    }
+
+    for(auto _ : state) {
+
+        size_t sum{0};
+
+        for(size_t pos{0}; pos < 1024; pos++) {
+            if(hal::check_bit(flags[pos / 32], pos % 32)) {
+                sum += pos;
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_Bits_IterateSet_CheckBit);
+
+static void BM_Bits_IterateSet_BitSet(benchmark::State &state) {
+
+    hal::data_structures::BitSet<1024> flags{};
+
+    for(size_t pos{0}; pos < 1024; pos += 37) {
+        flags.set(pos);
+    }
+
+    for(auto _ : state) {
+
+        size_t sum{0};
+
+        for(const size_t pos : flags) {
+            sum += pos;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_Bits_IterateSet_BitSet);
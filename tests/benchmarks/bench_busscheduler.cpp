@@ -0,0 +1,56 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include "bus/BusScheduler.h"
+
+using hal::bus::I2CRequest;
+using hal::bus::I2CScheduler;
+
+/**
+ * Twelve sensors, six registers read by two requests each: the cost of the scheduler per request. The fake bus
+ * completes a request before submit() returns, so nothing queues up and nothing is coalesced.
+ */
+static void BM_BusScheduler_I2C(benchmark::State &state) {
+
+    auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    auto &scheduler{I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    std::array<hal::host::I2CRegisterDevice<16>, 12> sensors{};
+
+    i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+
+    const uint8_t regs[]{0x00, 0x03};
+    uint8_t samples[12][6]{};
+    I2CRequest requests[24];
+
+    for(size_t i{0}; i < sensors.size(); i++) {
+
+        const auto address{static_cast<uint8_t>(0x40 + i)};
+
+        i2c.attach(address, sensors[i]);
+        requests[2 * i] = {{address, {&regs[0], 1}, {samples[i], 3}}};
+        requests[2 * i + 1] = {{address, {&regs[1], 1}, {samples[i] + 3, 3}}};
+    }
+
+    for(auto _ : state) {
+
+        for(I2CRequest &request : requests) {
+            scheduler.submit(request);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(std::size(requests)));
+
+    for(size_t i{0}; i < sensors.size(); i++) {
+        i2c.detach(static_cast<uint8_t>(0x40 + i));
+    }
+
+    i2c.deinit();
+}
+BENCHMARK(BM_BusScheduler_I2C);
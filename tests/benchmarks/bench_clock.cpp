@@ -0,0 +1,31 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "clock/Clock.h"
+
+static void BM_Clock_NowUs(benchmark::State &state) {
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(hal::clock::now_us());
+    }
+}
+BENCHMARK(BM_Clock_NowUs);
+
+static void BM_Clock_NowCycles(benchmark::State &state) {
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(hal::clock::now_cycles());
+    }
+}
+BENCHMARK(BM_Clock_NowCycles);
+
+static void BM_Clock_ChronoNow(benchmark::State &state) {
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(hal::clock::Clock::now());
+    }
+}
+BENCHMARK(BM_Clock_ChronoNow);
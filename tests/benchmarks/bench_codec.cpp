@@ -0,0 +1,134 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "serialization/Cobs.h"
+#include "serialization/Varint.h"
+
+using hal::serialization::BufferReader;
+using hal::serialization::BufferWriter;
+
+namespace {
+
+    /// Sink copying into a buffer, like a DMA or a ring would
+    struct BufferSink {
+
+        void write(const uint8_t * const data, const size_t length) {
+
+            memcpy(buffer + position, data, length);
+            position += length;
+        }
+
+        uint8_t *buffer;
+        size_t position;
+    };
+
+    std::vector<uint8_t> payload(const size_t length) {
+
+        std::mt19937 generator{42};
+        std::vector<uint8_t> data(length);
+
+        for(auto &byte : data) {
+            byte = static_cast<uint8_t>(generator() % 16 == 0 ? 0 : generator());
+        }
+
+        return data;
+    }
+
+} // namespace
+
+static void BM_Varint_Write(benchmark::State &state) {
+
+    uint8_t buffer[64 * hal::serialization::varint_max_size_v<int32_t>]{};
+    int32_t value{0};
+
+    for(auto _ : state) {
+
+        BufferWriter writer{buffer};
+
+        for(size_t i{0}; i < 64; i++) {
+            writeVarint(writer, value);
+            value += 37;
+        }
+
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+BENCHMARK(BM_Varint_Write);
+
+static void BM_Varint_Read(benchmark::State &state) {
+
+    uint8_t buffer[64 * hal::serialization::varint_max_size_v<int32_t>]{};
+    BufferWriter writer{buffer};
+
+    for(int32_t i{0}; i < 64; i++) {
+        writeVarint(writer, i * i * (i % 2 == 0 ? 1 : -1));
+    }
+
+    for(auto _ : state) {
+
+        BufferReader reader{writer.getWritten()};
+        int32_t value{0};
+
+        for(size_t i{0}; i < 64; i++) {
+            readVarint(reader, value);
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+BENCHMARK(BM_Varint_Read);
+
+static void BM_Cobs_Encode(benchmark::State &state) {
+
+    const std::vector<uint8_t> data{payload(static_cast<size_t>(state.range(0)))};
+    std::vector<uint8_t> encoded(hal::serialization::cobsMaxEncodedSize(data.size()) + 1);
+
+    for(auto _ : state) {
+
+        BufferSink sink{encoded.data(), 0};
+        hal::serialization::CobsEncoder encoder{sink};
+
+        encoder.write(data);
+        encoder.end();
+
+        benchmark::DoNotOptimize(sink.position);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Cobs_Encode)->Arg(64)->Arg(1024);
+
+static void BM_Cobs_Decode(benchmark::State &state) {
+
+    const std::vector<uint8_t> data{payload(static_cast<size_t>(state.range(0)))};
+    std::vector<uint8_t> encoded(hal::serialization::cobsMaxEncodedSize(data.size()) + 1);
+    std::vector<uint8_t> frame(data.size());
+
+    BufferSink sink{encoded.data(), 0};
+    hal::serialization::CobsEncoder encoder{sink};
+    encoder.write(data);
+    encoder.end();
+    encoded.resize(sink.position);
+
+    hal::serialization::CobsDecoder decoder{frame};
+
+    for(auto _ : state) {
+
+        size_t consumed{0};
+        benchmark::DoNotOptimize(decoder.decode(encoded, consumed));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Cobs_Decode)->Arg(64)->Arg(1024);
@@ -0,0 +1,112 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "commons/commons.h"
+
+// Register-style read-modify-write: one bit at a time
+static void BM_Commons_SetClearBit(benchmark::State &state) {
+
+    uint32_t reg{0};
+    uint32_t pos{0};
+
+    for(auto _ : state) {
+
+        hal::set_bit(reg, pos);
+        benchmark::DoNotOptimize(hal::check_bit(reg, pos));
+        hal::clear_bit(reg, pos);
+
+        pos = (pos + 1U) & 31U;
+        benchmark::DoNotOptimize(reg);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Commons_SetClearBit);
+
+static void BM_Commons_ToggleBits(benchmark::State &state) {
+
+    uint32_t reg{0};
+    uint32_t mask{0x0000'00FFU};
+
+    for(auto _ : state) {
+
+        hal::toggle_bits(reg, mask);
+        benchmark::DoNotOptimize(hal::check_bits(reg, mask));
+
+        mask = mask << 1U | mask >> 31U;
+        benchmark::DoNotOptimize(reg);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Commons_ToggleBits);
+
+static void BM_Commons_SetBitsPos(benchmark::State &state) {
+
+    uint32_t reg{0};
+    uint32_t pos{0};
+
+    for(auto _ : state) {
+
+        hal::set_bits_pos(reg, pos, 0b101U);
+
+        pos = (pos + 1U) & 15U;
+        benchmark::DoNotOptimize(reg);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Commons_SetBitsPos);
+
+static void BM_Commons_MinMax(benchmark::State &state) {
+
+    int32_t a{-5};
+    uint32_t b{7};
+    float c{2.5f};
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(c);
+
+        benchmark::DoNotOptimize(hal::min(a, 3));
+        benchmark::DoNotOptimize(hal::max(b, 9U));
+        benchmark::DoNotOptimize(hal::max(c, 1.0f));
+    }
+
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_Commons_MinMax);
+
+// Pack a value and unpack it back, the round trip of a field through a wire buffer
+template<typename T>
+static void BM_Commons_TypeSerializer_RoundTrip(benchmark::State &state) {
+
+    hal::TypeSerializer ts{};
+    T value{};
+    uint8_t buffer[sizeof(T)];
+
+    for(auto _ : state) {
+
+        ts << value;
+        ts.unpack(buffer, sizeof(T));
+
+        ts.pack(buffer, sizeof(T));
+        ts >> value;
+
+        benchmark::DoNotOptimize(value);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(T)));
+}
+BENCHMARK(BM_Commons_TypeSerializer_RoundTrip<uint16_t>);
+BENCHMARK(BM_Commons_TypeSerializer_RoundTrip<uint32_t>);
+BENCHMARK(BM_Commons_TypeSerializer_RoundTrip<float>);
+BENCHMARK(BM_Commons_TypeSerializer_RoundTrip<double>);
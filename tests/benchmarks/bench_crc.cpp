@@ -0,0 +1,52 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "crc/Crc.h"
+
+using hal::crc::Algorithm;
+
+namespace {
+
+    std::vector<uint8_t> message(const size_t length) {
+
+        std::mt19937 generator{42};
+        std::vector<uint8_t> data(length);
+
+        for(auto &byte : data) {
+            byte = static_cast<uint8_t>(generator());
+        }
+
+        return data;
+    }
+
+} // namespace
+
+template<auto P, Algorithm A>
+static void BM_Crc(benchmark::State &state) {
+
+    const std::vector<uint8_t> data{message(static_cast<size_t>(state.range(0)))};
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(hal::crc::compute<P, A>(data));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC8, Algorithm::BITWISE)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC8, Algorithm::TABLE)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC8, Algorithm::SLICE_BY_8)->Arg(1024);
+
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC16_CCITT_FALSE, Algorithm::BITWISE)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC16_CCITT_FALSE, Algorithm::TABLE)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC16_CCITT_FALSE, Algorithm::SLICE_BY_8)->Arg(1024);
+
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC32, Algorithm::BITWISE)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC32, Algorithm::TABLE)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Crc, hal::crc::CRC32, Algorithm::SLICE_BY_8)->Arg(64)->Arg(1024)->Arg(65536);
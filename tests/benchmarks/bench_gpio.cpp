@@ -0,0 +1,68 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/Pin.h"
+
+using hal::peripherals::gpio::Direction;
+
+static void BM_GPIO_Toggle_Virtual(benchmark::State &state) {
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO2};
+    hal::interfaces::InterfaceDigitalGPIO &interface{gpio};
+
+    for(auto _ : state) {
+
+        interface.toggle();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GPIO_Toggle_Virtual);
+
+static void BM_GPIO_Toggle_Static(benchmark::State &state) {
+
+    hal::peripherals::gpio::Pin<hal::GPIO2, Direction::OUT> gpio{};
+
+    for(auto _ : state) {
+
+        gpio.toggle();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GPIO_Toggle_Static);
+
+static void BM_GPIO_Write_Virtual(benchmark::State &state) {
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO2};
+    hal::interfaces::InterfaceDigitalGPIO &interface{gpio};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        interface.write(value);
+        value ^= 1U;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GPIO_Write_Virtual);
+
+static void BM_GPIO_Write_Static(benchmark::State &state) {
+
+    hal::peripherals::gpio::Pin<hal::GPIO2, Direction::OUT> gpio{};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        gpio.write(value);
+        value ^= 1U;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GPIO_Write_Static);
@@ -0,0 +1,65 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "peripherals/GpioIRQ.h"
+
+using hal::peripherals::gpio::IRQ;
+using hal::peripherals::gpio::Event;
+using hal::peripherals::gpio::IRQDispatcher;
+
+static void countIRQ(const uint gpio_pin, const IRQ gpio_irq, void * const context) {
+
+    (void)gpio_pin;
+    (void)gpio_irq;
+
+    (*static_cast<uint64_t *>(context))++;
+}
+
+// Latency from an edge on the simulated pin to the callback
+static void BM_GpioIRQ_Callback(benchmark::State &state) {
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    uint64_t count{0};
+
+    bank.reset();
+    IRQDispatcher::getInstance().attach(hal::GPIO2, IRQ::EDGE_RISE, countIRQ, &count);
+
+    for(auto _ : state) {
+
+        bank.drive(hal::GPIO2, true);
+        bank.drive(hal::GPIO2, false);
+    }
+
+    IRQDispatcher::getInstance().detach(hal::GPIO2);
+
+    benchmark::DoNotOptimize(count);
+    state.SetItemsProcessed(static_cast<int64_t>(count));
+}
+BENCHMARK(BM_GpioIRQ_Callback);
+
+// Latency from an edge on the simulated pin to the event popped from the queue
+static void BM_GpioIRQ_Queue(benchmark::State &state) {
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    auto &dispatcher{IRQDispatcher::getInstance()};
+    Event event{};
+
+    bank.reset();
+    dispatcher.attach(hal::GPIO2, IRQ::EDGE_RISE);
+
+    for(auto _ : state) {
+
+        bank.drive(hal::GPIO2, true);
+        bank.drive(hal::GPIO2, false);
+
+        benchmark::DoNotOptimize(dispatcher.popEvent(event));
+    }
+
+    dispatcher.detach(hal::GPIO2);
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioIRQ_Queue);
@@ -0,0 +1,89 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/GpioPort.h"
+
+using namespace hal;
+
+static void BM_GpioPort_Write_PerPin(benchmark::State &state) {
+
+    peripherals::gpio::DigitalInOut pins[]{
+        peripherals::gpio::DigitalInOut{GPIO8}, peripherals::gpio::DigitalInOut{GPIO9},
+        peripherals::gpio::DigitalInOut{GPIO10}, peripherals::gpio::DigitalInOut{GPIO11},
+        peripherals::gpio::DigitalInOut{GPIO12}, peripherals::gpio::DigitalInOut{GPIO13},
+        peripherals::gpio::DigitalInOut{GPIO14}, peripherals::gpio::DigitalInOut{GPIO15}};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        for(uint i{0}; i < sizeof_array(pins); i++) {
+            pins[i].write(check_bit(value, i));
+        }
+
+        value++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioPort_Write_PerPin);
+
+static void BM_GpioPort_Write_Contiguous(benchmark::State &state) {
+
+    peripherals::gpio::GpioPort<GPIO8, GPIO9, GPIO10, GPIO11, GPIO12, GPIO13, GPIO14, GPIO15> port{};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        port.write(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioPort_Write_Contiguous);
+
+static void BM_GpioPort_Write_Scattered(benchmark::State &state) {
+
+    peripherals::gpio::GpioPort<GPIO3, GPIO1, GPIO20, GPIO7, GPIO9, GPIO28, GPIO14, GPIO5> port{};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        port.write(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioPort_Write_Scattered);
+
+static void BM_GpioBus_Write_Scattered(benchmark::State &state) {
+
+    const uint pins[]{GPIO3, GPIO1, GPIO20, GPIO7, GPIO9, GPIO28, GPIO14, GPIO5};
+    peripherals::gpio::GpioBus bus{pins};
+    uint8_t value{0};
+
+    for(auto _ : state) {
+
+        bus.write(value++);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioBus_Write_Scattered);
+
+static void BM_GpioBus_Read_Contiguous(benchmark::State &state) {
+
+    const uint pins[]{GPIO8, GPIO9, GPIO10, GPIO11, GPIO12, GPIO13, GPIO14, GPIO15};
+    peripherals::gpio::GpioBus bus{pins};
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(bus.read());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GpioBus_Read_Contiguous);
@@ -0,0 +1,132 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include "peripherals/I2C.h"
+
+using hal::peripherals::i2c::I2C;
+using hal::peripherals::i2c::Transaction;
+
+/**
+ * Twelve sensors read six registers each, one writeRead() per sensor or one transfer() for all of them.
+ */
+class I2CSensors : public benchmark::Fixture {
+public:
+
+    void SetUp(const benchmark::State &) override {
+
+        i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+
+        for(size_t i{0}; i < sensors.size(); i++) {
+
+            i2c.attach(address(i), sensors[i]);
+            transactions[i] = {address(i), {&reg, 1}, samples[i]};
+        }
+    }
+
+    void TearDown(const benchmark::State &) override {
+
+        for(size_t i{0}; i < sensors.size(); i++) {
+            i2c.detach(address(i));
+        }
+
+        i2c.deinit();
+    }
+
+    static uint8_t address(const size_t i) {
+
+        return static_cast<uint8_t>(0x40 + i);
+    }
+
+    I2C &i2c{I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    std::array<hal::host::I2CRegisterDevice<16>, 12> sensors{};
+    const uint8_t reg{0x08};
+    uint8_t samples[12][6]{};
+    Transaction transactions[12]{};
+};
+
+BENCHMARK_F(I2CSensors, BM_I2C_WriteRead)(benchmark::State &state) {
+
+    for(auto _ : state) {
+
+        for(size_t i{0}; i < sensors.size(); i++) {
+            benchmark::DoNotOptimize(i2c.writeRead(address(i), {&reg, 1}, samples[i]));
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sensors.size()));
+}
+
+BENCHMARK_F(I2CSensors, BM_I2C_Transfer)(benchmark::State &state) {
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(i2c.transfer(transactions));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sensors.size()));
+}
+
+static void BM_I2C_RegisterMap_Byte(benchmark::State &state) {
+
+    uint8_t registers[256]{};
+    hal::peripherals::i2c::RegisterMap map{};
+    map.attach(registers, [](size_t, size_t, void *) {}, nullptr);
+
+    uint8_t byte{0};
+
+    // What the interrupt handler of the slave spends per byte, a write then a read of 16 registers
+    for(auto _ : state) {
+
+        map.receive(byte, true);
+
+        for(size_t i{0}; i < 16; i++) {
+            map.receive(byte, false);
+        }
+
+        map.stop();
+
+        for(size_t i{0}; i < 16; i++) {
+            byte = static_cast<uint8_t>(byte + map.transmit());
+        }
+
+        benchmark::DoNotOptimize(byte);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 33);
+}
+BENCHMARK(BM_I2C_RegisterMap_Byte);
+
+static void BM_I2C_Slave_WriteRead(benchmark::State &state) {
+
+    auto &master{I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    auto &slave{I2C::getInstance(hal::peripherals::I2C_INSTANCE1)};
+    uint8_t registers[64]{};
+
+    master.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+    slave.initSlave(0x42, hal::GPIO6, hal::GPIO7, registers);
+    master.attach(0x42, slave.getSlaveDevice());
+
+    const uint8_t reg{0x00};
+    uint8_t received[16];
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(master.writeRead(0x42, {&reg, 1}, received));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(received)));
+
+    master.detach(0x42);
+    slave.deinit();
+    master.deinit();
+}
+BENCHMARK(BM_I2C_Slave_WriteRead);
@@ -0,0 +1,36 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "peripherals/PioUART.h"
+
+using hal::peripherals::uart::PioUART;
+
+// Cost of the host model of the state machines, per byte shifted out and decoded bit by bit
+static void BM_PioUART_WriteRead(benchmark::State &state) {
+
+    auto &left{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE0)};
+    auto &right{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE1)};
+    left.init(hal::GPIO6, hal::GPIO7, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    right.init(hal::GPIO7, hal::GPIO6, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    std::vector<uint8_t> tx(hal::peripherals::uart::PIO_UART_FIFO_DEPTH, 0x55);
+    std::vector<uint8_t> rx(tx.size());
+
+    for(auto _ : state) {
+
+        left.write(tx.data(), tx.size());
+        right.read(rx.data(), rx.size());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(tx.size()));
+
+    left.deinit();
+    right.deinit();
+}
+BENCHMARK(BM_PioUART_WriteRead);
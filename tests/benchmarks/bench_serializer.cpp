@@ -0,0 +1,212 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "commons/commons.h"
+#include "serialization/BufferSerializer.h"
+#include "serialization/Schema.h"
+
+using hal::serialization::BufferWriter;
+using hal::serialization::BufferReader;
+using hal::serialization::Endian;
+
+// Telemetry frame: id, timestamp, three floats and a status byte
+static constexpr size_t FRAME_SIZE{hal::serialization::serialized_size_v<uint8_t, uint32_t, float, float, float, uint8_t>};
+
+static void BM_Serializer_Write_TypeSerializer(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    uint32_t timestamp{0};
+    hal::TypeSerializer ts{};
+
+    for(auto _ : state) {
+
+        size_t position{0};
+        uint8_t scratch[8];
+
+        ts << uint8_t{0x42};
+        ts.unpack(scratch, sizeof(uint8_t));
+        position += sizeof(uint8_t);
+        frame[0] = scratch[0];
+
+        ts << timestamp++;
+        ts.unpack(scratch, sizeof(uint32_t));
+        memcpy(frame + position, scratch, sizeof(uint32_t));
+        position += sizeof(uint32_t);
+
+        for(const float value : {1.5f, -2.5f, 3.0f}) {
+
+            ts << value;
+            ts.unpack(scratch, sizeof(float));
+            memcpy(frame + position, scratch, sizeof(float));
+            position += sizeof(float);
+        }
+
+        ts << uint8_t{0x01};
+        ts.unpack(scratch, sizeof(uint8_t));
+        frame[position] = scratch[0];
+
+        benchmark::DoNotOptimize(frame);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Write_TypeSerializer);
+
+static void BM_Serializer_Write_BufferWriter(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    uint32_t timestamp{0};
+
+    for(auto _ : state) {
+
+        BufferWriter writer{frame, Endian::LITTLE};
+        writer.write(uint8_t{0x42}, timestamp++, 1.5f, -2.5f, 3.0f, uint8_t{0x01});
+
+        benchmark::DoNotOptimize(frame);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Write_BufferWriter);
+
+static void BM_Serializer_Write_BufferWriter_BigEndian(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    uint32_t timestamp{0};
+
+    for(auto _ : state) {
+
+        BufferWriter writer{frame, Endian::BIG};
+        writer.write(uint8_t{0x42}, timestamp++, 1.5f, -2.5f, 3.0f, uint8_t{0x01});
+
+        benchmark::DoNotOptimize(frame);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Write_BufferWriter_BigEndian);
+
+static void BM_Serializer_Read_BufferReader(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    BufferWriter{frame}.write(uint8_t{0x42}, uint32_t{1234}, 1.5f, -2.5f, 3.0f, uint8_t{0x01});
+
+    for(auto _ : state) {
+
+        BufferReader reader{frame};
+        uint8_t id, status;
+        uint32_t timestamp;
+        float x, y, z;
+
+        reader.read(id, timestamp, x, y, z, status);
+
+        benchmark::DoNotOptimize(id);
+        benchmark::DoNotOptimize(timestamp);
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(status);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Read_BufferReader);
+
+namespace {
+
+    struct Frame {
+        uint8_t id;
+        uint32_t timestamp;
+        float x;
+        float y;
+        float z;
+        uint8_t status;
+    };
+
+    using FrameSchema = hal::serialization::Schema<Endian::LITTLE,
+            hal::serialization::Field<&Frame::id>,
+            hal::serialization::Field<&Frame::timestamp>,
+            hal::serialization::Field<&Frame::x>,
+            hal::serialization::Field<&Frame::y>,
+            hal::serialization::Field<&Frame::z>,
+            hal::serialization::Field<&Frame::status>>;
+
+    static_assert(FrameSchema::SIZE == FRAME_SIZE);
+
+} // namespace
+
+static void BM_Serializer_Write_Schema(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    Frame telemetry{0x42, 0, 1.5f, -2.5f, 3.0f, 0x01};
+
+    for(auto _ : state) {
+
+        telemetry.timestamp++;
+        FrameSchema::encode(telemetry, frame);
+
+        benchmark::DoNotOptimize(frame);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Write_Schema);
+
+static void BM_Serializer_Read_TypeSerializer(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    BufferWriter{frame}.write(uint8_t{0x42}, uint32_t{1234}, 1.5f, -2.5f, 3.0f, uint8_t{0x01});
+
+    hal::TypeSerializer ts{};
+
+    for(auto _ : state) {
+
+        Frame telemetry{};
+        size_t position{0};
+
+        ts.pack(frame + position, sizeof(uint8_t));
+        ts >> telemetry.id;
+        position += sizeof(uint8_t);
+
+        ts.pack(frame + position, sizeof(uint32_t));
+        ts >> telemetry.timestamp;
+        position += sizeof(uint32_t);
+
+        for(float *value : {&telemetry.x, &telemetry.y, &telemetry.z}) {
+
+            ts.pack(frame + position, sizeof(float));
+            ts >> *value;
+            position += sizeof(float);
+        }
+
+        ts.pack(frame + position, sizeof(uint8_t));
+        ts >> telemetry.status;
+
+        benchmark::DoNotOptimize(telemetry);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Read_TypeSerializer);
+
+static void BM_Serializer_Read_Schema(benchmark::State &state) {
+
+    uint8_t frame[FRAME_SIZE]{};
+    BufferWriter{frame}.write(uint8_t{0x42}, uint32_t{1234}, 1.5f, -2.5f, 3.0f, uint8_t{0x01});
+
+    for(auto _ : state) {
+
+        Frame telemetry{};
+        FrameSchema::decode(frame, telemetry);
+
+        benchmark::DoNotOptimize(telemetry);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FRAME_SIZE));
+}
+BENCHMARK(BM_Serializer_Read_Schema);
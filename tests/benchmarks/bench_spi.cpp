@@ -0,0 +1,61 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include "peripherals/SPI.h"
+
+using hal::peripherals::spi::SPI;
+using hal::peripherals::spi::Transaction;
+
+static void BM_SPI_Transfer(benchmark::State &state) {
+
+    auto &spi{SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+    spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+
+    std::vector<uint8_t> tx(static_cast<size_t>(state.range(0)), 0x55);
+    std::vector<uint8_t> rx(tx.size());
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(spi.transfer(tx, rx));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+
+    spi.deinit();
+}
+BENCHMARK(BM_SPI_Transfer)->Arg(16)->Arg(256);
+
+static void BM_SPI_Queue(benchmark::State &state) {
+
+    auto &spi{SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+    spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+
+    uint8_t tx[hal::peripherals::SPI_QUEUE_SIZE][256]{};
+    uint8_t rx[hal::peripherals::SPI_QUEUE_SIZE][256]{};
+    Transaction transactions[hal::peripherals::SPI_QUEUE_SIZE];
+
+    for(auto _ : state) {
+
+        for(size_t i{0}; i < hal::peripherals::SPI_QUEUE_SIZE; i++) {
+
+            transactions[i] = {nullptr, tx[i], rx[i]};
+            spi.transferAsync(transactions[i]);
+        }
+
+        while(spi.isBusy()) {
+            std::this_thread::yield();
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(tx)));
+
+    spi.deinit();
+}
+BENCHMARK(BM_SPI_Queue);
@@ -0,0 +1,81 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "data_structures/SpscRing.h"
+
+#include <thread>
+
+static void BM_SpscRing_PushPop(benchmark::State &state) {
+
+    hal::data_structures::SpscRing<uint32_t, 1024> ring{};
+    uint32_t value{0};
+
+    for(auto _ : state) {
+
+        ring.push(value);
+        ring.pop(value);
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpscRing_PushPop);
+
+static void BM_SpscRing_Bulk(benchmark::State &state) {
+
+    hal::data_structures::SpscRing<uint8_t, 4096> ring{};
+    const size_t length{static_cast<size_t>(state.range(0))};
+    uint8_t buffer[4096]{};
+
+    for(auto _ : state) {
+
+        ring.write(buffer, length);
+        benchmark::DoNotOptimize(ring.read(buffer, length));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(length));
+}
+BENCHMARK(BM_SpscRing_Bulk)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_SpscRing_Threads(benchmark::State &state) {
+
+    constexpr uint32_t items{1'000'000};
+
+    static hal::data_structures::SpscRing<uint32_t, 1024> ring{};
+
+    for(auto _ : state) {
+
+        ring.clear();
+
+        std::thread producer{[]() {
+            for(uint32_t i{0}; i < items;) {
+
+                if(ring.push(i)) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+
+        uint32_t value{0};
+
+        for(uint32_t i{0}; i < items;) {
+
+            if(ring.pop(value)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        producer.join();
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations() * items);
+}
+BENCHMARK(BM_SpscRing_Threads)->Unit(benchmark::kMillisecond)->UseRealTime();
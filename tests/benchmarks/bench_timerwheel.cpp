@@ -0,0 +1,92 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "timers/TimerWheel.h"
+
+using hal::timers::TimerId;
+using hal::timers::TimerWheel;
+
+namespace {
+
+    void count(const TimerId timer, void * const context) {
+
+        (void)timer;
+        (*static_cast<size_t *>(context))++;
+    }
+
+} // namespace
+
+static void BM_TimerWheel_StartCancel(benchmark::State &state) {
+
+    hal::host::FakeClock::getInstance().reset();
+
+    TimerWheel wheel{};
+    size_t calls{0};
+    uint64_t delay{1'000};
+    TimerId timer;
+
+    for(auto _ : state) {
+
+        wheel.start(timer, delay, count, &calls);
+        wheel.cancel(timer);
+
+        // Spread the timers over every level
+        delay = delay * 3 % 10'000'000'000ULL + 1'000;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerWheel_StartCancel);
+
+static void BM_TimerWheel_RunPeriodic(benchmark::State &state) {
+
+    auto &clock{hal::host::FakeClock::getInstance()};
+    clock.reset();
+
+    TimerWheel wheel{};
+    size_t calls{0};
+    TimerId timer;
+
+    // Periods from 1 to 32 ticks
+    for(size_t i{0}; i < hal::timers::TIMER_SLOTS; i++) {
+        wheel.startPeriodic(timer, (i + 1) * hal::timers::TIMER_TICK_US, count, &calls);
+    }
+
+    for(auto _ : state) {
+
+        clock.advance(hal::timers::TIMER_TICK_US);
+        benchmark::DoNotOptimize(wheel.runPending());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(calls));
+}
+BENCHMARK(BM_TimerWheel_RunPeriodic);
+
+static void BM_TimerWheel_RunIdle(benchmark::State &state) {
+
+    auto &clock{hal::host::FakeClock::getInstance()};
+    clock.reset();
+
+    TimerWheel wheel{};
+    size_t calls{0};
+    TimerId timer;
+
+    // One timer an hour away: a long jump only looks at the occupied buckets
+    wheel.start(timer, 3'600'000'000ULL, count, &calls);
+
+    for(auto _ : state) {
+
+        clock.advance(static_cast<uint64_t>(state.range(0)) * hal::timers::TIMER_TICK_US);
+        benchmark::DoNotOptimize(wheel.runPending());
+
+        if(!wheel.isActive(timer)) {
+            wheel.start(timer, 3'600'000'000ULL, count, &calls);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerWheel_RunIdle)->Arg(1)->Arg(1'000);
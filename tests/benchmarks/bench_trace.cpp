@@ -0,0 +1,75 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "trace/Trace.h"
+#include "trace/TraceExport.h"
+
+using hal::trace::Tracer;
+
+namespace {
+
+    struct VectorSink {
+
+        void write(const uint8_t * const data, const size_t length) {
+
+            bytes.insert(bytes.end(), data, data + length);
+        }
+
+        std::vector<uint8_t> bytes;
+    };
+
+} // namespace
+
+// What HAL_TRACE_SCOPE expands to when HAL_TRACE is defined
+static void BM_Trace_Scope(benchmark::State &state) {
+
+    Tracer::getInstance().setEnabled(true);
+
+    for(auto _ : state) {
+        const hal::trace::Scope scope{"bench.scope"};
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_Trace_Scope);
+
+static void BM_Trace_ScopePaused(benchmark::State &state) {
+
+    Tracer::getInstance().setEnabled(false);
+
+    for(auto _ : state) {
+        const hal::trace::Scope scope{"bench.scope"};
+        benchmark::ClobberMemory();
+    }
+
+    Tracer::getInstance().setEnabled(true);
+}
+BENCHMARK(BM_Trace_ScopePaused);
+
+static void BM_Trace_Export(benchmark::State &state) {
+
+    auto &tracer{Tracer::getInstance()};
+    tracer.setEnabled(true);
+
+    for(size_t i{0}; i < hal::trace::TRACE_BUFFER_SIZE / 2; i++) {
+        const hal::trace::Scope scope{"bench.export"};
+    }
+
+    VectorSink sink;
+
+    for(auto _ : state) {
+
+        sink.bytes.clear();
+        benchmark::DoNotOptimize(hal::trace::exportTrace(sink));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(hal::trace::TRACE_BUFFER_SIZE));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sink.bytes.size()));
+}
+BENCHMARK(BM_Trace_Export);
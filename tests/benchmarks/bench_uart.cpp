@@ -0,0 +1,136 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include "peripherals/UART.h"
+
+#include <sys/socket.h>
+
+using hal::peripherals::uart::UART;
+
+namespace {
+
+    /**
+     * Initialise the UART and drain its wire from a thread, so the writes never wait on a full socket.
+     */
+    class DrainedUART {
+    public:
+
+        DrainedUART() : m_uart{UART::getInstance(hal::peripherals::UART_INSTANCE0)} {
+
+            m_uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+            m_drain = std::thread{[peer = m_uart.getPeer()]() {
+                uint8_t sink[4096];
+                while(::recv(peer, sink, sizeof(sink), 0) > 0) {}
+            }};
+        }
+
+        ~DrainedUART() {
+
+            // Wake the drain thread up before closing the wire
+            ::shutdown(m_uart.getPeer(), SHUT_RDWR);
+            m_drain.join();
+            m_uart.deinit();
+        }
+
+        UART &get() {
+
+            return m_uart;
+        }
+
+    private:
+
+        UART &m_uart;
+        std::thread m_drain;
+    };
+
+} // namespace
+
+static void BM_UART_WriteByte_Virtual(benchmark::State &state) {
+
+    DrainedUART drained{};
+    hal::interfaces::InterfaceUART &uart{drained.get()};
+
+    for(auto _ : state) {
+
+        uart.write(0x55);
+    }
+
+    state.SetBytesProcessed(state.iterations());
+}
+BENCHMARK(BM_UART_WriteByte_Virtual);
+
+static void BM_UART_Write(benchmark::State &state) {
+
+    DrainedUART drained{};
+    UART &uart{drained.get()};
+    const std::vector<uint8_t> data(static_cast<size_t>(state.range(0)), 0x55);
+
+    for(auto _ : state) {
+
+        uart.write(data.data(), data.size());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UART_Write)->RangeMultiplier(4)->Range(16, 1024);
+
+// A frame sent as header, payload and checksum without gathering it first
+static void BM_UART_Writev(benchmark::State &state) {
+
+    DrainedUART drained{};
+    UART &uart{drained.get()};
+    const uint8_t header[4]{};
+    const uint8_t payload[64]{};
+    const uint8_t crc[4]{};
+    const std::span<const uint8_t> frame[]{header, payload, crc};
+
+    for(auto _ : state) {
+
+        uart.writev(frame);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(header) + sizeof(payload) + sizeof(crc)));
+}
+BENCHMARK(BM_UART_Writev);
+
+// Buffered mode: the write lands in the TX ring and the simulated interrupt sends it
+static void BM_UART_Buffered_Write(benchmark::State &state) {
+
+    DrainedUART drained{};
+    UART &uart{drained.get()};
+    const uint8_t data[32]{};
+
+    uart.setBuffered(true);
+
+    for(auto _ : state) {
+
+        uart.write(data, sizeof(data));
+        uart.raiseIRQ();
+    }
+
+    uart.setBuffered(false);
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(data)));
+}
+BENCHMARK(BM_UART_Buffered_Write);
+
+static void BM_UART_IsWritable(benchmark::State &state) {
+
+    DrainedUART drained{};
+    const hal::interfaces::InterfaceUART &uart{drained.get()};
+
+    for(auto _ : state) {
+
+        benchmark::DoNotOptimize(uart.isWritable());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UART_IsWritable);
@@ -0,0 +1,297 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "bus/BusScheduler.h"
+#include "peripherals/DigitalInOut.h"
+
+using hal::bus::I2CRequest;
+using hal::bus::I2CScheduler;
+using hal::bus::Priority;
+using hal::bus::SPIRequest;
+using hal::bus::SPIScheduler;
+
+namespace {
+
+    /**
+     * Device holding the bus until it is opened, so the next requests queue up.
+     */
+    class Gate : public hal::host::I2CDevice {
+    public:
+
+        bool onWrite(std::span<const uint8_t>) override {
+
+            return true;
+        }
+
+        bool onRead(const std::span<uint8_t> data) override {
+
+            m_entered = true;
+
+            while(!m_open) {
+                std::this_thread::yield();
+            }
+
+            std::fill(data.begin(), data.end(), 0);
+
+            return true;
+        }
+
+        std::atomic<bool> m_entered{false};
+        std::atomic<bool> m_open{false};
+    };
+
+    /**
+     * Completion order of the requests, each request gives its tag as context.
+     */
+    std::vector<int> s_order;
+
+    void record(const hal::Error, void *context) {
+
+        s_order.push_back(*static_cast<int *>(context));
+    }
+
+} // namespace
+
+TEST(BusScheduler, i2c_priorities_coalescing) {
+
+    auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    auto &scheduler{I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+
+    i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+    scheduler.resetLatency();
+    s_order.clear();
+
+    Gate gate{};
+    hal::host::I2CRegisterDevice<32> accel{};
+    hal::host::I2CRegisterDevice<16> mag{};
+
+    for(size_t reg{0}; reg < 32; reg++) {
+        accel.setRegister(reg, static_cast<uint8_t>(0x80 + reg));
+    }
+
+    mag.setRegister(0x03, 0x33);
+
+    i2c.attach(0x50, gate);
+    i2c.attach(0x68, accel);
+    i2c.attach(0x1E, mag);
+
+    const uint8_t regs[]{0x00, 0x10, 0x12, 0x03};
+    uint8_t gate_data[1];
+    uint8_t low[2]{};
+    uint8_t first[2]{};
+    uint8_t second[4]{};
+    uint8_t high[6]{};
+    uint8_t missing[1]{};
+    int tags[]{0, 1, 2, 3, 4, 5};
+
+    I2CRequest gate_request{{0x50, {}, gate_data}, Priority::NORMAL, record, &tags[0]};
+    I2CRequest low_request{{0x68, {&regs[0], 1}, low}, Priority::LOW, record, &tags[1]};
+    I2CRequest first_request{{0x68, {&regs[1], 1}, first}, Priority::NORMAL, record, &tags[2]};
+    I2CRequest second_request{{0x68, {&regs[2], 1}, second}, Priority::NORMAL, record, &tags[3]};
+    I2CRequest missing_request{{0x30, {&regs[0], 1}, missing}, Priority::NORMAL, record, &tags[4]};
+    I2CRequest high_request{{0x1E, {&regs[3], 1}, high}, Priority::HIGH, record, &tags[5]};
+
+    // The fake bus completes in the caller, the first request holds it in another thread
+    std::thread holder{[&scheduler, &gate_request]() { scheduler.submit(gate_request); }};
+
+    while(!gate.m_entered) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_FALSE(scheduler.submit(low_request));
+    EXPECT_FALSE(scheduler.submit(first_request));
+    EXPECT_FALSE(scheduler.submit(second_request));
+    EXPECT_FALSE(scheduler.submit(missing_request));
+    EXPECT_FALSE(scheduler.submit(high_request));
+    EXPECT_TRUE(scheduler.isBusy());
+    EXPECT_EQ(accel.getReads(), 0U);
+
+    gate.m_open = true;
+    holder.join();
+
+    EXPECT_FALSE(scheduler.isBusy());
+    EXPECT_EQ(s_order, (std::vector<int>{0, 5, 2, 3, 4, 1}));
+
+    // The two contiguous reads of 0x68 were one transaction
+    EXPECT_EQ(accel.getReads(), 2U);
+    EXPECT_EQ(first[0], 0x90);
+    EXPECT_EQ(first[1], 0x91);
+    EXPECT_EQ(second[0], 0x92);
+    EXPECT_EQ(second[3], 0x95);
+    EXPECT_EQ(low[1], 0x81);
+    EXPECT_EQ(high[0], 0x33);
+
+    EXPECT_EQ(first_request.error, hal::Error::NONE);
+    EXPECT_EQ(second_request.error, hal::Error::NONE);
+    EXPECT_EQ(missing_request.error, hal::Error::ERROR);
+    EXPECT_EQ(missing_request.transaction.error, hal::Error::ERROR);
+
+    const hal::bus::DeviceLatency latency{scheduler.getLatency(0x68)};
+    EXPECT_EQ(latency.requests, 3U);
+    EXPECT_LE(latency.mean_latency, latency.max_latency);
+    EXPECT_EQ(scheduler.getLatency(0x1E).requests, 1U);
+    EXPECT_EQ(scheduler.getLatency(0x30).requests, 1U);
+    EXPECT_EQ(scheduler.getLatency(0x42).requests, 0U);
+
+    i2c.detach(0x50);
+    i2c.detach(0x68);
+    i2c.detach(0x1E);
+    i2c.deinit();
+}
+
+TEST(BusScheduler, i2c_invalid) {
+
+    auto &scheduler{I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+
+    const uint8_t reg{0x00};
+    uint8_t big[hal::peripherals::I2C_MAX_TRANSFER]{};
+
+    I2CRequest reserved{{0x78, {&reg, 1}, {big, 1}}};
+    EXPECT_TRUE(scheduler.submit(reserved));
+    EXPECT_EQ(reserved.error, hal::Error::ERROR);
+
+    I2CRequest empty{{0x68, {}, {}}};
+    EXPECT_TRUE(scheduler.submit(empty));
+    EXPECT_EQ(scheduler.getLastError(), hal::Error::TOOSMALL);
+
+    I2CRequest too_big{{0x68, {&reg, 1}, big}};
+    EXPECT_TRUE(scheduler.submit(too_big));
+    EXPECT_EQ(too_big.error, hal::Error::TOOBIG);
+
+    EXPECT_FALSE(scheduler.isBusy());
+}
+
+TEST(BusScheduler, i2c_resubmit) {
+
+    auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    auto &scheduler{I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+
+    i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+
+    hal::host::I2CRegisterDevice<16> sensor{};
+    i2c.attach(0x68, sensor);
+
+    struct Poll {
+        I2CRequest request;
+        uint8_t reg;
+        uint8_t sample[2];
+        size_t remaining;
+    } poll{};
+
+    poll.request = {{0x68, {&poll.reg, 1}, poll.sample}, Priority::NORMAL, [](const hal::Error, void *context) {
+        auto *state{static_cast<Poll *>(context)};
+
+        // A polling driver submits its request again from its callback
+        if(--state->remaining > 0) {
+            I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0).submit(state->request);
+        }
+    }, &poll};
+    poll.remaining = 5;
+
+    EXPECT_FALSE(scheduler.submit(poll.request));
+    EXPECT_FALSE(scheduler.isBusy());
+    EXPECT_EQ(poll.remaining, 0U);
+    EXPECT_EQ(sensor.getReads(), 5U);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(BusScheduler, i2c_resubmit_many) {
+
+    auto &i2c{hal::peripherals::i2c::I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+    auto &scheduler{I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0)};
+
+    i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+
+    hal::host::I2CRegisterDevice<16> sensor{};
+    i2c.attach(0x68, sensor);
+
+    struct Poll {
+        I2CRequest request;
+        uint8_t reg;
+        uint8_t sample[2];
+        size_t remaining;
+    } poll{};
+
+    poll.request = {{0x68, {&poll.reg, 1}, poll.sample}, Priority::NORMAL, [](const hal::Error, void *context) {
+        auto *state{static_cast<Poll *>(context)};
+
+        if(--state->remaining > 0) {
+            I2CScheduler::getInstance(hal::peripherals::I2C_INSTANCE0).submit(state->request);
+        }
+    }, &poll};
+
+    // Each batch completes before its start returns, they must not pile up on the stack
+    constexpr size_t POLLS{200'000};
+    poll.remaining = POLLS;
+
+    EXPECT_FALSE(scheduler.submit(poll.request));
+    EXPECT_FALSE(scheduler.isBusy());
+    EXPECT_EQ(poll.remaining, 0U);
+    EXPECT_EQ(sensor.getReads(), POLLS);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(BusScheduler, spi) {
+
+    auto &spi{hal::peripherals::spi::SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+    auto &scheduler{SPIScheduler::getInstance(hal::peripherals::SPI_INSTANCE0)};
+
+    spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+    scheduler.resetLatency();
+
+    hal::peripherals::gpio::DigitalInOut flash_cs{hal::GPIO17};
+    hal::peripherals::gpio::DigitalInOut display_cs{hal::GPIO20};
+    flash_cs.write(1);
+    display_cs.write(1);
+
+    constexpr size_t REQUESTS{hal::peripherals::BUS_BATCH_SIZE * 2 + 3};
+    uint8_t tx[REQUESTS][4];
+    uint8_t rx[REQUESTS][4]{};
+    SPIRequest requests[REQUESTS];
+    std::atomic<size_t> completed{0};
+
+    for(size_t i{0}; i < REQUESTS; i++) {
+
+        for(size_t byte{0}; byte < 4; byte++) {
+            tx[i][byte] = static_cast<uint8_t>(i + byte);
+        }
+
+        hal::interfaces::InterfaceDigitalGPIO *cs{i % 3 == 0 ? nullptr : (i % 3 == 1 ? &flash_cs : &display_cs)};
+
+        requests[i] = {{cs, tx[i], rx[i]}, Priority::NORMAL, [](const hal::Error error, void *context) {
+            if(error == hal::Error::NONE) {
+                (*static_cast<std::atomic<size_t> *>(context))++;
+            }
+        }, &completed};
+
+        EXPECT_FALSE(scheduler.submit(requests[i]));
+    }
+
+    while(scheduler.isBusy()) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(completed, REQUESTS);
+    EXPECT_EQ(flash_cs.read(), 1);
+
+    for(size_t i{0}; i < REQUESTS; i++) {
+        EXPECT_EQ(memcmp(tx[i], rx[i], 4), 0);
+    }
+
+    EXPECT_EQ(scheduler.getLatency(hal::GPIO17).requests, 6U);
+    EXPECT_EQ(scheduler.getLatency(hal::GPIO20).requests, 6U);
+    EXPECT_EQ(scheduler.getLatency(hal::NUMBER_GPIO_PIN).requests, 7U);
+
+    spi.deinit();
+}
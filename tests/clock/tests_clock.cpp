@@ -0,0 +1,104 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <type_traits>
+
+#include "clock/Clock.h"
+
+using namespace std::chrono_literals;
+
+static_assert(std::chrono::is_clock_v<hal::clock::Clock>);
+static_assert(std::is_same_v<hal::clock::Duration, std::chrono::duration<int64_t, std::micro>>);
+
+TEST(Clock, monotonic) {
+
+    uint64_t previous_us{hal::clock::now_us()};
+    uint64_t previous_cycles{hal::clock::now_cycles()};
+
+    for(size_t i{0}; i < 10'000; i++) {
+
+        const uint64_t us{hal::clock::now_us()};
+        const uint64_t cycles{hal::clock::now_cycles()};
+
+        EXPECT_GE(us, previous_us);
+        EXPECT_GE(cycles, previous_cycles);
+
+        previous_us = us;
+        previous_cycles = cycles;
+    }
+}
+
+TEST(Clock, chrono) {
+
+    const uint64_t before{hal::clock::now_us()};
+    const hal::clock::TimePoint now{hal::clock::Clock::now()};
+    const uint64_t after{hal::clock::now_us()};
+
+    EXPECT_GE(static_cast<uint64_t>(now.time_since_epoch().count()), before);
+    EXPECT_LE(static_cast<uint64_t>(now.time_since_epoch().count()), after);
+
+    const hal::clock::Duration duration{2ms};
+    EXPECT_EQ(duration.count(), 2'000);
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(now + 1s - now).count(), 1'000);
+}
+
+TEST(Clock, cycles_to_duration) {
+
+    const uint64_t frequency{hal::clock::cycles_frequency()};
+
+    EXPECT_EQ(hal::clock::cycles_to_duration(frequency), 1s);
+    EXPECT_EQ(hal::clock::cycles_to_duration(frequency * 3 / 2), 1500ms);
+    EXPECT_EQ(hal::clock::cycles_to_duration(frequency * 3'600 * 24 * 365), std::chrono::hours{24 * 365});
+    EXPECT_EQ(hal::clock::cycles_to_duration(0), 0us);
+}
+
+TEST(Clock, cycles_follow_time) {
+
+    const uint64_t start_us{hal::clock::now_us()};
+    const uint64_t start_cycles{hal::clock::now_cycles()};
+
+    hal::clock::sleep_for(20ms);
+
+    const auto elapsed_us{static_cast<int64_t>(hal::clock::now_us() - start_us)};
+    const auto elapsed{hal::clock::cycles_to_duration(hal::clock::now_cycles() - start_cycles).count()};
+
+    EXPECT_GE(elapsed_us, 20'000);
+    EXPECT_NEAR(static_cast<double>(elapsed), static_cast<double>(elapsed_us), 1'000.0);
+}
+
+TEST(Clock, sleep_until) {
+
+    const hal::clock::TimePoint deadline{hal::clock::Clock::now() + 5ms};
+
+    hal::clock::sleep_until(deadline);
+    EXPECT_GE(hal::clock::Clock::now(), deadline);
+
+    // Already reached
+    const hal::clock::TimePoint before{hal::clock::Clock::now()};
+    hal::clock::sleep_until(before - 1s);
+    hal::clock::sleep_until(hal::clock::TimePoint{});
+    EXPECT_LT(hal::clock::Clock::now() - before, 5ms);
+}
+
+TEST(Clock, periodic_loop_does_not_drift) {
+
+    const hal::clock::TimePoint start{hal::clock::Clock::now()};
+    hal::clock::TimePoint deadline{start};
+
+    for(size_t i{0}; i < 10; i++) {
+
+        // Work shorter than the period, its duration must not add up
+        const hal::clock::TimePoint work{hal::clock::Clock::now() + 500us};
+        while(hal::clock::Clock::now() < work) {}
+
+        deadline += 2ms;
+        hal::clock::sleep_until(deadline);
+    }
+
+    EXPECT_GE(hal::clock::Clock::now() - start, 20ms);
+    EXPECT_LT(hal::clock::Clock::now() - start, 30ms);
+}
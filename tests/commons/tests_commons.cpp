@@ -6,7 +6,9 @@
 
 #include "commons/commons.h"
 
+#include <bit>
 #include <limits>
+#include <span>
 
 TEST(CommonsTest, set_bit) {
 
@@ -339,6 +341,233 @@ TEST(CommonsTest, sizeof_array) {
     EXPECT_EQ(hal::sizeof_array(arrayd), array_size);
 }
 
+TEST(CommonsTest, span_set_clear_toggle_bits) {
+
+    // Odd lengths and an unaligned start go through the vector, word and element loops
+    uint8_t storage8[103];
+    uint32_t storage32[37];
+
+    for(size_t i{0}; i < hal::sizeof_array(storage8); i++) {
+        storage8[i] = static_cast<uint8_t>(i * 37U);
+    }
+
+    for(size_t i{0}; i < hal::sizeof_array(storage32); i++) {
+        storage32[i] = static_cast<uint32_t>(i * 2654435761U);
+    }
+
+    uint8_t expected8[hal::sizeof_array(storage8)];
+    uint32_t expected32[hal::sizeof_array(storage32)];
+
+    memcpy(expected8, storage8, sizeof(storage8));
+    memcpy(expected32, storage32, sizeof(storage32));
+
+    const std::span<uint8_t> bits8{std::span{storage8}.subspan(1)};
+    const std::span<uint32_t> bits32{std::span{storage32}.subspan(1)};
+
+    // --------------------------------
+    hal::set_bits(bits8, uint8_t{0b10100101});
+    hal::set_bits(bits32, 0x80000001U);
+
+    for(size_t i{1}; i < hal::sizeof_array(expected8); i++) {
+        hal::set_bits(expected8[i], uint8_t{0b10100101});
+    }
+
+    for(size_t i{1}; i < hal::sizeof_array(expected32); i++) {
+        hal::set_bits(expected32[i], 0x80000001U);
+    }
+
+    EXPECT_EQ(memcmp(storage8, expected8, sizeof(storage8)), 0);
+    EXPECT_EQ(memcmp(storage32, expected32, sizeof(storage32)), 0);
+
+    // --------------------------------
+    hal::clear_bits(bits8, uint8_t{0b00111100});
+    hal::clear_bits(bits32, 0x0000FFFFU);
+
+    for(size_t i{1}; i < hal::sizeof_array(expected8); i++) {
+        hal::clear_bits(expected8[i], static_cast<uint8_t>(0b00111100));
+    }
+
+    for(size_t i{1}; i < hal::sizeof_array(expected32); i++) {
+        hal::clear_bits(expected32[i], 0x0000FFFFU);
+    }
+
+    EXPECT_EQ(memcmp(storage8, expected8, sizeof(storage8)), 0);
+    EXPECT_EQ(memcmp(storage32, expected32, sizeof(storage32)), 0);
+
+    // --------------------------------
+    hal::toggle_bits(bits8, uint8_t{0xFF});
+    hal::toggle_bits(bits32, 0x12345678U);
+
+    for(size_t i{1}; i < hal::sizeof_array(expected8); i++) {
+        hal::toggle_bits(expected8[i], static_cast<uint8_t>(0xFF));
+    }
+
+    for(size_t i{1}; i < hal::sizeof_array(expected32); i++) {
+        hal::toggle_bits(expected32[i], 0x12345678U);
+    }
+
+    EXPECT_EQ(memcmp(storage8, expected8, sizeof(storage8)), 0);
+    EXPECT_EQ(memcmp(storage32, expected32, sizeof(storage32)), 0);
+}
+
+TEST(CommonsTest, span_bits_wider_than_word) {
+
+    // uint64_t elements with a 32 bits word, as on the RP2040: the word step is skipped
+    using hal::detail::bits::Op;
+
+    uint64_t bits[5];
+    uint64_t expected[hal::sizeof_array(bits)];
+
+    for(size_t i{0}; i < hal::sizeof_array(bits); i++) {
+        bits[i] = expected[i] = i * 0x9E3779B97F4A7C15U;
+    }
+
+    const uint64_t mask{0x8000'0001'0000'00F0U};
+
+    hal::detail::bits::apply<Op::SET, uint64_t, std::dynamic_extent, uint32_t>(std::span<uint64_t>{bits}, mask);
+
+    for(uint64_t &element : expected) {
+        element |= mask;
+    }
+
+    EXPECT_EQ(memcmp(bits, expected, sizeof(bits)), 0);
+
+    hal::detail::bits::apply<Op::TOGGLE, uint64_t, std::dynamic_extent, uint32_t>(std::span<uint64_t>{bits}, mask);
+
+    for(uint64_t &element : expected) {
+        element ^= mask;
+    }
+
+    EXPECT_EQ(memcmp(bits, expected, sizeof(bits)), 0);
+}
+
+TEST(CommonsTest, span_popcount) {
+
+    uint8_t bits8[101]{};
+    uint16_t bits16[3]{0x0001, 0x8000, 0xFFFF};
+
+    EXPECT_EQ(hal::popcount(std::span{bits8}), 0U);
+    EXPECT_EQ(hal::popcount(std::span{bits16}), 18U);
+    EXPECT_EQ(hal::popcount(std::span<const uint16_t>{}), 0U);
+
+    size_t expected{0};
+
+    for(size_t i{0}; i < hal::sizeof_array(bits8); i++) {
+
+        bits8[i] = static_cast<uint8_t>(i * 131U + 7U);
+
+        for(uint pos{0}; pos < 8; pos++) {
+            expected += hal::check_bit(bits8[i], pos);
+        }
+    }
+
+    EXPECT_EQ(hal::popcount(std::span{bits8}), expected);
+    EXPECT_EQ(hal::popcount(std::span{bits8}.subspan(3)),
+              expected - static_cast<size_t>(std::popcount(bits8[0]) + std::popcount(bits8[1]) + std::popcount(bits8[2])));
+}
+
+TEST(CommonsTest, span_find_first_set) {
+
+    uint16_t bits16[]{0x0000, 0x0000, 0x0010};
+    uint8_t bits8[100]{};
+    uint64_t bits64[4]{};
+
+    EXPECT_EQ(hal::find_first_set(std::span{bits16}), 36U);
+    EXPECT_EQ(hal::find_first_set(std::span{bits8}), 800U);
+    EXPECT_EQ(hal::find_first_set(std::span{bits64}), 256U);
+
+    // Every position, so the bit is found in every kind of block
+    for(size_t pos{0}; pos < 800; pos++) {
+
+        memset(bits8, 0, sizeof(bits8));
+        hal::set_bit(bits8[pos / 8], pos % 8);
+        hal::set_bit(bits8[99], 7U);
+
+        ASSERT_EQ(hal::find_first_set(std::span{bits8}), pos);
+    }
+
+    bits64[3] = 1ULL << 63;
+    EXPECT_EQ(hal::find_first_set(std::span{bits64}), 255U);
+}
+
+TEST(CommonsTest, span_copy_bits) {
+
+    uint8_t src[]{0b11110000, 0b00001111};
+    uint8_t dst[]{0x00, 0x00};
+
+    // --------------------------------
+    EXPECT_FALSE(hal::copy_bits(std::span{dst}, 2, std::span{src}, 4, 8));
+    EXPECT_EQ(dst[0], 0b11111100);
+    EXPECT_EQ(dst[1], 0b00000011);
+
+    // --------------------------------
+    EXPECT_TRUE(hal::copy_bits(std::span{dst}, 9, std::span{src}, 0, 8));
+    EXPECT_TRUE(hal::copy_bits(std::span{dst}, 0, std::span{src}, 9, 8));
+
+    // --------------------------------
+    // Compare against a bit by bit copy for every offset
+    uint32_t source[5]{0xDEADBEEF, 0x01234567, 0x89ABCDEF, 0xF0F0F0F0, 0x0F0F0F0F};
+
+    for(size_t src_pos{0}; src_pos < 40; src_pos += 3) {
+        for(size_t dst_pos{0}; dst_pos < 40; dst_pos += 5) {
+
+            uint32_t result[5]{0x55555555, 0x55555555, 0x55555555, 0x55555555, 0x55555555};
+            uint32_t expected[5]{0x55555555, 0x55555555, 0x55555555, 0x55555555, 0x55555555};
+            const size_t count{100};
+
+            ASSERT_FALSE(hal::copy_bits(std::span{result}, dst_pos, std::span<const uint32_t>{source}, src_pos, count));
+
+            for(size_t i{0}; i < count; i++) {
+
+                const size_t to{dst_pos + i};
+
+                hal::clear_bit(expected[to / 32], to % 32);
+
+                if(hal::check_bit(source[(src_pos + i) / 32], (src_pos + i) % 32)) {
+                    hal::set_bit(expected[to / 32], to % 32);
+                }
+            }
+
+            ASSERT_EQ(memcmp(result, expected, sizeof(result)), 0) << "src_pos " << src_pos << " dst_pos " << dst_pos;
+        }
+    }
+}
+
+TEST(CommonsTest, span_shift_bits) {
+
+    uint8_t bits[]{0b10000001, 0b01000010, 0b00100100};
+
+    // --------------------------------
+    hal::shift_bits_left(std::span{bits}, 3);
+    EXPECT_EQ(bits[0], 0b00001000);
+    EXPECT_EQ(bits[1], 0b00010100);
+    EXPECT_EQ(bits[2], 0b00100010);
+
+    // --------------------------------
+    hal::shift_bits_right(std::span{bits}, 3);
+    EXPECT_EQ(bits[0], 0b10000001);
+    EXPECT_EQ(bits[1], 0b01000010);
+    EXPECT_EQ(bits[2], 0b00000100);
+
+    // --------------------------------
+    hal::shift_bits_left(std::span{bits}, 9);
+    EXPECT_EQ(bits[0], 0b00000000);
+    EXPECT_EQ(bits[1], 0b00000010);
+    EXPECT_EQ(bits[2], 0b10000101);
+
+    // --------------------------------
+    hal::shift_bits_right(std::span{bits}, 17);
+    EXPECT_EQ(bits[0], 0b01000010);
+    EXPECT_EQ(bits[1], 0b00000000);
+    EXPECT_EQ(bits[2], 0b00000000);
+
+    // --------------------------------
+    hal::shift_bits_left(std::span{bits}, 100);
+    EXPECT_EQ(bits[0], 0);
+    EXPECT_EQ(bits[1], 0);
+    EXPECT_EQ(bits[2], 0);
+}
+
 TEST(TypeSerializer, set_get) {
 
     uint8_t     base_value8{123};
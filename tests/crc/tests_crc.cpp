@@ -0,0 +1,137 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "crc/Crc.h"
+#include "peripherals/UART.h"
+
+#include <unistd.h>
+
+using hal::crc::Algorithm;
+using hal::crc::Crc;
+
+namespace {
+
+    constexpr uint8_t CHECK_DATA[]{'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    /// Compare every algorithm against the check value of the catalogue, and against each other on random data
+    template<auto P>
+    void checkAlgorithms() {
+
+        EXPECT_EQ(hal::crc::compute<P>(CHECK_DATA), P.check);
+        EXPECT_EQ((hal::crc::compute<P, Algorithm::BITWISE>(CHECK_DATA)), P.check);
+        EXPECT_EQ((hal::crc::compute<P, Algorithm::TABLE>(CHECK_DATA)), P.check);
+        EXPECT_EQ((hal::crc::compute<P, Algorithm::SLICE_BY_8>(CHECK_DATA)), P.check);
+
+        std::mt19937 generator{42};
+        std::vector<uint8_t> data(1000);
+
+        for(auto &byte : data) {
+            byte = static_cast<uint8_t>(generator());
+        }
+
+        for(const size_t length : {0UL, 1UL, 7UL, 8UL, 9UL, 63UL, 1000UL}) {
+
+            const std::span<const uint8_t> message{data.data(), length};
+            const auto expected{hal::crc::compute<P, Algorithm::BITWISE>(message)};
+
+            EXPECT_EQ((hal::crc::compute<P, Algorithm::TABLE>(message)), expected);
+            EXPECT_EQ((hal::crc::compute<P, Algorithm::SLICE_BY_8>(message)), expected);
+
+            if constexpr (hal::crc::detail::hasSniffer<P>()) {
+                EXPECT_EQ((hal::crc::compute<P, Algorithm::DMA>(message)), expected);
+            }
+        }
+    }
+
+} // namespace
+
+// Computed at compile time
+static_assert(hal::crc::compute<hal::crc::CRC8>(CHECK_DATA) == 0xF4);
+static_assert(hal::crc::compute<hal::crc::CRC32, Algorithm::SLICE_BY_8>(CHECK_DATA) == 0xCBF43926);
+static_assert(hal::crc::compute<hal::crc::CRC32, Algorithm::DMA>(CHECK_DATA) == 0xCBF43926);
+static_assert(hal::crc::detail::hasSniffer<hal::crc::CRC16_KERMIT>() and !hal::crc::detail::hasSniffer<hal::crc::CRC32C>());
+
+TEST(Crc, catalogue) {
+
+    checkAlgorithms<hal::crc::CRC8>();
+    checkAlgorithms<hal::crc::CRC8_MAXIM>();
+    checkAlgorithms<hal::crc::CRC16_CCITT_FALSE>();
+    checkAlgorithms<hal::crc::CRC16_XMODEM>();
+    checkAlgorithms<hal::crc::CRC16_KERMIT>();
+    checkAlgorithms<hal::crc::CRC16_MODBUS>();
+    checkAlgorithms<hal::crc::CRC32>();
+    checkAlgorithms<hal::crc::CRC32C>();
+    checkAlgorithms<hal::crc::CRC32_MPEG2>();
+}
+
+TEST(Crc, streaming) {
+
+    std::mt19937 generator{7};
+    std::vector<uint8_t> data(4096);
+
+    for(auto &byte : data) {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    const uint32_t expected{hal::crc::compute<hal::crc::CRC32>(data)};
+
+    hal::crc::Crc32 crc;
+    hal::crc::Crc<hal::crc::CRC32, Algorithm::DMA> dma;
+
+    // Chunks of random sizes, not aligned on the slices
+    for(size_t position{0}, length{0}; position < data.size(); position += length) {
+
+        length = hal::min<size_t>(generator() % 100, data.size() - position);
+        crc.update(data.data() + position, length);
+
+        dma.updateAsync({data.data() + position, length});
+        dma.wait();
+        EXPECT_FALSE(dma.isBusy());
+    }
+
+    EXPECT_EQ(crc.value(), expected);
+    EXPECT_EQ(dma.value(), expected);
+
+    crc.reset();
+    EXPECT_EQ(crc.update(CHECK_DATA).value(), hal::crc::CRC32.check);
+}
+
+TEST(Crc, uart) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE1)};
+    uart.init(hal::GPIO5, hal::GPIO4, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    // Frame followed by its CRC-16, most significant byte first
+    std::vector<uint8_t> frame(300);
+
+    for(size_t i{0}; i < frame.size(); i++) {
+        frame[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    const uint16_t crc_sent{hal::crc::Crc16::compute(frame)};
+    frame.push_back(static_cast<uint8_t>(crc_sent >> 8U));
+    frame.push_back(static_cast<uint8_t>(crc_sent));
+
+    ASSERT_EQ(::write(uart.getPeer(), frame.data(), frame.size()), static_cast<ssize_t>(frame.size()));
+
+    // Fed as the bytes are read, a frame followed by its CRC gives a residue of 0 for this CRC
+    hal::crc::Crc16 crc;
+    uint8_t buffer[32]{};
+
+    for(size_t received{0}, count{0}; received < frame.size(); received += count) {
+
+        count = hal::min(sizeof(buffer), frame.size() - received);
+        uart.read(buffer, count);
+        crc.update(buffer, count);
+    }
+
+    EXPECT_EQ(crc.value(), 0U);
+
+    uart.deinit();
+}
@@ -0,0 +1,206 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "data_structures/BitSet.h"
+
+#include <thread>
+#include <vector>
+
+using hal::data_structures::BitSet;
+using hal::data_structures::AtomicBitSet;
+
+// Everything but the atomic variant is usable at compile time
+static_assert([]() {
+
+    BitSet<100> bits{};
+
+    bits.set(3);
+    bits.setRange(60, 10);
+    bits.toggle(99);
+    bits.clear(65);
+
+    return bits.count() == 11 and bits.check(3) and !bits.check(65) and bits.findFirst() == 3
+           and bits.findNext(4) == 60 and bits.findFirstClear() == 0;
+}());
+
+TEST(BitSet, set_clear_toggle_check) {
+
+    BitSet<70, uint32_t> bits{};
+
+    EXPECT_TRUE(bits.none());
+    EXPECT_EQ((BitSet<70, uint32_t>::WORDS), 3U);
+
+    bits.set(0);
+    bits.set(33);
+    bits.set(69);
+
+    EXPECT_TRUE(bits.check(0));
+    EXPECT_TRUE(bits.check(33));
+    EXPECT_TRUE(bits.check(69));
+    EXPECT_FALSE(bits.check(1));
+    EXPECT_FALSE(bits.check(70));
+    EXPECT_EQ(bits.count(), 3U);
+
+    bits.clear(33);
+    EXPECT_FALSE(bits.check(33));
+
+    bits.toggle(33);
+    bits.toggle(0);
+    EXPECT_TRUE(bits.check(33));
+    EXPECT_FALSE(bits.check(0));
+
+    EXPECT_EQ(bits.getWord(1), 1U << 1);
+    EXPECT_EQ(bits.getWord(2), 1U << 5);
+}
+
+TEST(BitSet, ranges) {
+
+    BitSet<200, uint64_t> bits{};
+
+    // --------------------------------
+    bits.setRange(60, 80);
+    EXPECT_EQ(bits.count(), 80U);
+    EXPECT_EQ(bits.findFirst(), 60U);
+    EXPECT_FALSE(bits.check(59));
+    EXPECT_TRUE(bits.check(139));
+    EXPECT_FALSE(bits.check(140));
+
+    // --------------------------------
+    bits.clearRange(64, 64);
+    EXPECT_EQ(bits.count(), 16U);
+    EXPECT_EQ(bits.getWord(1), 0U);
+
+    // --------------------------------
+    // Clamped to the end of the bitset
+    bits.setRange(190, 100);
+    EXPECT_EQ(bits.count(), 26U);
+    bits.setRange(300, 1);
+    EXPECT_EQ(bits.count(), 26U);
+
+    // --------------------------------
+    bits.setAll();
+    EXPECT_TRUE(bits.all());
+    EXPECT_EQ(bits.count(), 200U);
+    EXPECT_EQ(bits.findFirstClear(), 200U);
+
+    bits.clearAll();
+    EXPECT_TRUE(bits.none());
+}
+
+TEST(BitSet, iterate) {
+
+    BitSet<130> bits{};
+    const std::vector<size_t> expected{0, 1, 31, 32, 63, 64, 100, 129};
+
+    for(const size_t pos : expected) {
+        bits.set(pos);
+    }
+
+    std::vector<size_t> found{};
+
+    for(const size_t pos : bits) {
+        found.push_back(pos);
+    }
+
+    EXPECT_EQ(found, expected);
+
+    BitSet<130> empty{};
+    EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(BitSet, find) {
+
+    BitSet<96, uint32_t> bits{};
+
+    EXPECT_EQ(bits.findFirst(), 96U);
+    EXPECT_EQ(bits.findFirstClear(), 0U);
+
+    bits.setRange(0, 40);
+    EXPECT_EQ(bits.findFirstClear(), 40U);
+
+    bits.set(95);
+    EXPECT_EQ(bits.findNext(40), 95U);
+    EXPECT_EQ(bits.findNext(96), 96U);
+}
+
+TEST(BitSet, operators) {
+
+    const BitSet<40, uint8_t> a{0b1100ULL | (1ULL << 39)};
+    const BitSet<40, uint8_t> b{0b1010ULL};
+
+    EXPECT_EQ(a & b, (BitSet<40, uint8_t>{0b1000ULL}));
+    EXPECT_EQ(a | b, (BitSet<40, uint8_t>{0b1110ULL | (1ULL << 39)}));
+    EXPECT_EQ(a ^ b, (BitSet<40, uint8_t>{0b0110ULL | (1ULL << 39)}));
+
+    // The bits past N stay cleared
+    EXPECT_EQ((~b).count(), 38U);
+    EXPECT_EQ((BitSet<40, uint8_t>{~0ULL}.count()), 40U);
+}
+
+TEST(BitSet, words) {
+
+    BitSet<64, uint16_t> bits{0x123456789ABCDEF0ULL};
+
+    EXPECT_EQ(hal::popcount(bits.words()), bits.count());
+    EXPECT_EQ(hal::find_first_set(bits.words()), bits.findFirst());
+}
+
+TEST(AtomicBitSet, set_clear_take) {
+
+    AtomicBitSet<70> flags{};
+
+    EXPECT_FALSE(flags.any());
+    EXPECT_FALSE(flags.set(5));
+    EXPECT_TRUE(flags.set(5));
+    EXPECT_FALSE(flags.set(69));
+    EXPECT_TRUE(flags.check(69));
+
+    EXPECT_TRUE(flags.toggle(69));
+    EXPECT_FALSE(flags.check(69));
+
+    EXPECT_TRUE(flags.clear(5));
+    EXPECT_FALSE(flags.clear(5));
+
+    flags.set(1);
+    flags.set(66);
+
+    const auto snapshot{flags.load()};
+    EXPECT_EQ(snapshot.count(), 2U);
+    EXPECT_TRUE(flags.any());
+
+    const auto taken{flags.takeAll()};
+    EXPECT_EQ(taken, snapshot);
+    EXPECT_FALSE(flags.any());
+}
+
+TEST(AtomicBitSet, concurrent) {
+
+    AtomicBitSet<128> flags{};
+    BitSet<128> received{};
+
+    std::thread producer{[&flags]() {
+
+        for(size_t pos{0}; pos < 128; pos++) {
+            flags.set(pos);
+            std::this_thread::yield();
+        }
+    }};
+
+    while(received.count() < 128) {
+
+        const auto taken{flags.takeAll()};
+
+        // A flag is never taken twice
+        EXPECT_TRUE((received & taken).none());
+        received |= taken;
+
+        std::this_thread::yield();
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(received.all());
+}
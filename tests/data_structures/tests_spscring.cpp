@@ -0,0 +1,174 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "data_structures/SpscRing.h"
+
+#include <thread>
+
+TEST(SpscRing, push_pop) {
+
+    hal::data_structures::SpscRing<uint32_t, 4> ring{};
+    uint32_t value{0};
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.pop(value));
+
+    for(uint32_t i{0}; i < 4; i++) {
+        EXPECT_TRUE(ring.push(i));
+    }
+
+    EXPECT_TRUE(ring.full());
+    EXPECT_FALSE(ring.push(4));
+    EXPECT_EQ(ring.size(), 4U);
+
+    for(uint32_t i{0}; i < 4; i++) {
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, i);
+    }
+
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, wrap_around) {
+
+    hal::data_structures::SpscRing<uint8_t, 8> ring{};
+    uint8_t value{0};
+
+    for(uint8_t i{0}; i < 100; i++) {
+
+        EXPECT_TRUE(ring.push(i));
+        EXPECT_TRUE(ring.push(static_cast<uint8_t>(i + 1)));
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, i);
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, i + 1);
+    }
+
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, spans) {
+
+    hal::data_structures::SpscRing<uint8_t, 8> ring{};
+
+    // Move the indices so the free space wraps around
+    const uint8_t init[]{0, 1, 2, 3, 4, 5};
+    uint8_t out[8]{};
+
+    EXPECT_EQ(ring.write(init, hal::sizeof_array(init)), 6U);
+    EXPECT_EQ(ring.read(out, 6), 6U);
+
+    std::span<uint8_t> slots{ring.pushN(8)};
+    EXPECT_EQ(slots.size(), 2U);
+    slots[0] = 10;
+    slots[1] = 11;
+    ring.commitPush(2);
+
+    slots = ring.pushN(8);
+    EXPECT_EQ(slots.size(), 6U);
+    slots[0] = 12;
+    ring.commitPush(1);
+
+    std::span<const uint8_t> data{ring.popN(8)};
+    EXPECT_EQ(data.size(), 2U);
+    EXPECT_EQ(data[0], 10);
+    EXPECT_EQ(data[1], 11);
+    ring.commitPop(2);
+
+    data = ring.popN(8);
+    EXPECT_EQ(data.size(), 1U);
+    EXPECT_EQ(data[0], 12);
+    ring.commitPop(1);
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.popN(8).empty());
+}
+
+TEST(SpscRing, bulk_read_write) {
+
+    hal::data_structures::SpscRing<uint16_t, 16> ring{};
+    uint16_t in[20];
+    uint16_t out[20]{};
+
+    for(uint16_t i{0}; i < 20; i++) {
+        in[i] = static_cast<uint16_t>(i * 3);
+    }
+
+    EXPECT_EQ(ring.write(in, 10), 10U);
+    EXPECT_EQ(ring.read(out, 5), 5U);
+
+    // Wraps around the end of the storage and stops once full
+    EXPECT_EQ(ring.write(in + 10, 10), 10U);
+    EXPECT_EQ(ring.write(in, 20), 1U);
+
+    EXPECT_EQ(ring.read(out + 5, 20), 16U);
+    EXPECT_EQ(memcmp(out, in, 20 * sizeof(uint16_t)), 0);
+    EXPECT_EQ(ring.read(out, 20), 0U);
+}
+
+TEST(SpscRing, stress) {
+
+    constexpr uint32_t iterations{1'000'000};
+
+    static hal::data_structures::SpscRing<uint32_t, 256> ring{};
+    ring.clear();
+
+    std::thread producer{[]() {
+
+        uint32_t values[7];
+
+        for(uint32_t i{0}; i < iterations;) {
+
+            // Mix single and bulk pushes
+            if(i % 3 == 0) {
+
+                if(ring.push(i)) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            } else {
+
+                const uint32_t length{hal::min(7U, iterations - i)};
+
+                for(uint32_t j{0}; j < length; j++) {
+                    values[j] = i + j;
+                }
+
+                const size_t count{ring.write(values, length)};
+
+                if(count == 0) {
+                    std::this_thread::yield();
+                }
+
+                i += static_cast<uint32_t>(count);
+            }
+        }
+    }};
+
+    bool in_order{true};
+    uint32_t expected{0};
+
+    while(expected < iterations) {
+
+        const std::span<const uint32_t> data{ring.popN(32)};
+
+        for(const uint32_t value : data) {
+            in_order &= value == expected++;
+        }
+
+        ring.commitPop(data.size());
+
+        if(data.empty()) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,84 @@
+//
+// Created by marmelade on 17/10/22.
+//
+
+#include <gtest/gtest.h>
+
+#include "peripherals/DigitalInOut.h"
+
+TEST(DigitalInOut, init_deinit) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    {
+        hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO4};
+
+        EXPECT_TRUE(gpio.inited());
+        EXPECT_TRUE(hal::host::PinBank::getInstance().isUsed(hal::GPIO4));
+        EXPECT_TRUE(hal::host::PinBank::getInstance().isOutput(hal::GPIO4));
+    }
+
+    EXPECT_FALSE(hal::host::PinBank::getInstance().isUsed(hal::GPIO4));
+}
+
+TEST(DigitalInOut, write_read) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO3};
+
+    gpio.write(1);
+    EXPECT_EQ(gpio.read(), 1);
+    EXPECT_EQ(hal::host::PinBank::getInstance().getAll(), 1U << hal::GPIO3);
+
+    gpio << 0;
+    uint8_t value{1};
+    gpio >> value;
+    EXPECT_EQ(value, 0);
+}
+
+TEST(DigitalInOut, toggle) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO7};
+
+    gpio.toggle();
+    EXPECT_EQ(gpio.read(), 1);
+
+    gpio.toggle();
+    EXPECT_EQ(gpio.read(), 0);
+}
+
+TEST(DigitalInOut, input) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO9};
+
+    gpio.setDirection(hal::peripherals::gpio::Direction::IN);
+    gpio.write(1);
+    EXPECT_EQ(gpio.read(), 0);
+
+    hal::host::PinBank::getInstance().drive(hal::GPIO9, true);
+    EXPECT_EQ(gpio.read(), 1);
+
+    hal::host::PinBank::getInstance().drive(hal::GPIO9, false);
+    EXPECT_TRUE(gpio.setPull(hal::peripherals::gpio::Pull::UP));
+    EXPECT_EQ(gpio.read(), 1);
+
+    EXPECT_FALSE(gpio.setPull(hal::peripherals::gpio::Pull::OPEN_DRAIN));
+    EXPECT_EQ(gpio.getLastError(), hal::Error::NOTAVAILABLEONPLATFORM);
+}
+
+TEST(DigitalInOut, move) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO5};
+    hal::peripherals::gpio::DigitalInOut moved{std::move(gpio)};
+
+    EXPECT_FALSE(gpio.inited());
+    EXPECT_TRUE(moved.inited());
+    EXPECT_EQ(moved.getPin(), hal::GPIO5);
+}
@@ -0,0 +1,206 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/GpioIRQ.h"
+
+using hal::peripherals::gpio::IRQ;
+using hal::peripherals::gpio::Event;
+using hal::peripherals::gpio::IRQDispatcher;
+
+static void resetIRQs() {
+
+    auto &dispatcher{IRQDispatcher::getInstance()};
+    Event event{};
+
+    for(uint gpio_pin{0}; gpio_pin < hal::NUMBER_GPIO_PIN; gpio_pin++) {
+        dispatcher.detach(gpio_pin);
+    }
+
+    while(dispatcher.popEvent(event)) {}
+
+    dispatcher.resetDroppedEvents();
+    hal::host::PinBank::getInstance().reset();
+}
+
+static void countIRQ(const uint gpio_pin, const IRQ gpio_irq, void * const context) {
+
+    (void)gpio_pin;
+    (void)gpio_irq;
+
+    (*static_cast<uint *>(context))++;
+}
+
+TEST(GpioIRQ, to_events) {
+
+    EXPECT_EQ(IRQDispatcher::toEvents(IRQ::NONE), 0U);
+    EXPECT_EQ(IRQDispatcher::toEvents(IRQ::LEVEL_LOW), 0x1U);
+    EXPECT_EQ(IRQDispatcher::toEvents(IRQ::LEVEL_HIGH), 0x2U);
+    EXPECT_EQ(IRQDispatcher::toEvents(IRQ::EDGE_FALL), 0x4U);
+    EXPECT_EQ(IRQDispatcher::toEvents(IRQ::EDGE_RISE), 0x8U);
+}
+
+TEST(GpioIRQ, callback) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    uint count{0};
+
+    EXPECT_FALSE(IRQDispatcher::getInstance().attach(hal::GPIO5, IRQ::EDGE_RISE, countIRQ, &count));
+
+    bank.drive(hal::GPIO5, true);
+    bank.drive(hal::GPIO5, true);   // No edge
+    bank.drive(hal::GPIO5, false);  // Falling edge, not attached
+    bank.drive(hal::GPIO5, true);
+
+    EXPECT_EQ(count, 2U);
+    EXPECT_EQ(IRQDispatcher::getInstance().getPendingEvents(), 0U);
+}
+
+TEST(GpioIRQ, queue_order) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    auto &dispatcher{IRQDispatcher::getInstance()};
+
+    dispatcher.attach(hal::GPIO2, IRQ::EDGE_RISE);
+    dispatcher.attach(hal::GPIO3, IRQ::EDGE_FALL);
+
+    bank.drive(hal::GPIO3, true);
+    bank.drive(hal::GPIO2, true);
+    bank.drive(hal::GPIO3, false);
+    bank.drive(hal::GPIO2, false);
+    bank.drive(hal::GPIO2, true);
+
+    ASSERT_EQ(dispatcher.getPendingEvents(), 3U);
+
+    Event event{};
+    uint64_t last{0};
+    const uint8_t expected_pins[]{hal::GPIO2, hal::GPIO3, hal::GPIO2};
+    const IRQ expected_irqs[]{IRQ::EDGE_RISE, IRQ::EDGE_FALL, IRQ::EDGE_RISE};
+
+    for(size_t i{0}; i < hal::sizeof_array(expected_pins); i++) {
+
+        ASSERT_TRUE(dispatcher.popEvent(event));
+        EXPECT_EQ(event.gpio_pin, expected_pins[i]);
+        EXPECT_EQ(event.gpio_irq, expected_irqs[i]);
+        EXPECT_GE(event.timestamp, last);
+
+        last = event.timestamp;
+    }
+
+    EXPECT_FALSE(dispatcher.popEvent(event));
+}
+
+TEST(GpioIRQ, same_change) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    auto &dispatcher{IRQDispatcher::getInstance()};
+
+    dispatcher.attach(hal::GPIO9, IRQ::EDGE_RISE);
+    dispatcher.attach(hal::GPIO4, IRQ::EDGE_RISE);
+    bank.setDirection(hal::GPIO4, true);
+    bank.setDirection(hal::GPIO9, true);
+
+    // Both pins change at once, the events are raised in pin order
+    bank.putMasked((1U << hal::GPIO4) | (1U << hal::GPIO9), ~0U);
+
+    Event event{};
+
+    ASSERT_TRUE(dispatcher.popEvent(event));
+    EXPECT_EQ(event.gpio_pin, hal::GPIO4);
+    ASSERT_TRUE(dispatcher.popEvent(event));
+    EXPECT_EQ(event.gpio_pin, hal::GPIO9);
+}
+
+TEST(GpioIRQ, dropped) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    auto &dispatcher{IRQDispatcher::getInstance()};
+
+    dispatcher.attach(hal::GPIO6, IRQ::EDGE_RISE);
+
+    for(size_t i{0}; i < hal::peripherals::GPIO_EVENT_QUEUE_SIZE + 10; i++) {
+
+        bank.drive(hal::GPIO6, true);
+        bank.drive(hal::GPIO6, false);
+    }
+
+    EXPECT_EQ(dispatcher.getPendingEvents(), hal::peripherals::GPIO_EVENT_QUEUE_SIZE);
+    EXPECT_EQ(dispatcher.getDroppedEvents(), 10U);
+
+    dispatcher.resetDroppedEvents();
+    EXPECT_EQ(dispatcher.getDroppedEvents(), 0U);
+}
+
+TEST(GpioIRQ, detach) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    auto &dispatcher{IRQDispatcher::getInstance()};
+    uint count{0};
+
+    dispatcher.attach(hal::GPIO8, IRQ::LEVEL_HIGH, countIRQ, &count);
+    bank.drive(hal::GPIO8, true);
+
+    EXPECT_FALSE(dispatcher.detach(hal::GPIO8));
+    EXPECT_EQ(dispatcher.getIRQ(hal::GPIO8), IRQ::NONE);
+
+    bank.drive(hal::GPIO8, false);
+    bank.drive(hal::GPIO8, true);
+
+    EXPECT_EQ(count, 1U);
+}
+
+TEST(GpioIRQ, invalid) {
+
+    resetIRQs();
+
+    auto &dispatcher{IRQDispatcher::getInstance()};
+
+    EXPECT_TRUE(dispatcher.attach(hal::NUMBER_GPIO_PIN, IRQ::EDGE_RISE));
+    EXPECT_EQ(dispatcher.getLastError(), hal::Error::ERROR);
+
+    EXPECT_TRUE(dispatcher.attach(hal::GPIO1, IRQ::NONE));
+    EXPECT_TRUE(dispatcher.detach(hal::NUMBER_GPIO_PIN));
+}
+
+TEST(GpioIRQ, digitalinout) {
+
+    resetIRQs();
+
+    auto &bank{hal::host::PinBank::getInstance()};
+    uint count{0};
+
+    {
+        hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO10};
+
+        gpio.setDirection(hal::peripherals::gpio::Direction::IN);
+
+        EXPECT_FALSE(gpio.setIRQ(IRQ::EDGE_FALL, countIRQ, &count));
+        EXPECT_EQ(gpio.getIRQ(), IRQ::EDGE_FALL);
+
+        bank.drive(hal::GPIO10, true);
+        bank.drive(hal::GPIO10, false);
+
+        EXPECT_EQ(count, 1U);
+    }
+
+    // The interrupt is detached with the pin
+    EXPECT_EQ(IRQDispatcher::getInstance().getIRQ(hal::GPIO10), IRQ::NONE);
+
+    bank.drive(hal::GPIO10, true);
+    bank.drive(hal::GPIO10, false);
+
+    EXPECT_EQ(count, 1U);
+}
@@ -0,0 +1,112 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "peripherals/GpioPort.h"
+
+using namespace hal;
+using peripherals::gpio::Direction;
+using peripherals::gpio::GpioBus;
+using peripherals::gpio::GpioPort;
+
+using ContiguousPort = GpioPort<GPIO8, GPIO9, GPIO10, GPIO11>;
+using ScatteredPort = GpioPort<GPIO3, GPIO1, GPIO20, GPIO7>;
+
+static_assert(ContiguousPort::MASK == 0x0F00);
+static_assert(ContiguousPort::pack(0b1010) == 0x0A00);
+static_assert(ContiguousPort::unpack(0xFFFF'F5FF) == 0b0101);
+static_assert(ScatteredPort::MASK == ((1U << 3) | (1U << 1) | (1U << 20) | (1U << 7)));
+static_assert(ScatteredPort::pack(0b0101) == ((1U << 3) | (1U << 20)));
+static_assert(ScatteredPort::unpack((1U << 1) | (1U << 7) | (1U << 5)) == 0b1010);
+
+TEST(GpioPort, write_read) {
+
+    host::PinBank::getInstance().reset();
+
+    ContiguousPort port{};
+
+    port.write(0b1001);
+    EXPECT_EQ(host::PinBank::getInstance().getAll(), 0x0900U);
+    EXPECT_EQ(port.read(), 0b1001U);
+
+    // Pins outside the port are untouched
+    host::PinBank::getInstance().setDirection(GPIO0, true);
+    host::PinBank::getInstance().put(GPIO0, true);
+    port.write(0xFFFF'FFFF);
+    EXPECT_EQ(host::PinBank::getInstance().getAll(), 0x0F01U);
+}
+
+TEST(GpioPort, scattered) {
+
+    host::PinBank::getInstance().reset();
+
+    ScatteredPort port{};
+
+    for(uint32_t value{0}; value < 16; value++) {
+
+        port.write(value);
+        EXPECT_EQ(port.read(), value);
+    }
+}
+
+TEST(GpioPort, input) {
+
+    host::PinBank::getInstance().reset();
+
+    ScatteredPort port{Direction::IN};
+
+    host::PinBank::getInstance().drive(GPIO20, true);
+    host::PinBank::getInstance().drive(GPIO1, true);
+
+    EXPECT_EQ(port.read(), 0b0110U);
+}
+
+TEST(GpioBus, write_read) {
+
+    host::PinBank::getInstance().reset();
+
+    const uint pins[]{GPIO5, GPIO2, GPIO12};
+    GpioBus bus{pins};
+
+    EXPECT_EQ(bus.getLastError(), Error::NONE);
+    EXPECT_EQ(bus.getWidth(), 3U);
+    EXPECT_EQ(bus.getMask(), (1U << 5) | (1U << 2) | (1U << 12));
+
+    for(uint32_t value{0}; value < 8; value++) {
+
+        bus.write(value);
+        EXPECT_EQ(bus.read(), value);
+        EXPECT_EQ(bus.unpack(bus.pack(value)), value);
+    }
+
+    bus.write(0b001);
+    EXPECT_EQ(host::PinBank::getInstance().getAll(), 1U << 5);
+}
+
+TEST(GpioBus, contiguous) {
+
+    host::PinBank::getInstance().reset();
+
+    const uint pins[]{GPIO16, GPIO17, GPIO18, GPIO19, GPIO20, GPIO21, GPIO22, GPIO23};
+    GpioBus bus{pins};
+
+    bus.write(0xA5);
+    EXPECT_EQ(host::PinBank::getInstance().getAll(), 0xA5U << 16);
+    EXPECT_EQ(bus.read(), 0xA5U);
+}
+
+TEST(GpioBus, invalid) {
+
+    const uint duplicated[]{GPIO1, GPIO2, GPIO1};
+    GpioBus bus{duplicated};
+
+    EXPECT_EQ(bus.getLastError(), Error::ERROR);
+    EXPECT_EQ(bus.getMask(), 0U);
+
+    const uint out_of_range[]{GPIO1, NUMBER_GPIO_PIN};
+    GpioBus bus2{out_of_range};
+
+    EXPECT_EQ(bus2.getLastError(), Error::ERROR);
+}
@@ -0,0 +1,346 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "peripherals/I2C.h"
+
+using hal::peripherals::i2c::I2C;
+using hal::peripherals::i2c::Transaction;
+
+namespace {
+
+    /**
+     * Device that records the stops it sees.
+     */
+    class StopCounter : public hal::host::I2CRegisterDevice<16> {
+    public:
+
+        void onStop() override {
+
+            m_stops++;
+        }
+
+        size_t m_stops{0};
+    };
+
+    I2C &initialised_i2c() {
+
+        auto &i2c{I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+        i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+
+        return i2c;
+    }
+
+} // namespace
+
+TEST(I2C, init_deinit) {
+
+    auto &i2c{I2C::getInstance(hal::peripherals::I2C_INSTANCE0)};
+
+    EXPECT_FALSE(i2c.init(hal::GPIO4, hal::GPIO5, hal::peripherals::I2C_DEFAULT_BAUD_RATE));
+    EXPECT_TRUE(i2c.isInitialised());
+    EXPECT_EQ(i2c.getBaudrate(), hal::peripherals::I2C_DEFAULT_BAUD_RATE);
+    EXPECT_NE(&i2c, &I2C::getInstance(hal::peripherals::I2C_INSTANCE1));
+
+    EXPECT_FALSE(i2c.deinit());
+    EXPECT_FALSE(i2c.isInitialised());
+
+    const uint8_t data{0};
+    EXPECT_TRUE(i2c.write(0x68, {&data, 1}));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+}
+
+TEST(I2C, write_read) {
+
+    auto &i2c{initialised_i2c()};
+    hal::host::I2CRegisterDevice<16> sensor{};
+    ASSERT_FALSE(i2c.attach(0x68, sensor));
+
+    const uint8_t data[]{0x02, 0xDE, 0xAD};
+    EXPECT_FALSE(i2c.write(0x68, data));
+    EXPECT_EQ(sensor.getRegister(2), 0xDE);
+    EXPECT_EQ(sensor.getRegister(3), 0xAD);
+
+    const uint8_t reg{0x02};
+    uint8_t received[2]{};
+    EXPECT_FALSE(i2c.writeRead(0x68, {&reg, 1}, received));
+    EXPECT_EQ(received[0], 0xDE);
+    EXPECT_EQ(received[1], 0xAD);
+    EXPECT_EQ(sensor.getReads(), 1U);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(I2C, repeated_start) {
+
+    auto &i2c{initialised_i2c()};
+    StopCounter sensor{};
+    i2c.attach(0x68, sensor);
+    sensor.setRegister(0x0F, 0x68);
+
+    const uint8_t reg{0x0F};
+    uint8_t who_am_i{0};
+
+    // The bus is kept between the write and the read
+    EXPECT_FALSE(i2c.write(0x68, {&reg, 1}, true));
+    EXPECT_EQ(sensor.m_stops, 0U);
+    EXPECT_FALSE(i2c.read(0x68, {&who_am_i, 1}));
+    EXPECT_EQ(sensor.m_stops, 1U);
+    EXPECT_EQ(who_am_i, 0x68);
+
+    EXPECT_FALSE(i2c.writeRead(0x68, {&reg, 1}, {&who_am_i, 1}));
+    EXPECT_EQ(sensor.m_stops, 2U);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(I2C, nack) {
+
+    auto &i2c{initialised_i2c()};
+    hal::host::I2CRegisterDevice<16> sensor{};
+    i2c.attach(0x68, sensor);
+
+    uint8_t data[]{0x00, 0x01};
+
+    EXPECT_TRUE(i2c.write(0x69, data));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+
+    // Register out of range
+    const uint8_t reg{0x20};
+    EXPECT_TRUE(i2c.write(0x68, {&reg, 1}));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+
+    EXPECT_TRUE(i2c.read(0x00, data));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+
+    EXPECT_TRUE(i2c.read(0x68, {data, 0}));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::TOOSMALL);
+
+    // Reserved or already used address
+    EXPECT_TRUE(i2c.attach(0x78, sensor));
+    EXPECT_TRUE(i2c.attach(0x68, sensor));
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(I2C, transfer_validation) {
+
+    auto &i2c{initialised_i2c()};
+    hal::host::I2CRegisterDevice<16> sensor{};
+    i2c.attach(0x68, sensor);
+
+    const uint8_t reg{0x00};
+    uint8_t small[4]{};
+    uint8_t big[hal::peripherals::I2C_MAX_TRANSFER]{};
+
+    Transaction too_big[]{{0x68, {&reg, 1}, small}, {0x68, {&reg, 1}, big}};
+    EXPECT_TRUE(i2c.transfer(too_big));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::TOOBIG);
+    EXPECT_EQ(too_big[1].error, hal::Error::TOOBIG);
+
+    Transaction empty[]{{0x68, {&reg, 1}, small}, {0x68, {}, {}}};
+    EXPECT_TRUE(i2c.transfer(empty));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::TOOSMALL);
+
+    Transaction reserved[]{{0x68, {&reg, 1}, small}, {0x03, {&reg, 1}, small}};
+    EXPECT_TRUE(i2c.transfer(reserved));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+
+    // Nothing was executed
+    EXPECT_EQ(sensor.getReads(), 0U);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(I2C, transfer_sensors) {
+
+    auto &i2c{initialised_i2c()};
+    std::array<hal::host::I2CRegisterDevice<16>, 12> sensors{};
+
+    for(size_t i{0}; i < sensors.size(); i++) {
+
+        for(size_t reg{0}; reg < 6; reg++) {
+            sensors[i].setRegister(0x08 + reg, static_cast<uint8_t>(i * 16 + reg));
+        }
+
+        i2c.attach(static_cast<uint8_t>(0x40 + i), sensors[i]);
+    }
+
+    const uint8_t reg{0x08};
+    uint8_t samples[12][6]{};
+    Transaction transactions[13];
+
+    for(size_t i{0}; i < 12; i++) {
+        transactions[i] = {static_cast<uint8_t>(0x40 + i), {&reg, 1}, samples[i]};
+    }
+
+    // A missing device does not stop the list
+    uint8_t missing[6]{};
+    transactions[12] = {0x30, {&reg, 1}, missing};
+
+    EXPECT_TRUE(i2c.transfer(transactions));
+    EXPECT_EQ(i2c.getLastError(), hal::Error::ERROR);
+    EXPECT_EQ(transactions[12].error, hal::Error::ERROR);
+
+    for(size_t i{0}; i < 12; i++) {
+
+        EXPECT_EQ(transactions[i].error, hal::Error::NONE);
+        EXPECT_EQ(sensors[i].getReads(), 1U);
+
+        for(size_t byte{0}; byte < 6; byte++) {
+            EXPECT_EQ(samples[i][byte], i * 16 + byte);
+        }
+
+        i2c.detach(static_cast<uint8_t>(0x40 + i));
+    }
+
+    i2c.deinit();
+}
+
+TEST(I2C, transfer_async) {
+
+    auto &i2c{initialised_i2c()};
+    hal::host::I2CRegisterDevice<16> sensor{};
+    i2c.attach(0x68, sensor);
+    sensor.setRegister(0x01, 0x42);
+
+    struct Result {
+        hal::Error error;
+        size_t count;
+    } result{hal::Error::ERROR, 0};
+
+    const uint8_t reg{0x01};
+    uint8_t value{0};
+    Transaction transactions[]{{0x68, {&reg, 1}, {&value, 1}}};
+
+    EXPECT_FALSE(i2c.transferAsync(transactions, [](const hal::Error error, const size_t count, void *context) {
+        *static_cast<Result *>(context) = {error, count};
+    }, &result));
+
+    EXPECT_FALSE(i2c.isBusy());
+    EXPECT_EQ(result.error, hal::Error::NONE);
+    EXPECT_EQ(result.count, 1U);
+    EXPECT_EQ(value, 0x42);
+    EXPECT_EQ(i2c.abort(), 0U);
+
+    i2c.detach(0x68);
+    i2c.deinit();
+}
+
+TEST(I2C, register_map) {
+
+    struct Written {
+        size_t offset;
+        size_t length;
+        size_t calls;
+    } written{0, 0, 0};
+
+    uint8_t registers[8]{};
+    hal::peripherals::i2c::RegisterMap map{};
+
+    map.attach(registers, [](const size_t offset, const size_t length, void *context) {
+        auto *result{static_cast<Written *>(context)};
+        *result = {offset, length, result->calls + 1};
+    }, &written);
+
+    // Pointer, then three registers written in place
+    map.receive(0x02, true);
+    map.receive(0xA0, false);
+    map.receive(0xA1, false);
+    map.receive(0xA2, false);
+    EXPECT_EQ(written.calls, 0U);
+    EXPECT_EQ(registers[3], 0xA1);
+
+    map.stop();
+    EXPECT_EQ(written.calls, 1U);
+    EXPECT_EQ(written.offset, 2U);
+    EXPECT_EQ(written.length, 3U);
+
+    // A write wrapping around is reported in two ranges
+    map.receive(0x07, true);
+    map.receive(0xB0, false);
+    map.receive(0xB1, false);
+    EXPECT_EQ(written.calls, 2U);
+    EXPECT_EQ(written.offset, 7U);
+    EXPECT_EQ(written.length, 1U);
+    map.stop();
+    EXPECT_EQ(written.calls, 3U);
+    EXPECT_EQ(written.offset, 0U);
+    EXPECT_EQ(registers[0], 0xB1);
+
+    // Reads auto-increment and wrap around, out of range pointers wrap too
+    map.receive(0x0F, true);
+    EXPECT_EQ(map.getPointer(), 7U);
+    EXPECT_EQ(map.transmit(), 0xB0);
+    EXPECT_EQ(map.transmit(), 0xB1);
+    map.stop();
+    EXPECT_EQ(written.calls, 3U);
+}
+
+TEST(I2C, slave) {
+
+    auto &master{initialised_i2c()};
+    auto &slave{I2C::getInstance(hal::peripherals::I2C_INSTANCE1)};
+
+    struct Written {
+        size_t offset;
+        size_t length;
+    } written{0, 0};
+
+    uint8_t registers[32]{};
+    registers[0x10] = 0x5A;
+    registers[0x11] = 0xA5;
+
+    uint8_t too_big[257]{};
+    EXPECT_TRUE(slave.initSlave(0x42, hal::GPIO6, hal::GPIO7, too_big));
+    EXPECT_EQ(slave.getLastError(), hal::Error::TOOBIG);
+    EXPECT_TRUE(slave.initSlave(0x42, hal::GPIO6, hal::GPIO7, {}));
+    EXPECT_EQ(slave.getLastError(), hal::Error::TOOSMALL);
+    EXPECT_TRUE(slave.initSlave(0x7F, hal::GPIO6, hal::GPIO7, registers));
+    EXPECT_EQ(slave.getLastError(), hal::Error::ERROR);
+
+    EXPECT_FALSE(slave.initSlave(0x42, hal::GPIO6, hal::GPIO7, registers, [](const size_t offset, const size_t length, void *context) {
+        *static_cast<Written *>(context) = {offset, length};
+    }, &written));
+    EXPECT_EQ(slave.getMode(), hal::peripherals::i2c::Mode::MODE_SLAVE);
+    EXPECT_EQ(master.getMode(), hal::peripherals::i2c::Mode::MODE_MASTER);
+    ASSERT_FALSE(master.attach(0x42, slave.getSlaveDevice()));
+
+    // A slave cannot drive the bus
+    EXPECT_TRUE(slave.write(0x42, registers));
+    EXPECT_EQ(slave.getLastError(), hal::Error::ERROR);
+
+    const uint8_t command[]{0x04, 0x01, 0x02, 0x03};
+    EXPECT_FALSE(master.write(0x42, command));
+    EXPECT_EQ(registers[4], 0x01);
+    EXPECT_EQ(registers[6], 0x03);
+    EXPECT_EQ(written.offset, 4U);
+    EXPECT_EQ(written.length, 3U);
+
+    const uint8_t reg{0x10};
+    uint8_t received[2]{};
+    EXPECT_FALSE(master.writeRead(0x42, {&reg, 1}, received));
+    EXPECT_EQ(received[0], 0x5A);
+    EXPECT_EQ(received[1], 0xA5);
+
+    // The application updates a register, the next read sees it without a copy
+    registers[0x10] = 0x77;
+    Transaction transactions[]{{0x42, {&reg, 1}, {received, 1}}};
+    EXPECT_FALSE(master.transfer(transactions));
+    EXPECT_EQ(received[0], 0x77);
+
+    EXPECT_FALSE(slave.deinit());
+    EXPECT_EQ(slave.getMode(), hal::peripherals::i2c::Mode::MODE_MASTER);
+    EXPECT_TRUE(master.writeRead(0x42, {&reg, 1}, received));
+
+    master.detach(0x42);
+    master.deinit();
+}
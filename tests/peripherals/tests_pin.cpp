@@ -0,0 +1,91 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/Pin.h"
+
+using hal::peripherals::gpio::Direction;
+using hal::peripherals::gpio::DigitalInOut;
+using hal::peripherals::gpio::Pin;
+
+static_assert(hal::concepts::is_digital_gpio<DigitalInOut>);
+static_assert(hal::concepts::is_digital_gpio<Pin<hal::GPIO2, Direction::OUT>>);
+static_assert(hal::concepts::is_digital_input<Pin<hal::GPIO2, Direction::IN>>);
+static_assert(not hal::concepts::is_digital_output<Pin<hal::GPIO2, Direction::IN>>);
+static_assert(Pin<hal::GPIO7, Direction::OUT>::getPin() == hal::GPIO7);
+static_assert(sizeof(Pin<hal::GPIO7, Direction::OUT>) == 1);
+
+/**
+ * Generic driver accepting either a static or a virtual pin.
+ */
+template<hal::concepts::is_digital_output T>
+static void pulse(T &gpio, const int count) {
+
+    for(int i{0}; i < count; i++) {
+        gpio.toggle();
+    }
+}
+
+TEST(Pin, write_read) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    Pin<hal::GPIO3, Direction::OUT> gpio{};
+
+    EXPECT_TRUE(hal::host::PinBank::getInstance().isOutput(hal::GPIO3));
+
+    gpio.write(1);
+    EXPECT_EQ(gpio.read(), 1);
+
+    gpio.low();
+    EXPECT_EQ(gpio.read(), 0);
+
+    gpio.high();
+    EXPECT_EQ(hal::host::PinBank::getInstance().getAll(), 1U << hal::GPIO3);
+
+    gpio.toggle();
+    EXPECT_EQ(gpio.read(), 0);
+}
+
+TEST(Pin, input) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    Pin<hal::GPIO11, Direction::IN> gpio{};
+
+    EXPECT_EQ(gpio.read(), 0);
+
+    hal::host::PinBank::getInstance().drive(hal::GPIO11, true);
+    EXPECT_EQ(gpio.read(), 1);
+
+    EXPECT_FALSE(gpio.setPull(hal::peripherals::gpio::Pull::OPEN_DRAIN));
+}
+
+TEST(Pin, deinit) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    {
+        Pin<hal::GPIO8, Direction::OUT> gpio{};
+        EXPECT_TRUE(hal::host::PinBank::getInstance().isUsed(hal::GPIO8));
+    }
+
+    EXPECT_FALSE(hal::host::PinBank::getInstance().isUsed(hal::GPIO8));
+}
+
+TEST(Pin, generic_driver) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    Pin<hal::GPIO0, Direction::OUT> static_gpio{};
+    DigitalInOut virtual_gpio{hal::GPIO1};
+
+    pulse(static_gpio, 3);
+    pulse(virtual_gpio, 3);
+
+    EXPECT_EQ(static_gpio.read(), 1);
+    EXPECT_EQ(virtual_gpio.read(), 1);
+}
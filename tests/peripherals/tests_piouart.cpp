@@ -0,0 +1,225 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "peripherals/PioUART.h"
+
+using hal::host::PioSerializer;
+using hal::host::PioWires;
+using hal::peripherals::uart::PioUART;
+
+namespace {
+
+    struct ReadResult {
+
+        size_t calls{0};
+        size_t count{0};
+    };
+
+    void onRead(const hal::Error error, const size_t count, void * const context) {
+
+        auto &result{*static_cast<ReadResult *>(context)};
+
+        EXPECT_EQ(error, hal::Error::NONE);
+        result.calls++;
+        result.count = count;
+    }
+
+    /**
+     * Drive a frame on a wire, with a stop bit at the level given.
+     */
+    void driveFrame(const uint pin, const uint8_t byte, const bool stop) {
+
+        const uint16_t frame{PioSerializer::frame(byte)};
+
+        for(size_t bit{0}; bit < PioSerializer::FRAME_BITS - 1; bit++) {
+            PioWires::getInstance().drive(pin, (frame >> bit & 1U) != 0);
+        }
+
+        PioWires::getInstance().drive(pin, stop);
+    }
+
+} // namespace
+
+TEST(PioUART, serializer) {
+
+    // Start bit low, data least significant bit first, stop bit high
+    EXPECT_EQ(PioSerializer::frame(0x00), 0b10'0000'0000);
+    EXPECT_EQ(PioSerializer::frame(0xA5), 0b11'0100'1010);
+
+    PioSerializer serializer;
+    uint8_t byte{0};
+
+    for(const uint8_t value : {0x00, 0x5A, 0xFF}) {
+
+        const uint16_t frame{PioSerializer::frame(value)};
+
+        // The line idles high before the start bit
+        EXPECT_EQ(serializer.sample(true, byte), PioSerializer::Event::NONE);
+
+        for(size_t bit{0}; bit < PioSerializer::FRAME_BITS - 1; bit++) {
+            EXPECT_EQ(serializer.sample((frame >> bit & 1U) != 0, byte), PioSerializer::Event::NONE);
+        }
+
+        EXPECT_EQ(serializer.sample(true, byte), PioSerializer::Event::BYTE);
+        EXPECT_EQ(byte, value);
+    }
+
+    // A low stop bit drops the byte, nothing is received until the line returns high
+    EXPECT_EQ(serializer.sample(false, byte), PioSerializer::Event::NONE);
+
+    for(size_t bit{0}; bit < 8; bit++) {
+        serializer.sample(false, byte);
+    }
+
+    EXPECT_EQ(serializer.sample(false, byte), PioSerializer::Event::FRAMING_ERROR);
+    EXPECT_EQ(serializer.sample(false, byte), PioSerializer::Event::NONE);
+    EXPECT_EQ(serializer.sample(true, byte), PioSerializer::Event::NONE);
+}
+
+TEST(PioUART, instances) {
+
+    auto &link0{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE0)};
+    auto &link3{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE3)};
+
+    EXPECT_NE(&link0, &link3);
+    EXPECT_EQ(hal::peripherals::uart::SERIAL_LINKS, 6);
+
+    // Hardware UARTs first, then the PIO ones
+    EXPECT_EQ(&hal::peripherals::uart::getSerial(1), &hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE1));
+    EXPECT_EQ(&hal::peripherals::uart::getSerial(2), &link0);
+    EXPECT_EQ(&hal::peripherals::uart::getSerial(5), &link3);
+}
+
+TEST(PioUART, write_read) {
+
+    auto &left{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE0)};
+    auto &right{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE1)};
+
+    // TX of each link wired to RX of the other
+    EXPECT_FALSE(left.init(hal::GPIO6, hal::GPIO7, hal::peripherals::UART_DEFAULT_BAUD_RATE));
+    EXPECT_FALSE(right.init(hal::GPIO7, hal::GPIO6, hal::peripherals::UART_DEFAULT_BAUD_RATE));
+    EXPECT_TRUE(left.isInitialised());
+    EXPECT_FALSE(left.isReadable());
+
+    // Only one link listens on a pin
+    auto &other{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE2)};
+    EXPECT_TRUE(other.init(hal::GPIO6, hal::GPIO8, hal::peripherals::UART_DEFAULT_BAUD_RATE));
+    EXPECT_FALSE(other.isInitialised());
+
+    const uint8_t data[]{0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t received[4]{};
+
+    left.write(data, sizeof(data));
+    EXPECT_TRUE(right.isReadable());
+    right.read(received, sizeof(received));
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    right.write(0x42);
+    EXPECT_EQ(left.read(), 0x42);
+
+    // Through the registry, from another thread while read() waits
+    std::thread writer{[]() { hal::peripherals::uart::getSerial(3).write(0x17); }};
+    EXPECT_EQ(hal::peripherals::uart::getSerial(2).read(), 0x17);
+    writer.join();
+
+    // Nothing listens on GPIO8, the frames are captured
+    EXPECT_FALSE(right.setPins(hal::GPIO7, hal::GPIO8));
+    right.write(0xA5);
+
+    const std::vector<bool> levels{PioWires::getInstance().take(hal::GPIO8)};
+    ASSERT_EQ(levels.size(), PioSerializer::FRAME_BITS);
+
+    for(size_t bit{0}; bit < PioSerializer::FRAME_BITS; bit++) {
+        EXPECT_EQ(levels[bit], (PioSerializer::frame(0xA5) >> bit & 1U) != 0);
+    }
+
+    EXPECT_FALSE(left.deinit());
+    EXPECT_FALSE(right.deinit());
+    EXPECT_FALSE(left.isInitialised());
+}
+
+TEST(PioUART, errors) {
+
+    auto &uart{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE2)};
+    uart.init(hal::GPIO10, hal::GPIO11, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.resetStats();
+
+    // The line has to idle before the next start bit is seen
+    driveFrame(hal::GPIO10, 0x11, false);
+    PioWires::getInstance().drive(hal::GPIO10, true);
+    driveFrame(hal::GPIO10, 0x22, true);
+
+    EXPECT_EQ(uart.read(), 0x22);
+    EXPECT_FALSE(uart.isReadable());
+
+    // The RX FIFO holds PIO_UART_FIFO_DEPTH bytes, the next ones are lost
+    for(size_t i{0}; i < hal::peripherals::uart::PIO_UART_FIFO_DEPTH + 2; i++) {
+        driveFrame(hal::GPIO10, static_cast<uint8_t>(i), true);
+    }
+
+    uint8_t received[hal::peripherals::uart::PIO_UART_FIFO_DEPTH];
+    uart.read(received, sizeof(received));
+
+    for(size_t i{0}; i < sizeof(received); i++) {
+        EXPECT_EQ(received[i], i);
+    }
+
+    EXPECT_FALSE(uart.isReadable());
+
+    const hal::stats::UARTStats stats{uart.getStats()};
+    EXPECT_EQ(stats.framing_errors, 1U);
+    EXPECT_EQ(stats.overruns, 2U);
+    EXPECT_EQ(stats.bytes_read, 1U + hal::peripherals::uart::PIO_UART_FIFO_DEPTH);
+
+    uart.deinit();
+}
+
+TEST(PioUART, async) {
+
+    auto &left{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE2)};
+    auto &right{PioUART::getInstance(hal::peripherals::PIO_UART_INSTANCE3)};
+    left.init(hal::GPIO12, hal::GPIO13, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    right.init(hal::GPIO13, hal::GPIO12, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    uint8_t data[20];
+    uint8_t received[20]{};
+    ReadResult write_result;
+    ReadResult read_result;
+
+    for(size_t i{0}; i < sizeof(data); i++) {
+        data[i] = static_cast<uint8_t>(i + 1);
+    }
+
+    // The bytes already in the RX FIFO are taken first
+    left.write(data, 4);
+    EXPECT_FALSE(right.readAsync(received, onRead, &read_result));
+    EXPECT_TRUE(right.isReadBusy());
+    EXPECT_TRUE(right.readAsync(received));
+    EXPECT_EQ(right.getLastError(), hal::Error::AGAIN);
+
+    EXPECT_FALSE(left.writeAsync({data + 4, 16}, onRead, &write_result));
+    EXPECT_EQ(write_result.calls, 1U);
+    EXPECT_EQ(write_result.count, 16U);
+
+    EXPECT_FALSE(right.isReadBusy());
+    EXPECT_EQ(read_result.calls, 1U);
+    EXPECT_EQ(read_result.count, 20U);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    // Aborted, the bytes received stay in the buffer and the callback is not called
+    EXPECT_FALSE(right.readAsync(received, onRead, &read_result));
+    left.write(data, 3);
+    EXPECT_EQ(right.abortRead(), 3U);
+    EXPECT_FALSE(right.isReadBusy());
+    EXPECT_EQ(read_result.calls, 1U);
+
+    left.deinit();
+    right.deinit();
+}
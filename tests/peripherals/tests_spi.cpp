@@ -0,0 +1,245 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/SPI.h"
+
+using hal::peripherals::spi::SPI;
+using hal::peripherals::spi::Transaction;
+
+namespace {
+
+    /**
+     * Device answering the complement of each byte and recording the level of its chip select.
+     */
+    class Device : public hal::host::SPIDevice {
+    public:
+
+        explicit Device(hal::interfaces::InterfaceDigitalGPIO &cs) : m_cs{cs} {}
+
+        uint8_t exchange(const uint8_t mosi) override {
+
+            m_selected = m_selected and m_cs.read() == 0;
+            m_bytes++;
+
+            return static_cast<uint8_t>(~mosi);
+        }
+
+        hal::interfaces::InterfaceDigitalGPIO &m_cs;
+        bool m_selected{true};
+        size_t m_bytes{0};
+    };
+
+    /**
+     * Loopback holding the transfer thread until it is opened.
+     */
+    class Gate : public hal::host::SPIDevice {
+    public:
+
+        uint8_t exchange(const uint8_t mosi) override {
+
+            m_entered = true;
+
+            while(!m_open) {
+                std::this_thread::yield();
+            }
+
+            return mosi;
+        }
+
+        std::atomic<bool> m_entered{false};
+        std::atomic<bool> m_open{false};
+    };
+
+    SPI &initialised_spi() {
+
+        auto &spi{SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+        spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+
+        return spi;
+    }
+
+} // namespace
+
+TEST(SPI, init_deinit) {
+
+    auto &spi{SPI::getInstance(hal::peripherals::SPI_INSTANCE0)};
+
+    EXPECT_FALSE(spi.init(hal::GPIO18, hal::GPIO19, hal::GPIO16, hal::peripherals::SPI_DEFAULT_BAUD_RATE));
+    EXPECT_TRUE(spi.isInitialised());
+    EXPECT_EQ(spi.getBaudrate(), hal::peripherals::SPI_DEFAULT_BAUD_RATE);
+    EXPECT_EQ(spi.getMode(), hal::peripherals::spi::Mode::MODE0);
+    EXPECT_NE(&spi, &SPI::getInstance(hal::peripherals::SPI_INSTANCE1));
+
+    EXPECT_FALSE(spi.setMode(hal::peripherals::spi::Mode::MODE3));
+    EXPECT_EQ(spi.getMode(), hal::peripherals::spi::Mode::MODE3);
+
+    EXPECT_FALSE(spi.deinit());
+    EXPECT_FALSE(spi.isInitialised());
+
+    const uint8_t data{0};
+    EXPECT_TRUE(spi.write({&data, 1}));
+    EXPECT_EQ(spi.getLastError(), hal::Error::ERROR);
+}
+
+TEST(SPI, loopback) {
+
+    auto &spi{initialised_spi()};
+
+    const uint8_t tx[]{0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t rx[4]{};
+
+    EXPECT_FALSE(spi.transfer(tx, rx));
+    EXPECT_EQ(memcmp(tx, rx, sizeof(tx)), 0);
+
+    // Reading sends the fill byte, which comes back
+    EXPECT_FALSE(spi.read(rx));
+    EXPECT_EQ(rx[0], hal::peripherals::spi::FILL_BYTE);
+    EXPECT_EQ(rx[3], hal::peripherals::spi::FILL_BYTE);
+
+    EXPECT_FALSE(spi.write(tx));
+
+    EXPECT_TRUE(spi.transfer({}, {}));
+    EXPECT_EQ(spi.getLastError(), hal::Error::TOOSMALL);
+
+    EXPECT_TRUE(spi.transfer(tx, {rx, 2}));
+    EXPECT_EQ(spi.getLastError(), hal::Error::ERROR);
+
+    spi.deinit();
+}
+
+TEST(SPI, chip_select) {
+
+    auto &spi{initialised_spi()};
+    hal::peripherals::gpio::DigitalInOut cs{hal::GPIO17};
+    cs.write(1);
+
+    Device device{cs};
+    spi.setDevice(&device);
+
+    const uint8_t tx[]{0x0F, 0xF0};
+    uint8_t rx[2]{};
+
+    EXPECT_FALSE(spi.transfer(cs, tx, rx));
+    EXPECT_TRUE(device.m_selected);
+    EXPECT_EQ(device.m_bytes, 2U);
+    EXPECT_EQ(cs.read(), 1);
+    EXPECT_EQ(rx[0], 0xF0);
+    EXPECT_EQ(rx[1], 0x0F);
+
+    spi.setDevice(nullptr);
+    spi.deinit();
+}
+
+TEST(SPI, transfer_async) {
+
+    auto &spi{initialised_spi()};
+    hal::peripherals::gpio::DigitalInOut cs{hal::GPIO17};
+    cs.write(1);
+
+    Device device{cs};
+    spi.setDevice(&device);
+
+    struct Completions {
+        std::vector<size_t> counts;
+        std::atomic<size_t> done{0};
+    } completions;
+
+    uint8_t tx[hal::peripherals::SPI_QUEUE_SIZE][4];
+    uint8_t rx[hal::peripherals::SPI_QUEUE_SIZE][4]{};
+    Transaction transactions[hal::peripherals::SPI_QUEUE_SIZE];
+
+    completions.counts.resize(hal::peripherals::SPI_QUEUE_SIZE);
+
+    for(size_t i{0}; i < hal::peripherals::SPI_QUEUE_SIZE; i++) {
+
+        for(size_t byte{0}; byte < 4; byte++) {
+            tx[i][byte] = static_cast<uint8_t>(i * 4 + byte);
+        }
+
+        transactions[i] = {&cs, tx[i], rx[i], [](const hal::Error error, const size_t count, void *context) {
+            auto *results{static_cast<Completions *>(context)};
+            results->counts[results->done++] = error == hal::Error::NONE ? count : 0;
+        }, &completions};
+
+        EXPECT_FALSE(spi.transferAsync(transactions[i]));
+    }
+
+    while(spi.isBusy()) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(completions.done, hal::peripherals::SPI_QUEUE_SIZE);
+    EXPECT_TRUE(device.m_selected);
+    EXPECT_EQ(cs.read(), 1);
+
+    for(size_t i{0}; i < hal::peripherals::SPI_QUEUE_SIZE; i++) {
+
+        EXPECT_EQ(completions.counts[i], 4U);
+        EXPECT_EQ(transactions[i].error, hal::Error::NONE);
+
+        for(size_t byte{0}; byte < 4; byte++) {
+            EXPECT_EQ(rx[i][byte], static_cast<uint8_t>(~tx[i][byte]));
+        }
+    }
+
+    Transaction invalid{&cs, {}, {}};
+    EXPECT_TRUE(spi.transferAsync(invalid));
+    EXPECT_EQ(invalid.error, hal::Error::TOOSMALL);
+
+    spi.setDevice(nullptr);
+    spi.deinit();
+}
+
+TEST(SPI, queue_full_abort) {
+
+    auto &spi{initialised_spi()};
+    Gate gate{};
+    spi.setDevice(&gate);
+
+    uint8_t data[4]{};
+    Transaction running{nullptr, {}, {data, 1}};
+    Transaction transactions[hal::peripherals::SPI_QUEUE_SIZE + 1];
+
+    EXPECT_FALSE(spi.transferAsync(running));
+
+    while(!gate.m_entered) {
+        std::this_thread::yield();
+    }
+
+    // The running transaction left the queue
+    for(size_t i{0}; i < hal::peripherals::SPI_QUEUE_SIZE; i++) {
+
+        transactions[i] = {nullptr, {}, {data, 4}};
+        EXPECT_FALSE(spi.transferAsync(transactions[i]));
+    }
+
+    transactions[hal::peripherals::SPI_QUEUE_SIZE] = {nullptr, {}, {data, 4}};
+    EXPECT_TRUE(spi.transferAsync(transactions[hal::peripherals::SPI_QUEUE_SIZE]));
+    EXPECT_EQ(spi.getLastError(), hal::Error::AGAIN);
+
+    EXPECT_TRUE(spi.read(data));
+    EXPECT_EQ(spi.getLastError(), hal::Error::AGAIN);
+
+    std::future<size_t> dropped{std::async(std::launch::async, [&spi]() { return spi.abort(); })};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    gate.m_open = true;
+
+    EXPECT_EQ(dropped.get(), hal::peripherals::SPI_QUEUE_SIZE);
+    EXPECT_FALSE(spi.isBusy());
+    EXPECT_EQ(running.error, hal::Error::NONE);
+    EXPECT_EQ(transactions[0].error, hal::Error::AGAIN);
+
+    spi.setDevice(nullptr);
+    spi.deinit();
+}
@@ -0,0 +1,449 @@
+//
+// Created by marmelade on 30/10/22.
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "peripherals/UART.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+TEST(UART, init_deinit) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+
+    EXPECT_FALSE(uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE));
+    EXPECT_TRUE(uart.isInitialised());
+    EXPECT_EQ(uart.getBaudrate(), hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    EXPECT_TRUE(uart.isWritable());
+    EXPECT_FALSE(uart.isReadable());
+
+    EXPECT_FALSE(uart.deinit());
+    EXPECT_FALSE(uart.isInitialised());
+}
+
+TEST(UART, instances) {
+
+    auto &uart0{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    auto &uart1{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE1)};
+
+    EXPECT_NE(&uart0, &uart1);
+    EXPECT_EQ(&uart0, &hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0));
+}
+
+TEST(UART, write) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    const uint8_t data[]{0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t received[5]{};
+
+    uart.write(0x42);
+    uart.write(data, hal::sizeof_array(data));
+
+    EXPECT_EQ(::read(uart.getPeer(), received, sizeof(received)), 5);
+    EXPECT_EQ(received[0], 0x42);
+    EXPECT_EQ(memcmp(received + 1, data, sizeof(data)), 0);
+
+    uart.deinit();
+}
+
+TEST(UART, read) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE1)};
+    uart.init(hal::GPIO5, hal::GPIO4, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    const uint8_t data[]{0x01, 0x02, 0x03, 0x04, 0x05};
+    uint8_t received[4]{};
+
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), 5);
+    EXPECT_TRUE(uart.isReadable());
+
+    EXPECT_EQ(uart.read(), 0x01);
+    uart.read(received, hal::sizeof_array(received));
+
+    EXPECT_EQ(uart.getLastError(), hal::Error::NONE);
+    EXPECT_EQ(memcmp(received, data + 1, sizeof(received)), 0);
+    EXPECT_FALSE(uart.isReadable());
+
+    uart.deinit();
+}
+
+TEST(UART, try_read_write) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    const uint8_t data[]{0x01, 0x02, 0x03};
+    uint8_t received[8]{};
+    size_t count{0};
+
+    EXPECT_EQ(uart.tryRead(received, hal::sizeof_array(received), count), hal::Error::AGAIN);
+    EXPECT_EQ(count, 0U);
+
+    EXPECT_EQ(uart.tryWrite(data, hal::sizeof_array(data), count), hal::Error::NONE);
+    EXPECT_EQ(count, 3U);
+
+    EXPECT_EQ(::read(uart.getPeer(), received, sizeof(received)), 3);
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), 3);
+
+    EXPECT_EQ(uart.tryRead(received, hal::sizeof_array(received), count), hal::Error::NONE);
+    EXPECT_EQ(count, 3U);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    uart.deinit();
+}
+
+TEST(UART, buffered) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    EXPECT_FALSE(uart.setBuffered(true));
+    EXPECT_TRUE(uart.isBuffered());
+
+    const uint8_t data[]{0xCA, 0xFE, 0xBA, 0xBE};
+    uint8_t received[8]{};
+    size_t count{0};
+
+    // TX: the write primes the FIFO, no interrupt needed for a short frame
+    EXPECT_EQ(uart.tryWrite(data, hal::sizeof_array(data), count), hal::Error::NONE);
+    EXPECT_EQ(count, 4U);
+    EXPECT_EQ(::read(uart.getPeer(), received, sizeof(received)), 4);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    // RX: nothing is readable until the interrupt moves the bytes into the ring
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), 4);
+    EXPECT_EQ(uart.tryRead(received, hal::sizeof_array(received), count), hal::Error::AGAIN);
+
+    uart.raiseIRQ();
+
+    EXPECT_EQ(uart.tryRead(received, hal::sizeof_array(received), count), hal::Error::NONE);
+    EXPECT_EQ(count, 4U);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    EXPECT_FALSE(uart.setBuffered(false));
+    EXPECT_FALSE(uart.isBuffered());
+
+    uart.deinit();
+}
+
+TEST(UART, buffered_peer_closed) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.setBuffered(true);
+
+    const uint8_t data[]{0x12, 0x34};
+    uint8_t received[4]{};
+
+    // The bytes sent before the remote end closes are still read, then the read gives up
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), 2);
+    EXPECT_EQ(::shutdown(uart.getPeer(), SHUT_WR), 0);
+
+    uart.read(received, sizeof(received));
+    EXPECT_EQ(uart.getLastError(), hal::Error::ERROR);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    uart.deinit();
+}
+
+TEST(UART, buffered_peer_closed_write) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.setBuffered(true);
+
+    // More than the TX ring and the socket hold, the write gives up instead of waiting for room
+    std::vector<uint8_t> data(64 * 1024);
+    size_t count{0};
+
+    EXPECT_EQ(::shutdown(uart.getPeer(), SHUT_RDWR), 0);
+
+    uart.write(data.data(), data.size());
+    EXPECT_EQ(uart.getLastError(), hal::Error::ERROR);
+
+    EXPECT_EQ(uart.tryWrite(data.data(), data.size(), count), hal::Error::ERROR);
+    EXPECT_EQ(count, 0U);
+
+    uart.deinit();
+}
+
+TEST(UART, buffered_full_rings) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.setBuffered(true);
+
+    uint8_t data[hal::peripherals::UART_RX_BUFFER_SIZE + 64];
+    uint8_t received[hal::peripherals::UART_RX_BUFFER_SIZE + 64]{};
+    size_t count{0};
+
+    for(size_t i{0}; i < sizeof(data); i++) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+
+    // RX ring stops at its capacity, the rest stays on the wire
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+
+    for(size_t i{0}; i < sizeof(data); i++) {
+        uart.raiseIRQ();
+    }
+
+    EXPECT_EQ(uart.tryRead(received, hal::sizeof_array(received), count), hal::Error::NONE);
+    EXPECT_EQ(count, hal::peripherals::UART_RX_BUFFER_SIZE);
+
+    uart.read(received + count, sizeof(data) - count);
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    // TX ring accepts up to its capacity
+    EXPECT_EQ(uart.tryWrite(data, hal::sizeof_array(data), count), hal::Error::NONE);
+    EXPECT_EQ(count, hal::peripherals::UART_TX_BUFFER_SIZE);
+
+    // Disabling the buffered mode flushes the TX ring
+    uart.setBuffered(false);
+    EXPECT_EQ(::recv(uart.getPeer(), received, count, MSG_WAITALL), static_cast<ssize_t>(count));
+    EXPECT_EQ(memcmp(received, data, count), 0);
+
+    uart.deinit();
+}
+
+namespace {
+
+    struct TransferResult {
+
+        std::atomic<int> calls{0};
+        std::atomic<size_t> count{0};
+        std::atomic<hal::Error> error{hal::Error::AGAIN};
+    };
+
+    void onTransfer(const hal::Error error, const size_t count, void * const context) {
+
+        auto * const result{static_cast<TransferResult *>(context)};
+
+        result->error.store(error);
+        result->count = count;
+        result->calls++;
+    }
+
+} // namespace
+
+TEST(UART, write_async) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    // Bigger than the socket buffer, the transfer cannot complete before the peer reads
+    std::vector<uint8_t> data(1 << 20);
+    std::vector<uint8_t> received(data.size());
+    TransferResult result;
+
+    for(size_t i{0}; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 13);
+    }
+
+    EXPECT_FALSE(uart.writeAsync(data, onTransfer, &result));
+    EXPECT_TRUE(uart.isWriteBusy());
+
+    EXPECT_TRUE(uart.writeAsync(data));
+    EXPECT_EQ(uart.getLastError(), hal::Error::AGAIN);
+
+    // Refused too, nothing is sent between the bytes of the transfer
+    const std::span<const uint8_t> frame[]{data};
+    uart.writev(frame);
+    EXPECT_EQ(uart.getLastError(), hal::Error::AGAIN);
+
+    uart.write(0x55);
+    EXPECT_EQ(uart.getLastError(), hal::Error::AGAIN);
+
+    EXPECT_EQ(::recv(uart.getPeer(), received.data(), received.size(), MSG_WAITALL), static_cast<ssize_t>(received.size()));
+    EXPECT_EQ(received, data);
+
+    while(uart.isWriteBusy()) {
+        std::this_thread::yield();
+    }
+
+    while(result.calls == 0) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(result.calls, 1);
+    EXPECT_EQ(result.error, hal::Error::NONE);
+    EXPECT_EQ(result.count, data.size());
+
+    uart.deinit();
+}
+
+TEST(UART, read_async) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE1)};
+    uart.init(hal::GPIO5, hal::GPIO4, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    uint8_t data[100];
+    uint8_t received[100]{};
+
+    for(size_t i{0}; i < sizeof(data); i++) {
+        data[i] = static_cast<uint8_t>(i + 1);
+    }
+
+    // Polled, no callback
+    EXPECT_FALSE(uart.readAsync(received));
+    EXPECT_TRUE(uart.isReadBusy());
+
+    // The blocking read does not take the bytes of the transfer
+    uart.read();
+    EXPECT_EQ(uart.getLastError(), hal::Error::AGAIN);
+
+    // Half of the bytes do not complete the transfer
+    EXPECT_EQ(::write(uart.getPeer(), data, 50), 50);
+
+    for(size_t i{0}; i < 100; i++) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_TRUE(uart.isReadBusy());
+
+    EXPECT_EQ(::write(uart.getPeer(), data + 50, 50), 50);
+
+    while(uart.isReadBusy()) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(memcmp(received, data, sizeof(data)), 0);
+
+    // With a write at the same time
+    TransferResult write_result;
+    TransferResult read_result;
+
+    EXPECT_FALSE(uart.readAsync({received, 10}, onTransfer, &read_result));
+    EXPECT_FALSE(uart.writeAsync({data, 10}, onTransfer, &write_result));
+    EXPECT_EQ(::recv(uart.getPeer(), received + 50, 10, MSG_WAITALL), 10);
+    EXPECT_EQ(::write(uart.getPeer(), data + 20, 10), 10);
+
+    while(read_result.calls == 0 or write_result.calls == 0) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(read_result.count, 10U);
+    EXPECT_EQ(write_result.count, 10U);
+    EXPECT_EQ(memcmp(received, data + 20, 10), 0);
+    EXPECT_EQ(memcmp(received + 50, data, 10), 0);
+
+    uart.deinit();
+}
+
+TEST(UART, abort_async) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    uint8_t received[16]{};
+    TransferResult result;
+
+    EXPECT_FALSE(uart.readAsync(received, onTransfer, &result));
+    EXPECT_EQ(uart.abortRead(), 0U);
+    EXPECT_FALSE(uart.isReadBusy());
+    EXPECT_EQ(uart.abortRead(), 0U);
+
+    // Aborted transfers are not completed later
+    const uint8_t data[16]{};
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), 16);
+
+    for(size_t i{0}; i < 100; i++) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(result.calls, 0);
+
+    // The bytes left on the wire complete the next transfer
+    EXPECT_FALSE(uart.readAsync(received, onTransfer, &result));
+
+    while(result.calls == 0) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(result.count, sizeof(data));
+
+    // The buffered mode and the transfers exclude each other
+    EXPECT_FALSE(uart.readAsync(received));
+    EXPECT_TRUE(uart.setBuffered(true));
+    EXPECT_EQ(uart.getLastError(), hal::Error::AGAIN);
+    uart.abortRead();
+
+    EXPECT_FALSE(uart.setBuffered(true));
+    EXPECT_TRUE(uart.writeAsync(data));
+    EXPECT_EQ(uart.getLastError(), hal::Error::ERROR);
+
+    // Empty transfers complete straight away
+    EXPECT_FALSE(uart.setBuffered(false));
+    EXPECT_FALSE(uart.writeAsync({}, onTransfer, &result));
+    EXPECT_EQ(result.calls, 2);
+    EXPECT_EQ(result.count, 0U);
+
+    // Deinitialising stops a running transfer
+    EXPECT_FALSE(uart.readAsync(received, onTransfer, &result));
+    EXPECT_FALSE(uart.deinit());
+    EXPECT_FALSE(uart.isReadBusy());
+    EXPECT_EQ(result.calls, 2);
+}
+
+TEST(UART, writev) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    const uint8_t header[]{0xAA, 0x03};
+    const uint8_t payload[]{0x01, 0x02, 0x03};
+    const uint8_t crc[]{0x5A, 0xA5};
+    const std::span<const uint8_t> frame[]{header, {}, payload, crc};
+    uint8_t received[7]{};
+
+    uart.writev(frame);
+
+    EXPECT_EQ(uart.getLastError(), hal::Error::NONE);
+    EXPECT_EQ(::recv(uart.getPeer(), received, sizeof(received), MSG_WAITALL), 7);
+
+    const uint8_t expected[]{0xAA, 0x03, 0x01, 0x02, 0x03, 0x5A, 0xA5};
+    EXPECT_EQ(memcmp(received, expected, sizeof(expected)), 0);
+
+    // More buffers than a single system call takes, bigger than the socket buffer in total
+    std::vector<uint8_t> data(1 << 20);
+    std::vector<std::span<const uint8_t>> buffers;
+    std::vector<uint8_t> all(data.size());
+
+    for(size_t i{0}; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    for(size_t position{0}, length{1}; position < data.size(); position += length, length = length * 3 % 65521) {
+
+        length = hal::min(length, data.size() - position);
+        buffers.emplace_back(data.data() + position, length);
+    }
+
+    std::thread reader{[&]() {
+        EXPECT_EQ(::recv(uart.getPeer(), all.data(), all.size(), MSG_WAITALL), static_cast<ssize_t>(all.size()));
+    }};
+
+    uart.writev(buffers);
+    reader.join();
+
+    EXPECT_EQ(uart.getLastError(), hal::Error::NONE);
+    EXPECT_EQ(all, data);
+
+    // Buffered mode goes through the TX ring
+    uart.setBuffered(true);
+    uart.writev(frame);
+    uart.setBuffered(false);
+
+    EXPECT_EQ(::recv(uart.getPeer(), received, sizeof(received), MSG_WAITALL), 7);
+    EXPECT_EQ(memcmp(received, expected, sizeof(expected)), 0);
+
+    uart.deinit();
+}
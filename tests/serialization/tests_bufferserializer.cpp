@@ -0,0 +1,173 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "serialization/BufferSerializer.h"
+
+using hal::serialization::BufferReader;
+using hal::serialization::BufferWriter;
+using hal::serialization::Endian;
+using hal::serialization::serialized_size_v;
+
+static_assert(serialized_size_v<uint8_t, uint16_t, uint32_t, uint64_t, float, double> == 27);
+static_assert(serialized_size_v<> == 0);
+
+// Round trip at compile time
+static_assert([]() {
+
+    uint8_t buffer[8]{};
+    BufferWriter writer{buffer, Endian::BIG};
+    writer << uint16_t{0x1234} << 1.5f;
+
+    BufferReader reader{buffer, Endian::BIG};
+    return buffer[0] == 0x12 and buffer[1] == 0x34 and reader.get<uint16_t>() == 0x1234 and reader.get<float>() == 1.5f;
+}());
+
+TEST(BufferSerializer, endianness) {
+
+    uint8_t buffer[14]{};
+
+    // --------------------------------
+    BufferWriter writer{buffer, Endian::LITTLE};
+
+    EXPECT_FALSE(writer.write(uint32_t{0x11223344}, int16_t{-2}));
+    writer.setEndian(Endian::BIG);
+    EXPECT_FALSE(writer.write(uint32_t{0x11223344}));
+    writer << uint32_t{0x3F800000};  // 1.0f
+
+    const uint8_t expected[]{0x44, 0x33, 0x22, 0x11, 0xFE, 0xFF, 0x11, 0x22, 0x33, 0x44, 0x3F, 0x80, 0x00, 0x00};
+    EXPECT_EQ(memcmp(buffer, expected, sizeof(expected)), 0);
+    EXPECT_EQ(writer.getPosition(), sizeof(expected));
+    EXPECT_EQ(writer.getRemaining(), 0U);
+
+    // --------------------------------
+    BufferReader reader{writer.getWritten(), Endian::LITTLE};
+    uint32_t value32{0};
+    int16_t value16{0};
+    float valuef{0};
+
+    EXPECT_FALSE(reader.read(value32, value16));
+    EXPECT_EQ(value32, 0x11223344U);
+    EXPECT_EQ(value16, -2);
+
+    reader.setEndian(Endian::BIG);
+    reader >> value32 >> valuef;
+    EXPECT_EQ(value32, 0x11223344U);
+    EXPECT_EQ(valuef, 1.0f);
+    EXPECT_EQ(reader.getLastError(), hal::Error::NONE);
+}
+
+TEST(BufferSerializer, round_trip) {
+
+    enum class Command : uint8_t {
+        START = 1,
+        STOP = 2
+    };
+
+    uint8_t buffer[serialized_size_v<Command, bool, uint8_t, uint64_t, double, int32_t>]{};
+
+    for(const Endian endian : {Endian::LITTLE, Endian::BIG}) {
+
+        BufferWriter writer{buffer, endian};
+        writer << Command::STOP << true << uint8_t{0xAB} << uint64_t{0x0123456789ABCDEF} << -3.25 << int32_t{-100000};
+
+        ASSERT_EQ(writer.getLastError(), hal::Error::NONE);
+        ASSERT_EQ(writer.getRemaining(), 0U);
+
+        BufferReader reader{buffer, endian};
+        Command command{Command::START};
+        bool flag{false};
+        uint8_t value8{0};
+        uint64_t value64{0};
+        double valued{0};
+        int32_t values32{0};
+
+        reader >> command >> flag >> value8 >> value64 >> valued >> values32;
+
+        EXPECT_EQ(reader.getLastError(), hal::Error::NONE);
+        EXPECT_EQ(command, Command::STOP);
+        EXPECT_TRUE(flag);
+        EXPECT_EQ(value8, 0xAB);
+        EXPECT_EQ(value64, 0x0123456789ABCDEFU);
+        EXPECT_EQ(valued, -3.25);
+        EXPECT_EQ(values32, -100000);
+    }
+}
+
+TEST(BufferSerializer, too_small) {
+
+    uint8_t buffer[5]{0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
+
+    // --------------------------------
+    BufferWriter writer{buffer};
+
+    EXPECT_FALSE(writer.write(uint32_t{0}));
+    EXPECT_TRUE(writer.write(uint16_t{0}));
+    EXPECT_EQ(writer.getLastError(), hal::Error::TOOSMALL);
+    EXPECT_EQ(buffer[4], 0xAA);
+
+    // The error is sticky, even if the next value fits
+    EXPECT_TRUE(writer.write(uint8_t{0}));
+    EXPECT_EQ(writer.getPosition(), 4U);
+
+    writer.reset();
+    EXPECT_TRUE(writer.write(uint32_t{1}, uint16_t{2}));
+    EXPECT_EQ(writer.getPosition(), 0U);
+
+    // --------------------------------
+    BufferReader reader{buffer};
+    uint32_t value32{0};
+    uint16_t value16{0x55};
+
+    reader >> value32 >> value16;
+
+    EXPECT_EQ(reader.getLastError(), hal::Error::TOOSMALL);
+    EXPECT_EQ(value16, 0x55);
+    EXPECT_EQ(reader.get<uint8_t>(0x77), 0x77);
+}
+
+TEST(BufferSerializer, bytes) {
+
+    uint8_t buffer[16]{};
+    const uint8_t payload[]{1, 2, 3, 4, 5};
+
+    // --------------------------------
+    BufferWriter writer{buffer, Endian::BIG};
+
+    // Length field filled once the payload is known
+    writer << uint8_t{0x7E};
+    const size_t length_position{writer.getPosition()};
+    writer << uint16_t{0};
+
+    EXPECT_FALSE(writer.writeBytes(payload));
+
+    const std::span<uint8_t> reserved{writer.reserve(3)};
+    ASSERT_EQ(reserved.size(), 3U);
+    std::fill(reserved.begin(), reserved.end(), 0x33);
+
+    const size_t end{writer.getPosition()};
+    EXPECT_FALSE(writer.setPosition(length_position));
+    writer << static_cast<uint16_t>(end - 3);
+    EXPECT_FALSE(writer.setPosition(end));
+
+    EXPECT_TRUE(writer.reserve(100).empty());
+    EXPECT_TRUE(writer.setPosition(17));
+
+    // --------------------------------
+    BufferReader reader{std::span{buffer}.first(end), Endian::BIG};
+    uint8_t copy[5]{};
+
+    EXPECT_EQ(reader.get<uint8_t>(), 0x7E);
+    EXPECT_EQ(reader.get<uint16_t>(), 8U);
+    EXPECT_FALSE(reader.readBytes(copy));
+    EXPECT_EQ(memcmp(copy, payload, sizeof(payload)), 0);
+
+    const std::span<const uint8_t> view{reader.view(3)};
+    ASSERT_EQ(view.size(), 3U);
+    EXPECT_EQ(view.data(), buffer + 8);
+
+    EXPECT_EQ(reader.getRemaining(), 0U);
+    EXPECT_TRUE(reader.skip(1));
+}
@@ -0,0 +1,275 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "peripherals/UART.h"
+#include "serialization/Cobs.h"
+#include "serialization/Varint.h"
+
+#include <unistd.h>
+
+using hal::serialization::cobsDecode;
+using hal::serialization::cobsEncode;
+using hal::serialization::cobsMaxEncodedSize;
+using hal::serialization::CobsDecoder;
+using hal::serialization::CobsEncoder;
+
+static_assert(hal::concepts::is_byte_writer<hal::interfaces::InterfaceUART>);
+static_assert(!hal::concepts::is_byte_writer<int>);
+
+namespace {
+
+    struct VectorSink {
+
+        void write(const uint8_t * const data, const size_t length) {
+
+            bytes.insert(bytes.end(), data, data + length);
+            calls++;
+        }
+
+        std::vector<uint8_t> bytes;
+        size_t calls{0};
+    };
+
+    std::vector<uint8_t> randomPayload(std::mt19937 &generator, const size_t length) {
+
+        std::vector<uint8_t> payload(length);
+
+        // Plenty of zeros and long runs without them
+        const bool sparse{generator() % 2 == 0};
+
+        for(auto &byte : payload) {
+            byte = sparse and generator() % 300 != 0 ? static_cast<uint8_t>(generator() % 255 + 1) : static_cast<uint8_t>(generator() % 4);
+        }
+
+        return payload;
+    }
+
+} // namespace
+
+TEST(Cobs, known_vectors) {
+
+    std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> vectors{
+            {{0x00}, {0x01, 0x01}},
+            {{0x00, 0x00}, {0x01, 0x01, 0x01}},
+            {{0x11, 0x22, 0x00, 0x33}, {0x03, 0x11, 0x22, 0x02, 0x33}},
+            {{0x11, 0x00, 0x00, 0x00}, {0x02, 0x11, 0x01, 0x01, 0x01}},
+    };
+
+    // A 0x00 right after a full block: the 0xFF block carries no zero, the 0x00 gets its own block
+    std::vector<uint8_t> full_block(254, 0x11);
+    std::vector<uint8_t> full_block_encoded{0xFF};
+    full_block_encoded.insert(full_block_encoded.end(), full_block.begin(), full_block.end());
+
+    full_block.push_back(0x00);
+    full_block_encoded.insert(full_block_encoded.end(), {0x01, 0x01});
+    vectors.emplace_back(full_block, full_block_encoded);
+
+    full_block.push_back(0x22);
+    full_block_encoded.back() = 0x02;
+    full_block_encoded.push_back(0x22);
+    vectors.emplace_back(full_block, full_block_encoded);
+
+    for(const auto &[payload, expected] : vectors) {
+
+        VectorSink sink;
+        CobsEncoder encoder{sink};
+
+        encoder.write(payload);
+        encoder.end();
+
+        ASSERT_EQ(sink.bytes.size(), expected.size() + 1);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), sink.bytes.begin()));
+        EXPECT_EQ(sink.bytes.back(), hal::serialization::COBS_DELIMITER);
+
+        // Same bytes as the whole buffer encoder
+        std::vector<uint8_t> encoded(cobsMaxEncodedSize(payload.size()));
+        size_t length{0};
+
+        EXPECT_EQ(cobsEncode(payload, encoded, length), hal::Error::NONE);
+        ASSERT_EQ(length, expected.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), encoded.begin()));
+    }
+
+    // 254 non-zero bytes fill a block
+    std::vector<uint8_t> block(254, 0xAA);
+    uint8_t encoded[260]{};
+    size_t length{0};
+
+    EXPECT_EQ(cobsEncode(block, encoded, length), hal::Error::NONE);
+    EXPECT_EQ(length, 256U);
+    EXPECT_EQ(encoded[0], 0xFF);
+    EXPECT_EQ(encoded[255], 0x01);
+}
+
+TEST(Cobs, round_trip) {
+
+    std::mt19937 generator{42};
+
+    for(size_t i{0}; i < 200; i++) {
+
+        const std::vector<uint8_t> payload{randomPayload(generator, generator() % 1200 + 1)};
+
+        // --------------------------------
+        // Streamed, in random pieces
+        VectorSink sink;
+        CobsEncoder encoder{sink};
+
+        for(size_t sent{0}, count{0}; sent < payload.size(); sent += count) {
+
+            count = hal::min<size_t>(generator() % 300 + 1, payload.size() - sent);
+            encoder.write(payload.data() + sent, count);
+        }
+
+        encoder.end();
+
+        ASSERT_LE(sink.bytes.size(), cobsMaxEncodedSize(payload.size()) + 1);
+        EXPECT_EQ(std::count(sink.bytes.begin(), sink.bytes.end(), 0), 1);
+
+        // --------------------------------
+        // Same bytes as the whole buffer encoder
+        std::vector<uint8_t> encoded(cobsMaxEncodedSize(payload.size()));
+        size_t length{0};
+
+        ASSERT_EQ(cobsEncode(payload, encoded, length), hal::Error::NONE);
+        ASSERT_EQ(length, sink.bytes.size() - 1);
+        EXPECT_TRUE(std::equal(encoded.begin(), encoded.begin() + static_cast<std::ptrdiff_t>(length), sink.bytes.begin()));
+
+        // --------------------------------
+        // Decoded in place
+        encoded.resize(length);
+        ASSERT_EQ(cobsDecode(encoded, encoded, length), hal::Error::NONE);
+        EXPECT_EQ(std::vector<uint8_t>(encoded.begin(), encoded.begin() + static_cast<std::ptrdiff_t>(length)), payload);
+
+        // --------------------------------
+        // Decoded byte by byte
+        uint8_t frame[1200]{};
+        CobsDecoder decoder{frame};
+        size_t consumed{0};
+
+        ASSERT_EQ(decoder.decode(sink.bytes, consumed), hal::Error::NONE);
+        EXPECT_EQ(consumed, sink.bytes.size());
+        EXPECT_TRUE(std::ranges::equal(decoder.getFrame(), payload));
+    }
+}
+
+TEST(Cobs, decoder_errors) {
+
+    uint8_t frame[4]{};
+    CobsDecoder decoder{frame};
+    size_t consumed{0};
+
+    // Empty frames and a truncated block
+    const uint8_t truncated[]{0x00, 0x00, 0x04, 0x11, 0x00};
+    EXPECT_EQ(decoder.decode(truncated, consumed), hal::Error::ERROR);
+    EXPECT_EQ(consumed, sizeof(truncated));
+
+    // Too big, dropped up to the next delimiter
+    const uint8_t big[]{0x06, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x02, 0x66, 0x00};
+    EXPECT_EQ(decoder.decode(big, consumed), hal::Error::TOOBIG);
+    EXPECT_EQ(consumed, 6U);
+
+    const std::span<const uint8_t> rest{std::span<const uint8_t>{big}.subspan(consumed)};
+    EXPECT_EQ(decoder.decode(rest, consumed), hal::Error::NONE);
+    EXPECT_EQ(consumed, rest.size());
+    ASSERT_EQ(decoder.getFrame().size(), 1U);
+    EXPECT_EQ(decoder.getFrame()[0], 0x66);
+
+    // Whole buffer decoding
+    uint8_t data[8]{};
+    size_t length{0};
+    const uint8_t malformed[]{0x05, 0x11};
+    EXPECT_EQ(cobsDecode(malformed, data, length), hal::Error::ERROR);
+    EXPECT_EQ(cobsDecode(std::span<const uint8_t>{truncated}.subspan(2, 2), data, length), hal::Error::ERROR);
+
+    const uint8_t valid[]{0x03, 0x11, 0x22, 0x02, 0x33};
+    EXPECT_EQ(cobsDecode(valid, std::span<uint8_t>{data, 3}, length), hal::Error::TOOSMALL);
+}
+
+TEST(Cobs, fuzz) {
+
+    std::mt19937 generator{7};
+    uint8_t frame[64]{};
+    CobsDecoder decoder{frame};
+
+    for(size_t i{0}; i < 100000; i++) {
+
+        // Zeros often enough to end frames
+        const auto byte{static_cast<uint8_t>(generator() % 8 == 0 ? 0 : generator())};
+        const enum hal::Error error{decoder.decode(byte)};
+
+        ASSERT_TRUE(error == hal::Error::NONE or error == hal::Error::AGAIN or error == hal::Error::ERROR or error == hal::Error::TOOBIG);
+        ASSERT_LE(decoder.getFrame().size(), sizeof(frame));
+    }
+}
+
+TEST(Cobs, uart) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    std::mt19937 generator{3};
+    const std::vector<uint8_t> payload{randomPayload(generator, 700)};
+
+    CobsEncoder<hal::interfaces::InterfaceUART> encoder{uart};
+    encoder.write(payload);
+    encoder.end();
+
+    EXPECT_EQ(uart.getLastError(), hal::Error::NONE);
+
+    // Read until the delimiter
+    uint8_t frame[700]{};
+    CobsDecoder decoder{frame};
+    enum hal::Error error{hal::Error::AGAIN};
+
+    while(error == hal::Error::AGAIN) {
+
+        uint8_t byte{0};
+        ASSERT_EQ(::read(uart.getPeer(), &byte, 1), 1);
+        error = decoder.decode(byte);
+    }
+
+    EXPECT_EQ(error, hal::Error::NONE);
+    EXPECT_TRUE(std::ranges::equal(decoder.getFrame(), payload));
+
+    uart.deinit();
+}
+
+TEST(Cobs, telemetry_size) {
+
+    // Typical telemetry: small counters and signed deltas, which fixed width fields pad with zeros
+    std::mt19937 generator{5};
+    uint8_t fixed[512]{};
+    uint8_t packed[512]{};
+
+    hal::serialization::BufferWriter fixed_writer{fixed};
+    hal::serialization::BufferWriter packed_writer{packed};
+
+    for(size_t i{0}; i < 32; i++) {
+
+        const auto counter{static_cast<uint32_t>(generator() % 1000)};
+        const auto delta{static_cast<int32_t>(generator() % 200) - 100};
+
+        fixed_writer.write(counter, delta);
+        writeVarint(packed_writer, counter);
+        writeVarint(packed_writer, delta);
+    }
+
+    VectorSink fixed_sink;
+    VectorSink packed_sink;
+    CobsEncoder fixed_encoder{fixed_sink};
+    CobsEncoder packed_encoder{packed_sink};
+
+    fixed_encoder.write(fixed_writer.getWritten());
+    fixed_encoder.end();
+    packed_encoder.write(packed_writer.getWritten());
+    packed_encoder.end();
+
+    // At least 2 times smaller on the wire
+    EXPECT_LT(packed_sink.bytes.size() * 2, fixed_sink.bytes.size());
+}
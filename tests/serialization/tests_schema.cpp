@@ -0,0 +1,131 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include "serialization/Schema.h"
+
+using namespace hal::serialization;
+
+namespace {
+
+    enum class Mode : uint8_t {
+        IDLE,
+        ARMED,
+        FLYING
+    };
+
+    struct Telemetry {
+        uint8_t id;
+        uint32_t timestamp;
+        float temperature;
+        Mode mode;
+        bool armed;
+        int8_t trim;
+        uint16_t crc;
+    };
+
+    using TelemetrySchema = Schema<Endian::BIG,
+            Field<&Telemetry::id>,
+            Field<&Telemetry::timestamp>,
+            Field<&Telemetry::temperature>,
+            BitField<uint8_t, Bits<&Telemetry::mode, 2>, Bits<&Telemetry::armed, 1>, Bits<&Telemetry::trim, 5>>,
+            Padding<2>,
+            Field<&Telemetry::crc>>;
+
+    constexpr bool operator==(const Telemetry &a, const Telemetry &b) {
+
+        return a.id == b.id and a.timestamp == b.timestamp and a.temperature == b.temperature and a.mode == b.mode
+               and a.armed == b.armed and a.trim == b.trim and a.crc == b.crc;
+    }
+
+} // namespace
+
+static_assert(TelemetrySchema::SIZE == 14);
+static_assert(TelemetrySchema::OFFSETS[0] == 0);
+static_assert(TelemetrySchema::OFFSETS[1] == 1);
+static_assert(TelemetrySchema::OFFSETS[2] == 5);
+static_assert(TelemetrySchema::OFFSETS[3] == 9);
+static_assert(TelemetrySchema::OFFSETS[4] == 10);
+static_assert(TelemetrySchema::OFFSETS[5] == 12);
+static_assert(std::is_same_v<TelemetrySchema::object_type, Telemetry>);
+
+// Encode and decode at compile time
+static_assert([]() {
+
+    const Telemetry in{7, 0x01020304, 2.0f, Mode::FLYING, true, -3, 0xBEEF};
+    uint8_t frame[TelemetrySchema::SIZE]{};
+    Telemetry out{};
+
+    TelemetrySchema::encode(in, frame);
+    TelemetrySchema::decode(frame, out);
+
+    return out == in and frame[1] == 0x01 and frame[12] == 0xBE;
+}());
+
+TEST(Schema, encode) {
+
+    const Telemetry telemetry{0x42, 0x11223344, 1.0f, Mode::ARMED, true, -1, 0xCAFE};
+    uint8_t frame[TelemetrySchema::SIZE + 2];
+
+    memset(frame, 0xAA, sizeof(frame));
+
+    EXPECT_FALSE(TelemetrySchema::encode(telemetry, frame));
+
+    // mode = 0b01, armed = 0b1, trim = 0b11111
+    const uint8_t expected[]{0x42, 0x11, 0x22, 0x33, 0x44, 0x3F, 0x80, 0x00, 0x00, 0b11111101, 0x00, 0x00, 0xCA, 0xFE, 0xAA, 0xAA};
+    EXPECT_EQ(memcmp(frame, expected, sizeof(expected)), 0);
+}
+
+TEST(Schema, round_trip) {
+
+    for(const int8_t trim : {int8_t{-16}, int8_t{-1}, int8_t{0}, int8_t{5}, int8_t{15}}) {
+
+        const Telemetry in{1, 123456, -12.5f, Mode::FLYING, false, trim, 0x1234};
+        uint8_t frame[TelemetrySchema::SIZE]{};
+        Telemetry out{};
+
+        EXPECT_FALSE(TelemetrySchema::encode(in, frame));
+        EXPECT_FALSE(TelemetrySchema::decode(frame, out));
+        EXPECT_TRUE(out == in) << "trim " << static_cast<int>(trim);
+    }
+}
+
+TEST(Schema, too_small) {
+
+    const Telemetry in{};
+    Telemetry out{9, 9, 9.0f, Mode::ARMED, true, 1, 9};
+    uint8_t frame[TelemetrySchema::SIZE - 1]{};
+
+    EXPECT_TRUE(TelemetrySchema::encode(in, frame));
+    EXPECT_TRUE(TelemetrySchema::decode(frame, out));
+    EXPECT_EQ(out.id, 9);
+}
+
+TEST(Schema, writer_reader) {
+
+    const Telemetry first{1, 10, 1.5f, Mode::IDLE, false, 0, 0x0001};
+    const Telemetry second{2, 20, 2.5f, Mode::ARMED, true, -2, 0x0002};
+    uint8_t buffer[2 * TelemetrySchema::SIZE + 1]{};
+
+    // --------------------------------
+    BufferWriter writer{buffer};
+
+    writer << uint8_t{2};
+    EXPECT_FALSE(TelemetrySchema::write(writer, first));
+    EXPECT_FALSE(TelemetrySchema::write(writer, second));
+    EXPECT_TRUE(TelemetrySchema::write(writer, second));
+    EXPECT_EQ(writer.getLastError(), hal::Error::TOOSMALL);
+
+    // --------------------------------
+    BufferReader reader{buffer};
+    Telemetry out{};
+
+    EXPECT_EQ(reader.get<uint8_t>(), 2);
+    EXPECT_FALSE(TelemetrySchema::read(reader, out));
+    EXPECT_TRUE(out == first);
+    EXPECT_FALSE(TelemetrySchema::read(reader, out));
+    EXPECT_TRUE(out == second);
+    EXPECT_TRUE(TelemetrySchema::read(reader, out));
+}
@@ -0,0 +1,162 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+
+#include "serialization/Varint.h"
+
+using hal::serialization::BufferReader;
+using hal::serialization::BufferWriter;
+using hal::serialization::decodeVarint;
+using hal::serialization::encodeVarint;
+using hal::serialization::varintSize;
+using hal::serialization::zigzagDecode;
+using hal::serialization::zigzagEncode;
+
+static_assert(hal::serialization::varint_max_size_v<uint8_t> == 2);
+static_assert(hal::serialization::varint_max_size_v<uint32_t> == 5);
+static_assert(hal::serialization::varint_max_size_v<int64_t> == 10);
+
+static_assert(zigzagEncode(int32_t{0}) == 0U and zigzagEncode(int32_t{-1}) == 1U and zigzagEncode(int32_t{1}) == 2U);
+static_assert(zigzagEncode(std::numeric_limits<int32_t>::min()) == std::numeric_limits<uint32_t>::max());
+static_assert(zigzagDecode(uint32_t{3}) == -2);
+
+static_assert(varintSize(uint32_t{0}) == 1 and varintSize(uint32_t{127}) == 1 and varintSize(uint32_t{128}) == 2);
+static_assert(varintSize(std::numeric_limits<uint64_t>::max()) == 10);
+
+TEST(Varint, encoding) {
+
+    uint8_t data[10]{};
+
+    // Examples of the protobuf documentation
+    EXPECT_EQ(encodeVarint(uint32_t{1}, data), 1U);
+    EXPECT_EQ(data[0], 0x01);
+
+    EXPECT_EQ(encodeVarint(uint32_t{150}, data), 2U);
+    EXPECT_EQ(data[0], 0x96);
+    EXPECT_EQ(data[1], 0x01);
+
+    EXPECT_EQ(encodeVarint(std::numeric_limits<uint64_t>::max(), data), 10U);
+    EXPECT_EQ(data[9], 0x01);
+}
+
+TEST(Varint, decoding_errors) {
+
+    uint32_t value{42};
+    size_t length{0};
+
+    const uint8_t truncated[]{0x96};
+    EXPECT_EQ(decodeVarint(std::span<const uint8_t>{truncated}, value, length), hal::Error::TOOSMALL);
+
+    // 2^32 does not fit in an uint32_t
+    const uint8_t overflow[]{0x80, 0x80, 0x80, 0x80, 0x10};
+    EXPECT_EQ(decodeVarint(std::span<const uint8_t>{overflow}, value, length), hal::Error::TOOBIG);
+
+    // Too many bytes, even if the value would fit
+    const uint8_t overlong[]{0x80, 0x80, 0x80, 0x80, 0x80, 0x00};
+    EXPECT_EQ(decodeVarint(std::span<const uint8_t>{overlong}, value, length), hal::Error::TOOBIG);
+
+    uint8_t small{0};
+    const uint8_t overflow8[]{0x80, 0x02};
+    EXPECT_EQ(decodeVarint(std::span<const uint8_t>{overflow8}, small, length), hal::Error::TOOBIG);
+
+    EXPECT_EQ(value, 42U);
+
+    const uint8_t max8[]{0xFF, 0x01};
+    EXPECT_EQ(decodeVarint(std::span<const uint8_t>{max8}, small, length), hal::Error::NONE);
+    EXPECT_EQ(small, 0xFF);
+    EXPECT_EQ(length, 2U);
+}
+
+TEST(Varint, reader_error_sticky) {
+
+    // An overflowing varint, then bytes that would be valid values
+    const uint8_t data[]{0x80, 0x80, 0x80, 0x80, 0x10, 0x01, 0x02};
+    BufferReader reader{data};
+
+    uint32_t value{0};
+    uint8_t byte{0};
+
+    EXPECT_TRUE(readVarint(reader, value));
+    EXPECT_EQ(reader.getLastError(), hal::Error::TOOBIG);
+
+    // The next reads are refused and keep the cause
+    EXPECT_TRUE(reader.read(byte));
+    EXPECT_TRUE(readVarint(reader, value));
+    EXPECT_EQ(reader.getLastError(), hal::Error::TOOBIG);
+    EXPECT_EQ(byte, 0);
+}
+
+TEST(Varint, round_trip) {
+
+    std::mt19937_64 generator{42};
+    uint8_t buffer[1024]{};
+
+    BufferWriter writer{buffer};
+    std::vector<int64_t> signed_values;
+    std::vector<uint32_t> unsigned_values;
+
+    for(size_t i{0}; i < 50; i++) {
+
+        // Spread the values over every size
+        const auto shift{static_cast<uint>(generator() % 64)};
+        signed_values.push_back(static_cast<int64_t>(generator()) >> shift);
+        unsigned_values.push_back(static_cast<uint32_t>(generator() >> (shift + 32U) % 64U));
+
+        EXPECT_FALSE(writeVarint(writer, signed_values.back()));
+        EXPECT_FALSE(writeVarint(writer, unsigned_values.back()));
+    }
+
+    BufferReader reader{writer.getWritten()};
+
+    for(size_t i{0}; i < 50; i++) {
+
+        int64_t signed_value{0};
+        uint32_t unsigned_value{0};
+
+        EXPECT_FALSE(readVarint(reader, signed_value));
+        EXPECT_FALSE(readVarint(reader, unsigned_value));
+        EXPECT_EQ(signed_value, signed_values[i]);
+        EXPECT_EQ(unsigned_value, unsigned_values[i]);
+    }
+
+    EXPECT_EQ(reader.getRemaining(), 0U);
+
+    int8_t value{0};
+    EXPECT_TRUE(readVarint(reader, value));
+    EXPECT_EQ(reader.getLastError(), hal::Error::TOOSMALL);
+}
+
+TEST(Varint, fuzz) {
+
+    std::mt19937 generator{7};
+    uint8_t data[12]{};
+
+    for(size_t i{0}; i < 10000; i++) {
+
+        for(auto &byte : data) {
+            byte = static_cast<uint8_t>(generator());
+        }
+
+        uint64_t value{0};
+        size_t length{0};
+        const std::span<const uint8_t> input{data, generator() % (sizeof(data) + 1)};
+
+        // A decoded value must survive a round trip, its canonical encoding is never longer
+        if(decodeVarint(input, value, length) == hal::Error::NONE) {
+
+            uint8_t encoded[10]{};
+            uint64_t decoded{0};
+            size_t decoded_length{0};
+
+            ASSERT_LE(length, input.size());
+            ASSERT_LE(encodeVarint(value, encoded), length);
+            ASSERT_EQ(decodeVarint(std::span<const uint8_t>{encoded}, decoded, decoded_length), hal::Error::NONE);
+            ASSERT_EQ(decoded, value);
+        }
+    }
+}
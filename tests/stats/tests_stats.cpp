@@ -0,0 +1,237 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/GpioIRQ.h"
+#include "peripherals/UART.h"
+#include "stats/Stats.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef HAL_STATS
+#error "The statistics tests need the counters, build them with HAL_STATS"
+#endif
+
+using hal::peripherals::gpio::IRQ;
+using hal::peripherals::gpio::Event;
+using hal::peripherals::gpio::IRQDispatcher;
+using hal::peripherals::uart::UART;
+
+TEST(Stats, counter) {
+
+    hal::stats::Counter counter;
+
+    counter.add();
+    counter.add(41);
+    EXPECT_EQ(counter.get(), 42U);
+
+    counter.raise(10);
+    EXPECT_EQ(counter.get(), 42U);
+    counter.raise(100);
+    EXPECT_EQ(counter.get(), 100U);
+
+    hal::stats::Counter other;
+    other.take(counter);
+    EXPECT_EQ(other.get(), 100U);
+    EXPECT_EQ(counter.get(), 0U);
+}
+
+TEST(Stats, counter_threads) {
+
+    hal::stats::Counter counter;
+    hal::stats::Counter maximum;
+    std::vector<std::thread> threads;
+
+    for(uint32_t t{0}; t < 4; t++) {
+        threads.emplace_back([&counter, &maximum, t]() {
+            for(uint32_t i{0}; i < 10'000; i++) {
+                counter.add();
+                maximum.raise(t * 10'000 + i);
+            }
+        });
+    }
+
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(counter.get(), 40'000U);
+    EXPECT_EQ(maximum.get(), 39'999U);
+}
+
+TEST(Stats, uart_bytes) {
+
+    auto &uart{UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.resetStats();
+
+    const uint8_t data[]{1, 2, 3, 4, 5};
+    uint8_t received[16];
+
+    uart.write(data, sizeof(data));
+    uart.write(6);
+
+    const std::span<const uint8_t> buffers[]{{data, 2}, {data + 2, 3}};
+    uart.writev(buffers);
+
+    EXPECT_EQ(::recv(uart.getPeer(), received, 11, MSG_WAITALL), 11);
+
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+    uart.read(received, sizeof(data));
+
+    hal::stats::UARTStats stats{uart.getStats()};
+
+    EXPECT_EQ(stats.bytes_written, 11U);
+    EXPECT_EQ(stats.bytes_read, 5U);
+    EXPECT_EQ(stats.tx_stalls, 0U);
+    EXPECT_EQ(stats.overruns, 0U);
+    EXPECT_EQ(stats.framing_errors, 0U);
+    EXPECT_EQ(stats.parity_errors, 0U);
+    EXPECT_EQ(stats.breaks, 0U);
+
+    uart.resetStats();
+    stats = uart.getStats();
+    EXPECT_EQ(stats.bytes_written, 0U);
+    EXPECT_EQ(stats.bytes_read, 0U);
+
+    uart.deinit();
+}
+
+TEST(Stats, uart_tx_stall) {
+
+    auto &uart{UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.resetStats();
+
+    // More than the socket buffers hold, the write waits for the peer
+    std::vector<uint8_t> data(1U << 22U, 0x55);
+    std::vector<uint8_t> received(data.size());
+
+    std::thread peer{[&uart, &received]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        ::recv(uart.getPeer(), received.data(), received.size(), MSG_WAITALL);
+    }};
+
+    uart.write(data.data(), data.size());
+    peer.join();
+
+    const hal::stats::UARTStats stats{uart.getStats()};
+
+    EXPECT_EQ(stats.bytes_written, data.size());
+    EXPECT_EQ(stats.tx_stalls, 1U);
+
+    uart.deinit();
+}
+
+TEST(Stats, uart_buffered_overrun) {
+
+    auto &uart{UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.setBuffered(true);
+    uart.resetStats();
+
+    uint8_t data[hal::peripherals::UART_RX_BUFFER_SIZE + 64]{};
+    uint8_t received[sizeof(data)];
+
+    EXPECT_EQ(::write(uart.getPeer(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+
+    // The RX ring fills up, the main loop does not read
+    for(size_t i{0}; i < sizeof(data); i++) {
+        uart.raiseIRQ();
+    }
+
+    hal::stats::UARTStats stats{uart.getStats()};
+
+    EXPECT_EQ(stats.bytes_read, hal::peripherals::UART_RX_BUFFER_SIZE);
+    EXPECT_GT(stats.overruns, 0U);
+
+    uart.read(received, sizeof(data));
+    stats = uart.getStats();
+    EXPECT_EQ(stats.bytes_read, sizeof(data));
+
+    // The TX ring accepts what the wire takes, counted once sent
+    uart.write(data, 16);
+    uart.setBuffered(false);
+    EXPECT_EQ(::recv(uart.getPeer(), received, 16, MSG_WAITALL), 16);
+    EXPECT_EQ(uart.getStats().bytes_written, 16U);
+
+    uart.deinit();
+}
+
+TEST(Stats, uart_async) {
+
+    auto &uart{UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+    uart.resetStats();
+
+    const uint8_t data[]{1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t received[sizeof(data)];
+
+    EXPECT_FALSE(uart.writeAsync(data));
+
+    while(uart.isWriteBusy()) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(::recv(uart.getPeer(), received, sizeof(received), MSG_WAITALL), static_cast<ssize_t>(sizeof(received)));
+    EXPECT_EQ(uart.getStats().bytes_written, sizeof(data));
+
+    uart.deinit();
+}
+
+TEST(Stats, gpio) {
+
+    auto &dispatcher{IRQDispatcher::getInstance()};
+    auto &bank{hal::host::PinBank::getInstance()};
+    Event event{};
+
+    bank.reset();
+
+    while(dispatcher.popEvent(event)) {}
+
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO9};
+    gpio.resetStats();
+
+    gpio.write(1);
+    gpio.write(0);
+    gpio.toggle();
+
+    gpio.setDirection(hal::peripherals::gpio::Direction::IN);
+    EXPECT_FALSE(gpio.setIRQ(IRQ::EDGE_RISE));
+
+    bank.drive(hal::GPIO9, false);
+    bank.drive(hal::GPIO9, true);
+    bank.drive(hal::GPIO9, false);
+    bank.drive(hal::GPIO9, true);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+
+    while(dispatcher.popEvent(event)) {}
+
+    hal::stats::GPIOStats stats{gpio.getStats()};
+
+    EXPECT_EQ(stats.writes, 2U);
+    EXPECT_EQ(stats.toggles, 1U);
+    EXPECT_EQ(stats.irqs, 2U);
+    EXPECT_GE(stats.max_irq_latency, 2'000U);
+
+    // The counters follow the pin when it is moved
+    hal::peripherals::gpio::DigitalInOut moved{std::move(gpio)};
+    EXPECT_EQ(moved.getStats().writes, 2U);
+
+    moved.resetStats();
+    stats = moved.getStats();
+
+    EXPECT_EQ(stats.writes, 0U);
+    EXPECT_EQ(stats.toggles, 0U);
+    EXPECT_EQ(stats.irqs, 0U);
+    EXPECT_EQ(stats.max_irq_latency, 0U);
+}
@@ -0,0 +1,354 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "timers/TimerWheel.h"
+
+using hal::timers::TimerId;
+using hal::timers::TimerWheel;
+using hal::timers::TIMER_TICK_US;
+
+namespace {
+
+    /// Time of every expiry, read on the fake clock
+    struct Log {
+
+        std::vector<uint64_t> times;
+        std::vector<TimerId> timers;
+    };
+
+    void record(const TimerId timer, void * const context) {
+
+        auto * const log{static_cast<Log *>(context)};
+
+        log->times.push_back(hal::host::FakeClock::getInstance().now());
+        log->timers.push_back(timer);
+    }
+
+    struct CancelAfter {
+
+        TimerWheel *wheel;
+        size_t remaining;
+        size_t calls;
+    };
+
+    void cancelAfter(const TimerId timer, void * const context) {
+
+        auto * const state{static_cast<CancelAfter *>(context)};
+
+        state->calls++;
+
+        if(--state->remaining == 0) {
+            EXPECT_FALSE(state->wheel->cancel(timer));
+        }
+    }
+
+    hal::host::FakeClock &resetClock() {
+
+        auto &clock{hal::host::FakeClock::getInstance()};
+        clock.reset();
+
+        return clock;
+    }
+
+} // namespace
+
+TEST(TimerWheel, one_shot) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer{hal::timers::INVALID_TIMER};
+
+    EXPECT_FALSE(wheel.start(timer, 10'000, record, &log));
+    EXPECT_NE(timer, hal::timers::INVALID_TIMER);
+    EXPECT_TRUE(wheel.isActive(timer));
+    EXPECT_EQ(wheel.getActiveCount(), 1U);
+    EXPECT_EQ(wheel.getNextDeadline(), 10'000U);
+
+    clock.advance(9'999);
+    EXPECT_EQ(wheel.runPending(), 0U);
+
+    clock.advance(1);
+    EXPECT_EQ(wheel.runPending(), 1U);
+    EXPECT_EQ(log.timers, std::vector<TimerId>{timer});
+
+    EXPECT_FALSE(wheel.isActive(timer));
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+    EXPECT_EQ(wheel.getNextDeadline(), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(wheel.runPending(), 0U);
+}
+
+TEST(TimerWheel, rounds_up) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer;
+
+    clock.advance(300);
+
+    // Never early: 300 + 1500 = 1800, expires on the tick at 2000
+    wheel.start(timer, 1'500, record, &log);
+    wheel.start(timer, 0, record, &log);
+
+    clock.advance(1'699);
+    EXPECT_EQ(wheel.runPending(), 1U);
+
+    clock.advance(1);
+    EXPECT_EQ(wheel.runPending(), 1U);
+}
+
+TEST(TimerWheel, expiry_order) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId t30, t10, t20, t10_bis;
+
+    wheel.start(t30, 30'000, record, &log);
+    wheel.start(t10, 10'000, record, &log);
+    wheel.start(t20, 20'000, record, &log);
+    wheel.start(t10_bis, 10'000, record, &log);
+
+    clock.advance(100'000);
+    EXPECT_EQ(wheel.runPending(), 4U);
+
+    // Started first, expires first within a tick
+    EXPECT_EQ(log.timers, (std::vector<TimerId>{t10, t10_bis, t20, t30}));
+}
+
+TEST(TimerWheel, cancel) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId kept, cancelled;
+
+    wheel.start(kept, 5'000, record, &log);
+    wheel.start(cancelled, 5'000, record, &log);
+
+    EXPECT_FALSE(wheel.cancel(cancelled));
+    EXPECT_FALSE(wheel.isActive(cancelled));
+
+    EXPECT_TRUE(wheel.cancel(cancelled));
+    EXPECT_EQ(wheel.getLastError(), hal::Error::ERROR);
+    EXPECT_TRUE(wheel.cancel(hal::timers::INVALID_TIMER));
+
+    // The slot is reused, the old identifier stays invalid
+    TimerId reused;
+    wheel.start(reused, 1'000'000, record, &log);
+    EXPECT_NE(reused, cancelled);
+    EXPECT_FALSE(wheel.isActive(cancelled));
+    EXPECT_TRUE(wheel.cancel(cancelled));
+
+    clock.advance(5'000);
+    EXPECT_EQ(wheel.runPending(), 1U);
+    EXPECT_EQ(log.timers, std::vector<TimerId>{kept});
+    EXPECT_TRUE(wheel.isActive(reused));
+}
+
+TEST(TimerWheel, periodic) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer;
+
+    EXPECT_FALSE(wheel.startPeriodic(timer, 7'000, record, &log));
+
+    for(size_t i{0}; i < 100; i++) {
+        clock.advance(1'000);
+        wheel.runPending();
+    }
+
+    ASSERT_EQ(log.times.size(), 14U);
+
+    for(size_t i{0}; i < log.times.size(); i++) {
+        EXPECT_EQ(log.times[i], (i + 1) * 7'000);
+    }
+
+    EXPECT_TRUE(wheel.isActive(timer));
+    EXPECT_EQ(wheel.getNextDeadline(), 105'000U);
+}
+
+TEST(TimerWheel, periodic_skips_missed) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer;
+
+    wheel.startPeriodic(timer, 10'000, record, &log);
+
+    // Late by 9 periods: one call, the phase is kept
+    clock.advance(95'000);
+    EXPECT_EQ(wheel.runPending(), 1U);
+    EXPECT_EQ(wheel.getNextDeadline(), 100'000U);
+
+    clock.advance(5'000);
+    EXPECT_EQ(wheel.runPending(), 1U);
+}
+
+TEST(TimerWheel, periodic_cancels_itself) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    CancelAfter state{&wheel, 3, 0};
+    TimerId timer;
+
+    wheel.startPeriodic(timer, 1'000, cancelAfter, &state);
+
+    for(size_t i{0}; i < 10; i++) {
+        clock.advance(1'000);
+        wheel.runPending();
+    }
+
+    EXPECT_EQ(state.calls, 3U);
+    EXPECT_FALSE(wheel.isActive(timer));
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+}
+
+TEST(TimerWheel, slots_exhausted) {
+
+    resetClock();
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer;
+
+    for(size_t i{0}; i < hal::timers::TIMER_SLOTS; i++) {
+        EXPECT_FALSE(wheel.start(timer, 1'000 * (i + 1), record, &log));
+    }
+
+    EXPECT_TRUE(wheel.start(timer, 1'000, record, &log));
+    EXPECT_EQ(wheel.getLastError(), hal::Error::TOOSMALL);
+
+    EXPECT_TRUE(wheel.start(timer, 1'000, nullptr));
+    EXPECT_EQ(wheel.getLastError(), hal::Error::ERROR);
+
+    EXPECT_FALSE(wheel.cancel(timer));
+    EXPECT_FALSE(wheel.start(timer, 1'000, record, &log));
+}
+
+TEST(TimerWheel, alarm_cascades) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    TimerId timer;
+
+    // Every level of the wheel, the boundaries between them, and the overflow list
+    const std::vector<uint64_t> ticks{1, 63, 64, 65, 127, 4'095, 4'096, 4'097, 262'143, 262'144, 300'000,
+                                      16'777'215, 16'777'216, 16'777'217, 40'000'000};
+
+    for(auto it{ticks.rbegin()}; it != ticks.rend(); it++) {
+        wheel.start(timer, *it * TIMER_TICK_US, record, &log);
+    }
+
+    EXPECT_FALSE(wheel.enableAlarm());
+    EXPECT_EQ(log.times.size(), 0U);
+
+    clock.advance(ticks.back() * TIMER_TICK_US);
+
+    ASSERT_EQ(log.times.size(), ticks.size());
+
+    for(size_t i{0}; i < ticks.size(); i++) {
+        EXPECT_EQ(log.times[i], ticks[i] * TIMER_TICK_US);
+    }
+
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+
+    wheel.disableAlarm();
+}
+
+TEST(TimerWheel, alarms_exhausted) {
+
+    resetClock();
+    TimerWheel wheels[hal::host::NUMBER_ALARMS + 1]{};
+
+    for(size_t i{0}; i < hal::host::NUMBER_ALARMS; i++) {
+        EXPECT_FALSE(wheels[i].enableAlarm());
+    }
+
+    EXPECT_TRUE(wheels[hal::host::NUMBER_ALARMS].enableAlarm());
+    EXPECT_EQ(wheels[hal::host::NUMBER_ALARMS].getLastError(), hal::Error::ERROR);
+
+    // Released by disableAlarm()
+    wheels[0].disableAlarm();
+    EXPECT_FALSE(wheels[hal::host::NUMBER_ALARMS].enableAlarm());
+}
+
+TEST(TimerWheel, random_against_model) {
+
+    auto &clock{resetClock()};
+    TimerWheel wheel{};
+    Log log;
+    std::mt19937_64 rng{42};
+    std::map<TimerId, uint64_t> expected;     // Active timer -> expiry time
+    std::vector<std::pair<TimerId, uint64_t>> fired_expected;
+
+    wheel.enableAlarm();
+
+    for(size_t step{0}; step < 5'000; step++) {
+
+        const uint64_t choice{rng() % 10};
+
+        if(choice < 5 and expected.size() < hal::timers::TIMER_SLOTS) {
+
+            // From a microsecond to hours, rounded up to the tick
+            const uint64_t delay{1 + rng() % (1ULL << (rng() % 34))};
+            TimerId timer;
+
+            ASSERT_FALSE(wheel.start(timer, delay, record, &log));
+            expected[timer] = (clock.now() + delay + TIMER_TICK_US - 1) / TIMER_TICK_US * TIMER_TICK_US;
+        } else if(choice < 7 and !expected.empty()) {
+
+            auto it{expected.begin()};
+            std::advance(it, static_cast<long>(rng() % expected.size()));
+
+            ASSERT_FALSE(wheel.cancel(it->first));
+            expected.erase(it);
+        } else {
+
+            const uint64_t target{clock.now() + rng() % (1ULL << (rng() % 28))};
+
+            for(auto it{expected.begin()}; it != expected.end();) {
+
+                if(it->second <= target) {
+
+                    fired_expected.emplace_back(it->first, it->second);
+                    it = expected.erase(it);
+                } else {
+                    it++;
+                }
+            }
+
+            clock.advance(target - clock.now());
+        }
+    }
+
+    ASSERT_EQ(log.timers.size(), fired_expected.size());
+
+    std::map<TimerId, uint64_t> fired;
+    std::map<TimerId, uint64_t> model;
+
+    for(size_t i{0}; i < log.timers.size(); i++) {
+
+        fired[log.timers[i]] = log.times[i];
+        model[fired_expected[i].first] = fired_expected[i].second;
+
+        // In expiry order
+        if(i > 0) {
+            EXPECT_LE(log.times[i - 1], log.times[i]);
+        }
+    }
+
+    EXPECT_EQ(fired, model);
+    EXPECT_EQ(wheel.getActiveCount(), expected.size());
+}
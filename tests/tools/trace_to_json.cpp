@@ -0,0 +1,35 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+// Convert a trace exported over a UART (see trace/TraceExport.h) to the Chrome trace event format.
+// Usage: Trace_To_Json < capture.bin > trace.json
+
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "trace/TraceJson.h"
+
+int main() {
+
+    std::vector<uint8_t> stream;
+
+    for(int c{getchar()}; c != EOF; c = getchar()) {
+        stream.push_back(static_cast<uint8_t>(c));
+    }
+
+    std::string json;
+    const bool error{hal::trace::traceToJson(stream, json)};
+
+    fputs(json.c_str(), stdout);
+
+    if(error) {
+
+        fputs("trace_to_json: malformed capture, the events before the error were converted\n", stderr);
+        return 1;
+    }
+
+    return 0;
+}
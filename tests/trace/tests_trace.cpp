@@ -0,0 +1,238 @@
+//
+// Created by marmelade on 17/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "peripherals/DigitalInOut.h"
+#include "peripherals/UART.h"
+#include "trace/Trace.h"
+#include "trace/TraceExport.h"
+#include "trace/TraceJson.h"
+
+#include <unistd.h>
+
+#ifndef HAL_TRACE
+#error "The trace tests need the probes, build them with HAL_TRACE"
+#endif
+
+using hal::trace::Event;
+using hal::trace::Phase;
+using hal::trace::Tracer;
+
+namespace {
+
+    /// Sink capturing the export
+    struct VectorSink {
+
+        void write(const uint8_t * const data, const size_t length) {
+
+            bytes.insert(bytes.end(), data, data + length);
+        }
+
+        std::vector<uint8_t> bytes;
+    };
+
+    Tracer &resetTracer() {
+
+        auto &tracer{Tracer::getInstance()};
+
+        tracer.setEnabled(true);
+        tracer.clear();
+
+        return tracer;
+    }
+
+    void traced(const int depth) {
+
+        HAL_TRACE_SCOPE("traced");
+
+        if(depth > 0) {
+
+            HAL_TRACE_SCOPE("traced.inner");
+            traced(depth - 1);
+        }
+    }
+
+    size_t count(const std::string &text, const std::string &pattern) {
+
+        size_t found{0};
+
+        for(size_t position{text.find(pattern)}; position != std::string::npos; position = text.find(pattern, position + 1)) {
+            found++;
+        }
+
+        return found;
+    }
+
+} // namespace
+
+TEST(Trace, scope) {
+
+    auto &tracer{resetTracer()};
+    Event events[8];
+
+    traced(1);
+
+    ASSERT_EQ(tracer.getRecorded(0), 6U);
+    ASSERT_EQ(tracer.getEvents(0, events), 6U);
+
+    const char * const names[]{"traced", "traced.inner", "traced", "traced", "traced.inner", "traced"};
+    const Phase phases[]{Phase::BEGIN, Phase::BEGIN, Phase::BEGIN, Phase::END, Phase::END, Phase::END};
+
+    for(size_t i{0}; i < 6; i++) {
+
+        EXPECT_STREQ(events[i].name, names[i]);
+        EXPECT_EQ(events[i].phase, phases[i]);
+
+        if(i > 0) {
+            EXPECT_GE(static_cast<int32_t>(events[i].timestamp - events[i - 1].timestamp), 0);
+        }
+    }
+}
+
+TEST(Trace, paused) {
+
+    auto &tracer{resetTracer()};
+
+    tracer.setEnabled(false);
+    traced(3);
+    EXPECT_EQ(tracer.getRecorded(0), 0U);
+
+    tracer.setEnabled(true);
+    traced(0);
+    EXPECT_EQ(tracer.getRecorded(0), 2U);
+}
+
+TEST(Trace, ring_keeps_last_events) {
+
+    auto &tracer{resetTracer()};
+    const char * const names[]{"a", "b", "c"};
+
+    for(size_t i{0}; i < hal::trace::TRACE_BUFFER_SIZE + 10; i++) {
+        tracer.record(names[i % 3], Phase::BEGIN);
+    }
+
+    EXPECT_EQ(tracer.getRecorded(0), hal::trace::TRACE_BUFFER_SIZE + 10);
+
+    // Read in chunks, oldest first
+    std::vector<Event> events;
+    Event chunk[7];
+
+    for(size_t first{0}, read{0}; (read = tracer.getEvents(0, chunk, first)) > 0; first += read) {
+        events.insert(events.end(), chunk, chunk + read);
+    }
+
+    ASSERT_EQ(events.size(), hal::trace::TRACE_BUFFER_SIZE);
+
+    for(size_t i{0}; i < events.size(); i++) {
+        EXPECT_EQ(events[i].name, names[(i + 10) % 3]);
+    }
+}
+
+TEST(Trace, export_to_json) {
+
+    auto &tracer{resetTracer()};
+    VectorSink sink;
+
+    traced(2);
+    tracer.record("quote\"name", Phase::BEGIN);
+    tracer.record("quote\"name", Phase::END);
+
+    EXPECT_EQ(hal::trace::exportTrace(sink), 12U);
+    EXPECT_TRUE(tracer.isEnabled());
+
+    // COBS frames: no 0x00 but the delimiters
+    EXPECT_EQ(sink.bytes.back(), 0);
+
+    std::string json;
+    EXPECT_FALSE(hal::trace::traceToJson(sink.bytes, json));
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0U);
+    EXPECT_EQ(json.substr(json.size() - 2), "]}");
+    EXPECT_EQ(count(json, "\"name\":\"traced\""), 6U);
+    EXPECT_EQ(count(json, "\"name\":\"traced.inner\""), 4U);
+    EXPECT_EQ(count(json, "\"name\":\"quote\\\"name\""), 2U);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), 6U);
+    EXPECT_EQ(count(json, "\"ph\":\"E\""), 6U);
+    EXPECT_EQ(count(json, "\"tid\":0"), 12U);
+}
+
+TEST(Trace, export_many_events) {
+
+    resetTracer();
+    VectorSink sink;
+
+    // Several event frames per core
+    for(size_t i{0}; i < hal::trace::TRACE_BUFFER_SIZE / 2; i++) {
+        traced(0);
+    }
+
+    EXPECT_EQ(hal::trace::exportTrace(sink), hal::trace::TRACE_BUFFER_SIZE);
+
+    std::string json;
+    EXPECT_FALSE(hal::trace::traceToJson(sink.bytes, json));
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), hal::trace::TRACE_BUFFER_SIZE / 2);
+
+    // A few bytes per event on the wire
+    EXPECT_LT(sink.bytes.size(), hal::trace::TRACE_BUFFER_SIZE * 5);
+}
+
+TEST(Trace, export_over_uart) {
+
+    auto &uart{hal::peripherals::uart::UART::getInstance(hal::peripherals::UART_INSTANCE0)};
+    uart.init(hal::GPIO1, hal::GPIO0, hal::peripherals::UART_DEFAULT_BAUD_RATE);
+
+    resetTracer();
+    traced(0);
+
+    hal::trace::exportTrace(uart);
+
+    uint8_t received[256];
+    const ssize_t length{::read(uart.getPeer(), received, sizeof(received))};
+    ASSERT_GT(length, 0);
+
+    std::string json;
+    EXPECT_FALSE(hal::trace::traceToJson({received, static_cast<size_t>(length)}, json));
+    EXPECT_EQ(count(json, "\"name\":\"traced\""), 2U);
+
+    uart.deinit();
+}
+
+TEST(Trace, peripheral_probes) {
+
+    hal::host::PinBank::getInstance().reset();
+
+    auto &tracer{resetTracer()};
+    hal::peripherals::gpio::DigitalInOut gpio{hal::GPIO7};
+    Event events[2];
+
+    tracer.clear();
+    gpio.write(1);
+
+    ASSERT_EQ(tracer.getEvents(0, events), 2U);
+    EXPECT_STREQ(events[0].name, "gpio.write");
+    EXPECT_EQ(events[0].phase, Phase::BEGIN);
+    EXPECT_EQ(events[1].phase, Phase::END);
+}
+
+TEST(Trace, malformed_capture) {
+
+    std::string json;
+
+    // Events before the header
+    const uint8_t no_header[]{0x02, 'E', 0x01, 0x00};
+    EXPECT_TRUE(hal::trace::traceToJson(no_header, json));
+
+    // Unknown frame type
+    const uint8_t unknown[]{0x02, 'X', 0x00};
+    EXPECT_TRUE(hal::trace::traceToJson(unknown, json));
+
+    // Truncated: nothing to convert, not an error
+    const uint8_t truncated[]{0x05, 'T', 0x01};
+    EXPECT_FALSE(hal::trace::traceToJson(truncated, json));
+    EXPECT_EQ(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}");
+}